@@ -0,0 +1,13 @@
+#include "bench.h"
+
+#include "bench_clientvariables.h"
+#include "bench_clock.h"
+#include "bench_console.h"
+#include "bench_crypto.h"
+#include "bench_input.h"
+#include "bench_jobs.h"
+#include "bench_packetcapture.h"
+#include "bench_prefixindex.h"
+#include "bench_shardedserver.h"
+
+int main(int argc, char **argv) { return bench::runBenchmarks(argc, argv); }
@@ -0,0 +1,98 @@
+//===-- bench.h - Minimal benchmark harness ---------------------*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Register and run benchmarks.
+///
+/// Benchmarks are declared with the BENCHMARK macro in bench_*.h headers
+/// included from bench.cpp, the same way tests are laid out. Each one times
+/// what it's interested in and reports results with 'report'.
+///
+/// Usage: svBench [name...]
+/// With no names, every benchmark is run.
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace bench {
+typedef void (*BenchmarkFunction)();
+
+struct Benchmark {
+    const char *name;
+    BenchmarkFunction function;
+};
+
+inline std::vector<Benchmark> &getBenchmarks() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Registrar {
+    Registrar(const char *name, BenchmarkFunction function) {
+        Benchmark benchmark = {name, function};
+        getBenchmarks().push_back(benchmark);
+    }
+};
+
+///-----------------------------------------------------------------------------
+/// \returns Seconds since an arbitrary point, for timing.
+///-----------------------------------------------------------------------------
+inline double now() {
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+///-----------------------------------------------------------------------------
+/// Print one result of a benchmark.
+///-----------------------------------------------------------------------------
+inline void report(const char *label, double value, const char *unit) {
+    printf("    %-40s %14.2f %s\n", label, value, unit);
+    fflush(stdout);
+}
+
+///-----------------------------------------------------------------------------
+/// Run the benchmarks named in \p argv, or all of them if none are named.
+///-----------------------------------------------------------------------------
+inline int runBenchmarks(int argc, char **argv) {
+    int numRun = 0;
+
+    const std::vector<Benchmark> &benchmarks = getBenchmarks();
+    for (size_t i = 0; i < benchmarks.size(); ++i) {
+        bool selected = argc <= 1;
+        for (int arg = 1; arg < argc; ++arg) {
+            if (strcmp(argv[arg], benchmarks[i].name) == 0) {
+                selected = true;
+            }
+        }
+
+        if (selected) {
+            printf("%s\n", benchmarks[i].name);
+            benchmarks[i].function();
+            ++numRun;
+        }
+    }
+
+    if (numRun == 0) {
+        printf("No benchmarks matched.\n");
+        return 1;
+    }
+
+    return 0;
+}
+}
+
+#define BENCHMARK(name)                                                        \
+    static void bench_##name();                                                \
+    static bench::Registrar registrar_##name(#name, bench_##name);             \
+    static void bench_##name()
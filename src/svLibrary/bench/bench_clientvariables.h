@@ -0,0 +1,51 @@
+#include <cstdio>
+#include <string>
+
+#include <sv/ClientVariables.h>
+
+// Client variables read per second by name through the string interface, which
+// looks the name up and parses the value, and through a handle
+BENCHMARK(ClientVariablesRead) {
+    const double duration = 0.5;
+
+    sv::ClientVariables cvars;
+    for (int i = 0; i < 200; ++i) {
+        cvars.registerFloat("var" + std::to_string(i), (float)i);
+    }
+    cvars.setStringValue("sensitivity", "2.5");
+    sv::CVar gamma = cvars.registerFloat("gamma", 1.5f);
+
+    // By name, unregistered
+    const std::string name = "sensitivity";
+    uint64_t numReads      = 0;
+    float check            = 0.0f;
+    double start           = bench::now();
+    double elapsed         = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 1000; ++batch) {
+            float value = 0.0f;
+            cvars.getFloatValue(name, &value);
+            check += value;
+            ++numReads;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("by name, parsed", numReads / elapsed, "reads/s");
+
+    // Handle
+    numReads = 0;
+    start    = bench::now();
+    elapsed  = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 1000; ++batch) {
+            check += gamma.getFloat();
+            ++numReads;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("handle", numReads / elapsed, "reads/s");
+
+    if (check == 0.0f) {
+        std::printf("ClientVariablesRead: nothing read\n");
+    }
+}
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <time.h>
+
+#include <sv/Clock.h>
+
+namespace {
+// Sleeps timed per way of sleeping, at a typical frame's leftover time
+const int BENCH_CLOCK_NUM_SLEEPS      = 200;
+const int64_t BENCH_CLOCK_SLEEP_NANOS = 2000000;
+
+// Report the median and worst lateness of \p lateness in microseconds
+void reportLateness(const char *label, std::vector<int64_t> &lateness) {
+    std::sort(lateness.begin(), lateness.end());
+    char name[64];
+    snprintf(name, sizeof(name), "%s median late", label);
+    bench::report(name, lateness[lateness.size() / 2] * 1e-3, "us");
+    snprintf(name, sizeof(name), "%s 99th late", label);
+    bench::report(name, lateness[lateness.size() * 99 / 100] * 1e-3, "us");
+}
+}
+
+// Cost of reading the clock, and how late sleeping for a frame's leftover
+// time wakes up, with a plain sleep against sleeping then spinning
+BENCHMARK(Clock) {
+    const double duration = 0.5;
+
+    uint64_t numReads = 0;
+    int64_t check     = 0;
+    double start      = bench::now();
+    double elapsed    = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 1000; ++batch) {
+            check += sv::Clock::now().nanoseconds & 1;
+            ++numReads;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("now", elapsed * 1e9 / numReads, "ns/call");
+
+    std::vector<int64_t> lateness;
+    for (int i = 0; i < BENCH_CLOCK_NUM_SLEEPS; ++i) {
+        sv::TimePoint deadline = sv::Clock::now() + BENCH_CLOCK_SLEEP_NANOS;
+        struct timespec t;
+        t.tv_sec  = 0;
+        t.tv_nsec = (long)BENCH_CLOCK_SLEEP_NANOS;
+        nanosleep(&t, NULL);
+        lateness.push_back(sv::Clock::now() - deadline);
+    }
+    reportLateness("nanosleep", lateness);
+
+    lateness.clear();
+    for (int i = 0; i < BENCH_CLOCK_NUM_SLEEPS; ++i) {
+        sv::TimePoint deadline = sv::Clock::now() + BENCH_CLOCK_SLEEP_NANOS;
+        sv::sleepUntil(deadline);
+        lateness.push_back(sv::Clock::now() - deadline);
+    }
+    reportLateness("sleepUntil", lateness);
+
+    if (check < 0) {
+        std::printf("Clock: clock went backwards\n");
+    }
+}
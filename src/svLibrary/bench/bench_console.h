@@ -0,0 +1,194 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <sv/console/Console.h>
+
+extern "C" {
+#include <sv/console/Commands.h>
+#include <sv/console/OutputBuffer.h>
+#include <sv/console/Tokenizer.h>
+}
+
+namespace {
+// Typical key bound and config lines
+const char *BENCH_CONSOLE_LINES[] = {
+    "+forward",
+    "bind \"KEY_W\" \"+forward\"",
+    "set sensitivity 2.5 ; set invert_mouse 0 ; echo \"Mouse updated\"",
+    "net_sim latency 100 ; net_sim jitter 20 ; net_sim loss 5",
+};
+const size_t BENCH_CONSOLE_NUM_LINES =
+    sizeof(BENCH_CONSOLE_LINES) / sizeof(BENCH_CONSOLE_LINES[0]);
+
+class NopCommand : public sv::ConsoleCommand {
+  public:
+    virtual bool execute(sv::Console &, int, char *[]) { return true; }
+};
+
+// Parse a line the way the console used to: validate, count, tokenize, then
+// copy every argument into its own allocation
+int parseWithCopies(const char *line) {
+    std::string input(line);
+
+    int numTokens = svTokenizerGetNumTokens(input.c_str(), NULL) + 1;
+    char **token  = (char **)calloc(numTokens, sizeof(char *));
+    svTokenizerTokenize(&input[0], token, NULL);
+
+    int numCommands     = svCommandsGetNum(token, NULL) + 1;
+    svCommand *commands = (svCommand *)calloc(numCommands, sizeof(svCommand));
+    svCommandsMakeNullCommand(commands + numCommands - 1);
+    svCommandsSeparate(token, commands, NULL);
+
+    svCommandsFreeContents(commands);
+    free(commands);
+    free(token);
+
+    return numCommands - 1;
+}
+}
+
+// Lines tokenized and split into commands per second, with the old copying
+// parser for comparison, and lines executed by a console per second, with and
+// without help from its cache of parsed lines
+BENCHMARK(ConsoleParse) {
+    const double duration = 0.5;
+
+    // Copying parser
+    uint64_t numLines = 0;
+    uint64_t check    = 0;
+    double start      = bench::now();
+    double elapsed    = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 1000; ++batch) {
+            check += parseWithCopies(
+                BENCH_CONSOLE_LINES[numLines % BENCH_CONSOLE_NUM_LINES]);
+            ++numLines;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("parse with copies", numLines / elapsed, "lines/s");
+
+    // In place parser
+    char line[256];
+    char *token[sizeof(line) / 2 + 2];
+    svCommand commands[sizeof(line) / 2 + 2];
+    numLines = 0;
+    start    = bench::now();
+    elapsed  = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 1000; ++batch) {
+            strcpy(line,
+                   BENCH_CONSOLE_LINES[numLines % BENCH_CONSOLE_NUM_LINES]);
+            svTokenizerTokenizeInPlace(line, token,
+                                       sizeof(token) / sizeof(token[0]), NULL);
+            check += svCommandsSeparateInPlace(token, commands, NULL);
+            ++numLines;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("parse in place", numLines / elapsed, "lines/s");
+
+    // Whole console, including command lookup
+    sv::Console console;
+    std::shared_ptr<NopCommand> nop(new NopCommand);
+    const char *names[] = {"+forward", "bind", "set", "echo", "net_sim"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        console.registerCommand(names[i], nop);
+    }
+    numLines = 0;
+    start    = bench::now();
+    elapsed  = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 1000; ++batch) {
+            console.appendString(
+                BENCH_CONSOLE_LINES[numLines % BENCH_CONSOLE_NUM_LINES]);
+            check += console.execute();
+            ++numLines;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("console execute repeated lines", numLines / elapsed,
+                  "lines/s");
+
+    // Lines never seen before, so never found in the console's line cache
+    std::string unique;
+    numLines = 0;
+    start    = bench::now();
+    elapsed  = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 1000; ++batch) {
+            char number[32];
+            snprintf(number, sizeof(number), " %llu",
+                     (unsigned long long)numLines);
+            unique.assign(
+                BENCH_CONSOLE_LINES[numLines % BENCH_CONSOLE_NUM_LINES]);
+            unique.append(number);
+            console.appendString(unique);
+            check += console.execute();
+            ++numLines;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("console execute unique lines", numLines / elapsed,
+                  "lines/s");
+
+    if (check == 0) {
+        std::printf("ConsoleParse: nothing parsed\n");
+    }
+}
+
+// Lines of a large listing written per second, building a string per line the
+// way commands used to and printing straight into an output buffer. Each
+// listing is cleared and written again, as a command's output is every time it
+// executes.
+BENCHMARK(ConsoleOutput) {
+    const double duration  = 0.5;
+    const int linesPerDump = 10000;
+
+    // String concatenation
+    std::string output;
+    uint64_t numLines = 0;
+    uint64_t check    = 0;
+    double start      = bench::now();
+    double elapsed    = 0.0;
+    while (elapsed < duration) {
+        std::string dump;
+        for (int i = 0; i < linesPerDump; ++i) {
+            char line[64];
+            snprintf(line, sizeof(line), "textures/wall_%d.png %d bytes\n", i,
+                     i * 64);
+            dump += std::string(line);
+        }
+        output.swap(dump);
+        check += output.size();
+        numLines += linesPerDump;
+        elapsed = bench::now() - start;
+    }
+    bench::report("string append", numLines / elapsed, "lines/s");
+
+    // Output buffer
+    svOutputBuffer buffer;
+    svOutputBufferInit(&buffer, 0);
+    numLines = 0;
+    start    = bench::now();
+    elapsed  = 0.0;
+    while (elapsed < duration) {
+        svOutputBufferClear(&buffer);
+        for (int i = 0; i < linesPerDump; ++i) {
+            svOutputBufferPrint(&buffer, "textures/wall_%d.png %d bytes\n", i,
+                                i * 64);
+        }
+        check += svOutputBufferGetSize(&buffer);
+        numLines += linesPerDump;
+        elapsed = bench::now() - start;
+    }
+    bench::report("output buffer print", numLines / elapsed, "lines/s");
+    svOutputBufferFree(&buffer);
+
+    if (check == 0) {
+        std::printf("ConsoleOutput: nothing written\n");
+    }
+}
@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <vector>
+
+#include <sv/network/Crypto.h>
+
+// Cost of encrypting and authenticating a packet, and of checking and
+// decrypting it again, at typical game packet sizes
+BENCHMARK(CryptoAead) {
+    const size_t sizes[]  = {64, 256, 1200};
+    const double duration = 0.5;
+
+    uint8_t key[sv::net::CRYPTO_KEY_SIZE];
+    sv::net::randomBytes(key, sizeof(key));
+    uint8_t nonce[sv::net::CRYPTO_NONCE_SIZE] = {};
+    uint8_t header[17] = {};
+    uint8_t tag[sv::net::CRYPTO_TAG_SIZE];
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        std::vector<uint8_t> packet(sizes[i], 0xAB);
+
+        // Encrypt
+        uint64_t numPackets       = 0;
+        const double encryptStart = bench::now();
+        double elapsed            = 0.0;
+        while (elapsed < duration) {
+            for (int batch = 0; batch < 1000; ++batch) {
+                nonce[4] = (uint8_t)numPackets;
+                sv::net::aeadEncrypt(key, nonce, header, sizeof(header),
+                                     &packet[0], packet.size(), &packet[0],
+                                     tag);
+                ++numPackets;
+            }
+            elapsed = bench::now() - encryptStart;
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "encrypt %u bytes",
+                 (unsigned)sizes[i]);
+        bench::report(label, numPackets / elapsed, "packets/s");
+        snprintf(label, sizeof(label), "encrypt %u bytes throughput",
+                 (unsigned)sizes[i]);
+        bench::report(label,
+                      numPackets * sizes[i] / elapsed / (1024.0 * 1024.0),
+                      "MB/s");
+
+        // Decrypt, the tag is checked before anything is decrypted
+        sv::net::aeadEncrypt(key, nonce, header, sizeof(header), &packet[0],
+                             packet.size(), &packet[0], tag);
+        std::vector<uint8_t> plaintext(packet.size());
+        uint64_t numDecrypted     = 0;
+        numPackets                = 0;
+        const double decryptStart = bench::now();
+        elapsed                   = 0.0;
+        while (elapsed < duration) {
+            for (int batch = 0; batch < 1000; ++batch) {
+                numDecrypted += sv::net::aeadDecrypt(
+                    key, nonce, header, sizeof(header), &packet[0],
+                    packet.size(), tag, &plaintext[0]);
+                ++numPackets;
+            }
+            elapsed = bench::now() - decryptStart;
+        }
+
+        snprintf(label, sizeof(label), "decrypt %u bytes",
+                 (unsigned)sizes[i]);
+        bench::report(label, numPackets / elapsed, "packets/s");
+        if (numDecrypted != numPackets) {
+            printf("    decrypt failed!\n");
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sv/console/Console.h>
+#include <sv/input/Input.h>
+#include <sv/input/InputDispatcher.h>
+#include <sv/platform/Keycodes.h>
+
+namespace {
+class BenchNopCommand : public sv::ConsoleCommand {
+  public:
+    virtual bool execute(sv::Console &, int, char *[]) { return true; }
+};
+
+// A binding the way Input used to keep them, found by name
+struct BenchNamedBinding {
+    std::string keyName;
+    std::string cmdString;
+};
+}
+
+// Key presses dispatched per second with every key bound, finding the binding
+// by name the way Input used to against the table indexed by keycode, and key
+// events bound to actions handled per second by the input dispatcher
+BENCHMARK(KeyDispatch) {
+    const double duration = 0.5;
+
+    sv::Console console;
+    std::shared_ptr<BenchNopCommand> nop(new BenchNopCommand);
+    console.registerCommand("+forward", nop);
+    console.registerCommand("set", nop);
+
+    // Every named key, bound to a line with a couple of commands
+    std::vector<sv::Keycodes::Enum> keys;
+    std::vector<BenchNamedBinding> namedBindings;
+    sv::Input input;
+    for (int index = 0; index < sv::NUM_KEYCODE_INDICES; ++index) {
+        sv::Keycodes::Enum key =
+            (index < 128) ? (sv::Keycodes::Enum)index
+                          : (sv::Keycodes::Enum)(0x40000000 + index - 128);
+        if (sv::getKeycodeName(key) == nullptr) {
+            continue;
+        }
+
+        std::string line = "+forward ; set key " + std::to_string(index);
+        BenchNamedBinding binding = {sv::getKeycodeString(key), line};
+        namedBindings.push_back(binding);
+        input.bind(key, line, console);
+        keys.push_back(key);
+    }
+
+    // Keycode to name, search by name, execute the string (parsed lines are
+    // still found in the console's line cache)
+    uint64_t numPresses = 0;
+    uint64_t check      = 0;
+    double start        = bench::now();
+    double elapsed      = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 1000; ++batch) {
+            const std::string keyName =
+                sv::getKeycodeString(keys[numPresses % keys.size()]);
+            for (const BenchNamedBinding &binding : namedBindings) {
+                if (binding.keyName == keyName) {
+                    check += console.executeString(binding.cmdString);
+                    break;
+                }
+            }
+            ++numPresses;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("dispatch by name", numPresses / elapsed, "presses/s");
+
+    numPresses = 0;
+    start      = bench::now();
+    elapsed    = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 1000; ++batch) {
+            check += input.execute(keys[numPresses % keys.size()], console);
+            ++numPresses;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("dispatch by keycode", numPresses / elapsed, "presses/s");
+
+    // A frame's worth of key events, each key bound to its own action
+    sv::InputDispatcher dispatcher(input, console);
+    std::vector<sv::PlatformEvent> events(sv::INPUT_DISPATCHER_BATCH_SIZE);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const sv::Keycodes::Enum key = keys[(i / 2) % keys.size()];
+        const std::string action =
+            "action" + std::to_string((i / 2) % sv::MAX_INPUT_ACTIONS);
+        dispatcher.registerAction(action);
+        input.bind(key, "+" + action);
+
+        events[i].type   = sv::PlatformEventType::Key;
+        events[i].value1 = key;
+        events[i].value2 = (i % 2 == 0) ? 1 : 0;
+    }
+    uint64_t numEvents = 0;
+    start              = bench::now();
+    elapsed            = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 100; ++batch) {
+            input.beginFrame();
+            dispatcher.dispatch(events.data(), events.size());
+            check += input.getActionsDown().none();
+            numEvents += events.size();
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("dispatch action events", numEvents / elapsed, "events/s");
+
+    if (check == 0) {
+        std::printf("KeyDispatch: nothing executed\n");
+    }
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <sv/job/JobSystem.h>
+
+namespace {
+// Jobs run between waits when timing scheduling overhead
+const size_t BENCH_JOBS_BATCH_SIZE = 1000;
+
+// Elements of the array updated when timing scaling, and elements a job
+const size_t BENCH_JOBS_NUM_ELEMENTS = 1 << 20;
+const size_t BENCH_JOBS_GRAIN_SIZE   = 4096;
+
+void benchEmptyJob(void *) {}
+
+// Some arithmetic per element, about what a particle or animation update costs
+void benchUpdateElements(float *values, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        float x = values[i];
+        for (int step = 0; step < 16; ++step) {
+            x = std::sqrt(x * x + 1.0f) * 0.5f;
+        }
+        values[i] = x;
+    }
+}
+
+// \returns Seconds per update of every element with \p numThreads threads
+double benchScaling(int numThreads, double duration,
+                    std::vector<float> &values) {
+    sv::JobSystem jobSystem;
+    jobSystem.initialize(numThreads - 1);
+
+    float *data     = values.data();
+    uint64_t numRun = 0;
+    double start    = bench::now();
+    double elapsed  = 0.0;
+    while (elapsed < duration) {
+        sv::parallelFor(jobSystem, values.size(), BENCH_JOBS_GRAIN_SIZE,
+                        [data](size_t begin, size_t end) {
+                            benchUpdateElements(data, begin, end);
+                        });
+        ++numRun;
+        elapsed = bench::now() - start;
+    }
+
+    return elapsed / numRun;
+}
+}
+
+// Cost of running and waiting on empty jobs, alone and in batches, and time
+// to update an array with parallelFor on 1 thread up to every hardware
+// thread, against updating it in a plain loop
+BENCHMARK(Jobs) {
+    const double duration = 0.5;
+    const int numHardwareThreads =
+        std::max((int)std::thread::hardware_concurrency(), 1);
+
+    sv::JobSystem jobSystem;
+    jobSystem.initialize();
+    bench::report("threads", jobSystem.getNumThreads(), "");
+
+    std::vector<sv::Job> batch(BENCH_JOBS_BATCH_SIZE,
+                               sv::Job(&benchEmptyJob, nullptr));
+    sv::JobCounter counter;
+
+    // One job at a time, the latency of handing work off and back
+    uint64_t numJobs = 0;
+    double start     = bench::now();
+    double elapsed   = 0.0;
+    while (elapsed < duration) {
+        for (int i = 0; i < 100; ++i) {
+            jobSystem.run(batch[0], &counter);
+            jobSystem.wait(counter);
+            ++numJobs;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("run and wait one job", elapsed * 1e9 / numJobs, "ns/job");
+
+    numJobs = 0;
+    start   = bench::now();
+    elapsed = 0.0;
+    while (elapsed < duration) {
+        jobSystem.run(batch.data(), batch.size(), &counter);
+        jobSystem.wait(counter);
+        numJobs += batch.size();
+        elapsed = bench::now() - start;
+    }
+    bench::report("run and wait batches of 1000", elapsed * 1e9 / numJobs,
+                  "ns/job");
+    bench::report("jobs stolen", jobSystem.getNumStolenJobs(), "jobs");
+
+    numJobs = 0;
+    start   = bench::now();
+    elapsed = 0.0;
+    while (elapsed < duration) {
+        for (int i = 0; i < 100; ++i) {
+            jobSystem.runOnMainThread(batch[0], &counter);
+        }
+        jobSystem.executeMainThreadJobs();
+        numJobs += 100;
+        elapsed = bench::now() - start;
+    }
+    bench::report("main thread jobs", elapsed * 1e9 / numJobs, "ns/job");
+    jobSystem.shutdown();
+
+    // Scaling of an update spread over threads
+    std::vector<float> values(BENCH_JOBS_NUM_ELEMENTS, 1.0f);
+    uint64_t numUpdates = 0;
+    start               = bench::now();
+    elapsed             = 0.0;
+    while (elapsed < duration) {
+        benchUpdateElements(values.data(), 0, values.size());
+        ++numUpdates;
+        elapsed = bench::now() - start;
+    }
+    const double serial = elapsed / numUpdates;
+    bench::report("update in a loop", serial * 1e3, "ms");
+
+    char label[64];
+    // Powers of two, then every hardware thread
+    for (int numThreads = 1; numThreads <= numHardwareThreads;
+         numThreads = (numThreads < numHardwareThreads)
+                          ? std::min(numThreads * 2, numHardwareThreads)
+                          : numThreads + 1) {
+        double perUpdate = benchScaling(numThreads, duration, values);
+        snprintf(label, sizeof(label), "parallelFor %d threads", numThreads);
+        bench::report(label, perUpdate * 1e3, "ms");
+        snprintf(label, sizeof(label), "parallelFor %d threads speedup",
+                 numThreads);
+        bench::report(label, serial / perUpdate, "x");
+    }
+
+    if (values[0] < 0.0f) {
+        std::printf("Jobs: values went negative\n");
+    }
+}
@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <vector>
+
+#include <sv/network/Connection.h>
+#include <sv/network/PacketCapture.h>
+
+namespace {
+const char *BENCH_CAPTURE_PATH = "bench_packetcapture.svpc";
+
+// Record a server receiving a busy client over loopback
+bool recordSession(uint32_t protocolId, float timeout) {
+    const int16_t serverPort = 30200;
+    const int16_t clientPort = 30201;
+    const float deltaTime    = 0.001f;
+
+    sv::net::Connection client(protocolId, timeout);
+    sv::net::Connection server(protocolId, timeout);
+    if (!client.start(clientPort) || !server.start(serverPort)) {
+        return false;
+    }
+    client.connect(sv::net::Address(127, 0, 0, 1, serverPort));
+    server.listen();
+
+    sv::net::PacketCapture capture;
+    if (!capture.open(BENCH_CAPTURE_PATH)) {
+        return false;
+    }
+    server.setCapture(&capture);
+
+    std::vector<uint8_t> buffer(server.getMaxPayloadSize());
+    for (int i = 0; i < 2000; ++i) {
+        // A few small messages per update and a large one now and then
+        for (int message = 0; message < 4; ++message) {
+            std::vector<uint8_t> payload(64 + message * 32, (uint8_t)i);
+            client.sendPacket(&payload[0], payload.size());
+        }
+        if (i % 50 == 0) {
+            std::vector<uint8_t> payload(8000, (uint8_t)i);
+            client.sendPacket(&payload[0], payload.size());
+        }
+
+        while (server.receivePacket(&buffer[0], buffer.size()) > 0) {
+        }
+        while (client.receivePacket(&buffer[0], buffer.size()) > 0) {
+        }
+
+        client.update(deltaTime);
+        server.update(deltaTime);
+    }
+
+    server.setCapture(nullptr);
+    capture.close();
+    client.stop();
+    server.stop();
+
+    return true;
+}
+}
+
+// Receive path of a connection driven from a captured session, no sockets
+BENCHMARK(ConnectionReplay) {
+    const uint32_t protocolId = 0x11112222;
+    const float timeout       = 10.0f;
+    const double duration     = 1.0;
+
+    if (!sv::net::initializeSockets()) {
+        return;
+    }
+    bool recorded = recordSession(protocolId, timeout);
+    sv::net::shutdownSockets();
+
+    sv::net::PacketCaptureReader reader;
+    if (!recorded || !reader.open(BENCH_CAPTURE_PATH)) {
+        std::remove(BENCH_CAPTURE_PATH);
+        return;
+    }
+
+    uint64_t packets  = 0;
+    uint64_t payloads = 0;
+    uint64_t bytes    = 0;
+    size_t numReplays = 0;
+
+    std::vector<uint8_t> buffer(sv::net::CONNECTION_MAX_PACKET_SIZE);
+    const double start = bench::now();
+    double elapsed     = 0.0;
+    while (elapsed < duration) {
+        sv::net::Connection server(protocolId, timeout);
+        server.startReplay();
+        server.listen();
+
+        reader.rewind();
+        sv::net::ConnectionReplay replay(server, reader);
+        while (!replay.isFinished()) {
+            size_t size = replay.receivePacket(&buffer[0], buffer.size());
+            if (size > 0) {
+                ++payloads;
+                bytes += size;
+            }
+        }
+        packets += replay.getPacketsReplayed();
+        ++numReplays;
+
+        elapsed = bench::now() - start;
+    }
+
+    bench::report("replays", (double)numReplays, "");
+    bench::report("datagrams", packets / elapsed, "packets/s");
+    bench::report("payloads", payloads / elapsed, "payloads/s");
+    bench::report("payload bytes", bytes / elapsed / (1024.0 * 1024.0),
+                  "MB/s");
+
+    std::remove(BENCH_CAPTURE_PATH);
+}
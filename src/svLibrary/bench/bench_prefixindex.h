@@ -0,0 +1,178 @@
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <sv/console/PrefixIndex.h>
+}
+
+namespace {
+// Number of names indexed, around what a game with many mods registers
+const int BENCH_PREFIX_INDEX_NUM_NAMES = 50000;
+
+// Most matches asked for, about what fits in a console's completion popup
+const size_t BENCH_PREFIX_INDEX_MAX_MATCHES = 10;
+
+// Names shaped like commands and variables: a subsystem, a noun and a number
+std::vector<std::string> makeBenchNames() {
+    const char *subsystems[] = {"sv", "cl", "net", "r",    "snd",
+                                "in", "ui", "ai",  "phys", "game"};
+    const char *nouns[] = {"max",     "min",      "rate",  "timeout",
+                           "debug",   "draw",     "shadow", "light",
+                           "volume",  "speed",    "gravity", "friction",
+                           "fov",     "lod",      "cache"};
+
+    std::vector<std::string> names;
+    char name[64];
+    for (int i = 0; i < BENCH_PREFIX_INDEX_NUM_NAMES; ++i) {
+        snprintf(name, sizeof(name), "%s_%s_%s%d", subsystems[i % 10],
+                 nouns[(i / 10) % 15], nouns[(i / 150) % 15], i);
+        names.push_back(name);
+    }
+
+    return names;
+}
+
+// Same subsequence test as svPrefixIndexSearch, for the linear scan
+bool benchIsSubsequence(const char *pattern, const std::string &name) {
+    size_t matched = 0;
+    for (size_t i = 0; i < name.size() && pattern[matched] != '\0'; ++i) {
+        if (std::tolower((unsigned char)name[i]) ==
+            std::tolower((unsigned char)pattern[matched])) {
+            ++matched;
+        }
+    }
+
+    return pattern[matched] == '\0';
+}
+}
+
+// Microseconds per completion and search over 50000 names, against scanning
+// every name, and names inserted and removed per second
+BENCHMARK(PrefixIndex) {
+    const double duration = 0.5;
+    const char *prefixes[] = {"s", "sv_", "net_rate_", "phys_gravity_fov1",
+                              "game_lod_cache4"};
+    const char *patterns[] = {"svmax", "ngrav", "rshadowlod", "sndvol99",
+                              "xyz"};
+    const size_t numQueries = sizeof(prefixes) / sizeof(prefixes[0]);
+
+    std::vector<std::string> names = makeBenchNames();
+
+    svPrefixIndex index;
+    svPrefixIndexInit(&index);
+    double start = bench::now();
+    for (const std::string &name : names) {
+        svPrefixIndexInsert(&index, name.c_str(), 1);
+    }
+    bench::report("insert", names.size() / (bench::now() - start),
+                  "names/s");
+
+    svPrefixIndexMatch matches[BENCH_PREFIX_INDEX_MAX_MATCHES];
+    uint64_t check = 0;
+
+    // Linear scan for the first names with a prefix
+    uint64_t numQueriesRun = 0;
+    start                  = bench::now();
+    double elapsed         = 0.0;
+    while (elapsed < duration) {
+        const char *prefix  = prefixes[numQueriesRun % numQueries];
+        size_t prefixLength = strlen(prefix);
+        std::vector<const std::string *> found;
+        for (const std::string &name : names) {
+            if (name.compare(0, prefixLength, prefix) == 0) {
+                found.push_back(&name);
+            }
+        }
+        check += found.size();
+        ++numQueriesRun;
+        elapsed = bench::now() - start;
+    }
+    bench::report("complete by scanning", elapsed * 1e6 / numQueriesRun,
+                  "us/query");
+
+    numQueriesRun = 0;
+    start         = bench::now();
+    elapsed       = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 100; ++batch) {
+            check += svPrefixIndexComplete(
+                &index, prefixes[numQueriesRun % numQueries], 1, matches,
+                BENCH_PREFIX_INDEX_MAX_MATCHES);
+            ++numQueriesRun;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("complete top 10", elapsed * 1e6 / numQueriesRun,
+                  "us/query");
+
+    char common[64];
+    numQueriesRun = 0;
+    start         = bench::now();
+    elapsed       = 0.0;
+    while (elapsed < duration) {
+        for (int batch = 0; batch < 100; ++batch) {
+            check += svPrefixIndexGetCommonPrefix(
+                &index, prefixes[numQueriesRun % numQueries], common,
+                sizeof(common));
+            ++numQueriesRun;
+        }
+        elapsed = bench::now() - start;
+    }
+    bench::report("common prefix", elapsed * 1e6 / numQueriesRun,
+                  "us/query");
+
+    // Linear scan for names containing a pattern
+    numQueriesRun = 0;
+    start         = bench::now();
+    elapsed       = 0.0;
+    while (elapsed < duration) {
+        const char *pattern = patterns[numQueriesRun % numQueries];
+        for (const std::string &name : names) {
+            check += benchIsSubsequence(pattern, name);
+        }
+        ++numQueriesRun;
+        elapsed = bench::now() - start;
+    }
+    bench::report("search by scanning", elapsed * 1e6 / numQueriesRun,
+                  "us/query");
+
+    // Each pattern on its own, to find the slowest
+    double total   = 0.0;
+    double slowest = 0.0;
+    for (size_t i = 0; i < numQueries; ++i) {
+        uint64_t numPatternQueries = 0;
+        start                      = bench::now();
+        elapsed                    = 0.0;
+        while (elapsed < duration / numQueries) {
+            for (int batch = 0; batch < 10; ++batch) {
+                check += svPrefixIndexSearch(&index, patterns[i], 1, matches,
+                                             BENCH_PREFIX_INDEX_MAX_MATCHES);
+                ++numPatternQueries;
+            }
+            elapsed = bench::now() - start;
+        }
+        double perQuery = elapsed / numPatternQueries;
+        total += perQuery;
+        if (perQuery > slowest) {
+            slowest = perQuery;
+        }
+    }
+    bench::report("search top 10", total * 1e6 / numQueries, "us/query");
+    bench::report("search top 10 slowest pattern", slowest * 1e6,
+                  "us/query");
+
+    start = bench::now();
+    for (const std::string &name : names) {
+        svPrefixIndexRemove(&index, name.c_str(), 1);
+    }
+    bench::report("remove", names.size() / (bench::now() - start),
+                  "names/s");
+    svPrefixIndexFree(&index);
+
+    if (check == 0) {
+        std::printf("PrefixIndex: nothing found\n");
+    }
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <sv/network/ShardedServer.h>
+#include <sv/network/Sockets.h>
+
+namespace {
+// Per-packet work standing in for the game processing a message
+class ChecksumHandler : public sv::net::ShardedServerHandler {
+  public:
+    ChecksumHandler() : checksum(0) {}
+
+    virtual void onPacket(sv::net::ShardWorker &, sv::net::ShardClient &,
+                          const uint8_t *data, size_t size) {
+        uint32_t hash = 2166136261u;
+        for (int round = 0; round < 16; ++round) {
+            for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ data[i]) * 16777619u;
+            }
+        }
+        checksum.fetch_add(hash, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32_t> checksum;
+};
+
+// Blast packets at the server from one socket until told to stop
+void sendPackets(uint16_t port, uint16_t sourcePort,
+                 const std::atomic<bool> *running) {
+    sv::net::Socket socket;
+    if (!socket.open(sourcePort)) {
+        return;
+    }
+
+    const sv::net::Address server(127, 0, 0, 1, port);
+    uint8_t packet[64] = {};
+    uint32_t sequence  = 0;
+    while (*running) {
+        memcpy(packet, &sequence, sizeof(sequence));
+        ++sequence;
+        socket.send(server, packet, sizeof(packet));
+    }
+}
+}
+
+// Receive throughput with one worker per socket on the same port, as the
+// number of workers grows. Only scales on a machine with several cores.
+BENCHMARK(ShardedServerReceive) {
+    const uint16_t port       = 30100;
+    const size_t numSenders   = 8;
+    const double duration     = 1.0;
+    const size_t numCores     = std::thread::hardware_concurrency();
+    const size_t maxWorkers   = std::max<size_t>(numCores, 2);
+    const float clientTimeout = 10.0f;
+
+    if (!sv::net::initializeSockets()) {
+        return;
+    }
+
+    bench::report("hardware threads", (double)numCores, "");
+
+    for (size_t numWorkers = 1; numWorkers <= maxWorkers; numWorkers *= 2) {
+        ChecksumHandler handler;
+        sv::net::ShardedServer server(clientTimeout);
+        if (!server.start(port, numWorkers, &handler)) {
+            break;
+        }
+
+        std::atomic<bool> running(true);
+        std::vector<std::thread> senders;
+        for (size_t i = 0; i < numSenders; ++i) {
+            senders.push_back(std::thread(sendPackets, port,
+                                          (uint16_t)(port + 1 + i), &running));
+        }
+
+        // Let the senders get going before measuring
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const uint64_t startPackets = server.getPacketsReceived();
+        const double start          = bench::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(
+            (std::chrono::milliseconds::rep)(duration * 1000.0)));
+        const double elapsed   = bench::now() - start;
+        const uint64_t packets = server.getPacketsReceived() - startPackets;
+
+        running = false;
+        for (size_t i = 0; i < senders.size(); ++i) {
+            senders[i].join();
+        }
+        server.stop();
+
+        char label[64];
+        snprintf(label, sizeof(label), "%u worker(s)", (unsigned)numWorkers);
+        bench::report(label, packets / elapsed, "packets/s");
+    }
+
+    sv::net::shutdownSockets();
+}
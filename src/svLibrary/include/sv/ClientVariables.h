@@ -10,29 +10,283 @@
 /// \brief A client variable is a simple name-value association. This system
 /// manages those variables.
 ///
-/// A client variable is always stored as a string, but may be interpreted as a
-/// float, int or string.
+/// Variables are either registered or unregistered. Code that owns a variable
+/// registers it with a type (int, float or string), a default value, bounds
+/// and flags, and gets back a CVar handle. Reading a value through a handle is
+/// a load of an already converted value, so handles are cheap enough to read
+/// every frame. Strings are only parsed or formatted when a value is set.
+///
+/// Unregistered variables are created by setting a value for a name no one
+/// registered (e.g. from a config file or the 'set' command) and are stored as
+/// strings, interpreted as a float, int or string when read. Registering a
+/// name that was already set this way keeps the value that was set, if it is
+/// valid for the variable.
+///
+/// Flags say how a registered variable is shared. Archived variables are saved
+/// to a config file, which can be run with 'exec' to load them again. Changes
+/// are batched: saving happens at most once per save interval (see 'update')
+/// and when the registry is destroyed, and writes every archived variable in a
+/// single write. Replicated variables are sent from server to clients. Each
+/// change queues the variable once in a dirty set, 'writeReplicated' sends
+/// only the queued variables, so the cost of both follows the number of
+/// changes rather than the number of variables.
+///
+/// Typical usage:
+///     CVar sensitivity =
+///         cvars.registerFloat("sensitivity", 2.0f, 0.1f, 10.0f,
+///                             ClientVariableFlags::Enum::Archive);
+///     // Each frame
+///     float scale = sensitivity.getFloat();
+///     cvars.update(deltaTime);
 ///
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
 #include <string>
 #include <vector>
 
+extern "C" {
+#include <sv/console/CommandTable.h>
+#include <sv/console/PrefixIndex.h>
+}
+
 namespace sv {
 
+namespace ClientVariableType {
+enum Enum { String, Int, Float };
+}
+
+namespace ClientVariableFlags {
+enum Enum : uint32_t {
+    None = 0,
+    /// Can't be changed after it is registered.
+    ReadOnly = 1 << 0,
+    /// Saved to the archive file.
+    Archive = 1 << 1,
+    /// Sent from the server to clients when changed.
+    Replicated = 1 << 2,
+    /// Can only be changed while cheats are enabled.
+    Cheat = 1 << 3,
+};
+}
+
+struct ClientVariable;
+
+/// Called after a registered variable's value changes.
+typedef std::function<void(const ClientVariable &)> ClientVariableCallback;
+
 struct ClientVariable {
-    ClientVariable() : name(""), value("") {}
+    ClientVariable()
+        : name(""), value(""), type(ClientVariableType::Enum::String),
+          intValue(0), floatValue(0.0f), minValue(0.0), maxValue(0.0),
+          flags(ClientVariableFlags::Enum::None), registered(false),
+          dirty(false), replicationQueued(false) {}
     ClientVariable(const std::string &varName, const std::string &varValue)
-        : name(varName), value(varValue) {}
+        : name(varName), value(varValue),
+          type(ClientVariableType::Enum::String), intValue(0),
+          floatValue(0.0f), minValue(0.0), maxValue(0.0),
+          flags(ClientVariableFlags::Enum::None), registered(false),
+          dirty(false), replicationQueued(false) {}
 
     std::string name;
+    /// Value as a string, kept up to date for every type.
     std::string value;
+
+    ClientVariableType::Enum type;
+    /// Value of an int variable, or of a float variable rounded towards zero.
+    int intValue;
+    /// Value of a float or int variable.
+    float floatValue;
+    /// Bounds values of int and float variables are clamped to.
+    double minValue;
+    double maxValue;
+    std::string defaultValue;
+    /// ClientVariableFlags
+    uint32_t flags;
+    bool registered;
+    /// Set when the value changes, cleared by 'CVar::clearDirty'.
+    bool dirty;
+    /// Set while a replicated variable is waiting to be sent.
+    bool replicationQueued;
+    ClientVariableCallback callback;
+};
+
+/// Handle to a registered client variable
+///
+/// Stays valid until the variable is removed, or the ClientVariables it came
+/// from is destroyed.
+class CVar {
+  public:
+    CVar() : variable(nullptr) {}
+    explicit CVar(ClientVariable *variable_) : variable(variable_) {}
+
+    bool isValid() const { return variable != nullptr; }
+
+    int getInt() const { return variable->intValue; }
+    float getFloat() const { return variable->floatValue; }
+    const std::string &getString() const { return variable->value; }
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if the value changed since 'clearDirty' was last called.
+    ///-------------------------------------------------------------------------
+    bool isDirty() const { return variable->dirty; }
+    void clearDirty() { variable->dirty = false; }
+
+    const ClientVariable &getVariable() const { return *variable; }
+
+  private:
+    friend class ClientVariables;
+
+    ClientVariable *variable;
 };
 
 /// Class for managing a number of client variables and their values.
 class ClientVariables {
   public:
+    ClientVariables();
+    ~ClientVariables();
+
+    ClientVariables(const ClientVariables &) = delete;
+    ClientVariables &operator=(const ClientVariables &) = delete;
+
+    ///-------------------------------------------------------------------------
+    /// Register an int variable, clamped to [\p minValue, \p maxValue].
+    ///
+    /// \param   flags   ClientVariableFlags.
+    ///
+    /// \returns Handle to the variable. Registering a name again returns the
+    /// same variable if it has the same type, an invalid handle otherwise.
+    ///-------------------------------------------------------------------------
+    CVar registerInt(const std::string &name, int defaultValue,
+                     int minValue = std::numeric_limits<int>::min(),
+                     int maxValue = std::numeric_limits<int>::max(),
+                     uint32_t flags = ClientVariableFlags::Enum::None);
+
+    ///-------------------------------------------------------------------------
+    /// Register a float variable, clamped to [\p minValue, \p maxValue].
+    ///
+    /// \see registerInt
+    ///-------------------------------------------------------------------------
+    CVar registerFloat(const std::string &name, float defaultValue,
+                       float minValue = -std::numeric_limits<float>::max(),
+                       float maxValue = std::numeric_limits<float>::max(),
+                       uint32_t flags = ClientVariableFlags::Enum::None);
+
+    ///-------------------------------------------------------------------------
+    /// Register a string variable.
+    ///
+    /// \see registerInt
+    ///-------------------------------------------------------------------------
+    CVar registerString(const std::string &name,
+                        const std::string &defaultValue,
+                        uint32_t flags = ClientVariableFlags::Enum::None);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Handle to the registered variable with the given name, invalid
+    /// if there is none.
+    ///-------------------------------------------------------------------------
+    CVar find(const std::string &name) const;
+
+    ///-------------------------------------------------------------------------
+    /// Set a registered variable from a string, parsing it for int and float
+    /// variables and clamping it to the variable's bounds.
+    ///
+    /// \returns False if the variable is read-only, is a cheat and cheats are
+    /// disabled, or \p value isn't valid for its type, in which case the value
+    /// is unchanged.
+    ///-------------------------------------------------------------------------
+    bool set(CVar cvar, const std::string &value);
+    bool setInt(CVar cvar, int value);
+    bool setFloat(CVar cvar, float value);
+
+    ///-------------------------------------------------------------------------
+    /// Set a registered variable back to its default value.
+    ///-------------------------------------------------------------------------
+    void reset(CVar cvar);
+
+    ///-------------------------------------------------------------------------
+    /// Call \p callback after each change to the value of a registered
+    /// variable, replacing any callback it had.
+    ///-------------------------------------------------------------------------
+    void setCallback(CVar cvar, const ClientVariableCallback &callback);
+
+    ///-------------------------------------------------------------------------
+    /// Allow or disallow changing cheat variables. Disabling cheats resets
+    /// every cheat variable to its default value. Cheats start disabled.
+    ///-------------------------------------------------------------------------
+    void setCheatsEnabled(bool enabled);
+    bool areCheatsEnabled() const;
+
+    ///-------------------------------------------------------------------------
+    /// Queue every replicated variable to be sent, e.g. to bring a newly
+    /// connected client up to date.
+    ///-------------------------------------------------------------------------
+    void queueAllReplicated();
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of replicated variables waiting to be sent.
+    ///-------------------------------------------------------------------------
+    size_t getNumQueuedReplicated() const;
+
+    ///-------------------------------------------------------------------------
+    /// Write the values of queued replicated variables to \p buffer, in the
+    /// order they changed, and take them off the queue. Variables that don't
+    /// fit stay queued for the next call.
+    ///
+    /// \returns Number of bytes written to \p buffer, 0 if nothing was queued
+    /// or \p buffer can't hold the first queued variable.
+    ///-------------------------------------------------------------------------
+    size_t writeReplicated(void *buffer, size_t bufferSize);
+
+    ///-------------------------------------------------------------------------
+    /// Apply values written by 'writeReplicated' on the server. Values are set
+    /// even on read-only and cheat variables, but only on variables registered
+    /// here as replicated. Values for any other variable are skipped.
+    ///
+    /// \returns False if the data is malformed. Values read before the error
+    /// are still applied.
+    ///-------------------------------------------------------------------------
+    bool readReplicated(const void *data, size_t dataSize);
+
+    ///-------------------------------------------------------------------------
+    /// Save archived variables to \p path. Once \p saveInterval seconds have
+    /// passed after an archived variable changes, 'update' saves them; with a
+    /// \p saveInterval of 0 they are only saved by 'saveArchive' and when the
+    /// registry is destroyed. An empty \p path disables saving.
+    ///-------------------------------------------------------------------------
+    void setArchiveFile(const std::string &path, float saveInterval = 0.0f);
+
+    ///-------------------------------------------------------------------------
+    /// Advance the save timer, saving archived variables if it is due.
+    ///-------------------------------------------------------------------------
+    void update(float deltaTime);
+
+    ///-------------------------------------------------------------------------
+    /// Write every archived variable to the archive file as 'set' commands.
+    ///
+    /// \returns False if there is no archive file or it couldn't be written.
+    ///-------------------------------------------------------------------------
+    bool saveArchive();
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if an archived variable changed since the archive was
+    /// last saved.
+    ///-------------------------------------------------------------------------
+    bool isArchiveDirty() const;
+
+    ///-------------------------------------------------------------------------
+    /// Keep the names of all variables in \p index (e.g. the console's, see
+    /// 'Console::getNameIndex') for completion, or in no index if \p index is
+    /// nullptr. Names are taken out of the previous index.
+    ///
+    /// NOTE: \p index must outlive this object, or be replaced first.
+    ///-------------------------------------------------------------------------
+    void setNameIndex(svPrefixIndex *index);
+
     ///-------------------------------------------------------------------------
     /// Get the client variable with the given name as a float if possible.
     ///
@@ -75,27 +329,78 @@ class ClientVariables {
 
     ///-------------------------------------------------------------------------
     /// Set the value of the client variable with the given name (float).
+    ///
+    /// \returns False if the variable is registered and can't take the value
+    /// (see 'set').
     ///-------------------------------------------------------------------------
-    void setFloatValue(const std::string &variableName, float value);
+    bool setFloatValue(const std::string &variableName, float value);
 
     ///-------------------------------------------------------------------------
     /// Set the value of the client variable with the given name (int).
+    ///
+    /// \returns False if the variable is registered and can't take the value
+    /// (see 'set').
     ///-------------------------------------------------------------------------
-    void setIntValue(const std::string &variableName, int value);
+    bool setIntValue(const std::string &variableName, int value);
 
     ///-------------------------------------------------------------------------
     /// Set the value of the client variable with the given name (string).
+    ///
+    /// \returns False if the variable is registered and can't take the value
+    /// (see 'set').
     ///-------------------------------------------------------------------------
-    void setStringValue(const std::string &variableName,
+    bool setStringValue(const std::string &variableName,
                         const std::string &value);
 
     ///-------------------------------------------------------------------------
-    /// Remove the variable with the given name (if one exists).
+    /// Remove the variable with the given name (if one exists). Handles to it
+    /// must no longer be used.
     ///-------------------------------------------------------------------------
     void removeVariable(const std::string &variableName);
 
   private:
-    std::vector<ClientVariable> variables;
+    // Variable with the given name, nullptr if none
+    ClientVariable *findVariable(const std::string &name) const;
+    // Add an unregistered variable
+    ClientVariable *addVariable(const std::string &name,
+                                const std::string &value);
+    // Register a new or unregistered variable, keeping a value it was set to
+    // if valid
+    CVar registerVariable(const std::string &name,
+                          ClientVariableType::Enum type, double minValue,
+                          double maxValue, const std::string &defaultValue,
+                          uint32_t flags);
+    // Parse and set a registered variable's value, \returns false if invalid
+    bool assign(ClientVariable &variable, const std::string &value);
+    // Set a registered variable's numeric value, clamped to its bounds
+    void assignNumber(ClientVariable &variable, double value);
+    // Mark a registered variable changed if its value differs from
+    // \p oldValue, queueing it for replication if \p replicate
+    void changed(ClientVariable &variable, const std::string &oldValue,
+                 bool replicate = true);
+    // \returns True if the flags of \p variable allow setting it
+    bool isWritable(const ClientVariable &variable) const;
+
+    // Deque so handles stay valid as variables are added
+    std::deque<ClientVariable> variables;
+    // Index in 'variables' of each name
+    svCommandTable variableTable;
+    // Indices of removed variables, reused for new variables
+    std::vector<int> freeVariables;
+    // Index names are kept in for completion, nullptr if none
+    svPrefixIndex *nameIndex;
+
+    bool cheatsEnabled;
+    // Indices of replicated variables waiting to be sent, in the order they
+    // changed
+    std::deque<int> replicationQueue;
+    // Indices of archived variables
+    std::vector<int> archivedVariables;
+    std::string archivePath;
+    float archiveSaveInterval;
+    // Seconds since the archive became dirty
+    float archiveTimer;
+    bool archiveDirty;
 };
 
 ///-----------------------------------------------------------------------------
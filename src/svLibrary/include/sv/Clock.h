@@ -0,0 +1,105 @@
+//===-- sv/Clock.h - Monotonic clock ----------------------------*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Nanosecond monotonic clock, for frame pacing and profiling.
+///
+/// Times are points on the monotonic clock (clock_gettime(CLOCK_MONOTONIC) on
+/// POSIX systems), which never jumps when the system time is changed and
+/// doesn't wrap for centuries. Durations are signed nanoseconds.
+///
+/// Typical usage:
+///     TimePoint start = Clock::now();
+///     // Do something
+///     double seconds = nanosecondsToSeconds(Clock::now() - start);
+///
+/// 'sleepUntil' wakes up close to a deadline by sleeping until just before
+/// it, then spinning the rest of the way, since sleeps alone may oversleep
+/// by a millisecond or more.
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+
+namespace sv {
+/// How long before a deadline 'sleepUntil' stops sleeping and starts spinning
+const int64_t SLEEP_SPIN_NANOSECONDS = 1000000;
+
+///-----------------------------------------------------------------------------
+/// \returns \p seconds in nanoseconds.
+///-----------------------------------------------------------------------------
+inline int64_t secondsToNanoseconds(double seconds) {
+    return (int64_t)(seconds * 1e9);
+}
+
+///-----------------------------------------------------------------------------
+/// \returns \p nanoseconds in seconds.
+///-----------------------------------------------------------------------------
+inline double nanosecondsToSeconds(int64_t nanoseconds) {
+    return (double)nanoseconds * 1e-9;
+}
+
+/// A point in time on the monotonic clock
+struct TimePoint {
+    TimePoint() : nanoseconds(0) {}
+    explicit TimePoint(int64_t nanoseconds_) : nanoseconds(nanoseconds_) {}
+
+    /// Nanoseconds since some fixed point (such as OS start).
+    int64_t nanoseconds;
+
+    TimePoint operator+(int64_t duration) const {
+        return TimePoint(nanoseconds + duration);
+    }
+    TimePoint operator-(int64_t duration) const {
+        return TimePoint(nanoseconds - duration);
+    }
+    TimePoint &operator+=(int64_t duration) {
+        nanoseconds += duration;
+        return *this;
+    }
+    /// \returns Nanoseconds from \p other to this time point.
+    int64_t operator-(const TimePoint &other) const {
+        return nanoseconds - other.nanoseconds;
+    }
+
+    bool operator==(const TimePoint &other) const {
+        return nanoseconds == other.nanoseconds;
+    }
+    bool operator!=(const TimePoint &other) const {
+        return nanoseconds != other.nanoseconds;
+    }
+    bool operator<(const TimePoint &other) const {
+        return nanoseconds < other.nanoseconds;
+    }
+    bool operator<=(const TimePoint &other) const {
+        return nanoseconds <= other.nanoseconds;
+    }
+    bool operator>(const TimePoint &other) const {
+        return nanoseconds > other.nanoseconds;
+    }
+    bool operator>=(const TimePoint &other) const {
+        return nanoseconds >= other.nanoseconds;
+    }
+};
+
+namespace Clock {
+///-----------------------------------------------------------------------------
+/// \returns The current time on the monotonic clock.
+///-----------------------------------------------------------------------------
+TimePoint now();
+}
+
+///-----------------------------------------------------------------------------
+/// Block the calling thread until \p deadline, sleeping until
+/// \p spinNanoseconds before it and spinning from there. Returns straight
+/// away if \p deadline has passed.
+///-----------------------------------------------------------------------------
+void sleepUntil(TimePoint deadline,
+                int64_t spinNanoseconds = SLEEP_SPIN_NANOSECONDS);
+}
@@ -13,14 +13,88 @@
 /// The game engine retrieves platform events from a Platform interface
 /// implementation and pushes those events to the client and server.
 ///
+/// 'run' is the main loop. Each frame it handles platform events and console
+/// input, simulates a whole number of fixed ticks (see FixedTimestep.h) and
+/// renders once, interpolating between the last two ticks. Simulation only
+/// ever sees the tick length as its delta time, e.g. for
+/// 'Connection::update', so frame timing jitter doesn't reach it. Frames can
+/// be paced to a target rate by sleeping until each frame's deadline (see
+/// 'sleepUntil').
+///
 //===----------------------------------------------------------------------===//
 #pragma once
-#pragma once
 
+#include <sv/Clock.h>
 #include <sv/client/Client.h>
+#include <sv/job/JobSystem.h>
 #include <sv/platform/Platform.h>
 
 namespace sv {
+class Engine;
+
+/// Game code called by 'Engine::run'
+class EngineCallbacks {
+  public:
+    virtual ~EngineCallbacks() {}
+
+    ///-------------------------------------------------------------------------
+    /// Advance the simulation by one tick of \p tickSeconds.
+    ///-------------------------------------------------------------------------
+    virtual void tick(Engine &engine, double tickSeconds) = 0;
+
+    ///-------------------------------------------------------------------------
+    /// Draw the frame, \p alpha in [0, 1) of the way from the state before
+    /// the last tick to the state after it.
+    ///-------------------------------------------------------------------------
+    virtual void render(Engine &engine, double alpha) = 0;
+};
+
+/// Options of 'Engine::run'
+struct EngineRunOptions {
+    EngineRunOptions()
+        : tickRate(60.0), maxTicksPerFrame(8), frameRate(0.0), maxFrames(0) {}
+
+    /// Simulation ticks a second.
+    double tickRate;
+    /// Most ticks simulated a frame, time owed beyond them is dropped.
+    int maxTicksPerFrame;
+    /// Frames a second to pace rendering to, 0 to render as fast as possible.
+    double frameRate;
+    /// Frames to run before returning, 0 to run until asked to quit.
+    uint64_t maxFrames;
+};
+
+/// Nanoseconds spent in each phase of a frame
+struct EngineFrameTimes {
+    EngineFrameTimes()
+        : events(0), simulation(0), render(0), wait(0), frame(0) {}
+
+    /// Platform events, console input and main thread jobs.
+    int64_t events;
+    /// All ticks of the frame.
+    int64_t simulation;
+    int64_t render;
+    /// Sleeping until the frame's deadline when pacing.
+    int64_t wait;
+    /// The whole frame.
+    int64_t frame;
+};
+
+/// Timing of 'Engine::run'
+struct EngineRunStats {
+    EngineRunStats() : numFrames(0), numTicks(0), numDroppedTicks(0) {}
+
+    uint64_t numFrames;
+    uint64_t numTicks;
+    /// Ticks owed beyond the most simulated a frame, see 'maxTicksPerFrame'.
+    uint64_t numDroppedTicks;
+    EngineFrameTimes last;
+    /// Sum of each phase over all frames.
+    EngineFrameTimes total;
+    /// Longest time spent in each phase by any frame.
+    EngineFrameTimes longest;
+};
+
 class Engine {
   public:
     Engine();
@@ -31,6 +105,12 @@ class Engine {
     ///
     /// Must be called before other method calls.
     ///
+    /// Options:
+    ///     --headless   Use a NullPlatform rather than SDL2, no window or input
+    ///                  devices (e.g. for a dedicated server).
+    ///     --jobthreads <n>   Worker threads of the job system, one fewer than
+    ///                        the number of hardware threads by default.
+    ///
     /// \param argc Number of command-line arguments.
     /// \param argv Command-line arguments.
     /// \returns True if initialization was successful, false otherwise.
@@ -43,11 +123,54 @@ class Engine {
     ///-------------------------------------------------------------------------
     uint32_t getMilliseconds() const;
 
+    ///-------------------------------------------------------------------------
+    /// Get the current time on the monotonic clock, with nanosecond
+    /// resolution, for frame pacing and profiling.
+    ///-------------------------------------------------------------------------
+    TimePoint getTime() const;
+
+    ///-------------------------------------------------------------------------
+    /// Run the main loop until the platform or 'quit' asks it to stop, or
+    /// \p options.maxFrames frames have run.
+    ///
+    /// \returns False if the engine isn't initialized or \p options are
+    /// invalid.
+    ///-------------------------------------------------------------------------
+    bool run(EngineCallbacks &callbacks,
+             const EngineRunOptions &options = EngineRunOptions());
+
+    ///-------------------------------------------------------------------------
+    /// Stop 'run' once the current frame ends.
+    ///-------------------------------------------------------------------------
+    void quit();
+
+    ///-------------------------------------------------------------------------
+    /// \returns Timing of the current or last call to 'run'.
+    ///-------------------------------------------------------------------------
+    const EngineRunStats &getRunStats() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns The platform, valid once the engine is initialized.
+    ///-------------------------------------------------------------------------
+    Platform &getPlatform();
+
+    Client &getClient();
+
+    ///-------------------------------------------------------------------------
+    /// \returns The job system, whose main thread jobs 'run' executes each
+    /// frame before simulating.
+    ///-------------------------------------------------------------------------
+    JobSystem &getJobSystem();
+
   private:
     bool isInitialized;
+    bool quitRequested;
+    EngineRunStats runStats;
 
     std::shared_ptr<Platform> platform;
 
+    JobSystem jobSystem;
+
     Client client;
 };
 }
@@ -0,0 +1,86 @@
+//===-- sv/FixedTimestep.h - Fixed simulation timestep ----------*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Turns the varying time between frames into a whole number of fixed
+/// simulation ticks.
+///
+/// Time passed to 'advance' is added to an accumulator, and a tick is taken
+/// out for each whole tick in it. What remains is the fraction of a tick the
+/// renderer is ahead of the simulation (see 'getAlpha'), used to interpolate
+/// between the last two simulated states.
+///
+/// If a frame is so slow that the ticks it owes would take longer to simulate
+/// than the frame they cover, each frame falls further behind (the "spiral of
+/// death"). To prevent that, at most a fixed number of ticks are run a frame
+/// and the time owed beyond them is dropped, so the simulation slows down
+/// instead.
+///
+/// Typical usage:
+///     FixedTimestep timestep(secondsToNanoseconds(1.0 / 60.0), 8);
+///     int numTicks = timestep.advance(frameNanoseconds);
+///     for (int i = 0; i < numTicks; ++i) {
+///         simulate(timestep.getTickSeconds());
+///     }
+///     render(timestep.getAlpha());
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+
+namespace sv {
+class FixedTimestep {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \param   tickNanoseconds    Length of a tick, > 0.
+    /// \param   maxTicksPerFrame   Most ticks 'advance' returns, > 0.
+    ///-------------------------------------------------------------------------
+    FixedTimestep(int64_t tickNanoseconds, int maxTicksPerFrame);
+
+    ///-------------------------------------------------------------------------
+    /// Add \p elapsedNanoseconds of real time to the accumulator.
+    ///
+    /// \returns Number of ticks to simulate, at most the maximum a frame.
+    ///-------------------------------------------------------------------------
+    int advance(int64_t elapsedNanoseconds);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Fraction of a tick, in [0, 1), left in the accumulator.
+    ///-------------------------------------------------------------------------
+    double getAlpha() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Length of a tick in nanoseconds.
+    ///-------------------------------------------------------------------------
+    int64_t getTickNanoseconds() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Length of a tick in seconds.
+    ///-------------------------------------------------------------------------
+    double getTickSeconds() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of ticks dropped because a frame owed more than the
+    /// maximum.
+    ///-------------------------------------------------------------------------
+    uint64_t getNumDroppedTicks() const;
+
+    ///-------------------------------------------------------------------------
+    /// Empty the accumulator, e.g. after loading, so the time spent isn't
+    /// simulated.
+    ///-------------------------------------------------------------------------
+    void reset();
+
+  private:
+    int64_t tickNanoseconds;
+    int maxTicksPerFrame;
+    int64_t accumulator;
+    uint64_t numDroppedTicks;
+};
+}
@@ -4,19 +4,54 @@
 #include <sv/ProgramOptions.h>
 #include <sv/console/Console.h>
 #include <sv/input/Input.h>
+#include <sv/input/InputDispatcher.h>
+#include <sv/network/Connection.h>
+#include <sv/network/NetworkSimulator.h>
+#include <sv/platform/Platform.h>
 #include <sv/resource/ResourceCache.h>
 
 namespace sv {
+/// Most time a frame spends executing the console's command buffer
+const double CLIENT_BUFFER_SECONDS = 0.002;
+
+/// Protocol id of the client's connection to a server.
+const uint32_t CLIENT_PROTOCOL_ID = 0x53564331;
+
+/// Seconds without hearing from the server before the connection is dropped.
+const float CLIENT_CONNECTION_TIMEOUT = 10.0f;
+
 class Client {
   public:
-    Client() : resourceCache(10) {}
+    Client()
+        : connection(CLIENT_PROTOCOL_ID, CLIENT_CONNECTION_TIMEOUT),
+          resourceCache(10), dispatcher(input, console) {
+        connection.setSimulator(&simulator);
+    }
 
     bool initialize(const ProgramOptions &options);
 
+    ///-------------------------------------------------------------------------
+    /// Handle a frame's platform events, then execute console input
+    /// submitted from other threads and some of the command buffer. Call
+    /// once a frame, before simulating.
+    ///
+    /// \returns False once the platform has asked to quit.
+    ///-------------------------------------------------------------------------
+    bool update(Platform &platform);
+
+    Console &getConsole();
+
+    InputDispatcher &getInputDispatcher();
+
   private:
-    ClientVariables cvars;
+    // Declared before the console, whose net commands refer to them
+    net::NetworkSimulator simulator;
+    net::Connection connection;
+    // Declared before cvars, which keep their names in its name index
     Console console;
+    ClientVariables cvars;
     Input input;
     ResourceCache resourceCache;
+    InputDispatcher dispatcher;
 };
 }
@@ -0,0 +1,69 @@
+/*===-- sv/console/CommandTable.h - Command name lookup ------------*- C -*-===
+ *
+ *                  The Special Engine Variant Game Engine
+ *
+ * This file is distributed under the MIT License. See LICENSE.txt for details.
+ *
+ *===----------------------------------------------------------------------===*/
+/**
+ * \file
+ * \brief Maps command names to integers (e.g. indices into an array of
+ * commands), shared by the Shell and the Console.
+ *
+ * An open-addressed hash table using FNV-1a hashes and linear probing. Names
+ * are looked up straight from a NULL-terminated string, such as an argv
+ * element, without building any other string first.
+ *
+ * A table that has been zeroed (e.g. a static table) is a valid, empty table.
+ *===----------------------------------------------------------------------===*/
+#pragma once
+
+typedef struct svCommandTableSlot {
+    char *name;        /* Copy of name, NULL if never used */
+    unsigned int hash; /* Hash of name */
+    int value;
+} svCommandTableSlot;
+
+typedef struct svCommandTable {
+    svCommandTableSlot *slots;
+    int capacity;    /* Number of slots, always a power of two */
+    int count;       /* Number of names in the table */
+    int numRemoved;  /* Number of slots of removed names */
+} svCommandTable;
+
+/**
+ * Make \p table an empty table.
+ */
+void svCommandTableInit(svCommandTable *table);
+
+/**
+ * Free all memory used by \p table, leaving it an empty table.
+ */
+void svCommandTableFree(svCommandTable *table);
+
+/**
+ * \returns FNV-1a hash of the NULL-terminated string \p str.
+ */
+unsigned int svCommandTableHash(const char *str);
+
+/**
+ * \returns The value associated with \p name, or < 0 if \p name is not in the
+ * table.
+ */
+int svCommandTableFind(const svCommandTable *table, const char *name);
+
+/**
+ * Associate \p value (>= 0) with \p name, replacing the value associated with
+ * \p name if it is already in the table. \p name is copied.
+ *
+ * \returns 0 if no error, other if memory could not be allocated.
+ */
+int svCommandTableInsert(svCommandTable *table, const char *name, int value);
+
+/**
+ * Remove \p name from the table.
+ *
+ * \returns The value that was associated with \p name, or < 0 if \p name was
+ * not in the table.
+ */
+int svCommandTableRemove(svCommandTable *table, const char *name);
@@ -1,3 +1,5 @@
+#pragma once
+
 /* Command seperator - must be a single character */
 #define SV_SEP_SEQ ";"
 
@@ -75,6 +77,30 @@ int svCommandsGetNum(char *token[], svCommandError *error);
 int svCommandsSeparate(char *token[], svCommand command[],
                        svCommandError *error);
 
+/**
+ * Separate the list of tokens in the \p token array into a sequence of
+ * commands in a single pass, validating the token array at the same time.
+ *
+ * Unlike 'svCommandsSeparate' nothing is allocated: each command's argv points
+ * into the \p token array itself, with the separator token following the
+ * command replaced by NULL so that argv is NULL-terminated. Do NOT call
+ * 'svCommandsFreeContents' on the \p command array.
+ *
+ * The \p token array is left untouched if an error occurs.
+ *
+ * \pre The \p command array must have at least as many elements as there are
+ * tokens in the \p token array.
+ *
+ * \param token   [in/out]  array of tokens with last element being NULL.
+ * \param command [out]     array of commands out.
+ * \param error   [out]     pointer to error structure which is filled in case
+ * of error in token array.
+ *
+ * \returns number of commands if no error (>= 0) or < 0 in case of error.
+ */
+int svCommandsSeparateInPlace(char *token[], svCommand command[],
+                              svCommandError *error);
+
 /**
  * Frees any of the contents of an array of commands that was dynamically
  * allocated.
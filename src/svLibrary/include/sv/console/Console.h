@@ -31,12 +31,45 @@
 /// Each registered command name maps to one ConsoleCommand. If two commands of
 /// the same name are entered, the second will overwrite the first.
 ///
+/// A name may instead be an alias for a line of input, which is executed in
+/// its place (see 'registerAlias').
+///
+/// Recently executed lines are kept already tokenized and split into commands,
+/// so lines executed again and again (e.g. by key bindings) aren't parsed
+/// again. A line can also be compiled once and kept by whoever executes it
+/// (see 'compile'), so it is never parsed or looked up again.
+///
+/// Input can also be queued in a command buffer and executed a few commands at
+/// a time each frame (see 'bufferString' and 'executeBuffered'), so a large
+/// config or scripted sequence is spread over several frames. A 'wait'
+/// command (see 'wait') pauses the buffer until a later frame.
+///
+/// The console belongs to one thread. Other threads (workers, the network
+/// thread, an admin socket) hand it input with 'submit', which the owning
+/// thread executes with 'executeSubmitted'.
+///
+/// Names of commands and aliases are kept in a prefix index for completion
+/// and search (see 'complete' and 'search'). ClientVariables can add the
+/// names of variables to the same index (see 'getNameIndex').
+///
 //===----------------------------------------------------------------------===//
 #pragma once
 
-#include <map>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
 #include <memory>
 #include <string>
+#include <vector>
+
+extern "C" {
+#include <sv/console/CommandTable.h>
+#include <sv/console/Commands.h>
+#include <sv/console/OutputBuffer.h>
+#include <sv/console/PrefixIndex.h>
+}
 
 namespace sv {
 class Console;
@@ -64,9 +97,82 @@ class ConsoleCommand {
     // virtual void rollback() = 0;
 };
 
+/// What a name in the console's name index refers to, used as kinds in the
+/// index (see PrefixIndex.h)
+namespace ConsoleNameKind {
+enum Enum : uint32_t {
+    Command  = 1 << 0,
+    Alias    = 1 << 1,
+    Variable = 1 << 2,
+    All      = Command | Alias | Variable,
+};
+}
+
+/// Name found by 'Console::complete' or 'Console::search'
+struct ConsoleCompletion {
+    std::string name;
+    /// ConsoleNameKind, more than one if e.g. a command and variable share
+    /// the name.
+    uint32_t kinds;
+};
+
+/// Result of a command executed from the console's command buffer, or of a
+/// line submitted from another thread
+struct ConsoleCommandResult {
+    /// The command and its arguments.
+    std::string command;
+    bool succeeded;
+    /// What the command appended to the output buffer.
+    std::string output;
+    /// What the command appended to the error buffer.
+    std::string error;
+};
+
+/// A line of input tokenized and split into its commands once, to be executed
+/// again and again without parsing it (see 'Console::compile'). The entry
+/// each command names is looked up on the first execution, and again only
+/// once commands or aliases have been registered or removed.
+class CompiledLine {
+  public:
+    CompiledLine();
+
+    ///-------------------------------------------------------------------------
+    /// \returns The line as it was compiled.
+    ///-------------------------------------------------------------------------
+    const std::string &getLine() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of commands in the line.
+    ///-------------------------------------------------------------------------
+    int getNumCommands() const;
+
+  private:
+    friend class Console;
+
+    std::string line;
+    // Line after tokenizing, before any command could change its arguments
+    std::string tokenized;
+    // Offset of each token in 'tokenized', < 0 for NULL elements
+    std::vector<int> tokenOffsets;
+    // Commands without 'sep' and 'argv', they would point into the scratch
+    std::vector<svCommand> commands;
+    // Offset of each command's separator in 'tokenized', < 0 if it isn't in
+    // the line (a command at the end of the line)
+    std::vector<int> sepOffsets;
+    int numCommands;
+    // Index of the entry each command names in 'console', < 0 if none. Valid
+    // while the console's entries are as they were at 'entriesVersion'
+    mutable std::vector<int> entryIndices;
+    mutable const Console *console;
+    mutable uint64_t entriesVersion;
+};
+
 /// Console system
 class Console {
   public:
+    Console();
+    ~Console();
+
     ///-------------------------------------------------------------------------
     /// Registers a command with the console. Console will execute the command
     /// if the command's name is found in the input buffer when a call to
@@ -91,6 +197,76 @@ class Console {
     ///-------------------------------------------------------------------------
     bool commandWithNameExists(const std::string &name) const;
 
+    ///-------------------------------------------------------------------------
+    /// Make \p name an alias for \p line. When \p name is found in the input
+    /// buffer in place of a command, \p line is executed instead. Arguments
+    /// following an alias are ignored.
+    ///
+    /// Will overwrite an existing alias with the same name.
+    ///
+    /// \returns False if a command with the same name is registered.
+    ///-------------------------------------------------------------------------
+    bool registerAlias(const std::string &name, const std::string &line);
+
+    ///-------------------------------------------------------------------------
+    /// Remove the alias with the given name from the console.
+    ///-------------------------------------------------------------------------
+    void removeAlias(const std::string &name);
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if an alias with the given name is registered with the
+    /// console.
+    ///-------------------------------------------------------------------------
+    bool aliasWithNameExists(const std::string &name) const;
+
+    ///-------------------------------------------------------------------------
+    /// Get the line an alias stands for.
+    ///
+    /// \returns False if there is no alias with the given name.
+    ///-------------------------------------------------------------------------
+    bool getAlias(const std::string &name, std::string *line) const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of lines executed without parsing them, because they
+    /// were executed recently.
+    ///-------------------------------------------------------------------------
+    size_t getNumLineCacheHits() const;
+
+    ///-------------------------------------------------------------------------
+    /// Find the first \p maxMatches names, in byte order, starting with
+    /// \p prefix and of one of the given kinds.
+    ///
+    /// \param   kinds   ConsoleNameKind.
+    ///-------------------------------------------------------------------------
+    void complete(const std::string &prefix, size_t maxMatches,
+                  std::vector<ConsoleCompletion> *matchesOut,
+                  uint32_t kinds = ConsoleNameKind::Enum::All) const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Longest string every name starting with \p prefix starts
+    /// with, what \p prefix completes to when tab is pressed. \p prefix if no
+    /// names start with it.
+    ///-------------------------------------------------------------------------
+    std::string getCommonPrefix(const std::string &prefix) const;
+
+    ///-------------------------------------------------------------------------
+    /// Find the best \p maxMatches names of the given kinds containing the
+    /// characters of \p pattern in order, ignoring case, best first (see
+    /// 'svPrefixIndexSearch').
+    ///
+    /// \param   kinds   ConsoleNameKind.
+    ///-------------------------------------------------------------------------
+    void search(const std::string &pattern, size_t maxMatches,
+                std::vector<ConsoleCompletion> *matchesOut,
+                uint32_t kinds = ConsoleNameKind::Enum::All) const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Index of the names of this console's commands and aliases,
+    /// which other registries may add names to (see
+    /// 'ClientVariables::setNameIndex').
+    ///-------------------------------------------------------------------------
+    svPrefixIndex *getNameIndex();
+
     ///-------------------------------------------------------------------------
     /// Append to the output buffer of this console. Should only be called by
     /// ConsoleCommands wanting to output useful information. Do not use this
@@ -109,9 +285,24 @@ class Console {
     ///-------------------------------------------------------------------------
     void appendToErrorBuffer(const std::string &errorStr);
 
+    ///-------------------------------------------------------------------------
+    /// Append formatted output to the output buffer, function mimics printf.
+    /// Cheaper than building a string for 'appendToOutputBuffer'.
+    ///-------------------------------------------------------------------------
+    void printToOutputBuffer(const char *format, ...);
+
+    ///-------------------------------------------------------------------------
+    /// Append formatted output to the error buffer, function mimics printf.
+    ///-------------------------------------------------------------------------
+    void printToErrorBuffer(const char *format, ...);
+
     ///-------------------------------------------------------------------------
     /// Get the output buffer of the console, where useful information from
     /// console commands is placed.
+    ///
+    /// NOTE: The buffer is kept in chunks and copied into a string when this is
+    /// called after it changes, use 'drainOutputBuffer' to read large output
+    /// without the copy.
     ///-------------------------------------------------------------------------
     const std::string &getOutputBuffer() const;
 
@@ -123,6 +314,42 @@ class Console {
     ///-------------------------------------------------------------------------
     const std::string &getErrorBuffer() const;
 
+    ///-------------------------------------------------------------------------
+    /// Pass the output buffer to \p callback a chunk at a time, then clear it.
+    ///-------------------------------------------------------------------------
+    void drainOutputBuffer(svOutputBufferCallback callback, void *userData);
+
+    ///-------------------------------------------------------------------------
+    /// Pass the error buffer to \p callback a chunk at a time, then clear it.
+    ///-------------------------------------------------------------------------
+    void drainErrorBuffer(svOutputBufferCallback callback, void *userData);
+
+    ///-------------------------------------------------------------------------
+    /// Pass output to \p callback as commands append it instead of collecting
+    /// it in the output buffer, or collect it again if \p callback is nullptr.
+    ///-------------------------------------------------------------------------
+    void setOutputCallback(svOutputBufferCallback callback, void *userData);
+
+    ///-------------------------------------------------------------------------
+    /// Pass errors to \p callback as commands append them instead of
+    /// collecting them in the error buffer, or collect them again if
+    /// \p callback is nullptr.
+    ///-------------------------------------------------------------------------
+    void setErrorCallback(svOutputBufferCallback callback, void *userData);
+
+    ///-------------------------------------------------------------------------
+    /// Hold at most \p maxSize bytes in each of the output and error buffers,
+    /// or any amount if \p maxSize is 0. Further output is dropped. Defaults
+    /// to SV_OUTPUT_BUFFER_DEFAULT_MAX_SIZE.
+    ///-------------------------------------------------------------------------
+    void setOutputBufferMaxSize(size_t maxSize);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of bytes dropped from the output and error buffers
+    /// because they were full, since they were last cleared.
+    ///-------------------------------------------------------------------------
+    size_t getNumDroppedOutput() const;
+
     ///-------------------------------------------------------------------------
     /// Append a string to the to the console, to be executed when 'execute()'
     /// is
@@ -151,13 +378,208 @@ class Console {
     ///-------------------------------------------------------------------------
     bool executeString(const std::string &str);
 
+    ///-------------------------------------------------------------------------
+    /// Tokenize \p line and split it into its commands, ready to be executed
+    /// by 'execute(const CompiledLine &)'.
+    ///
+    /// \returns False if \p line is not valid input, in which case
+    /// \p compiled is unchanged and the error is appended to the error buffer.
+    ///-------------------------------------------------------------------------
+    bool compile(const std::string &line, CompiledLine *compiled);
+
+    ///-------------------------------------------------------------------------
+    /// Execute a line compiled by 'compile', without parsing it again.
+    ///
+    /// NOTE: Each call to execute clears the output and error buffers.
+    ///
+    /// \returns True if all commands executed successfully, false otherwise.
+    /// Note that execution stops at the first unsuccessful command.
+    ///-------------------------------------------------------------------------
+    bool execute(const CompiledLine &compiled);
+
+    ///-------------------------------------------------------------------------
+    /// Queue the commands in \p str in the command buffer, after any commands
+    /// already queued, to be executed by 'executeBuffered'.
+    ///
+    /// \returns False if \p str is not valid input, in which case nothing is
+    /// queued and the error is appended to the error buffer.
+    ///-------------------------------------------------------------------------
+    bool bufferString(const std::string &str);
+
+    ///-------------------------------------------------------------------------
+    /// Queue the commands in \p str in the command buffer, before any commands
+    /// already queued. Used by commands executing from the buffer that run
+    /// more input (e.g. 'exec'), so it runs before the commands after them.
+    ///
+    /// \returns False if \p str is not valid input, in which case nothing is
+    /// queued and the error is appended to the error buffer.
+    ///-------------------------------------------------------------------------
+    bool insertString(const std::string &str);
+
+    ///-------------------------------------------------------------------------
+    /// Execute commands from the command buffer, in the order they were
+    /// queued, until the buffer is empty, a command calls 'wait' or the budget
+    /// is used up. Call once a frame.
+    ///
+    /// A command that fails doesn't stop the following commands. Each
+    /// command's output is collected in 'getBufferedResults' rather than the
+    /// output and error buffers. An alias queues the commands it stands for
+    /// in its place, so they can 'wait' too, unless it is nested too deeply
+    /// (e.g. an alias that expands to itself).
+    ///
+    /// \param   maxCommands   Most commands to execute, 0 for no limit.
+    /// \param   maxSeconds   Stop once this much time has passed, 0 for no
+    /// limit. At least one command is executed if any are queued.
+    ///
+    /// \returns Number of commands executed.
+    ///-------------------------------------------------------------------------
+    size_t executeBuffered(size_t maxCommands, double maxSeconds);
+
+    ///-------------------------------------------------------------------------
+    /// Stop executing the command buffer until \p frames more calls to
+    /// 'executeBuffered' have passed, 1 to continue next frame.
+    ///-------------------------------------------------------------------------
+    void wait(unsigned int frames);
+
+    ///-------------------------------------------------------------------------
+    /// \returns True while 'executeBuffered' is executing commands.
+    ///-------------------------------------------------------------------------
+    bool isExecutingBuffer() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of commands waiting in the command buffer.
+    ///-------------------------------------------------------------------------
+    size_t getNumBufferedCommands() const;
+
+    ///-------------------------------------------------------------------------
+    /// Remove all commands from the command buffer and stop waiting.
+    ///-------------------------------------------------------------------------
+    void clearBuffer();
+
+    ///-------------------------------------------------------------------------
+    /// Get the results of commands executed from the command buffer, oldest
+    /// first. Results are kept until 'clearBufferedResults' is called.
+    ///-------------------------------------------------------------------------
+    const std::vector<ConsoleCommandResult> &getBufferedResults() const;
+
+    ///-------------------------------------------------------------------------
+    /// Forget the results of commands executed from the command buffer.
+    ///-------------------------------------------------------------------------
+    void clearBufferedResults();
+
+    ///-------------------------------------------------------------------------
+    /// Queue \p str to be executed by the thread that owns the console when it
+    /// next calls 'executeSubmitted'.
+    ///
+    /// May be called from any thread. Never waits for the console, or for any
+    /// other thread submitting at the same time.
+    ///
+    /// \returns Future result of executing \p str, with what it appended to
+    /// the output and error buffers.
+    ///-------------------------------------------------------------------------
+    std::future<ConsoleCommandResult> submit(const std::string &str);
+
+    ///-------------------------------------------------------------------------
+    /// Execute all input submitted so far, in the order it was submitted. Call
+    /// on the thread that owns the console, e.g. once a frame.
+    ///
+    /// Input and output buffers are left as they were, output of submitted
+    /// input only goes to its result.
+    ///
+    /// \returns Number of submissions executed.
+    ///-------------------------------------------------------------------------
+    size_t executeSubmitted();
+
   private:
-    typedef std::map<std::string, std::shared_ptr<ConsoleCommand>>
-        ConsoleCommandMap;
-    ConsoleCommandMap consoleCommands;
+    // A command or an alias
+    struct ConsoleEntry {
+        std::string name;
+        std::shared_ptr<ConsoleCommand> command;
+        std::string alias;
+    };
+    // Index into 'entries' of the entry with the given name, < 0 if none
+    int findEntry(const std::string &name) const;
+    // Add or replace the entry with the given name
+    void setEntry(const ConsoleEntry &entry);
+    void removeEntry(int index);
+    // ConsoleNameKind of an entry
+    static uint32_t getEntryKind(const ConsoleEntry &entry);
+
+    std::vector<ConsoleEntry> entries;
+    // Changed each time an entry is added, replaced or removed, so compiled
+    // lines know when the entries they looked up may have moved
+    uint64_t entriesVersion;
+    // Index in 'entries' of each name
+    svCommandTable entryTable;
+    // Names of entries, and of anything else sharing the index
+    svPrefixIndex nameIndex;
 
     std::string inputBuffer;
-    std::string outputBuffer;
-    std::string errorBuffer;
+    svOutputBuffer outputBuffer;
+    svOutputBuffer errorBuffer;
+    // Copies of the output and error buffers returned by 'getOutputBuffer'
+    // and 'getErrorBuffer', made again once the buffers change
+    mutable std::string outputString;
+    mutable std::string errorString;
+    mutable bool outputStringValid;
+    mutable bool errorStringValid;
+
+    // Clear the output and error buffers
+    void clearOutput();
+    // Move the output and error buffers into \p result
+    void takeOutput(ConsoleCommandResult *result);
+
+    // Line being executed, its tokens and its commands. Kept between calls to
+    // 'execute' so parsing a line doesn't allocate once they have grown large
+    // enough. Commands may execute more input (e.g. 'exec'), so there is one
+    // per level of nesting.
+    struct ParseScratch;
+    std::vector<std::unique_ptr<ParseScratch>> parseScratch;
+    size_t executeDepth;
+
+    // Get the scratch for the current level of nesting
+    ParseScratch &getParseScratch();
+    // Tokenize and split the scratch line into its commands, \returns number
+    // of commands or < 0 if the line isn't valid (error buffer says why)
+    int parseLine(ParseScratch &scratch);
+    // Parse (or find in the line cache) and execute the scratch line
+    bool executeLine(ParseScratch &scratch);
+    // Remember the parsed scratch line in \p compiled
+    void storeLine(const ParseScratch &scratch, int numCommands,
+                   CompiledLine *compiled);
+    // Put a parsed line back in the scratch, \returns number of commands
+    int restoreLine(const CompiledLine &compiled, ParseScratch &scratch);
+    // Execute the commands of a parsed line, the scratch line restored from
+    // \p compiled
+    bool executeCommands(ParseScratch &scratch, int numCommands,
+                         const CompiledLine &compiled);
+
+    // Recently executed lines, already parsed
+    struct CachedLine;
+    std::unique_ptr<CachedLine[]> lineCache;
+    uint64_t lineCacheClock;
+    size_t numLineCacheHits;
+
+    // A command waiting in the command buffer
+    struct BufferedCommand {
+        std::string name;
+        // Command and its arguments
+        std::string line;
+        // Number of aliases it was expanded from
+        size_t depth;
+    };
+    // Split \p str into commands, \returns false if \p str isn't valid input
+    bool splitCommands(const std::string &str,
+                       std::vector<BufferedCommand> *commands);
+
+    std::deque<BufferedCommand> commandBuffer;
+    std::vector<BufferedCommand> splitBuffer;
+    std::vector<ConsoleCommandResult> bufferedResults;
+    unsigned int waitFrames;
+    bool executingBuffer;
+
+    // Input submitted from other threads, most recent first
+    struct Submission;
+    std::atomic<Submission *> submissions;
 };
 }
@@ -3,6 +3,9 @@
 #include <sv/ClientVariables.h>
 #include <sv/console/Console.h>
 #include <sv/input/Input.h>
+#include <sv/network/Connection.h>
+#include <sv/network/NetworkSimulator.h>
+#include <sv/network/PacketCapture.h>
 #include <sv/resource/ResourceCache.h>
 
 namespace sv {
@@ -37,6 +40,26 @@ class UnbindAllCommand : public ConsoleCommand {
     Input &inputSystem;
 };
 
+/// Presses ("+name") or releases ("-name") an input action
+class ActionCommand : public ConsoleCommand {
+  public:
+    ActionCommand(Input &inputSystem_, int action_, bool press_)
+        : inputSystem(inputSystem_), action(action_), press(press_) {}
+
+    ///-------------------------------------------------------------------------
+    /// \copydoc ConsoleCommand::execute()
+    ///
+    /// Usage: +name
+    ///        -name
+    ///-------------------------------------------------------------------------
+    virtual bool execute(Console &console, int argc, char *argv[]);
+
+  private:
+    Input &inputSystem;
+    int action;
+    bool press;
+};
+
 /// Used to set client variables
 class SetCommand : public ConsoleCommand {
   public:
@@ -65,6 +88,9 @@ class ExecCommand : public ConsoleCommand {
     /// \copydoc ConsoleCommand::execute()
     ///
     /// Usage: exec "file"
+    ///
+    /// When executed from the console's command buffer, the file's commands
+    /// are queued to execute next rather than executed immediately.
     ///-------------------------------------------------------------------------
     virtual bool execute(Console &console, int argc, char *argv[]);
 
@@ -82,4 +108,123 @@ class EchoCommand : public ConsoleCommand {
     ///-------------------------------------------------------------------------
     virtual bool execute(Console &console, int argc, char *argv[]);
 };
+
+/// Used to spread commands in the console's command buffer over several
+/// frames.
+class WaitCommand : public ConsoleCommand {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \copydoc ConsoleCommand::execute()
+    ///
+    /// Usage: wait ["frames"]
+    ///
+    /// Stops executing the command buffer until the given number of frames
+    /// (default 1) have passed.
+    ///-------------------------------------------------------------------------
+    virtual bool execute(Console &console, int argc, char *argv[]);
+};
+
+/// Used to give a line of input a short name.
+class AliasCommand : public ConsoleCommand {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \copydoc ConsoleCommand::execute()
+    ///
+    /// Usage: alias "name" ["COMMAND_STRING"]
+    ///
+    /// With no command string, prints the command string of the alias.
+    ///-------------------------------------------------------------------------
+    virtual bool execute(Console &console, int argc, char *argv[]);
+};
+
+/// Used to remove an alias.
+class UnaliasCommand : public ConsoleCommand {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \copydoc ConsoleCommand::execute()
+    ///
+    /// Usage: unalias "name"
+    ///-------------------------------------------------------------------------
+    virtual bool execute(Console &console, int argc, char *argv[]);
+};
+
+/// Used to look up commands, aliases and variables by part of their name.
+class FindCommand : public ConsoleCommand {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \copydoc ConsoleCommand::execute()
+    ///
+    /// Usage: find "pattern"
+    ///
+    /// Prints the names best matching the pattern, see 'Console::search'.
+    ///-------------------------------------------------------------------------
+    virtual bool execute(Console &console, int argc, char *argv[]);
+};
+
+/// Used to configure a network simulator from the console.
+class NetSimCommand : public ConsoleCommand {
+  public:
+    NetSimCommand(net::NetworkSimulator &simulator_) : simulator(simulator_) {}
+
+    ///-------------------------------------------------------------------------
+    /// \copydoc ConsoleCommand::execute()
+    ///
+    /// Usage: net_sim ["on"|"off"]
+    ///        net_sim "latency"|"jitter" "ms"
+    ///        net_sim "loss"|"duplicate" "percent"
+    ///        net_sim "bandwidth"|"queue" "bytes"
+    ///        net_sim "distribution" "uniform"|"normal"
+    ///        net_sim "seed" "n"
+    ///
+    /// With no arguments, prints the current network conditions.
+    ///-------------------------------------------------------------------------
+    virtual bool execute(Console &console, int argc, char *argv[]);
+
+  private:
+    net::NetworkSimulator &simulator;
+};
+
+/// Used to inspect the statistics of a network connection.
+class NetStatsCommand : public ConsoleCommand {
+  public:
+    NetStatsCommand(net::Connection &connection_) : connection(connection_) {}
+
+    ///-------------------------------------------------------------------------
+    /// \copydoc ConsoleCommand::execute()
+    ///
+    /// Usage: net_stats
+    ///        net_stats "log" "seconds"
+    ///
+    /// With no arguments, prints the connection's statistics. Otherwise sets
+    /// how often statistics are written to the log, 0 to stop.
+    ///-------------------------------------------------------------------------
+    virtual bool execute(Console &console, int argc, char *argv[]);
+
+  private:
+    net::Connection &connection;
+};
+
+/// Used to record a network connection's traffic to a file.
+class NetCaptureCommand : public ConsoleCommand {
+  public:
+    NetCaptureCommand(net::Connection &connection_) : connection(connection_) {}
+    ~NetCaptureCommand();
+
+    ///-------------------------------------------------------------------------
+    /// \copydoc ConsoleCommand::execute()
+    ///
+    /// Usage: net_capture
+    ///        net_capture "file"
+    ///        net_capture "off"
+    ///
+    /// With no arguments, prints whether a capture is running. Otherwise
+    /// starts capturing to the given file (replacing any capture running) or
+    /// stops capturing.
+    ///-------------------------------------------------------------------------
+    virtual bool execute(Console &console, int argc, char *argv[]);
+
+  private:
+    net::Connection &connection;
+    net::PacketCapture capture;
+};
 }
@@ -0,0 +1,146 @@
+/*===-- sv/console/OutputBuffer.h - Command output -----------------*- C -*-===
+ *
+ *                  The Special Engine Variant Game Engine
+ *
+ * This file is distributed under the MIT License. See LICENSE.txt for details.
+ *
+ *===----------------------------------------------------------------------===*/
+/**
+ * \file
+ * \brief Collects the output of commands, shared by the Shell and the Console.
+ *
+ * Output is kept in a list of fixed size chunks, so appending never moves what
+ * has already been written and long output (e.g. a listing of every resource)
+ * doesn't repeatedly reallocate. Formatted output is printed straight into the
+ * free space of the last chunk. Clearing the buffer keeps its chunks for
+ * reuse, so a buffer that is cleared and refilled stops allocating.
+ *
+ * A buffer may be capped at a maximum size, output past the cap is dropped and
+ * counted. Instead of collecting output, a buffer may pass it to a callback as
+ * soon as it is written, and collected output may be drained chunk by chunk.
+ *
+ * A buffer that has been zeroed (e.g. a static buffer) is a valid, empty,
+ * uncapped buffer.
+ *===----------------------------------------------------------------------===*/
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/* Bytes of output held by each chunk */
+#define SV_OUTPUT_BUFFER_CHUNK_SIZE 4096
+
+/* Cap used by the Shell and Console unless told otherwise */
+#define SV_OUTPUT_BUFFER_DEFAULT_MAX_SIZE (4 * 1024 * 1024)
+
+/**
+ * Receives \p size bytes of output. \p data is not NULL-terminated.
+ */
+typedef void (*svOutputBufferCallback)(void *userData, const char *data,
+                                       size_t size);
+
+typedef struct svOutputBufferChunk {
+    struct svOutputBufferChunk *next;
+    size_t size; /* Bytes used */
+    /* SV_OUTPUT_BUFFER_CHUNK_SIZE bytes of data follow, plus one for a
+     * NULL-terminator */
+} svOutputBufferChunk;
+
+typedef struct svOutputBuffer {
+    svOutputBufferChunk *first;
+    svOutputBufferChunk *last;
+    svOutputBufferChunk *spare;      /* Chunks kept for reuse */
+    size_t size;                     /* Bytes of output held */
+    size_t maxSize;                  /* 0 if uncapped */
+    size_t numDropped;               /* Bytes dropped because of the cap */
+    svOutputBufferCallback callback; /* NULL if collecting output */
+    void *userData;
+} svOutputBuffer;
+
+/**
+ * Make \p buffer an empty buffer holding at most \p maxSize bytes, or any
+ * amount if \p maxSize is 0.
+ */
+void svOutputBufferInit(svOutputBuffer *buffer, size_t maxSize);
+
+/**
+ * Free all memory used by \p buffer, leaving it an empty buffer with the same
+ * cap and callback.
+ */
+void svOutputBufferFree(svOutputBuffer *buffer);
+
+/**
+ * Forget all output and the count of dropped bytes, keeping the chunks for
+ * reuse.
+ */
+void svOutputBufferClear(svOutputBuffer *buffer);
+
+/**
+ * Hold at most \p maxSize bytes from now on, or any amount if \p maxSize is 0.
+ * Output already held is kept.
+ */
+void svOutputBufferSetMaxSize(svOutputBuffer *buffer, size_t maxSize);
+
+/**
+ * Pass output to \p callback as it is written instead of collecting it, or
+ * collect it again if \p callback is NULL. Streamed output is not capped.
+ */
+void svOutputBufferSetCallback(svOutputBuffer *buffer,
+                               svOutputBufferCallback callback,
+                               void *userData);
+
+/**
+ * Append \p size bytes of \p data.
+ *
+ * \returns Number of bytes kept, less than \p size if the cap was reached.
+ */
+size_t svOutputBufferAppend(svOutputBuffer *buffer, const char *data,
+                            size_t size);
+
+/**
+ * Append formatted output, function mimics printf.
+ *
+ * \returns Number of bytes kept.
+ */
+size_t svOutputBufferPrint(svOutputBuffer *buffer, const char *format, ...);
+
+/**
+ * Append formatted output, function mimics vprintf.
+ *
+ * \returns Number of bytes kept.
+ */
+size_t svOutputBufferVPrint(svOutputBuffer *buffer, const char *format,
+                            va_list args);
+
+/**
+ * \returns Number of bytes of output held.
+ */
+size_t svOutputBufferGetSize(const svOutputBuffer *buffer);
+
+/**
+ * \returns Number of bytes dropped because of the cap since the buffer was
+ * last cleared.
+ */
+size_t svOutputBufferGetNumDropped(const svOutputBuffer *buffer);
+
+/**
+ * Copy the output into \p out as a NULL-terminated string, copying at most
+ * \p outSize - 1 bytes.
+ *
+ * \returns Number of bytes copied, not counting the NULL-terminator.
+ */
+size_t svOutputBufferCopy(const svOutputBuffer *buffer, char *out,
+                          size_t outSize);
+
+/**
+ * Pass the output to \p callback a chunk at a time, in order.
+ */
+void svOutputBufferForEach(const svOutputBuffer *buffer,
+                           svOutputBufferCallback callback, void *userData);
+
+/**
+ * Pass the output to \p callback a chunk at a time, in order, then clear the
+ * buffer.
+ */
+void svOutputBufferDrain(svOutputBuffer *buffer,
+                         svOutputBufferCallback callback, void *userData);
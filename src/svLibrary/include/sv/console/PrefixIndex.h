@@ -0,0 +1,141 @@
+/*===-- sv/console/PrefixIndex.h - Name completion -----------------*- C -*-===
+ *
+ *                  The Special Engine Variant Game Engine
+ *
+ * This file is distributed under the MIT License. See LICENSE.txt for details.
+ *
+ *===----------------------------------------------------------------------===*/
+/**
+ * \file
+ * \brief Index of names (commands, aliases, client variables) for completion
+ * and search, shared by the Console and ClientVariables.
+ *
+ * A radix trie: each edge is labelled with a run of bytes, and nodes with a
+ * single child and no name of their own are merged into it. Children are kept
+ * sorted, so names are visited in byte order. Each node counts the names below
+ * it, so the number of names starting with a prefix is found without visiting
+ * them. Each node also keeps the characters used below it and the length of
+ * its shortest name, so a search skips subtrees that can't hold a match, or a
+ * better match than those already found.
+ *
+ * Each name carries a set of kinds, bits chosen by the users of the index
+ * (e.g. command or variable), so several registries can share one index and a
+ * search can be limited to some of them.
+ *
+ * An index that has been zeroed (e.g. a static index) is a valid, empty
+ * index.
+ *===----------------------------------------------------------------------===*/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct svPrefixIndexNode {
+    char *label;         /* Bytes on the edge from the parent, not
+                            NULL-terminated */
+    size_t labelLength;
+    char *name;          /* Name ending at this node, NULL if none */
+    unsigned int kinds;  /* Kinds of name, 0 if none */
+    size_t count;        /* Names ending at or below this node */
+    size_t minLength;    /* Length of the shortest name at or below this
+                            node */
+    uint64_t chars;      /* Characters in the labels of this node and those
+                            below it, a bit per letter (ignoring case) or
+                            digit, other bytes share bits */
+    struct svPrefixIndexNode **children; /* Sorted by first label byte */
+    int numChildren;
+    int childCapacity;
+} svPrefixIndexNode;
+
+typedef struct svPrefixIndex {
+    svPrefixIndexNode root; /* Has an empty label */
+} svPrefixIndex;
+
+typedef struct svPrefixIndexMatch {
+    const char *name; /* Valid until the name is removed */
+    size_t length;    /* Length of name */
+    unsigned int kinds;
+    int score; /* 0 for prefix matches, see svPrefixIndexSearch */
+} svPrefixIndexMatch;
+
+/**
+ * Make \p index an empty index.
+ */
+void svPrefixIndexInit(svPrefixIndex *index);
+
+/**
+ * Free all memory used by \p index, leaving it an empty index.
+ */
+void svPrefixIndexFree(svPrefixIndex *index);
+
+/**
+ * Add \p kinds (not 0) to the kinds of \p name, adding \p name if it is not
+ * in the index. \p name is copied.
+ *
+ * \returns 0 if no error, other if memory could not be allocated.
+ */
+int svPrefixIndexInsert(svPrefixIndex *index, const char *name,
+                        unsigned int kinds);
+
+/**
+ * Take \p kinds from the kinds of \p name, removing \p name once it has none.
+ *
+ * \returns The kinds \p name had, 0 if it was not in the index.
+ */
+unsigned int svPrefixIndexRemove(svPrefixIndex *index, const char *name,
+                                 unsigned int kinds);
+
+/**
+ * \returns The kinds of \p name, 0 if it is not in the index.
+ */
+unsigned int svPrefixIndexFind(const svPrefixIndex *index, const char *name);
+
+/**
+ * \returns Number of names in the index.
+ */
+size_t svPrefixIndexGetCount(const svPrefixIndex *index);
+
+/**
+ * \returns Number of names of any kind starting with \p prefix.
+ */
+size_t svPrefixIndexCountPrefix(const svPrefixIndex *index,
+                                const char *prefix);
+
+/**
+ * Find the first names, in byte order, starting with \p prefix and having one
+ * of \p kinds. Stops after \p maxMatches, so the cost follows \p maxMatches
+ * rather than the number of names starting with \p prefix.
+ *
+ * \returns Number of matches written to \p matches.
+ */
+size_t svPrefixIndexComplete(const svPrefixIndex *index, const char *prefix,
+                             unsigned int kinds, svPrefixIndexMatch *matches,
+                             size_t maxMatches);
+
+/**
+ * Copy the longest string that every name starting with \p prefix starts
+ * with into \p out as a NULL-terminated string, copying at most
+ * \p outSize - 1 bytes. That is what \p prefix completes to when tab is
+ * pressed. If no names start with \p prefix, \p prefix is copied.
+ *
+ * \returns Number of names starting with \p prefix.
+ */
+size_t svPrefixIndexGetCommonPrefix(const svPrefixIndex *index,
+                                    const char *prefix, char *out,
+                                    size_t outSize);
+
+/**
+ * Find the best \p maxMatches names having one of \p kinds that contain the
+ * bytes of \p pattern in order, ignoring ASCII case (e.g. "nsim" matches
+ * "net_sim").
+ *
+ * A match's score is the number of bytes of the name skipped up to its last
+ * matched byte, using the earliest match. Lower scores are better, then
+ * shorter names, then names earlier in byte order. Matches are written best
+ * first.
+ *
+ * \returns Number of matches written to \p matches.
+ */
+size_t svPrefixIndexSearch(const svPrefixIndex *index, const char *pattern,
+                           unsigned int kinds, svPrefixIndexMatch *matches,
+                           size_t maxMatches);
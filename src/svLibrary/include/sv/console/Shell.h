@@ -50,11 +50,17 @@
  *
  * If any command in a series of commands entered returns an integer other than
  * 0 or cannot be found, no following commands will be executed.
+ *
+ * The shell's commands and buffers are global and unsynchronised, only use the
+ * shell from one thread. Other threads should submit input through a console
+ * instead (see Console::submit).
  *===----------------------------------------------------------------------===*/
 #pragma once
 
 #include <stddef.h>
 
+#include <sv/console/OutputBuffer.h>
+
 /**
  * Add a new command to the shell. The command will be given the name \p
  * commandName and when that name is found in an input line, the given \p
@@ -130,6 +136,25 @@ size_t svShellGetErrorBufferSize();
  */
 void svShellGetErrorBuffer(void *outBuffer);
 
+/**
+ * Hold at most \p maxSize bytes in each of the output and error buffers, or
+ * any amount if \p maxSize is 0. Further output is dropped. Defaults to
+ * SV_OUTPUT_BUFFER_DEFAULT_MAX_SIZE.
+ */
+void svShellSetOutputBufferMaxSize(size_t maxSize);
+
+/**
+ * Pass output to \p callback as commands print it instead of collecting it in
+ * the output buffer, or collect it again if \p callback is NULL.
+ */
+void svShellSetOutputCallback(svOutputBufferCallback callback, void *userData);
+
+/**
+ * Pass errors to \p callback as commands print them instead of collecting them
+ * in the error buffer, or collect them again if \p callback is NULL.
+ */
+void svShellSetErrorCallback(svOutputBufferCallback callback, void *userData);
+
 /**
  * Print to shell output buffer, function mimics printf.
  */
@@ -4,6 +4,8 @@ typedef struct svTokenizerError {
     /* Error code:
      *     -1,  if string is not properly closed, e.g. ("Hello world) instead of
      *          ("Hello world")
+     *     -2,  if the input has more tokens than fit in the token array
+     *          given to 'svTokenizerTokenizeInPlace'.
      */
     int errorCode;
     /* Position of character causing error relative to starting character of
@@ -66,3 +68,32 @@ int svTokenizerGetNumTokens(const char *inputLine, svTokenizerError *error);
 */
 int svTokenizerTokenize(char *inputLine, char *token[],
                         svTokenizerError *error);
+
+/**
+ * Split \p inputLine into tokens in a single pass, validating it at the same
+ * time. Unlike 'svTokenizerTokenize' no separate validation or counting pass
+ * is needed and nothing is allocated: tokens are NULL-terminated in place and
+ * \p token is filled with pointers into \p inputLine.
+ *
+ * Whitespace outside of strings separates tokens, leading and trailing
+ * whitespace is ignored and empty strings ("" or '') are removed from the
+ * input line. A token that was only empty strings is kept as an empty token.
+ *
+ * A line of N characters never has more than N / 2 + 1 tokens, so a token
+ * array of N / 2 + 2 elements (including the NULL terminator) is always large
+ * enough.
+ *
+ * \pre   \p inputLine is a NULL-terminated string.
+ *
+ * \param       inputLine    string of characters to tokenise, contents are
+ * undefined if an error occurs.
+ * \param [out] token        tokens out, followed by a NULL element.
+ * \param       maxTokens    number of elements in \p token, including the
+ * NULL element.
+ * \param [out] error        pointer to error structure which is filled in case
+ * of error.
+ *
+ * \return Number of tokens if no error (>= 0) or < 0 on error.
+ */
+int svTokenizerTokenizeInPlace(char *inputLine, char *token[], int maxTokens,
+                               svTokenizerError *error);
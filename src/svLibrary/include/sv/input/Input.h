@@ -7,34 +7,71 @@
 //===----------------------------------------------------------------------===//
 ///
 /// \file
-/// \brief The input system is used to associate key names with command strings,
+/// \brief The input system is used to associate keys with command strings,
 /// which can be executed by the console.
 ///
+/// Bindings are kept in a table indexed by keycode (see 'getKeycodeIndex'),
+/// so the binding of a pressed key is found without any string work. Key
+/// names ("KEY_W") are only looked up when binding from the console. Each
+/// binding keeps its command string compiled by the console (see
+/// 'Console::compile'), so executing it doesn't parse it again.
+///
+/// Like Quake, a key bound to "+name" where 'name' is a registered action
+/// holds the action down while the key is down, without involving the
+/// console. Gameplay code polls actions each frame (see 'isActionDown'). A
+/// key bound to any other line starting with '+' executes the line with '-'
+/// in place of the '+' when released.
+///
 /// The input system also exposes some console commands that allow
 /// binding/unbinding to be done from the console.
 ///
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <bitset>
 #include <string>
 #include <vector>
 
+#include <sv/console/Console.h>
+#include <sv/platform/Keycodes.h>
+
 namespace sv {
 
+/// Most actions that can be registered with the input system
+const int MAX_INPUT_ACTIONS = 128;
+
+/// A bit for each action, by index
+typedef std::bitset<MAX_INPUT_ACTIONS> InputActionBits;
+
 /// Associates a key with a command string
 struct Binding {
-    Binding() : keyName(std::string("")), cmdString(std::string("")) {}
-    Binding(const std::string &keyName_, const std::string &cmdString_)
-        : keyName(keyName_), cmdString(cmdString_) {}
+    Binding()
+        : keycode(Keycodes::Enum::KEY_FIRST), bound(false), compiled(false),
+          action(-1), hasRelease(false) {}
 
-    std::string keyName;
+    Keycodes::Enum keycode;
     std::string cmdString;
+    bool bound;
+    /// True once 'cmdString' has been resolved to an action or compiled by
+    /// the console.
+    bool compiled;
+    /// Action held while the key is down, < 0 if 'cmdString' is executed by
+    /// the console instead.
+    int action;
+    CompiledLine commands;
+    /// True if 'releaseCommands' should be executed when the key is released.
+    bool hasRelease;
+    CompiledLine releaseCommands;
 };
 
+/// A binding for each keycode index
 typedef std::vector<Binding> Bindings;
 
 class Input {
   public:
+    Input();
+    ~Input();
+
     ///-------------------------------------------------------------------------
     /// Get the command string associated with the given key name.
     ///
@@ -45,8 +82,29 @@ class Input {
 
     ///-------------------------------------------------------------------------
     /// Associate a key name with a command string.
+    ///
+    /// \returns False if no key has the given name (see 'getKeycodeFromName').
+    ///-------------------------------------------------------------------------
+    bool bind(const std::string &keyName, const std::string &commandStr);
+
+    ///-------------------------------------------------------------------------
+    /// Associate a key with a command string. The command string is compiled
+    /// when the key is first executed.
+    ///
+    /// \returns False if \p keycode is not a key.
+    ///-------------------------------------------------------------------------
+    bool bind(Keycodes::Enum keycode, const std::string &commandStr);
+
+    ///-------------------------------------------------------------------------
+    /// Associate a key with a command string, compiling it now with the given
+    /// console.
+    ///
+    /// \returns False if \p keycode is not a key or \p commandStr is not valid
+    /// input (the console's error buffer says why), in which case the key's
+    /// binding is unchanged.
     ///-------------------------------------------------------------------------
-    void bind(const std::string &keyName, const std::string &commandStr);
+    bool bind(Keycodes::Enum keycode, const std::string &commandStr,
+              Console &console);
 
     ///-------------------------------------------------------------------------
     /// \returns Pointer to binding with the given name or nullptr if not found.
@@ -58,12 +116,107 @@ class Input {
     ///-------------------------------------------------------------------------
     const Binding *findBinding(const std::string &keyName) const;
 
+    ///-------------------------------------------------------------------------
+    /// \returns Pointer to binding of the given key or nullptr if not found.
+    ///-------------------------------------------------------------------------
+    Binding *findBinding(Keycodes::Enum keycode);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Pointer to binding of the given key or nullptr if not found.
+    ///-------------------------------------------------------------------------
+    const Binding *findBinding(Keycodes::Enum keycode) const;
+
+    ///-------------------------------------------------------------------------
+    /// Execute the commands bound to the given key with the given console,
+    /// e.g. when the key is pressed.
+    ///
+    /// \returns False if the key isn't bound or its commands failed.
+    ///-------------------------------------------------------------------------
+    bool execute(Keycodes::Enum keycode, Console &console);
+
     ///-------------------------------------------------------------------------
     /// Remove all bindings from the input system.
     ///-------------------------------------------------------------------------
     void clearAllBindings();
 
+    ///-------------------------------------------------------------------------
+    /// Register an action, held down while a key bound to "+name" is down.
+    ///
+    /// \returns Index of the action (the same index if it is already
+    /// registered), or < 0 if MAX_INPUT_ACTIONS actions are registered.
+    ///-------------------------------------------------------------------------
+    int registerAction(const std::string &name);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Index of the action with the given name, < 0 if none.
+    ///-------------------------------------------------------------------------
+    int findAction(const std::string &name) const;
+
+    ///-------------------------------------------------------------------------
+    /// Hold an action down, e.g. for a key or a "+name" console command. The
+    /// action is down until each press is released.
+    ///-------------------------------------------------------------------------
+    void pressAction(int action);
+
+    ///-------------------------------------------------------------------------
+    /// Release one press of an action.
+    ///-------------------------------------------------------------------------
+    void releaseAction(int action);
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if the action is held down.
+    ///-------------------------------------------------------------------------
+    bool isActionDown(int action) const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if the action went down since 'beginFrame', even if it
+    /// has been released again since.
+    ///-------------------------------------------------------------------------
+    bool wasActionPressed(int action) const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if the action was released since 'beginFrame'.
+    ///-------------------------------------------------------------------------
+    bool wasActionReleased(int action) const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns A bit for each action, set if the action is held down.
+    ///-------------------------------------------------------------------------
+    const InputActionBits &getActionsDown() const;
+
+    ///-------------------------------------------------------------------------
+    /// Start a new frame, forgetting which actions were pressed and released.
+    ///-------------------------------------------------------------------------
+    void beginFrame();
+
+    ///-------------------------------------------------------------------------
+    /// Handle a key going down or up, pressing or releasing the action it is
+    /// bound to, or executing its commands with the given console. Repeated
+    /// key downs while a key is held are ignored.
+    ///
+    /// \returns False if commands failed.
+    ///-------------------------------------------------------------------------
+    bool handleKey(Keycodes::Enum keycode, bool down, Console &console);
+
   private:
     Bindings bindings;
+
+    // Resolve a binding's action or compile its commands with \p console,
+    // \returns false if its command string isn't valid input
+    bool prepareBinding(Binding &binding, Console &console);
+
+    std::vector<std::string> actionNames;
+    // Index of each action name
+    svCommandTable actionTable;
+    // Number of presses holding each action down
+    std::vector<int> actionPresses;
+    InputActionBits actionsDown;
+    InputActionBits actionsPressed;
+    InputActionBits actionsReleased;
+
+    std::bitset<NUM_KEYCODE_INDICES> keysDown;
+    // Action each key pressed when it went down, < 0 if none, so the same
+    // action is released even if the key was bound again while down
+    std::vector<int> keyActions;
 };
 }
@@ -0,0 +1,91 @@
+//===-- sv/input/InputDispatcher.h - Platform events to input ---*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Drains a platform's events once a frame and feeds them to the input
+/// system.
+///
+/// Key events go through the input system's bindings (see
+/// 'Input::handleKey'): keys bound to actions only change the action bits,
+/// other keys execute their compiled commands. Mouse motion and text input
+/// are gathered for the frame, and a quit event is remembered.
+///
+/// Events are taken from the platform a batch at a time and handled in one
+/// pass.
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <sv/console/Console.h>
+#include <sv/input/Input.h>
+#include <sv/platform/Platform.h>
+
+namespace sv {
+/// Most events taken from the platform before they are handled
+const size_t INPUT_DISPATCHER_BATCH_SIZE = 256;
+
+class InputDispatcher {
+  public:
+    InputDispatcher(Input &input, Console &console);
+
+    ///-------------------------------------------------------------------------
+    /// Register an action with the input system, along with "+name" and
+    /// "-name" console commands pressing and releasing it.
+    ///
+    /// \returns Index of the action, or < 0 if no more actions can be
+    /// registered.
+    ///-------------------------------------------------------------------------
+    int registerAction(const std::string &name);
+
+    ///-------------------------------------------------------------------------
+    /// Start a new frame and handle every event queued by \p platform. Call
+    /// once a frame, before polling actions.
+    ///
+    /// \returns Number of events handled.
+    ///-------------------------------------------------------------------------
+    size_t dispatch(Platform &platform);
+
+    ///-------------------------------------------------------------------------
+    /// Handle events in order, as part of the current frame.
+    ///-------------------------------------------------------------------------
+    void dispatch(const PlatformEvent *events, size_t numEvents);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Relative mouse movement along x this frame.
+    ///-------------------------------------------------------------------------
+    int getMouseDeltaX() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Relative mouse movement along y this frame.
+    ///-------------------------------------------------------------------------
+    int getMouseDeltaY() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Text input this frame.
+    ///-------------------------------------------------------------------------
+    const std::string &getTextInput() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns True once a quit event has been handled.
+    ///-------------------------------------------------------------------------
+    bool wasQuitRequested() const;
+
+  private:
+    Input &input;
+    Console &console;
+
+    std::vector<PlatformEvent> batch;
+    int mouseDeltaX;
+    int mouseDeltaY;
+    std::string textInput;
+    bool quitRequested;
+};
+}
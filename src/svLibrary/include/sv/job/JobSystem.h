@@ -0,0 +1,311 @@
+//===-- sv/job/JobSystem.h - Work-stealing job scheduler --------*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Runs small jobs on a pool of worker threads, for subsystems with
+/// work that can be done in parallel (resource loading, packet processing,
+/// script work).
+///
+/// A job is a function and a pointer to its data. The thread that initializes
+/// the job system is thread 0, and each worker thread has its own job deque.
+/// A thread pushes the jobs it runs on its own deque and pops from the same
+/// end, so the jobs it just made (whose data is likely still in its cache)
+/// run first. A thread with an empty deque steals the oldest job of another
+/// thread's deque instead. Threads that aren't part of the job system can
+/// still run jobs, which go in a shared queue any worker takes from.
+///
+/// Jobs are tracked with counters: each job run with a counter adds one to it
+/// and takes one away once it has finished. A job that depends on others
+/// waits on their counter (see 'wait'), and the waiting thread runs other
+/// jobs rather than blocking, so waiting inside a job is fine.
+///
+/// Jobs that must run on thread 0 (e.g. those touching the platform or the
+/// console) can be queued from any thread with 'runOnMainThread'; thread 0
+/// runs them in 'executeMainThreadJobs', once a frame, or while it waits.
+///
+/// Typical usage:
+///     JobSystem jobs;
+///     jobs.initialize();
+///     JobCounter counter;
+///     parallelFor(jobs, particles.size(), 256,
+///                 [&](size_t begin, size_t end) { update(begin, end); });
+///     jobs.run(Job(&loadTexture, &request), &counter);
+///     jobs.wait(counter);
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sv {
+/// Jobs each thread's deque holds, further jobs go in the shared queue
+const size_t JOB_DEQUE_CAPACITY = 4096;
+
+/// Bytes kept between data written by different threads
+const size_t JOB_CACHE_LINE_SIZE = 64;
+
+/// Times an idle worker looks for a job before it sleeps
+const int JOB_IDLE_SPINS = 64;
+
+typedef void (*JobFunction)(void *data);
+
+/// A function to run, and the data it is run with
+struct Job {
+    Job() : function(nullptr), data(nullptr) {}
+    Job(JobFunction function_, void *data_)
+        : function(function_), data(data_) {}
+
+    JobFunction function;
+    void *data;
+};
+
+/// Number of unfinished jobs run with the counter
+class JobCounter {
+  public:
+    JobCounter() : value(0) {}
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of jobs run with the counter that haven't finished.
+    ///-------------------------------------------------------------------------
+    int get() const { return value.load(std::memory_order_acquire); }
+
+    ///-------------------------------------------------------------------------
+    /// \returns True once every job run with the counter has finished.
+    ///-------------------------------------------------------------------------
+    bool isDone() const { return get() == 0; }
+
+  private:
+    friend class JobSystem;
+
+    std::atomic<int> value;
+
+    JobCounter(const JobCounter &) = delete;
+    JobCounter &operator=(const JobCounter &) = delete;
+};
+
+/// A job in a deque, with the counter it finishes
+struct QueuedJob {
+    QueuedJob() : counter(nullptr) {}
+
+    Job job;
+    JobCounter *counter;
+};
+
+/// Fixed size work-stealing deque (Chase and Lev). Only the thread that owns
+/// the deque pushes and pops, at the bottom; any thread steals from the top.
+class JobDeque {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \param   capacity   Most jobs in the deque, a power of two.
+    ///-------------------------------------------------------------------------
+    explicit JobDeque(size_t capacity = JOB_DEQUE_CAPACITY);
+
+    ///-------------------------------------------------------------------------
+    /// Push a job at the bottom. Owner only.
+    ///
+    /// \returns False if the deque is full.
+    ///-------------------------------------------------------------------------
+    bool push(const QueuedJob &job);
+
+    ///-------------------------------------------------------------------------
+    /// Take the newest job, from the bottom. Owner only.
+    ///
+    /// \returns False if the deque is empty.
+    ///-------------------------------------------------------------------------
+    bool pop(QueuedJob *job);
+
+    ///-------------------------------------------------------------------------
+    /// Take the oldest job, from the top. Any thread.
+    ///
+    /// \returns False if the deque is empty, or another thread took the job
+    /// first.
+    ///-------------------------------------------------------------------------
+    bool steal(QueuedJob *job);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of jobs in the deque, which may already have changed.
+    ///-------------------------------------------------------------------------
+    size_t getSize() const;
+
+  private:
+    // Fields are atomic so a thief may read a slot the owner is writing, its
+    // steal fails if it did
+    struct Slot {
+        std::atomic<JobFunction> function;
+        std::atomic<void *> data;
+        std::atomic<JobCounter *> counter;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    int64_t mask;
+    // Padded onto their own cache lines, top is written by thieves and
+    // bottom by the owner
+    char topPadding[JOB_CACHE_LINE_SIZE];
+    std::atomic<int64_t> top;
+    char bottomPadding[JOB_CACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+    std::atomic<int64_t> bottom;
+    char endPadding[JOB_CACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+};
+
+class JobSystem {
+  public:
+    JobSystem();
+    ~JobSystem();
+
+    ///-------------------------------------------------------------------------
+    /// Start the worker threads. The calling thread becomes thread 0.
+    ///
+    /// \param   numWorkerThreads   Threads to start, < 0 for one fewer than
+    /// the number of hardware threads. With 0, jobs run on thread 0 while it
+    /// waits.
+    ///
+    /// \returns False if already initialized.
+    ///-------------------------------------------------------------------------
+    bool initialize(int numWorkerThreads = -1);
+
+    ///-------------------------------------------------------------------------
+    /// Stop and join the worker threads. Jobs not yet started are not run,
+    /// wait on their counters first.
+    ///-------------------------------------------------------------------------
+    void shutdown();
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of threads running jobs, including thread 0.
+    ///-------------------------------------------------------------------------
+    int getNumThreads() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Index of the calling thread in the job system, < 0 if it isn't
+    /// one of its threads.
+    ///-------------------------------------------------------------------------
+    int getThreadIndex() const;
+
+    ///-------------------------------------------------------------------------
+    /// Run \p job on any thread, adding one to \p counter (if not nullptr)
+    /// until it has finished. May be called from any thread. Before
+    /// 'initialize', jobs run at once on the calling thread.
+    ///-------------------------------------------------------------------------
+    void run(const Job &job, JobCounter *counter);
+
+    ///-------------------------------------------------------------------------
+    /// Run \p numJobs jobs on any threads, adding \p numJobs to \p counter
+    /// (if not nullptr) and taking one away as each finishes.
+    ///-------------------------------------------------------------------------
+    void run(const Job *jobs, size_t numJobs, JobCounter *counter);
+
+    ///-------------------------------------------------------------------------
+    /// Run jobs until every job run with \p counter has finished. Thread 0
+    /// also runs main thread jobs while it waits.
+    ///-------------------------------------------------------------------------
+    void wait(const JobCounter &counter);
+
+    ///-------------------------------------------------------------------------
+    /// Queue \p job to run on thread 0 (see 'executeMainThreadJobs'), adding
+    /// one to \p counter (if not nullptr) until it has finished. May be
+    /// called from any thread.
+    ///-------------------------------------------------------------------------
+    void runOnMainThread(const Job &job, JobCounter *counter);
+
+    ///-------------------------------------------------------------------------
+    /// Run the jobs queued for thread 0, in the order they were queued,
+    /// including those they queue. Thread 0 only, call once a frame.
+    ///
+    /// \returns Number of jobs run.
+    ///-------------------------------------------------------------------------
+    size_t executeMainThreadJobs();
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of jobs taken from another thread's deque.
+    ///-------------------------------------------------------------------------
+    uint64_t getNumStolenJobs() const;
+
+  private:
+    // Take a job for thread \p index (< 0 if not a job system thread), from
+    // its own deque, another's or the shared queue, and run it
+    bool runNextJob(int index);
+    bool stealJob(int index, QueuedJob *job);
+    void execute(const QueuedJob &job);
+    void workerMain(int index);
+
+    bool initialized;
+    std::vector<std::unique_ptr<JobDeque>> deques;
+    std::vector<std::thread> workers;
+
+    // Jobs run from threads outside the job system, and jobs that didn't fit
+    // in a full deque
+    std::mutex sharedMutex;
+    std::deque<QueuedJob> sharedJobs;
+    std::atomic<size_t> numSharedJobs;
+
+    std::mutex mainThreadMutex;
+    std::vector<QueuedJob> mainThreadJobs;
+
+    // Queued jobs not yet taken, idle workers sleep while there are none
+    std::atomic<int64_t> numQueuedJobs;
+    std::atomic<int> numSleepingWorkers;
+    std::atomic<bool> running;
+    std::mutex sleepMutex;
+    std::condition_variable wakeCondition;
+
+    std::atomic<uint64_t> numStolenJobs;
+};
+
+namespace detail {
+template <typename Function> struct ParallelForRange {
+    Function *function;
+    size_t begin;
+    size_t end;
+};
+
+template <typename Function> void runParallelForRange(void *data) {
+    ParallelForRange<Function> *range = (ParallelForRange<Function> *)data;
+    (*range->function)(range->begin, range->end);
+}
+}
+
+///-----------------------------------------------------------------------------
+/// Call \p function(begin, end) for ranges of at most \p grainSize of the
+/// indices [0, \p count) in parallel, returning once all have finished.
+///-----------------------------------------------------------------------------
+template <typename Function>
+void parallelFor(JobSystem &jobSystem, size_t count, size_t grainSize,
+                 Function function) {
+    if (grainSize == 0) {
+        grainSize = 1;
+    }
+    const size_t numRanges = (count + grainSize - 1) / grainSize;
+    if (numRanges <= 1 || jobSystem.getNumThreads() <= 1) {
+        if (count > 0) {
+            function((size_t)0, count);
+        }
+        return;
+    }
+
+    std::vector<detail::ParallelForRange<Function>> ranges(numRanges);
+    std::vector<Job> jobs(numRanges);
+    for (size_t i = 0; i < numRanges; ++i) {
+        ranges[i].function = &function;
+        ranges[i].begin    = i * grainSize;
+        ranges[i].end      = std::min(count, ranges[i].begin + grainSize);
+        jobs[i] = Job(&detail::runParallelForRange<Function>, &ranges[i]);
+    }
+
+    JobCounter counter;
+    jobSystem.run(jobs.data(), numRanges, &counter);
+    jobSystem.wait(counter);
+}
+}
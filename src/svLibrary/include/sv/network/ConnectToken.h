@@ -0,0 +1,94 @@
+//===-- sv/network/ConnectToken.h - Connection authorization ----*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Tokens that allow a client to connect to a secure server.
+///
+/// A trusted backend (e.g. a matchmaker the client has logged in to over
+/// HTTPS) shares a private key with the game servers. When a client should be
+/// allowed to play, the backend generates a connect token and hands it to the
+/// client. The token holds:
+///   - A private part, encrypted with the private key, that only the servers
+///     can read: the client id and a fresh pair of session keys.
+///   - The same session keys in the clear, for the client.
+///   - When the token expires.
+///
+/// The client presents the private part to the server to connect (see
+/// Connection::connect), after which the session keys encrypt and
+/// authenticate all traffic in both directions. Someone who only guessed the
+/// protocol id, or who copies packets off the wire, can't connect or take
+/// over a connection.
+///
+/// Based off the netcode.io standard by Glenn Fiedler
+/// https://github.com/networkprotocol/netcode/blob/master/STANDARD.md
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <sv/network/Crypto.h>
+
+namespace sv {
+namespace net {
+/// Size of the encrypted part of a connect token: client id and session keys
+/// followed by the authentication tag.
+const size_t CONNECT_TOKEN_PRIVATE_SIZE =
+    8 + CRYPTO_KEY_SIZE * 2 + CRYPTO_TAG_SIZE;
+
+/// Permission for one client to connect
+struct ConnectToken {
+    /// Seconds since the UNIX epoch after which the token is refused.
+    uint64_t expireTimestamp;
+    uint8_t nonce[CRYPTO_NONCE_SIZE];
+    /// Encrypted with the servers' private key.
+    uint8_t privateData[CONNECT_TOKEN_PRIVATE_SIZE];
+    /// Session key for packets from the client to the server.
+    uint8_t clientToServerKey[CRYPTO_KEY_SIZE];
+    /// Session key for packets from the server to the client.
+    uint8_t serverToClientKey[CRYPTO_KEY_SIZE];
+};
+
+/// What a server learns from the private part of a connect token
+struct ConnectTokenPrivate {
+    uint64_t clientId;
+    uint8_t clientToServerKey[CRYPTO_KEY_SIZE];
+    uint8_t serverToClientKey[CRYPTO_KEY_SIZE];
+};
+
+///-----------------------------------------------------------------------------
+/// Generate a connect token with new session keys.
+///
+/// \param   privateKey   Key shared by the backend and the servers,
+/// CRYPTO_KEY_SIZE bytes.
+/// \param   protocolId   Protocol id of the connections the token is for.
+/// \param   expireTimestamp   Seconds since the UNIX epoch after which the
+/// token can't be used.
+///-----------------------------------------------------------------------------
+void generateConnectToken(const uint8_t *privateKey, uint32_t protocolId,
+                          uint64_t clientId, uint64_t expireTimestamp,
+                          ConnectToken *token);
+
+///-----------------------------------------------------------------------------
+/// Decrypt the private part of a connect token.
+///
+/// \returns False if the data wasn't encrypted with \p privateKey for this
+/// protocol id and expiry time, or was tampered with.
+///-----------------------------------------------------------------------------
+bool readConnectToken(const uint8_t *privateKey, uint32_t protocolId,
+                      uint64_t expireTimestamp, const uint8_t *nonce,
+                      const uint8_t *privateData, ConnectTokenPrivate *result);
+
+///-----------------------------------------------------------------------------
+/// \returns Current time in seconds since the UNIX epoch, as used for token
+/// expiry.
+///-----------------------------------------------------------------------------
+uint64_t getTokenTimestamp();
+}
+}
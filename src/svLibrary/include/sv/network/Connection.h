@@ -27,6 +27,45 @@
 /// We define disconnection as not receiving packets from the other end of the
 /// connection for 'timeout' seconds.
 ///
+/// Packets are never sent larger than the maximum packet size (see
+/// 'setMaxPacketSize'), which should be below the path MTU. Larger payloads
+/// are split into fragments and reassembled by the receiver before being
+/// returned from 'receivePacket'. If fragments are lost, the receiver asks for
+/// only the missing fragments to be resent (see sv/network/Fragments.h).
+///
+/// Outgoing traffic can be limited to a bandwidth budget (see 'setBandwidth').
+/// Payloads that can't be sent right away are queued by priority and sent
+/// from 'update' as the budget allows, at a reduced rate while round trip time
+/// or packet loss show the link is congested (see sv/network/SendScheduler.h).
+///
+/// Every packet carries a sequence number and acks for the packets received
+/// from the other end, used to measure round trip time, packet loss and
+/// bandwidth (see 'getStatistics' and sv/network/ConnectionStats.h).
+///
+/// A server given a private key (see 'setPrivateKey') only accepts clients
+/// that connect with a connect token (see sv/network/ConnectToken.h):
+///   1. The client sends connection requests holding the encrypted part of
+///      its token and a random client nonce, padded so the server's reply is
+///      never larger.
+///   2. The server checks the token and replies with a random server nonce
+///      and a challenge token, which only it can read and which holds the
+///      client's address and both nonces. It keeps no state for the client
+///      yet, so spoofed requests cost it nothing and can't be used to flood
+///      someone else with larger replies.
+///   3. The client echoes the first challenge it receives back, proving it
+///      receives packets at its address. The server then accepts it, unless
+///      it has already accepted that challenge or a later one, and sends a
+///      keep alive.
+/// From then on every packet in both directions is encrypted and
+/// authenticated with ChaCha20-Poly1305, adding CONNECTION_SECURE_OVERHEAD
+/// bytes per packet. Each session's keys are derived from the token's keys
+/// and both nonces (see 'deriveKey'), so sessions made with the same token,
+/// whether retried or replayed, never reuse a key and nonce. Packets that fail
+/// to decrypt, or are replays of packets already received, are dropped.
+///
+/// Traffic can be recorded with 'setCapture' and played back later into a
+/// connection started with 'startReplay' (see sv/network/PacketCapture.h).
+///
 /// Typical usage:
 ///     int16_t clientPort = 30001;
 ///     int16_t serverPort = 30000;
@@ -40,23 +79,68 @@
 ///     client.connect(Address(127, 0, 0, 1, serverPort));
 ///     server.listen();
 ///
+///     TimePoint last = Clock::now();
 ///     ...
 ///     client.sendPacket(...);
 ///     server.receivePacket(...);
 ///
+///     TimePoint now   = Clock::now();
+///     float deltaTime = (float)nanosecondsToSeconds(now - last);
+///     last            = now;
 ///     client.update(deltaTime);
 ///     server.update(deltaTime);
 ///
+/// Timeouts and other timers only advance by the time passed to 'update', so
+/// replays and simulated time work the same as real time. Measure real time
+/// on the monotonic clock (see sv/Clock.h).
+///
 /// Based off the code provided by Glenn Fiedler
 /// http://gafferongames.com/networking-for-game-programmers/virtual-connection-over-udp/
 ///
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <vector>
+
+#include <sv/network/ConnectToken.h>
+#include <sv/network/ConnectionStats.h>
+#include <sv/network/Crypto.h>
+#include <sv/network/Fragments.h>
+#include <sv/network/SendScheduler.h>
 #include <sv/network/Sockets.h>
 
 namespace sv {
 namespace net {
+/// Default maximum size of a packet sent by a connection, in bytes. Chosen to
+/// fit comfortably below the MTU of most paths.
+const size_t CONNECTION_DEFAULT_MAX_PACKET_SIZE = 1200;
+
+/// Largest maximum packet size a connection can be configured with, the
+/// largest UDP payload over IPv4.
+const size_t CONNECTION_MAX_PACKET_SIZE = 65507;
+
+/// Smallest maximum packet size a connection can be configured with.
+const size_t CONNECTION_MIN_PACKET_SIZE = 64;
+
+/// Extra bytes in each packet of a secure connection: the encryption sequence
+/// number and the authentication tag.
+const size_t CONNECTION_SECURE_OVERHEAD = 4 + CRYPTO_TAG_SIZE;
+
+/// Size of a connection request, padded so no handshake reply is larger.
+const size_t CONNECTION_REQUEST_SIZE = 256;
+
+/// Size of the challenge token a server sends in reply to a request: sequence
+/// number, client id, expiry, client address, token keys, client and server
+/// nonces and tag.
+const size_t CONNECTION_CHALLENGE_TOKEN_SIZE =
+    8 + 8 + 8 + 19 + CRYPTO_KEY_SIZE * 2 + CRYPTO_NONCE_SIZE * 2 +
+    CRYPTO_TAG_SIZE;
+
+/// Seconds between handshake packets while connecting securely.
+const float CONNECTION_HANDSHAKE_SEND_INTERVAL = 0.1f;
+
+class WriteStream;
+
 namespace ConnectionMode {
 enum Enum { None, Client, Server };
 }
@@ -78,8 +162,15 @@ class Connection {
     /// considering the connection terminated (in seconds).
     ///-------------------------------------------------------------------------
     Connection(uint32_t protocolId_, float timeout_)
-        : protocolId(protocolId_), timeout(timeout_),
-          mode(ConnectionMode::Enum::None), isRunning(false) {
+        : protocolId(protocolId_), timeout(timeout_), isRunning(false),
+          isReplaying(false), mode(ConnectionMode::Enum::None),
+          maxPacketSize(CONNECTION_DEFAULT_MAX_PACKET_SIZE),
+          sendBuffer(CONNECTION_DEFAULT_MAX_PACKET_SIZE),
+          receiveBuffer(CONNECTION_MAX_PACKET_SIZE), statsLogInterval(0.0f),
+          hasPrivateKey(false), challengeSequence(0),
+          hasAcceptedChallenge(false), lastAcceptedChallenge(0),
+          hasConnectToken(false),
+          decryptBuffer(CONNECTION_MAX_PACKET_SIZE) {
         clearData();
     }
 
@@ -93,6 +184,12 @@ class Connection {
     ///-------------------------------------------------------------------------
     bool start(int16_t port);
 
+    ///-------------------------------------------------------------------------
+    /// Run the connection without a socket, to play back a capture. Packets
+    /// are given to it with 'injectPacket' and anything it sends is dropped.
+    ///-------------------------------------------------------------------------
+    bool startReplay();
+
     ///-------------------------------------------------------------------------
     /// Close the connection.
     ///-------------------------------------------------------------------------
@@ -108,6 +205,30 @@ class Connection {
     ///-------------------------------------------------------------------------
     void connect(const Address &serverAddress);
 
+    ///-------------------------------------------------------------------------
+    /// Connect to a secure server with a connect token. No payloads can be
+    /// sent until the connection is established, and the connection is only
+    /// secure once the server's challenge has arrived.
+    ///-------------------------------------------------------------------------
+    void connect(const Address &serverAddress, const ConnectToken &token);
+
+    ///-------------------------------------------------------------------------
+    /// Only accept clients with a connect token generated with \p key
+    /// (CRYPTO_KEY_SIZE bytes), or nullptr to accept anyone (the default).
+    ///-------------------------------------------------------------------------
+    void setPrivateKey(const uint8_t *key);
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if packets are encrypted and authenticated.
+    ///-------------------------------------------------------------------------
+    bool isSecure() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Id of the client from its connect token, 0 if not connected
+    /// securely.
+    ///-------------------------------------------------------------------------
+    uint64_t getClientId() const;
+
     ///-------------------------------------------------------------------------
     /// \returns If this connection is currently acting as a client, a server or
     /// neither.
@@ -126,35 +247,211 @@ class Connection {
     ///-------------------------------------------------------------------------
     void update(float deltaTime);
 
+    ///-------------------------------------------------------------------------
+    /// Pass packets sent by this connection through a network simulator, or
+    /// nullptr to send them directly. See 'Socket::setSimulator'.
+    ///-------------------------------------------------------------------------
+    void setSimulator(NetworkSimulator *simulator);
+
+    ///-------------------------------------------------------------------------
+    /// Record the packets this connection sends and receives in a capture,
+    /// or nullptr to stop. See 'Socket::setCapture'.
+    ///-------------------------------------------------------------------------
+    void setCapture(PacketCapture *capture);
+
+    ///-------------------------------------------------------------------------
+    /// Set the maximum size of the packets sent by this connection, including
+    /// headers. Payloads that don't fit in one packet are sent as fragments.
+    ///
+    /// NOTE: Size is clamped to [CONNECTION_MIN_PACKET_SIZE,
+    /// CONNECTION_MAX_PACKET_SIZE].
+    ///-------------------------------------------------------------------------
+    void setMaxPacketSize(size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Maximum size of the packets sent by this connection.
+    ///-------------------------------------------------------------------------
+    size_t getMaxPacketSize() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Largest payload that can be given to 'sendPacket'.
+    ///-------------------------------------------------------------------------
+    size_t getMaxPayloadSize() const;
+
+    ///-------------------------------------------------------------------------
+    /// Limit the bytes per second sent by this connection, 0 for unlimited
+    /// (the default).
+    ///-------------------------------------------------------------------------
+    void setBandwidth(uint32_t bytesPerSecond);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Bandwidth budget in bytes per second, 0 if unlimited.
+    ///-------------------------------------------------------------------------
+    uint32_t getBandwidth() const;
+
+    ///-------------------------------------------------------------------------
+    /// Set the most payload bytes that can be queued waiting for bandwidth.
+    ///-------------------------------------------------------------------------
+    void setMaxQueueSize(size_t bytes);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Whether the link is currently considered congested.
+    ///-------------------------------------------------------------------------
+    CongestionMode::Enum getCongestionMode() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Round trip time, packet loss, bandwidth and packet counters of
+    /// the current connection. Reset whenever the connection is (re)started.
+    ///-------------------------------------------------------------------------
+    ConnectionStatistics getStatistics() const;
+
+    ///-------------------------------------------------------------------------
+    /// Write statistics to the network log every \p interval seconds while
+    /// connected, 0 to disable (the default).
+    ///-------------------------------------------------------------------------
+    void setStatsLogInterval(float interval);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Seconds between statistics written to the log, 0 if disabled.
+    ///-------------------------------------------------------------------------
+    float getStatsLogInterval() const;
+
     ///-------------------------------------------------------------------------
     /// Send a packet over the connnection.
     ///
     /// NOTE: Protocol id is prepended to the packet automatically.
     ///
-    /// \returns True if packet sent successfully, false otherwise.
+    /// Payloads larger than fit in one packet are split into fragments.
+    ///
+    /// If the bandwidth budget is used up, or payloads of the same or higher
+    /// priority are already waiting, the payload is queued and sent later.
+    ///
+    /// \returns True if packet sent or queued successfully, false otherwise.
     ///-------------------------------------------------------------------------
-    bool sendPacket(const void *data, size_t dataSize);
+    bool sendPacket(const void *data, size_t dataSize,
+                    SendPriority::Enum priority = SendPriority::Enum::Normal);
 
     ///-------------------------------------------------------------------------
     /// Receive a packet over the connection.
     ///
+    /// Fragments are collected until the payload they belong to is complete,
+    /// then the whole payload is returned. Payloads larger than \p bufferSize
+    /// are discarded.
+    ///
     /// \returns Number of bytes read (excludes protocol id).
     ///-------------------------------------------------------------------------
     size_t receivePacket(void *buffer, size_t bufferSize);
 
+    ///-------------------------------------------------------------------------
+    /// Handle a packet that didn't come from the connection's socket, e.g.
+    /// one played back from a capture, exactly as 'receivePacket' would.
+    ///
+    /// \returns Number of bytes of payload copied into \p buffer, 0 if the
+    /// packet didn't complete a payload.
+    ///-------------------------------------------------------------------------
+    size_t injectPacket(const Address &sender, const uint8_t *packet,
+                        size_t packetSize, void *buffer, size_t bufferSize);
+
   private:
     // Convenience method to clear some internal state
     void clearData();
 
+    // Size of the payload carried by each fragment
+    uint16_t getFragmentSize() const;
+
+    // Bytes of every packet not available for the payload
+    size_t getPacketOverhead() const;
+
+    // \returns True if payloads can be sent to the other end
+    bool canSendPayloads() const;
+
+    // Send connection requests and responses while connecting securely
+    void updateHandshake(float deltaTime);
+
+    // Handle connection request, challenge and response packets
+    void processHandshake(const Address &sender, uint8_t packetType,
+                          const uint8_t *body, size_t bodySize);
+
+    // Send a handshake packet, which isn't encrypted with the session keys
+    void sendHandshake(uint8_t packetType, const uint8_t *body,
+                       size_t bodySize, size_t paddedSize);
+
+    // Use the given session keys from now on
+    void startSession(const uint8_t *sendKey_, const uint8_t *receiveKey_);
+
+    // Send an empty packet to let the other end know we're here
+    bool sendKeepAlive();
+
+    // Send a payload now, as one packet or as fragments
+    bool sendPayload(const void *data, size_t dataSize);
+
+    // Write protocol id, packet type, sequence number and acks
+    void writeHeader(WriteStream &stream, uint8_t packetType) const;
+
+    // Send the first \p size bytes of the send buffer as the next packet
+    bool sendBuffered(size_t size);
+
+    // Send one fragment of a message in the fragment send buffer
+    bool sendFragment(uint16_t messageId, uint8_t index);
+
+    // Ask the other end to resend missing fragments
+    bool sendNack(const FragmentNack &nack);
+
+    // Handle a packet received from the socket.
+    //
+    // \returns Number of bytes of payload copied into buffer.
+    size_t processPacket(const Address &sender, const uint8_t *packet,
+                         size_t packetSize, void *buffer, size_t bufferSize);
+
     uint32_t protocolId;
     float timeout;
 
     bool isRunning;
+    bool isReplaying;
     ConnectionMode::Enum mode;
     ConnectionState::Enum state;
     Socket socket;
     float timeoutAccumulator;
     Address address;
+
+    size_t maxPacketSize;
+    std::vector<uint8_t> sendBuffer;
+    std::vector<uint8_t> receiveBuffer;
+
+    FragmentReassembly reassembly;
+    FragmentSendBuffer sentMessages;
+    std::vector<FragmentNack> nacks;
+    std::vector<uint8_t> message;
+
+    SendScheduler scheduler;
+    std::vector<uint8_t> queuedPayload;
+
+    ConnectionStats stats;
+    float statsLogInterval;
+    float statsLogAccumulator;
+
+    bool hasPrivateKey;
+    uint8_t privateKey[CRYPTO_KEY_SIZE];
+    uint8_t challengeKey[CRYPTO_KEY_SIZE];
+    uint64_t challengeSequence;
+    // Challenges are accepted once, and only if later than the last accepted
+    bool hasAcceptedChallenge;
+    uint64_t lastAcceptedChallenge;
+
+    bool hasConnectToken;
+    ConnectToken connectToken;
+    uint8_t clientNonce[CRYPTO_NONCE_SIZE];
+    bool hasChallenge;
+    uint8_t challengeToken[CONNECTION_CHALLENGE_TOKEN_SIZE];
+    float handshakeAccumulator;
+
+    bool secure;
+    uint64_t clientId;
+    uint8_t sendKey[CRYPTO_KEY_SIZE];
+    uint8_t receiveKey[CRYPTO_KEY_SIZE];
+    uint32_t sendSequence;
+    ReplayProtection replayProtection;
+    std::vector<uint8_t> decryptBuffer;
 };
 }
 }
@@ -0,0 +1,205 @@
+//===-- sv/network/ConnectionStats.h - Connection statistics ----*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Measure round trip time, packet loss and bandwidth of a connection.
+///
+/// Every packet sent carries a sequence number, along with the most recent
+/// sequence number received from the other end and a bitfield of which of the
+/// packets before it were also received (acks). When an ack for a packet
+/// arrives, the time since it was sent is a round trip time sample. A packet
+/// that isn't acked within 'CONNECTION_STATS_ACK_TIMEOUT' seconds is counted
+/// as lost.
+///
+/// Round trip time and its variation (jitter) are smoothed the way TCP
+/// smooths its RTT estimate (RFC 6298). Packet loss is the fraction of the
+/// last 'CONNECTION_STATS_HISTORY_SIZE' packets sent that were lost.
+/// Bandwidth is averaged over a sliding window.
+///
+/// Acks are only used for measurement, nothing is resent because of them.
+///
+/// Based off the reliability article by Glenn Fiedler
+/// http://gafferongames.com/networking-for-game-programmers/reliability-and-flow-control/
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sv {
+namespace net {
+/// Number of sent and received packets remembered.
+const size_t CONNECTION_STATS_HISTORY_SIZE = 256;
+
+/// Seconds to wait for a packet to be acked before counting it as lost.
+const float CONNECTION_STATS_ACK_TIMEOUT = 1.0f;
+
+/// Number of buckets the bandwidth window is split into.
+const size_t CONNECTION_STATS_BANDWIDTH_BUCKETS = 10;
+
+///-----------------------------------------------------------------------------
+/// \returns True if sequence number \p a is more recent than \p b, taking
+/// wrap around into account.
+///-----------------------------------------------------------------------------
+inline bool isSequenceMoreRecent(uint16_t a, uint16_t b) {
+    return (a > b && a - b <= 32768) || (a < b && b - a > 32768);
+}
+
+/// Snapshot of the statistics of a connection
+struct ConnectionStatistics {
+    ConnectionStatistics()
+        : rtt(0.0f), rttJitter(0.0f), packetLoss(0.0f), sentBandwidth(0.0f),
+          receivedBandwidth(0.0f), packetsSent(0), packetsReceived(0),
+          packetsAcked(0), packetsLost(0), bytesSent(0), bytesReceived(0),
+          pendingMessages(0), queuedMessages(0), queuedBytes(0) {}
+
+    /// Smoothed round trip time in seconds.
+    float rtt;
+    /// Smoothed mean deviation of the round trip time in seconds.
+    float rttJitter;
+    /// Fraction of recently sent packets that were lost (0 to 1).
+    float packetLoss;
+    /// Bytes per second sent, averaged over the bandwidth window.
+    float sentBandwidth;
+    /// Bytes per second received, averaged over the bandwidth window.
+    float receivedBandwidth;
+
+    uint64_t packetsSent;
+    uint64_t packetsReceived;
+    uint64_t packetsAcked;
+    uint64_t packetsLost;
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+
+    /// Number of fragmented messages waiting for more fragments.
+    size_t pendingMessages;
+    /// Number of messages waiting for bandwidth to be sent.
+    size_t queuedMessages;
+    /// Number of bytes waiting for bandwidth to be sent.
+    size_t queuedBytes;
+};
+
+///-----------------------------------------------------------------------------
+/// \returns Statistics as a single human readable line.
+///-----------------------------------------------------------------------------
+std::string formatStatistics(const ConnectionStatistics &stats);
+
+/// Tracks the packets sent and received by a connection
+class ConnectionStats {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \param   bandwidthWindow   Seconds bandwidth is averaged over.
+    ///-------------------------------------------------------------------------
+    ConnectionStats(float bandwidthWindow_ = 1.0f);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Sequence number the next packet sent should carry.
+    ///-------------------------------------------------------------------------
+    uint16_t getLocalSequence() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Most recent sequence number received.
+    ///-------------------------------------------------------------------------
+    uint16_t getAck() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Bitfield of received packets, bit n is set if packet
+    /// 'getAck() - n' was received. Zero if nothing has been received.
+    ///-------------------------------------------------------------------------
+    uint32_t getAckBits() const;
+
+    ///-------------------------------------------------------------------------
+    /// Record that the packet with sequence 'getLocalSequence()' was sent and
+    /// move on to the next sequence number.
+    ///
+    /// \param   size   Size of the packet in bytes.
+    ///-------------------------------------------------------------------------
+    void packetSent(size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// Record that a packet was received.
+    ///
+    /// \param   sequence   Sequence number the packet carried.
+    /// \param   size   Size of the packet in bytes.
+    ///-------------------------------------------------------------------------
+    void packetReceived(uint16_t sequence, size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// Process acks carried by a received packet.
+    ///-------------------------------------------------------------------------
+    void processAcks(uint16_t ack, uint32_t ackBits);
+
+    ///-------------------------------------------------------------------------
+    /// Advance time, counting packets that weren't acked in time as lost.
+    ///
+    /// \param   deltaTime   Time since last update in seconds.
+    ///-------------------------------------------------------------------------
+    void update(float deltaTime);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Current statistics.
+    ///-------------------------------------------------------------------------
+    ConnectionStatistics getStatistics() const;
+
+    ///-------------------------------------------------------------------------
+    /// Forget all packets sent and received.
+    ///-------------------------------------------------------------------------
+    void reset();
+
+  private:
+    struct SentPacket {
+        SentPacket()
+            : valid(false), acked(false), lost(false), sequence(0),
+              time(0.0) {}
+
+        bool valid;
+        bool acked;
+        bool lost;
+        uint16_t sequence;
+        double time;
+    };
+
+    // Bytes per second over the bandwidth window
+    float getBandwidth(const uint64_t *buckets) const;
+
+    // Clear buckets the window has moved past
+    void advanceBuckets();
+
+    // \returns True if packet with the given sequence number was received.
+    bool wasReceived(uint16_t sequence) const;
+
+    float bandwidthWindow;
+    double time;
+
+    uint16_t localSequence;
+    uint16_t remoteSequence;
+    bool hasReceived;
+
+    SentPacket sent[CONNECTION_STATS_HISTORY_SIZE];
+    // Sequence number of each packet received, or -1 if slot is empty
+    int32_t received[CONNECTION_STATS_HISTORY_SIZE];
+
+    bool hasRttSample;
+    float rtt;
+    float rttJitter;
+
+    uint64_t currentBucket;
+    uint64_t sentBuckets[CONNECTION_STATS_BANDWIDTH_BUCKETS];
+    uint64_t receivedBuckets[CONNECTION_STATS_BANDWIDTH_BUCKETS];
+
+    uint64_t packetsSent;
+    uint64_t packetsReceived;
+    uint64_t packetsAcked;
+    uint64_t packetsLost;
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+};
+}
+}
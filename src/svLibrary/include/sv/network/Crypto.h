@@ -0,0 +1,176 @@
+//===-- sv/network/Crypto.h - Packet encryption -----------------*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief ChaCha20-Poly1305 authenticated encryption (RFC 8439).
+///
+/// Implemented here rather than pulled in from a library so the engine builds
+/// anywhere without extra dependencies. ChaCha20 and Poly1305 only need 32-bit
+/// additions, rotations and multiplies, so they are fast without special
+/// instructions and take the same time whatever the data (no table lookups or
+/// data dependent branches).
+///
+/// NOTE: Never encrypt two messages with the same key and nonce, doing so
+/// gives away the plaintext of both and lets an attacker forge messages.
+///
+/// Poly1305 based off poly1305-donna by Andrew Moon (public domain)
+/// https://github.com/floodyberry/poly1305-donna
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sv {
+namespace net {
+/// Size of a ChaCha20 (and AEAD) key in bytes.
+const size_t CRYPTO_KEY_SIZE = 32;
+
+/// Size of a ChaCha20 (and AEAD) nonce in bytes.
+const size_t CRYPTO_NONCE_SIZE = 12;
+
+/// Size of a Poly1305 (and AEAD) authentication tag in bytes.
+const size_t CRYPTO_TAG_SIZE = 16;
+
+/// Size of a ChaCha20 block in bytes.
+const size_t CHACHA20_BLOCK_SIZE = 64;
+
+/// Number of recent packet sequence numbers remembered to reject replays.
+const size_t REPLAY_PROTECTION_WINDOW = 256;
+
+///-----------------------------------------------------------------------------
+/// Compute one ChaCha20 block of key stream.
+///
+/// \param   key   CRYPTO_KEY_SIZE bytes.
+/// \param   nonce   CRYPTO_NONCE_SIZE bytes.
+/// \param   block [out]   CHACHA20_BLOCK_SIZE bytes.
+///-----------------------------------------------------------------------------
+void chacha20Block(const uint8_t *key, uint32_t counter, const uint8_t *nonce,
+                   uint8_t *block);
+
+///-----------------------------------------------------------------------------
+/// Encrypt or decrypt \p size bytes with ChaCha20, starting from block
+/// \p counter. \p input and \p output may be the same buffer.
+///-----------------------------------------------------------------------------
+void chacha20Xor(const uint8_t *key, uint32_t counter, const uint8_t *nonce,
+                 const uint8_t *input, uint8_t *output, size_t size);
+
+/// Incremental Poly1305 message authentication code
+class Poly1305 {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \param   key   One time key of 32 bytes, never use it for more than one
+    /// message.
+    ///-------------------------------------------------------------------------
+    explicit Poly1305(const uint8_t *key);
+
+    void update(const uint8_t *data, size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// \param   tag [out]   CRYPTO_TAG_SIZE bytes.
+    ///-------------------------------------------------------------------------
+    void finish(uint8_t *tag);
+
+  private:
+    // Process whole 16 byte blocks, \p final for the padded last block
+    void blocks(const uint8_t *data, size_t size, bool final);
+
+    uint32_t r[5];
+    uint32_t h[5];
+    uint32_t pad[4];
+    uint8_t buffer[16];
+    size_t buffered;
+};
+
+///-----------------------------------------------------------------------------
+/// Compute the Poly1305 tag of a message with a one time \p key.
+///-----------------------------------------------------------------------------
+void poly1305(const uint8_t *key, const uint8_t *data, size_t size,
+              uint8_t *tag);
+
+///-----------------------------------------------------------------------------
+/// Encrypt and authenticate a message with ChaCha20-Poly1305.
+///
+/// \param   aad   Additional data authenticated but not encrypted, may be
+/// nullptr if \p aadSize is 0.
+/// \param   ciphertext [out]   \p size bytes, may be the same as
+/// \p plaintext.
+/// \param   tag [out]   CRYPTO_TAG_SIZE bytes.
+///-----------------------------------------------------------------------------
+void aeadEncrypt(const uint8_t *key, const uint8_t *nonce, const uint8_t *aad,
+                 size_t aadSize, const uint8_t *plaintext, size_t size,
+                 uint8_t *ciphertext, uint8_t *tag);
+
+///-----------------------------------------------------------------------------
+/// Authenticate and decrypt a message encrypted with 'aeadEncrypt'.
+///
+/// \param   plaintext [out]   \p size bytes, may be the same as
+/// \p ciphertext. Left untouched if authentication fails.
+///
+/// \returns False if the message or additional data were tampered with, or
+/// the key or nonce are wrong.
+///-----------------------------------------------------------------------------
+bool aeadDecrypt(const uint8_t *key, const uint8_t *nonce, const uint8_t *aad,
+                 size_t aadSize, const uint8_t *ciphertext, size_t size,
+                 const uint8_t *tag, uint8_t *plaintext);
+
+///-----------------------------------------------------------------------------
+/// Compare two buffers in time that doesn't depend on their contents.
+///-----------------------------------------------------------------------------
+bool constantTimeEqual(const uint8_t *a, const uint8_t *b, size_t size);
+
+///-----------------------------------------------------------------------------
+/// Fill \p data with random bytes suitable for keys and tokens, from the
+/// operating system's random number generator (getrandom or /dev/urandom on
+/// POSIX systems). Aborts if the generator can't be read.
+///-----------------------------------------------------------------------------
+void randomBytes(void *data, size_t size);
+
+///-----------------------------------------------------------------------------
+/// Derive a key from a secret \p key and a public \p nonce, e.g. a fresh
+/// key for each session from a long lived one. The first CRYPTO_KEY_SIZE
+/// bytes of the ChaCha20 block of \p key and \p nonce.
+///
+/// \param   nonce   CRYPTO_NONCE_SIZE bytes.
+/// \param   derived [out]   CRYPTO_KEY_SIZE bytes, may be the same as \p key.
+///-----------------------------------------------------------------------------
+void deriveKey(const uint8_t *key, const uint8_t *nonce, uint8_t *derived);
+
+/// Rejects packets an attacker recorded and sent again
+///
+/// Every encrypted packet carries a sequence number (also its nonce) that only
+/// goes up. A packet is accepted once; packets too old to remember are
+/// rejected too.
+class ReplayProtection {
+  public:
+    ReplayProtection();
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if \p sequence was already received or is too old to
+    /// tell.
+    ///-------------------------------------------------------------------------
+    bool isReplay(uint64_t sequence) const;
+
+    ///-------------------------------------------------------------------------
+    /// Remember that \p sequence was received. Only call once the packet has
+    /// been authenticated.
+    ///-------------------------------------------------------------------------
+    void packetReceived(uint64_t sequence);
+
+    ///-------------------------------------------------------------------------
+    /// Forget everything received.
+    ///-------------------------------------------------------------------------
+    void reset();
+
+  private:
+    uint64_t mostRecent;
+    uint64_t received[REPLAY_PROTECTION_WINDOW];
+};
+}
+}
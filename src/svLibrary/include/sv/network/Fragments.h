@@ -0,0 +1,216 @@
+//===-- sv/network/Fragments.h - Message fragmentation ----------*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Split messages larger than a packet into fragments and reassemble
+/// them on the other end.
+///
+/// Sending a datagram larger than the path MTU leaves fragmentation up to IP,
+/// where losing any one IP fragment loses the whole datagram. Instead, large
+/// messages are split into fragments that each fit in one packet. Every
+/// fragment carries the id of the message it belongs to, its index and the
+/// number of fragments in the message.
+///
+/// The receiver collects fragments in a fixed-size pool of reassembly slots.
+/// If fragments of a message stop arriving before the message is complete,
+/// the receiver asks for only the missing fragments to be resent (a NACK),
+/// which the sender can do as long as the message is still in its send
+/// buffer. Messages that are still incomplete after a timeout are dropped.
+///
+/// Based off the packet fragmentation article by Glenn Fiedler
+/// http://gafferongames.com/building-a-game-network-protocol/packet-fragmentation-and-reassembly/
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sv {
+namespace net {
+/// Maximum number of fragments a message can be split into.
+const size_t FRAGMENT_MAX_FRAGMENTS = 255;
+
+/// Largest fragment a FragmentReassembly accepts unless told otherwise (see
+/// 'FragmentReassembly::setLimits'), a default sized packet.
+const uint16_t FRAGMENT_DEFAULT_MAX_FRAGMENT_SIZE = 1200;
+
+/// Largest message a FragmentReassembly accepts unless told otherwise.
+const size_t FRAGMENT_DEFAULT_MAX_MESSAGE_SIZE =
+    FRAGMENT_DEFAULT_MAX_FRAGMENT_SIZE * FRAGMENT_MAX_FRAGMENTS;
+
+/// Number of messages that can be reassembled at once.
+const size_t FRAGMENT_POOL_SIZE = 8;
+
+/// Number of recently sent messages kept around to resend fragments of.
+const size_t FRAGMENT_SEND_BUFFER_SIZE = 8;
+
+/// Number of completed message ids remembered, so late duplicate fragments
+/// don't start reassembling a message that has already been delivered.
+const size_t FRAGMENT_COMPLETED_HISTORY_SIZE = 32;
+
+/// Request to resend the missing fragments of a message.
+struct FragmentNack {
+    FragmentNack() : messageId(0), numFragments(0) {
+        for (size_t i = 0; i < sizeof(missing); ++i) {
+            missing[i] = 0;
+        }
+    }
+
+    uint16_t messageId;
+    uint8_t numFragments;
+    /// One bit per fragment, set if the fragment is missing.
+    uint8_t missing[(FRAGMENT_MAX_FRAGMENTS + 7) / 8];
+};
+
+///-----------------------------------------------------------------------------
+/// \returns True if the fragment with the given index is set in \p mask.
+///-----------------------------------------------------------------------------
+inline bool isFragmentBitSet(const uint8_t *mask, size_t index) {
+    return (mask[index / 8] & (1 << (index % 8))) != 0;
+}
+
+/// Pool of messages being reassembled from fragments.
+class FragmentReassembly {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \param   timeout     Seconds without receiving a fragment of a message
+    /// before it is dropped.
+    /// \param   nackDelay   Seconds without receiving a fragment of an
+    /// incomplete message before asking for the missing fragments.
+    ///-------------------------------------------------------------------------
+    FragmentReassembly(float timeout_ = 5.0f, float nackDelay_ = 0.1f);
+
+    ///-------------------------------------------------------------------------
+    /// Add a received fragment.
+    ///
+    /// If the pool is full, the least recently active message is dropped to
+    /// make room. Fragments larger than the largest fragment size, or of
+    /// messages that could be larger than the largest message size, are
+    /// rejected before any memory is set aside for them.
+    ///
+    /// \param   fragmentSize   Size of every fragment of the message except
+    /// the last, which may be smaller.
+    /// \param   messageOut [out]   Filled with the message if this fragment
+    /// completed it.
+    ///
+    /// \returns True if this fragment completed a message.
+    ///-------------------------------------------------------------------------
+    bool addFragment(uint16_t messageId, uint8_t index, uint8_t numFragments,
+                     uint16_t fragmentSize, const uint8_t *data, size_t size,
+                     std::vector<uint8_t> *messageOut);
+
+    ///-------------------------------------------------------------------------
+    /// Set the largest fragment and message accepted, e.g. the fragment size
+    /// and largest payload of the receiving connection.
+    ///-------------------------------------------------------------------------
+    void setLimits(uint16_t maxFragmentSize, size_t maxMessageSize);
+
+    ///-------------------------------------------------------------------------
+    /// Advance time, dropping messages that timed out and collecting NACKs for
+    /// messages that are missing fragments.
+    ///
+    /// \param   deltaTime   Time since last update in seconds.
+    /// \param   nacksOut [out]   NACKs to send are appended here.
+    ///-------------------------------------------------------------------------
+    void update(float deltaTime, std::vector<FragmentNack> *nacksOut);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of messages currently being reassembled.
+    ///-------------------------------------------------------------------------
+    size_t getNumPending() const;
+
+    ///-------------------------------------------------------------------------
+    /// Drop all messages being reassembled.
+    ///-------------------------------------------------------------------------
+    void clear();
+
+  private:
+    struct Slot {
+        Slot()
+            : active(false), messageId(0), numFragments(0), fragmentSize(0),
+              numReceived(0), messageSize(0), idleTime(0.0f),
+              nackTime(0.0f) {}
+
+        bool active;
+        uint16_t messageId;
+        uint8_t numFragments;
+        uint16_t fragmentSize;
+        uint8_t numReceived;
+        size_t messageSize;
+        float idleTime;
+        float nackTime;
+        uint8_t received[(FRAGMENT_MAX_FRAGMENTS + 7) / 8];
+        std::vector<uint8_t> buffer;
+    };
+
+    // \returns True if a message with the given id completed recently.
+    bool isCompleted(uint16_t messageId) const;
+
+    float timeout;
+    float nackDelay;
+    uint16_t maxFragmentSize;
+    size_t maxMessageSize;
+    Slot slots[FRAGMENT_POOL_SIZE];
+    uint16_t completed[FRAGMENT_COMPLETED_HISTORY_SIZE];
+    size_t numCompleted;
+};
+
+/// Recently sent fragmented messages, kept so missing fragments can be resent.
+class FragmentSendBuffer {
+  public:
+    FragmentSendBuffer() : nextMessageId(0) {}
+
+    ///-------------------------------------------------------------------------
+    /// Store a message about to be sent as fragments, replacing the oldest
+    /// message in the buffer.
+    ///
+    /// \returns Id to send the message's fragments with.
+    ///-------------------------------------------------------------------------
+    uint16_t addMessage(const void *data, size_t size, uint16_t fragmentSize);
+
+    ///-------------------------------------------------------------------------
+    /// Find a fragment of a message still in the buffer.
+    ///
+    /// \param   dataOut [out]   Pointer to the fragment's data.
+    /// \param   sizeOut [out]   Size of the fragment.
+    /// \param   numFragmentsOut [out]   Number of fragments in the message.
+    /// \param   fragmentSizeOut [out]   Size of each fragment of the message.
+    ///
+    /// \returns True if the fragment was found.
+    ///-------------------------------------------------------------------------
+    bool getFragment(uint16_t messageId, uint8_t index, const uint8_t **dataOut,
+                     size_t *sizeOut, uint8_t *numFragmentsOut,
+                     uint16_t *fragmentSizeOut) const;
+
+    ///-------------------------------------------------------------------------
+    /// Forget all sent messages.
+    ///-------------------------------------------------------------------------
+    void clear();
+
+  private:
+    struct Entry {
+        Entry() : active(false), messageId(0), fragmentSize(0) {}
+
+        bool active;
+        uint16_t messageId;
+        uint16_t fragmentSize;
+        std::vector<uint8_t> data;
+    };
+
+    uint16_t nextMessageId;
+    Entry entries[FRAGMENT_SEND_BUFFER_SIZE];
+};
+
+///-----------------------------------------------------------------------------
+/// \returns Number of fragments a message of \p size bytes is split into.
+///-----------------------------------------------------------------------------
+size_t getNumFragments(size_t size, size_t fragmentSize);
+}
+}
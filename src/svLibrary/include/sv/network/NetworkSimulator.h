@@ -0,0 +1,171 @@
+//===-- sv/network/NetworkSimulator.h - Simulate bad networks ---*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Simulate latency, jitter, packet loss, duplication and limited
+/// bandwidth on outgoing packets.
+///
+/// Loopback is a perfect network, so code tested over it never sees the
+/// conditions of a real WAN. A simulator can be attached to a Socket (see
+/// 'Socket::setSimulator'), after which packets sent through the socket are
+/// held by the simulator and only really sent when the simulated network
+/// would have delivered them. Packets may be dropped, duplicated or delayed
+/// by a random amount (jitter), which also reorders them.
+///
+/// The simulator has its own clock, advanced by 'update', and its own random
+/// number generator, seeded explicitly. Given the same seed, conditions and
+/// sequence of sends and updates, it makes exactly the same decisions, so
+/// tests using it are reproducible.
+///
+/// Typical usage:
+///     NetworkConditions conditions;
+///     conditions.latency    = 0.1f;  // 100ms
+///     conditions.jitter     = 0.02f; // +/- 20ms
+///     conditions.packetLoss = 0.05f; // 5%
+///
+///     NetworkSimulator simulator(seed);
+///     simulator.setConditions(conditions);
+///     simulator.setEnabled(true);
+///     connection.setSimulator(&simulator);
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include <sv/network/Sockets.h>
+
+namespace sv {
+namespace net {
+namespace JitterDistribution {
+enum Enum {
+    Uniform, // Jitter is uniformly distributed in [-jitter, jitter]
+    Normal   // Jitter is normally distributed with a std. dev. of jitter
+};
+}
+
+/// Network conditions to simulate
+struct NetworkConditions {
+    NetworkConditions()
+        : latency(0.0f), jitter(0.0f),
+          jitterDistribution(JitterDistribution::Enum::Uniform),
+          packetLoss(0.0f), duplicates(0.0f), bandwidth(0), queueSize(0) {}
+
+    /// One-way delay added to every packet, in seconds.
+    float latency;
+    /// Random variation in delay, in seconds (see 'jitterDistribution').
+    float jitter;
+    /// How jitter is distributed.
+    JitterDistribution::Enum jitterDistribution;
+    /// Probability of a packet being dropped (0 to 1).
+    float packetLoss;
+    /// Probability of a packet being delivered twice (0 to 1).
+    float duplicates;
+    /// Bytes per second the link can carry, 0 for unlimited.
+    uint32_t bandwidth;
+    /// Bytes that can be waiting for a bandwidth limited link before further
+    /// packets are dropped, 0 for unlimited.
+    uint32_t queueSize;
+};
+
+/// Holds outgoing packets until the simulated network would deliver them
+class NetworkSimulator {
+  public:
+    ///-------------------------------------------------------------------------
+    /// Construct a disabled simulator with perfect network conditions.
+    ///
+    /// \param   seed   Seed for the simulator's random number generator.
+    ///-------------------------------------------------------------------------
+    NetworkSimulator(uint32_t seed = 0);
+
+    ///-------------------------------------------------------------------------
+    /// Reseed the random number generator.
+    ///-------------------------------------------------------------------------
+    void seed(uint32_t seed);
+
+    void setConditions(const NetworkConditions &conditions);
+    const NetworkConditions &getConditions() const;
+
+    ///-------------------------------------------------------------------------
+    /// Enable or disable the simulator. A disabled simulator passes packets
+    /// straight through, any packets it still holds are released on the next
+    /// update.
+    ///-------------------------------------------------------------------------
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    ///-------------------------------------------------------------------------
+    /// Give a packet to the simulator to deliver to \p destination.
+    ///-------------------------------------------------------------------------
+    void sendPacket(const Address &destination, const void *data, size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// Advance the simulator's clock.
+    ///
+    /// \param   deltaTime   Time since last update in seconds.
+    ///-------------------------------------------------------------------------
+    void update(float deltaTime);
+
+    ///-------------------------------------------------------------------------
+    /// Take the next packet that is due to be delivered.
+    ///
+    /// \param   destination [out]   Where the packet should be delivered.
+    /// \param   data        [out]   Contents of the packet.
+    ///
+    /// \returns True if a packet was due, false otherwise.
+    ///-------------------------------------------------------------------------
+    bool getNextPacket(Address *destination, std::vector<uint8_t> *data);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of packets held by the simulator.
+    ///-------------------------------------------------------------------------
+    size_t getNumPending() const;
+
+    /// Number of packets given to the simulator
+    uint64_t getNumSent() const;
+    /// Number of packets dropped (by packet loss or a full queue)
+    uint64_t getNumDropped() const;
+    /// Number of extra copies of packets created
+    uint64_t getNumDuplicated() const;
+
+  private:
+    struct PendingPacket {
+        double deliveryTime;
+        uint64_t order;
+        Address destination;
+        std::vector<uint8_t> data;
+    };
+
+    // Uniformly distributed random number in [0, 1)
+    double random();
+
+    // Random delay for one packet
+    double getDelay();
+
+    // Hold a packet until 'deliveryTime'
+    void schedule(double deliveryTime, const Address &destination,
+                  const void *data, size_t size);
+
+    bool enabled;
+    NetworkConditions conditions;
+    std::mt19937 generator;
+
+    double time;
+    double linkFreeTime;
+    uint64_t nextOrder;
+    std::deque<PendingPacket> pending;
+
+    uint64_t numSent;
+    uint64_t numDropped;
+    uint64_t numDuplicated;
+};
+}
+}
@@ -0,0 +1,252 @@
+//===-- sv/network/PacketCapture.h - Record and replay traffic --*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Record the datagrams a socket sends and receives, and feed them
+/// back into a connection later.
+///
+/// A capture is opt-in: give a 'PacketCapture' to a socket (or connection)
+/// and every datagram that leaves or arrives is written to the capture file
+/// along with its address and the time since the capture was opened. Socket
+/// updates are recorded too, with the exact delta time passed in, so a
+/// connection driven from the capture sees the same sequence of packets and
+/// time steps it did live.
+///
+/// 'ConnectionReplay' plays a capture back into a connection started with
+/// 'Connection::startReplay', which has no socket: received datagrams are
+/// processed as if they came off the wire, updates are applied with their
+/// recorded delta time, and anything the connection sends is dropped. Given
+/// the same starting state, a replay always produces the same payloads and
+/// statistics, so it can be used to reproduce a problem seen live, or to
+/// profile the receive path offline with real traffic.
+///
+/// File format, all values big-endian:
+///     Header: magic "SVPC" (u32), version (u16)
+///     Record: type (u8), microseconds since the previous record (u32), then
+///         Sent/Received: address type (u8), port (u16), 4 or 16 address
+///                        bytes, size (u16), datagram
+///         Update:        delta time (u32, bits of a float)
+///
+/// NOTE: A capture isn't thread safe, use one per socket.
+///
+/// Typical usage:
+///     PacketCapture capture;
+///     capture.open("session.svpc");
+///     connection.setCapture(&capture);
+///     ...
+///
+///     PacketCaptureReader reader;
+///     reader.open("session.svpc");
+///
+///     Connection connection(id, timeout);
+///     connection.startReplay();
+///     connection.listen();
+///
+///     ConnectionReplay replay(connection, reader);
+///     while (!replay.isFinished()) {
+///         size_t size = replay.receivePacket(buffer, sizeof(buffer));
+///         ...
+///     }
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sv/network/Sockets.h>
+
+namespace sv {
+namespace net {
+/// First four bytes of a capture file, "SVPC".
+const uint32_t PACKET_CAPTURE_MAGIC = 0x53565043;
+
+/// Version of the capture file format written.
+const uint16_t PACKET_CAPTURE_VERSION = 1;
+
+namespace CaptureRecordType {
+enum Enum : uint8_t { Sent, Received, Update };
+}
+
+/// One entry of a capture
+struct CaptureRecord {
+    CaptureRecord()
+        : type(CaptureRecordType::Enum::Update), time(0.0), deltaTime(0.0f),
+          data(nullptr), size(0) {}
+
+    CaptureRecordType::Enum type;
+    /// Seconds since the capture was opened.
+    double time;
+    /// Delta time of an update record.
+    float deltaTime;
+    /// Destination of a sent datagram, or sender of a received one.
+    Address address;
+    /// Contents of the datagram, valid until the reader is reopened.
+    const uint8_t *data;
+    size_t size;
+};
+
+/// Writes a capture file
+class PacketCapture {
+  public:
+    PacketCapture();
+    ~PacketCapture();
+
+    ///-------------------------------------------------------------------------
+    /// Start a new capture in the file at \p path, replacing anything there.
+    ///
+    /// \returns True if the file was opened.
+    ///-------------------------------------------------------------------------
+    bool open(const std::string &path);
+
+    ///-------------------------------------------------------------------------
+    /// Write out anything buffered and close the file.
+    ///-------------------------------------------------------------------------
+    void close();
+
+    bool isOpen() const;
+
+    ///-------------------------------------------------------------------------
+    /// Record a datagram sent to \p destination.
+    ///-------------------------------------------------------------------------
+    void recordSent(const Address &destination, const void *data, size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// Record a datagram received from \p sender.
+    ///-------------------------------------------------------------------------
+    void recordReceived(const Address &sender, const void *data, size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// Record an update of \p deltaTime seconds.
+    ///-------------------------------------------------------------------------
+    void recordUpdate(float deltaTime);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of records written since the capture was opened.
+    ///-------------------------------------------------------------------------
+    size_t getNumRecords() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Size of the capture so far in bytes, including anything not
+    /// yet written to the file.
+    ///-------------------------------------------------------------------------
+    size_t getSize() const;
+
+  private:
+    // Write the type and timestamp that start every record
+    void writeRecordHeader(CaptureRecordType::Enum type);
+
+    // Write a sent or received datagram
+    void writeDatagram(CaptureRecordType::Enum type, const Address &address,
+                       const void *data, size_t size);
+
+    // Write the buffer to the file
+    void flush();
+
+    std::ofstream file;
+    std::vector<uint8_t> buffer;
+    std::chrono::steady_clock::time_point lastRecordTime;
+    size_t numRecords;
+    size_t size;
+};
+
+/// Reads a capture file
+class PacketCaptureReader {
+  public:
+    PacketCaptureReader();
+
+    ///-------------------------------------------------------------------------
+    /// Read the whole capture file at \p path into memory.
+    ///
+    /// \returns False if the file couldn't be read or isn't a capture.
+    ///-------------------------------------------------------------------------
+    bool open(const std::string &path);
+
+    ///-------------------------------------------------------------------------
+    /// Read a capture already in memory. The data is copied.
+    ///
+    /// \returns False if the data isn't a capture.
+    ///-------------------------------------------------------------------------
+    bool load(const void *data, size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// Read the next record.
+    ///
+    /// \returns False at the end of the capture, or if the rest of it is
+    /// corrupt (see 'hasFailed').
+    ///-------------------------------------------------------------------------
+    bool readRecord(CaptureRecord *record);
+
+    ///-------------------------------------------------------------------------
+    /// Go back to the first record.
+    ///-------------------------------------------------------------------------
+    void rewind();
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if a record couldn't be read because it was cut short or
+    /// malformed.
+    ///-------------------------------------------------------------------------
+    bool hasFailed() const;
+
+  private:
+    std::vector<uint8_t> contents;
+    size_t position;
+    double time;
+    bool failed;
+};
+
+class Connection;
+
+/// Plays a capture back into a connection
+class ConnectionReplay {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \param   connection   Connection started with 'startReplay' and put in
+    /// the mode it was in when captured ('listen' or 'connect').
+    /// \param   reader   Capture to play, from its current position.
+    ///-------------------------------------------------------------------------
+    ConnectionReplay(Connection &connection_, PacketCaptureReader &reader_);
+
+    ///-------------------------------------------------------------------------
+    /// Play records until the connection produces a payload or the capture
+    /// ends, like 'Connection::receivePacket'. Sent records are skipped,
+    /// the connection makes its own.
+    ///
+    /// \returns Number of bytes of payload copied into \p buffer.
+    ///-------------------------------------------------------------------------
+    size_t receivePacket(void *buffer, size_t bufferSize);
+
+    ///-------------------------------------------------------------------------
+    /// \returns True once every record has been played.
+    ///-------------------------------------------------------------------------
+    bool isFinished() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Capture time of the last record played, in seconds.
+    ///-------------------------------------------------------------------------
+    double getTime() const;
+
+    /// Number of received datagrams given to the connection.
+    size_t getPacketsReplayed() const;
+    /// Number of updates applied to the connection.
+    size_t getUpdatesReplayed() const;
+
+  private:
+    Connection &connection;
+    PacketCaptureReader &reader;
+    bool finished;
+    double time;
+    size_t packetsReplayed;
+    size_t updatesReplayed;
+};
+}
+}
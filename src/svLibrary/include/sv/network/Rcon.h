@@ -0,0 +1,241 @@
+//===-- sv/network/Rcon.h - Remote console ----------------------*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Remote console access for administrators on the same machine.
+///
+/// An RconServer listens on a loopback UDP port and executes console input
+/// sent by RconClients that know the password. The server is updated from the
+/// game loop and never blocks: every update it drains whatever packets have
+/// arrived, from any number of sessions, and replies to each command with what
+/// it wrote to the console's output and error buffers, split into chunks that
+/// fit in a packet. Commands are executed as console submissions (see
+/// 'Console::submit'), so the host's own buffers are left as they were.
+///
+/// Only packets from loopback addresses are accepted, the password and
+/// console traffic are not encrypted.
+///
+/// Typical usage (server):
+///     RconServer rcon(console);
+///     rcon.start(port, password);
+///     // Each frame
+///     rcon.update(deltaTime);
+///
+/// Typical usage (client):
+///     RconClient client;
+///     client.open();
+///     if (client.connect(Address(127, 0, 0, 1, port), password, 1.0f)) {
+///         RconResult result;
+///         client.execute("echo hello", 1.0f, &result);
+///     }
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sv/network/Sockets.h>
+#include <sv/network/Stream.h>
+
+namespace sv {
+class Console;
+
+namespace net {
+/// First four bytes of every rcon packet.
+const uint32_t RCON_PROTOCOL_ID = 0x5356524e;
+
+/// Largest rcon packet sent or received, in bytes.
+const size_t RCON_MAX_PACKET_SIZE = 1200;
+
+/// Most bytes of console output carried by one packet.
+const size_t RCON_MAX_CHUNK_SIZE = 1024;
+
+/// Most chunks one command's output and errors are split into. Output that
+/// doesn't fit ends with "[output truncated]".
+const size_t RCON_MAX_CHUNKS = 256;
+
+/// Longest password, in bytes.
+const size_t RCON_MAX_PASSWORD_SIZE = 64;
+
+/// Longest line of console input, in bytes.
+const size_t RCON_MAX_LINE_SIZE = 1024;
+
+/// Most sessions logged in at once.
+const size_t RCON_MAX_SESSIONS = 16;
+
+/// Seconds a session lasts without receiving anything from its client.
+const float RCON_SESSION_TIMEOUT = 60.0f;
+
+/// Most packets handled by one call to 'RconServer::update'.
+const size_t RCON_MAX_PACKETS_PER_UPDATE = 64;
+
+namespace RconPacketType {
+enum Enum : uint8_t {
+    Login,
+    LoginAccepted,
+    LoginRejected,
+    Command,
+    Output,
+    Logout,
+    Count
+};
+}
+
+namespace RconStream {
+enum Enum : uint8_t { Output, Error };
+}
+
+/// Outcome of executing a line of console input remotely
+struct RconResult {
+    RconResult() : succeeded(false) {}
+
+    /// Whether the line executed successfully.
+    bool succeeded;
+    /// What the line appended to the console output buffer.
+    std::string output;
+    /// What the line appended to the console error buffer.
+    std::string error;
+};
+
+///-----------------------------------------------------------------------------
+/// \returns True if \p address is 127.x.x.x or ::1.
+///-----------------------------------------------------------------------------
+bool isLoopback(const Address &address);
+
+/// Executes console input sent by remote administrators
+class RconServer {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \param   console   Console remote input is executed on, must outlive
+    /// the server.
+    ///-------------------------------------------------------------------------
+    explicit RconServer(Console &console);
+    ~RconServer();
+
+    RconServer(const RconServer &) = delete;
+    RconServer &operator=(const RconServer &) = delete;
+
+    ///-------------------------------------------------------------------------
+    /// Start listening for clients on \p port.
+    ///
+    /// \returns False if already running, the password is empty or too long,
+    /// or the port couldn't be opened.
+    ///-------------------------------------------------------------------------
+    bool start(uint16_t port, const std::string &password);
+
+    ///-------------------------------------------------------------------------
+    /// Stop listening and forget every session.
+    ///-------------------------------------------------------------------------
+    void stop();
+
+    bool isRunning() const;
+
+    ///-------------------------------------------------------------------------
+    /// Handle the packets that have arrived since the last update, executing
+    /// any commands on the console, and time out idle sessions. Never blocks.
+    ///-------------------------------------------------------------------------
+    void update(float deltaTime);
+
+    size_t getNumSessions() const;
+
+    /// Total number of commands executed for clients.
+    uint64_t getNumCommandsExecuted() const;
+
+  private:
+    struct Session {
+        uint32_t id;
+        Address address;
+        float idleTime;
+        // Request id of the last command executed and the packets answering
+        // it, resent if the client retries so the command runs only once
+        uint32_t lastRequestId;
+        std::vector<std::vector<uint8_t>> response;
+    };
+
+    void handlePacket(const Address &sender, const uint8_t *data,
+                      size_t size);
+    void handleLogin(const Address &sender, ReadStream &stream);
+    void handleCommand(Session &session, ReadStream &stream);
+    Session *findSession(uint32_t id, const Address &address);
+    void removeSession(uint32_t id);
+    void sendResponse(const Session &session);
+
+    Console &console;
+    Socket socket;
+    std::string password;
+    std::vector<Session> sessions;
+    std::vector<uint8_t> buffer;
+    uint64_t numCommandsExecuted;
+};
+
+/// Talks to an RconServer, blocking while it waits for replies
+class RconClient {
+  public:
+    RconClient();
+    ~RconClient();
+
+    RconClient(const RconClient &) = delete;
+    RconClient &operator=(const RconClient &) = delete;
+
+    ///-------------------------------------------------------------------------
+    /// Open the socket used to talk to servers.
+    ///
+    /// \param   port   Local port, 0 picks any free port.
+    ///-------------------------------------------------------------------------
+    bool open(uint16_t port = 0);
+
+    ///-------------------------------------------------------------------------
+    /// Log out if connected and close the socket.
+    ///-------------------------------------------------------------------------
+    void close();
+
+    ///-------------------------------------------------------------------------
+    /// Log in to the server at \p address, waiting up to \p timeout seconds.
+    ///
+    /// \returns False if the password was wrong, the server is full or the
+    /// server didn't answer in time.
+    ///-------------------------------------------------------------------------
+    bool connect(const Address &address, const std::string &password,
+                 float timeout);
+
+    ///-------------------------------------------------------------------------
+    /// Tell the server the session is over.
+    ///-------------------------------------------------------------------------
+    void disconnect();
+
+    bool isConnected() const;
+
+    ///-------------------------------------------------------------------------
+    /// Execute \p line on the server's console, waiting up to \p timeout
+    /// seconds for all of its output. The request is resent while waiting in
+    /// case packets are lost, the server executes it only once.
+    ///
+    /// \returns False if not connected, the line is too long or the output
+    /// didn't arrive in time.
+    ///-------------------------------------------------------------------------
+    bool execute(const std::string &line, float timeout, RconResult *result);
+
+  private:
+    // Send \p size bytes of \p packet to the server every RESEND_INTERVAL
+    // until 'handle' returns true for a reply or \p timeout passes
+    template <typename Handler>
+    bool request(const uint8_t *packet, size_t size, float timeout,
+                 Handler handle);
+
+    Socket socket;
+    Address server;
+    bool connected;
+    uint32_t sessionId;
+    uint32_t nextRequestId;
+    std::vector<uint8_t> buffer;
+};
+}
+}
@@ -0,0 +1,226 @@
+//===-- sv/network/SendScheduler.h - Outgoing traffic control ---*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Limit the bandwidth a connection uses and back off when the link
+/// is congested.
+///
+/// Bytes sent are paid for out of a token bucket, refilled at the current
+/// send rate. A message is sent as soon as it is given to the connection if
+/// the bucket isn't empty, otherwise it waits in a queue for its priority
+/// until the bucket refills. Higher priority messages always leave first. A
+/// single message may overdraw the bucket, so messages larger than the bucket
+/// still get through, but nothing else is sent until the debt is paid off.
+///
+/// The send rate depends on how the link is doing, as measured by the
+/// connection's round trip time and packet loss (see ConnectionStats):
+///   - Good mode sends at the full bandwidth budget.
+///   - Bad mode sends at a fraction of it.
+/// The scheduler drops to bad mode as soon as RTT or loss cross their
+/// thresholds, and only returns to good mode after conditions have been good
+/// for a while. If the link turns bad again soon after recovering, the time
+/// needed to recover doubles, so a flaky link doesn't flip back and forth.
+///
+/// When the queue is full, the oldest messages of the lowest priority are
+/// dropped first, so a slow link degrades to sending only the most important
+/// and most recent data instead of falling further and further behind.
+///
+/// Based off the flow control article by Glenn Fiedler
+/// http://gafferongames.com/networking-for-game-programmers/reliability-and-flow-control/
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace sv {
+namespace net {
+namespace SendPriority {
+enum Enum { High, Normal, Low };
+}
+
+/// Number of send priorities.
+const size_t SEND_PRIORITY_COUNT = 3;
+
+namespace CongestionMode {
+enum Enum { Good, Bad };
+}
+
+/// Round trip time (in seconds) above which the link is considered congested.
+const float SEND_SCHEDULER_BAD_RTT = 0.25f;
+
+/// Packet loss (0 to 1) above which the link is considered congested.
+const float SEND_SCHEDULER_BAD_LOSS = 0.1f;
+
+/// Fraction of the bandwidth budget used while in bad mode.
+const float SEND_SCHEDULER_BAD_RATE_SCALE = 0.25f;
+
+/// Seconds of tokens the bucket can hold, limits the size of bursts.
+const float SEND_SCHEDULER_BURST_TIME = 0.1f;
+
+/// Default number of bytes that can wait to be sent.
+const size_t SEND_SCHEDULER_DEFAULT_MAX_QUEUE_SIZE = 64 * 1024;
+
+/// Rate limiter, tokens are bytes.
+class TokenBucket {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \param   rate   Bytes per second added to the bucket.
+    /// \param   capacity   Most bytes the bucket can hold.
+    ///-------------------------------------------------------------------------
+    TokenBucket(float rate_ = 0.0f, float capacity_ = 0.0f);
+
+    void setRate(float rate, float capacity);
+
+    ///-------------------------------------------------------------------------
+    /// Add tokens for the time passed.
+    ///
+    /// \param   deltaTime   Time since last update in seconds.
+    ///-------------------------------------------------------------------------
+    void update(float deltaTime);
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if the bucket isn't empty.
+    ///-------------------------------------------------------------------------
+    bool hasTokens() const;
+
+    ///-------------------------------------------------------------------------
+    /// Take \p amount tokens out of the bucket, which may leave it in debt.
+    ///-------------------------------------------------------------------------
+    void consume(size_t amount);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Tokens in the bucket, negative when in debt.
+    ///-------------------------------------------------------------------------
+    float getTokens() const;
+
+    ///-------------------------------------------------------------------------
+    /// Fill the bucket.
+    ///-------------------------------------------------------------------------
+    void reset();
+
+  private:
+    float rate;
+    float capacity;
+    float tokens;
+};
+
+/// Decides when a connection's outgoing messages are sent
+class SendScheduler {
+  public:
+    SendScheduler();
+
+    ///-------------------------------------------------------------------------
+    /// Set the bandwidth budget in bytes per second, 0 for unlimited (the
+    /// default). Congestion control only applies with a budget set.
+    ///-------------------------------------------------------------------------
+    void setBandwidth(uint32_t bytesPerSecond);
+    uint32_t getBandwidth() const;
+
+    ///-------------------------------------------------------------------------
+    /// Set the most bytes that can be queued waiting to be sent.
+    ///-------------------------------------------------------------------------
+    void setMaxQueueSize(size_t bytes);
+    size_t getMaxQueueSize() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Whether the link is currently considered congested.
+    ///-------------------------------------------------------------------------
+    CongestionMode::Enum getCongestionMode() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Bytes per second currently allowed, 0 if unlimited.
+    ///-------------------------------------------------------------------------
+    uint32_t getSendRate() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Seconds conditions must stay good before leaving bad mode.
+    ///-------------------------------------------------------------------------
+    float getPenaltyTime() const;
+
+    ///-------------------------------------------------------------------------
+    /// Refill the token bucket and react to the state of the link.
+    ///
+    /// \param   deltaTime   Time since last update in seconds.
+    /// \param   rtt   Measured round trip time in seconds.
+    /// \param   packetLoss   Measured packet loss (0 to 1).
+    ///-------------------------------------------------------------------------
+    void update(float deltaTime, float rtt, float packetLoss);
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if a message of the given priority can be sent right
+    /// away: the budget allows it and no message of the same or higher
+    /// priority is waiting.
+    ///-------------------------------------------------------------------------
+    bool canSend(SendPriority::Enum priority) const;
+
+    ///-------------------------------------------------------------------------
+    /// Pay for \p size bytes sent.
+    ///-------------------------------------------------------------------------
+    void consume(size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// Queue a message to be sent later. Older, lower (or equal) priority
+    /// messages are dropped to make room if the queue is full.
+    ///
+    /// \returns False if the message couldn't be queued.
+    ///-------------------------------------------------------------------------
+    bool enqueue(const void *data, size_t size, SendPriority::Enum priority);
+
+    ///-------------------------------------------------------------------------
+    /// Take the next message to send, if the budget allows.
+    ///
+    /// \param   data [out]   Contents of the message.
+    ///
+    /// \returns True if a message should be sent now.
+    ///-------------------------------------------------------------------------
+    bool dequeue(std::vector<uint8_t> *data);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of messages waiting to be sent.
+    ///-------------------------------------------------------------------------
+    size_t getNumQueued() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of bytes waiting to be sent.
+    ///-------------------------------------------------------------------------
+    size_t getQueuedBytes() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of messages dropped because the queue was full.
+    ///-------------------------------------------------------------------------
+    uint64_t getNumDropped() const;
+
+    ///-------------------------------------------------------------------------
+    /// Drop all queued messages and return to good mode.
+    ///-------------------------------------------------------------------------
+    void clear();
+
+  private:
+    // Update the token bucket for the current mode
+    void updateRate();
+
+    uint32_t bandwidth;
+    size_t maxQueueSize;
+    TokenBucket bucket;
+
+    CongestionMode::Enum mode;
+    float penaltyTime;
+    float goodConditionsTime;
+    float penaltyReductionTime;
+
+    std::deque<std::vector<uint8_t>> queues[SEND_PRIORITY_COUNT];
+    size_t numQueued;
+    size_t queuedBytes;
+    uint64_t numDropped;
+};
+}
+}
@@ -0,0 +1,238 @@
+//===-- sv/network/ShardedServer.h - Multi-threaded receive -----*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Spread a server's receive processing across several threads.
+///
+/// A single socket can only be read by one thread at a time, which limits a
+/// busy server to a single core for receiving packets. Instead, the server
+/// opens one socket per worker thread, all bound to the same port with
+/// SO_REUSEPORT. The kernel then hashes each client's address and port to one
+/// of the sockets, so all of a client's packets arrive at the same worker.
+///
+/// Each worker owns the state of the clients that arrive on its socket: it
+/// creates a client on its first packet and forgets it once it has been idle
+/// for longer than the timeout. Workers share nothing, so no locking is
+/// needed to handle a packet, and replies go out through the worker's own
+/// socket so they come from the port the client sent to.
+///
+/// A worker holds a bounded number of clients, and drops packets from new
+/// addresses while it is full, so spoofed source addresses can't grow its
+/// state without limit.
+///
+/// NOTE: Only supported where SO_REUSEPORT is (Linux 3.9+, BSD, macOS). With
+/// one worker, no special socket options are needed.
+///
+/// Typical usage:
+///     class Handler : public ShardedServerHandler {
+///         virtual void onPacket(ShardWorker &worker, ShardClient &client,
+///                               const uint8_t *data, size_t size) {
+///             worker.send(client.address, reply, replySize);
+///         }
+///     };
+///
+///     Handler handler;
+///     ShardedServer server(timeout);
+///     server.start(port, numWorkers, &handler);
+///     ...
+///     server.stop();
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sv/network/Sockets.h>
+
+namespace sv {
+namespace net {
+/// Largest datagram a shard worker can receive.
+const size_t SHARD_MAX_PACKET_SIZE = 65507;
+
+/// Most clients a shard worker holds unless told otherwise.
+const size_t SHARD_DEFAULT_MAX_CLIENTS_PER_WORKER = 4096;
+
+/// State a worker keeps for each of its clients
+struct ShardClient {
+    ShardClient()
+        : idleTime(0.0f), packetsReceived(0), bytesReceived(0),
+          userData(nullptr) {}
+
+    Address address;
+    /// Seconds since the last packet from this client.
+    float idleTime;
+    uint64_t packetsReceived;
+    uint64_t bytesReceived;
+    /// For use by the handler, e.g. to attach game state to a client.
+    void *userData;
+};
+
+class ShardWorker;
+
+/// Receives the packets of a sharded server.
+///
+/// NOTE: Called from the worker threads, concurrently for clients of
+/// different workers. Calls for any one client always come from the same
+/// thread.
+class ShardedServerHandler {
+  public:
+    virtual ~ShardedServerHandler() {}
+
+    ///-------------------------------------------------------------------------
+    /// Called when a packet arrives from an address the worker hasn't seen
+    /// (or has forgotten), before 'onPacket'.
+    ///-------------------------------------------------------------------------
+    virtual void onClientConnected(ShardWorker &, ShardClient &) {}
+
+    ///-------------------------------------------------------------------------
+    /// Called for every packet received.
+    ///-------------------------------------------------------------------------
+    virtual void onPacket(ShardWorker &worker, ShardClient &client,
+                          const uint8_t *data, size_t size) = 0;
+
+    ///-------------------------------------------------------------------------
+    /// Called when a client is forgotten after not sending anything for the
+    /// timeout, or when the server stops.
+    ///-------------------------------------------------------------------------
+    virtual void onClientDisconnected(ShardWorker &, ShardClient &) {}
+};
+
+/// One receive thread of a sharded server, with its own socket and clients
+class ShardWorker {
+  public:
+    ShardWorker(size_t index_, float timeout_, size_t maxClients_,
+                ShardedServerHandler *handler_);
+    ~ShardWorker();
+
+    ///-------------------------------------------------------------------------
+    /// Open the worker's socket on \p port.
+    ///-------------------------------------------------------------------------
+    bool open(uint16_t port, bool reusePort);
+
+    ///-------------------------------------------------------------------------
+    /// Start receiving on a thread of its own.
+    ///-------------------------------------------------------------------------
+    void start();
+
+    ///-------------------------------------------------------------------------
+    /// Stop the worker's thread, disconnect its clients and close its socket.
+    ///-------------------------------------------------------------------------
+    void stop();
+
+    ///-------------------------------------------------------------------------
+    /// Send a packet from this worker's socket.
+    ///
+    /// NOTE: Only call from this worker's thread (e.g. from the handler).
+    ///-------------------------------------------------------------------------
+    bool send(const Address &destination, const void *data, size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Index of this worker in the server.
+    ///-------------------------------------------------------------------------
+    size_t getIndex() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of clients this worker currently owns. Safe to call
+    /// from any thread.
+    ///-------------------------------------------------------------------------
+    size_t getNumClients() const;
+
+    /// Packets received by this worker, safe to call from any thread.
+    uint64_t getPacketsReceived() const;
+    /// Bytes received by this worker, safe to call from any thread.
+    uint64_t getBytesReceived() const;
+    /// Packets from new addresses dropped while the worker was full, safe to
+    /// call from any thread.
+    uint64_t getPacketsDropped() const;
+
+  private:
+    // Receive until told to stop
+    void run();
+
+    // Handle everything waiting on the socket
+    void receivePackets();
+
+    // Forget clients that have been idle too long
+    void updateClients(float deltaTime);
+
+    size_t index;
+    float timeout;
+    size_t maxClients;
+    ShardedServerHandler *handler;
+
+    Socket socket;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    std::unordered_map<Address, ShardClient> clients;
+    std::vector<uint8_t> buffer;
+
+    std::atomic<size_t> numClients;
+    std::atomic<uint64_t> packetsReceived;
+    std::atomic<uint64_t> bytesReceived;
+    std::atomic<uint64_t> packetsDropped;
+};
+
+/// Server receiving on one port with several threads
+class ShardedServer {
+  public:
+    ///-------------------------------------------------------------------------
+    /// \param   timeout   Seconds a client can go without sending anything
+    /// before it is forgotten.
+    /// \param   maxClientsPerWorker   Most clients each worker holds.
+    ///-------------------------------------------------------------------------
+    ShardedServer(float timeout_,
+                  size_t maxClientsPerWorker_ =
+                      SHARD_DEFAULT_MAX_CLIENTS_PER_WORKER);
+    ~ShardedServer();
+
+    ///-------------------------------------------------------------------------
+    /// Open \p numWorkers sockets on \p port and start a thread for each.
+    ///
+    /// \returns False if the sockets couldn't be opened, in which case no
+    /// workers are started.
+    ///-------------------------------------------------------------------------
+    bool start(uint16_t port, size_t numWorkers,
+               ShardedServerHandler *handler);
+
+    ///-------------------------------------------------------------------------
+    /// Stop all workers.
+    ///-------------------------------------------------------------------------
+    void stop();
+
+    bool isRunning() const;
+
+    size_t getNumWorkers() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Worker at \p index.
+    ///-------------------------------------------------------------------------
+    const ShardWorker &getWorker(size_t index) const;
+
+    /// Number of clients across all workers.
+    size_t getNumClients() const;
+    /// Packets received across all workers.
+    uint64_t getPacketsReceived() const;
+    /// Bytes received across all workers.
+    uint64_t getBytesReceived() const;
+    /// Packets dropped by full workers across all workers.
+    uint64_t getPacketsDropped() const;
+
+  private:
+    float timeout;
+    size_t maxClientsPerWorker;
+    std::vector<std::unique_ptr<ShardWorker>> workers;
+};
+}
+}
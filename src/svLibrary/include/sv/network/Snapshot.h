@@ -0,0 +1,248 @@
+//===-- sv/network/Snapshot.h - Delta-compressed world state ----*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Replicate world state to clients as delta-compressed snapshots.
+///
+/// A snapshot is the state of every replicated entity at one server tick. Each
+/// entity has an id and a fixed number of 32-bit fields (floats are stored as
+/// their bit pattern, see 'floatToField').
+///
+/// Rather than sending every snapshot in full, the server keeps a ring of
+/// recently sent snapshots for each client and encodes each new snapshot
+/// against the most recent snapshot that client has acknowledged (the
+/// baseline). Only entities that changed are written, and for each of those
+/// entities only the fields that changed are written, behind a per-field
+/// change bit. Entities that are not in the new snapshot but were in the
+/// baseline are sent as removed.
+///
+/// If the client hasn't acknowledged any snapshot yet, or the acknowledged
+/// snapshot is too old to still be in the ring, the snapshot is sent in full
+/// (encoded against an empty world).
+///
+/// The client keeps the same ring of snapshots it has received, so it always
+/// has the baseline a delta was encoded against, provided it only acknowledges
+/// snapshots it has successfully read.
+///
+/// Typical usage:
+///     // Server, each tick
+///     std::shared_ptr<Snapshot> world(new Snapshot(fieldCount, tick));
+///     world->setEntity(id, fields);
+///     ...
+///     size_t size = sender.writeSnapshot(world, buffer, sizeof(buffer));
+///     connection.sendPacket(buffer, size);
+///
+///     // Server, when the client acknowledges a snapshot
+///     sender.acknowledge(ackedSequence);
+///
+///     // Client
+///     Snapshot snapshot;
+///     if (receiver.readSnapshot(packet, packetSize, &snapshot)) {
+///         // Apply snapshot and acknowledge snapshot.getSequence()
+///     }
+///
+/// Based off the snapshot compression articles by Glenn Fiedler
+/// http://gafferongames.com/networked-physics/snapshot-compression/
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sv {
+namespace net {
+/// Maximum number of fields an entity in a snapshot may have.
+const uint8_t SNAPSHOT_MAX_FIELDS = 32;
+
+/// Number of recent snapshots kept for use as delta baselines. Snapshots older
+/// than this are sent in full.
+const uint32_t SNAPSHOT_HISTORY_SIZE = 32;
+
+///-----------------------------------------------------------------------------
+/// \returns Bit pattern of \p value, for storing floats in snapshot fields.
+///-----------------------------------------------------------------------------
+uint32_t floatToField(float value);
+
+///-----------------------------------------------------------------------------
+/// \returns Float with the bit pattern stored in \p field.
+///-----------------------------------------------------------------------------
+float fieldToFloat(uint32_t field);
+
+/// The state of every replicated entity at one point in time.
+class Snapshot {
+  public:
+    ///-------------------------------------------------------------------------
+    /// Construct an empty snapshot.
+    ///
+    /// \param   fieldCount   Number of fields each entity has (at most
+    /// SNAPSHOT_MAX_FIELDS).
+    /// \param   sequence     Sequence number of the snapshot, should increase
+    /// by one each time a snapshot is taken.
+    ///-------------------------------------------------------------------------
+    Snapshot(uint8_t fieldCount_ = 0, uint32_t sequence_ = 0);
+
+    uint32_t getSequence() const;
+    void setSequence(uint32_t sequence);
+
+    uint8_t getFieldCount() const;
+
+    ///-------------------------------------------------------------------------
+    /// Remove all entities and change the number of fields entities have.
+    ///-------------------------------------------------------------------------
+    void reset(uint8_t fieldCount);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of entities in the snapshot.
+    ///-------------------------------------------------------------------------
+    size_t getNumEntities() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Id of the entity at \p index. Entities are ordered by id.
+    ///-------------------------------------------------------------------------
+    uint16_t getEntityId(size_t index) const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Fields of the entity at \p index.
+    ///-------------------------------------------------------------------------
+    const uint32_t *getEntityFields(size_t index) const;
+
+    ///-------------------------------------------------------------------------
+    /// Add an entity to the snapshot, or replace the fields of the entity if
+    /// one with the same id already exists.
+    ///
+    /// NOTE: Adding entities in increasing id order is O(1).
+    ///
+    /// \param   fields   Array of 'getFieldCount()' fields.
+    ///-------------------------------------------------------------------------
+    void setEntity(uint16_t id, const uint32_t *fields);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Fields of the entity with the given id or nullptr if no entity
+    /// with that id is in the snapshot.
+    ///-------------------------------------------------------------------------
+    const uint32_t *findEntity(uint16_t id) const;
+
+    ///-------------------------------------------------------------------------
+    /// Remove the entity with the given id (if one exists).
+    ///-------------------------------------------------------------------------
+    void removeEntity(uint16_t id);
+
+  private:
+    // Index of the entity with the given id, or the index at which it would
+    // be inserted.
+    size_t lowerBound(uint16_t id) const;
+
+    uint32_t sequence;
+    uint8_t fieldCount;
+    std::vector<uint16_t> ids;
+    std::vector<uint32_t> fields;
+};
+
+/// Ring of recent snapshots, indexed by sequence number.
+class SnapshotHistory {
+  public:
+    ///-------------------------------------------------------------------------
+    /// Add a snapshot to the history, replacing the snapshot
+    /// SNAPSHOT_HISTORY_SIZE sequence numbers older than it.
+    ///-------------------------------------------------------------------------
+    void insert(const std::shared_ptr<const Snapshot> &snapshot);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Snapshot with the given sequence number, or nullptr if it is
+    /// not (or no longer) in the history.
+    ///-------------------------------------------------------------------------
+    std::shared_ptr<const Snapshot> find(uint32_t sequence) const;
+
+    ///-------------------------------------------------------------------------
+    /// Remove all snapshots from the history.
+    ///-------------------------------------------------------------------------
+    void clear();
+
+  private:
+    std::shared_ptr<const Snapshot> entries[SNAPSHOT_HISTORY_SIZE];
+};
+
+/// Server side of snapshot replication, one per client.
+class SnapshotSender {
+  public:
+    SnapshotSender() : hasAck(false), lastAcked(0) {}
+
+    ///-------------------------------------------------------------------------
+    /// Encode \p snapshot against the last snapshot the client acknowledged
+    /// and remember it for use as a future baseline.
+    ///
+    /// The same snapshot may be given to the senders of all clients, the
+    /// snapshot is shared rather than copied.
+    ///
+    /// \returns Number of bytes written to \p buffer, or 0 if the snapshot
+    /// did not fit.
+    ///-------------------------------------------------------------------------
+    size_t writeSnapshot(const std::shared_ptr<const Snapshot> &snapshot,
+                         void *buffer, size_t bufferSize);
+
+    ///-------------------------------------------------------------------------
+    /// Note that the client has received the snapshot with the given
+    /// sequence number. Acknowledgements older than the last one are ignored.
+    ///-------------------------------------------------------------------------
+    void acknowledge(uint32_t sequence);
+
+    ///-------------------------------------------------------------------------
+    /// Forget all sent snapshots and acknowledgements, the next snapshot will
+    /// be sent in full.
+    ///-------------------------------------------------------------------------
+    void reset();
+
+  private:
+    SnapshotHistory history;
+    bool hasAck;
+    uint32_t lastAcked;
+};
+
+/// Client side of snapshot replication.
+class SnapshotReceiver {
+  public:
+    SnapshotReceiver() : hasReceived(false), latestSequence(0) {}
+
+    ///-------------------------------------------------------------------------
+    /// Decode a snapshot written by a SnapshotSender.
+    ///
+    /// \post Value of given snapshotOut parameter is unspecified if this
+    /// method returns false.
+    ///
+    /// \returns True if the snapshot was read successfully, false if the data
+    /// is malformed or the baseline it was encoded against is unknown.
+    ///-------------------------------------------------------------------------
+    bool readSnapshot(const void *data, size_t dataSize,
+                      Snapshot *snapshotOut);
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if at least one snapshot has been read.
+    ///-------------------------------------------------------------------------
+    bool hasReceivedSnapshot() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Sequence number of the newest snapshot read, the one to
+    /// acknowledge to the server.
+    ///-------------------------------------------------------------------------
+    uint32_t getLatestSequence() const;
+
+    ///-------------------------------------------------------------------------
+    /// Forget all received snapshots.
+    ///-------------------------------------------------------------------------
+    void reset();
+
+  private:
+    SnapshotHistory history;
+    bool hasReceived;
+    uint32_t latestSequence;
+};
+}
+}
@@ -15,7 +15,11 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
 
 namespace sv {
 namespace net {
@@ -35,55 +39,143 @@ bool initializeSockets();
 ///-----------------------------------------------------------------------------
 void shutdownSockets();
 
-/// Represents a network address
+namespace AddressType {
+enum Enum : uint8_t { None, IPv4, IPv6 };
+}
+
+/// Represents a network address, either IPv4 or IPv6
 class Address {
   public:
-    Address() : address(0), port(0) {}
+    Address() : port(0), type(AddressType::Enum::None) {
+        words[0] = 0;
+        words[1] = 0;
+    }
     Address(uint8_t a, uint8_t b, uint8_t c, uint8_t d, uint16_t port_)
-        : address((a << 24) | (b << 16) | (c << 8) | d), port(port_) {}
+        : port(port_), type(AddressType::Enum::IPv4) {
+        words[0] = (uint32_t)((a << 24) | (b << 16) | (c << 8) | d);
+        words[1] = 0;
+    }
     Address(uint32_t address_, uint16_t port_)
-        : address(address_), port(port_) {}
+        : port(port_), type(AddressType::Enum::IPv4) {
+        words[0] = address_;
+        words[1] = 0;
+    }
+
+    ///-------------------------------------------------------------------------
+    /// Construct an IPv6 address from its eight 16-bit groups, in the order
+    /// they are written (e.g. ::1 is 0, 0, 0, 0, 0, 0, 0, 1).
+    ///-------------------------------------------------------------------------
+    Address(uint16_t a, uint16_t b, uint16_t c, uint16_t d, uint16_t e,
+            uint16_t f, uint16_t g, uint16_t h, uint16_t port_);
+
+    ///-------------------------------------------------------------------------
+    /// Construct an IPv6 address from 16 bytes in network byte order.
+    ///-------------------------------------------------------------------------
+    Address(const uint8_t (&ipv6Bytes)[16], uint16_t port_);
 
     ///-------------------------------------------------------------------------
-    /// Get the IP address
+    /// \returns Whether this is an IPv4 or IPv6 address, or None for a
+    /// default constructed address.
+    ///-------------------------------------------------------------------------
+    AddressType::Enum getType() const { return type; }
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if this is an IPv4 or IPv6 address.
+    ///-------------------------------------------------------------------------
+    bool isValid() const { return type != AddressType::Enum::None; }
+
+    ///-------------------------------------------------------------------------
+    /// Get the IPv4 address, 0 if this isn't an IPv4 address
     ///-------------------------------------------------------------------------
     uint32_t getAddress() const;
 
-    /// Get the first component of the IP address
+    /// Get the first component of the IPv4 address
     uint8_t getA() const;
-    /// Get the second component of the IP address
+    /// Get the second component of the IPv4 address
     uint8_t getB() const;
-    /// Get the third component of the IP address
+    /// Get the third component of the IPv4 address
     uint8_t getC() const;
-    /// Get the fourth component of the IP address
+    /// Get the fourth component of the IPv4 address
     uint8_t getD() const;
 
+    ///-------------------------------------------------------------------------
+    /// \returns The 16 bytes of the IPv6 address in network byte order, all
+    /// zero if this isn't an IPv6 address.
+    ///-------------------------------------------------------------------------
+    const uint8_t *getIPv6() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns The 16-bit group of the IPv6 address at \p index (0 to 7).
+    ///-------------------------------------------------------------------------
+    uint16_t getIPv6Group(size_t index) const;
+
     /// Get the address port
     uint16_t getPort() const;
 
-    bool operator==(const Address &other) const;
-    bool operator!=(const Address &other) const;
+    ///-------------------------------------------------------------------------
+    /// \returns Address in text form, e.g. "127.0.0.1:30000" or
+    /// "[::1]:30000".
+    ///-------------------------------------------------------------------------
+    std::string toString() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Hash of the address and port, for use in hash tables.
+    ///-------------------------------------------------------------------------
+    size_t getHash() const {
+        uint64_t key = (words[0] ^ (words[1] * 0x9E3779B97F4A7C15ull)) ^
+                       ((uint64_t)port << 48 | (uint64_t)type << 40);
+        key *= 0x9E3779B97F4A7C15ull;
+
+        return (size_t)(key ^ (key >> 32));
+    }
+
+    bool operator==(const Address &other) const {
+        return words[0] == other.words[0] && port == other.port &&
+               type == other.type && words[1] == other.words[1];
+    }
+    bool operator!=(const Address &other) const { return !(*this == other); }
+
+    ///-------------------------------------------------------------------------
+    /// Arbitrary but consistent order, for use in ordered containers.
+    ///-------------------------------------------------------------------------
+    bool operator<(const Address &other) const;
 
   private:
-    uint32_t address;
     uint16_t port;
+    AddressType::Enum type;
+    // IPv4 address in host byte order in the first word, or IPv6 address in
+    // network byte order
+    uint64_t words[2];
 };
 
+class NetworkSimulator;
+class PacketCapture;
+
 /// A UDP (connectionless, unreliable) socket
 class Socket {
   public:
-    Socket() : socket(0) {}
+    Socket()
+        : socket(0), isIPv6(false), simulator(nullptr), capture(nullptr) {}
     ~Socket();
 
     ///-------------------------------------------------------------------------
     /// Sets the socket up to listen on the given port.
     ///
+    /// The socket is dual-stack where the platform supports IPv6: it sends to
+    /// and receives from both IPv4 and IPv6 addresses. IPv4 peers are always
+    /// reported as IPv4 addresses. Falls back to an IPv4 only socket if IPv6
+    /// isn't available.
+    ///
     /// NOTE: Passing 0 for port number will result in system selecting a free
     /// port.
     ///
+    /// \param   reusePort   Allow other sockets to bind to the same port with
+    /// this option set (SO_REUSEPORT), the kernel spreads incoming packets
+    /// across them by sender. Fails where SO_REUSEPORT isn't supported.
+    ///
     /// \returns True if socket was opened successfully, false otherwise.
     ///-------------------------------------------------------------------------
-    bool open(uint16_t port);
+    bool open(uint16_t port, bool reusePort = false);
 
     ///-------------------------------------------------------------------------
     /// Stop the socket listening on the currently open port.
@@ -95,6 +187,11 @@ class Socket {
     ///-------------------------------------------------------------------------
     bool isOpen() const;
 
+    ///-------------------------------------------------------------------------
+    /// \returns True if this socket can send to IPv6 addresses.
+    ///-------------------------------------------------------------------------
+    bool supportsIPv6() const;
+
     ///-------------------------------------------------------------------------
     /// Send some data over this socket to the given address.
     ///
@@ -105,6 +202,13 @@ class Socket {
     ///-------------------------------------------------------------------------
     bool send(const Address &destination, const void *data, size_t size);
 
+    ///-------------------------------------------------------------------------
+    /// Block until there is data to receive or \p timeout seconds pass.
+    ///
+    /// \returns True if there is data to receive.
+    ///-------------------------------------------------------------------------
+    bool wait(float timeout) const;
+
     ///-------------------------------------------------------------------------
     /// Try to receive some data from the given sender.
     ///
@@ -119,8 +223,60 @@ class Socket {
     ///-------------------------------------------------------------------------
     size_t receive(Address &sender, void *buffer, size_t bufferSize);
 
+    ///-------------------------------------------------------------------------
+    /// Pass packets sent through this socket through a network simulator,
+    /// or nullptr to send them directly again. The simulator must outlive
+    /// the socket or be removed first.
+    ///
+    /// NOTE: Packets held by the simulator are only sent on 'update'.
+    ///-------------------------------------------------------------------------
+    void setSimulator(NetworkSimulator *simulator);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Network simulator packets are passed through, or nullptr.
+    ///-------------------------------------------------------------------------
+    NetworkSimulator *getSimulator() const;
+
+    ///-------------------------------------------------------------------------
+    /// Advance the network simulator (if any) and send the packets it has
+    /// finished delaying.
+    ///
+    /// \param   deltaTime   Time since last update in seconds.
+    ///-------------------------------------------------------------------------
+    void update(float deltaTime);
+
+    ///-------------------------------------------------------------------------
+    /// Record every datagram this socket sends and receives, and every
+    /// update, in a capture, or nullptr to stop. The capture must outlive the
+    /// socket or be removed first.
+    ///
+    /// NOTE: Packets are recorded as they reach the wire, after any network
+    /// simulator.
+    ///-------------------------------------------------------------------------
+    void setCapture(PacketCapture *capture);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Capture datagrams are recorded in, or nullptr.
+    ///-------------------------------------------------------------------------
+    PacketCapture *getCapture() const;
+
   private:
+    // Send data straight to the operating system socket
+    bool sendTo(const Address &destination, const void *data, size_t size);
+
     int32_t socket;
+    bool isIPv6;
+    NetworkSimulator *simulator;
+    std::vector<uint8_t> simulatedPacket;
+    PacketCapture *capture;
 };
 }
 }
+
+namespace std {
+template <> struct hash<sv::net::Address> {
+    size_t operator()(const sv::net::Address &address) const {
+        return address.getHash();
+    }
+};
+}
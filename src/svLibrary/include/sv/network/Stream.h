@@ -0,0 +1,105 @@
+//===-- sv/network/Stream.h - Packet serialization streams ------*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Bounds-checked streams for reading and writing packet data.
+///
+/// Values are written in network (big-endian) byte order, matching the way the
+/// protocol id is written by the connection.
+///
+/// A stream never reads or writes past the end of the buffer it was given. If
+/// an operation would overflow the buffer, the stream is marked as failed and
+/// all following operations do nothing, so a sequence of operations can be
+/// checked for success once at the end.
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sv {
+namespace net {
+/// Writes values to a caller-provided buffer
+class WriteStream {
+  public:
+    WriteStream(void *buffer_, size_t bufferSize_)
+        : buffer((uint8_t *)buffer_), bufferSize(bufferSize_), position(0),
+          failed(false) {}
+
+    void writeUint8(uint8_t value);
+    void writeUint16(uint16_t value);
+    void writeUint32(uint32_t value);
+    void writeBytes(const void *data, size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of bytes written so far.
+    ///-------------------------------------------------------------------------
+    size_t getBytesWritten() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if a write was attempted past the end of the buffer.
+    ///-------------------------------------------------------------------------
+    bool hasFailed() const;
+
+  private:
+    // \returns True if there is room for \p size more bytes.
+    bool reserve(size_t size);
+
+    uint8_t *buffer;
+    size_t bufferSize;
+    size_t position;
+    bool failed;
+};
+
+/// Reads values from a caller-provided buffer
+class ReadStream {
+  public:
+    ReadStream(const void *buffer_, size_t bufferSize_)
+        : buffer((const uint8_t *)buffer_), bufferSize(bufferSize_),
+          position(0), failed(false) {}
+
+    ///-------------------------------------------------------------------------
+    /// Read a value from the stream.
+    ///
+    /// \post Value of given valueOut parameter is not changed if this method
+    /// returns false.
+    ///
+    /// \returns True if the value could be read, false otherwise.
+    ///-------------------------------------------------------------------------
+    bool readUint8(uint8_t *valueOut);
+    bool readUint16(uint16_t *valueOut);
+    bool readUint32(uint32_t *valueOut);
+    bool readBytes(void *dataOut, size_t size);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of bytes read so far.
+    ///-------------------------------------------------------------------------
+    size_t getBytesRead() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of bytes left to read.
+    ///-------------------------------------------------------------------------
+    size_t getBytesRemaining() const;
+
+    ///-------------------------------------------------------------------------
+    /// \returns True if a read was attempted past the end of the buffer.
+    ///-------------------------------------------------------------------------
+    bool hasFailed() const;
+
+  private:
+    // \returns True if there are \p size more bytes to read.
+    bool consume(size_t size);
+
+    const uint8_t *buffer;
+    size_t bufferSize;
+    size_t position;
+    bool failed;
+};
+}
+}
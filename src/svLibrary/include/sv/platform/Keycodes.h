@@ -121,5 +121,29 @@ enum Enum {
 };
 }
 
+/// Number of keycodes with an index, see 'getKeycodeIndex'
+const int NUM_KEYCODE_INDICES = 384;
+
 std::string getKeycodeString(Keycodes::Enum keycode);
+
+///-----------------------------------------------------------------------------
+/// \returns Index of \p keycode in [0, NUM_KEYCODE_INDICES), for tables
+/// indexed by key, or < 0 if \p keycode is not a key. ASCII keys keep their
+/// value, the others follow.
+///-----------------------------------------------------------------------------
+int getKeycodeIndex(Keycodes::Enum keycode);
+
+///-----------------------------------------------------------------------------
+/// Find the keycode with the given name, as it is written in the enum
+/// ("KEY_W"), ignoring case.
+///
+/// \returns False if no keycode has that name.
+///-----------------------------------------------------------------------------
+bool getKeycodeFromName(const std::string &name, Keycodes::Enum *keycodeOut);
+
+///-----------------------------------------------------------------------------
+/// \returns Name of \p keycode as it is written in the enum ("KEY_W"), nullptr
+/// if \p keycode is not a key.
+///-----------------------------------------------------------------------------
+const char *getKeycodeName(Keycodes::Enum keycode);
 }
@@ -0,0 +1,112 @@
+//===-- sv/platform/NullPlatform.h - Headless Platform impl. ----*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Operating System abstraction with no window or devices, for
+/// dedicated servers, tests and benchmarks.
+///
+/// Milliseconds come from the monotonic clock (see Clock.h) and start at 0
+/// when the platform is initialized. Events come only from an event source
+/// given to the platform (see 'setEventSource'), such as a script of timed
+/// events.
+///
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sv/platform/Platform.h>
+
+namespace sv {
+/// Supplies the events of a platform that has no operating system events
+class PlatformEventSource {
+  public:
+    virtual ~PlatformEventSource() {}
+
+    ///-------------------------------------------------------------------------
+    /// Queue events on \p platform (see 'Platform::queueEvent'), called each
+    /// time the platform's event queue has been emptied.
+    ///
+    /// \param   milliseconds   The platform's time.
+    ///-------------------------------------------------------------------------
+    virtual void pumpEvents(Platform &platform, uint32_t milliseconds) = 0;
+};
+
+/// Event source that queues events once the platform's time reaches theirs
+class ScriptedEventSource : public PlatformEventSource {
+  public:
+    ScriptedEventSource();
+
+    ///-------------------------------------------------------------------------
+    /// Queue \p event once the platform's time reaches \p event's time. Events
+    /// must be added in order of time.
+    ///-------------------------------------------------------------------------
+    void addEvent(const PlatformEvent &event);
+
+    ///-------------------------------------------------------------------------
+    /// Queue a text input event once the platform's time reaches \p time.
+    ///-------------------------------------------------------------------------
+    void addTextEvent(uint32_t time, const std::string &text);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of events not yet queued.
+    ///-------------------------------------------------------------------------
+    size_t getNumRemainingEvents() const;
+
+    /// \copydoc PlatformEventSource::pumpEvents()
+    virtual void pumpEvents(Platform &platform, uint32_t milliseconds);
+
+  private:
+    struct ScriptedEvent {
+        PlatformEvent event;
+        std::string text;
+    };
+    std::vector<ScriptedEvent> events;
+    // Index of the next event to queue
+    size_t nextEvent;
+};
+
+class NullPlatform : public Platform {
+  public:
+    NullPlatform();
+
+    /// \copydoc Platform::initialize()
+    virtual bool initialize();
+
+    /// \copydoc Platform::shutdown()
+    virtual void shutdown();
+
+    /// \copydoc Platform::getMilliseconds()
+    virtual uint32_t getMilliseconds() const;
+
+    /// \copydoc Platform::startTextInput()
+    virtual void startTextInput();
+
+    /// \copydoc Platform::stopTextInput()
+    virtual void stopTextInput();
+
+    /// \copydoc Platform::isTextInputActive()
+    virtual bool isTextInputActive() const;
+
+    ///-------------------------------------------------------------------------
+    /// Take events from \p source, or have no events if \p source is nullptr.
+    ///-------------------------------------------------------------------------
+    void setEventSource(const std::shared_ptr<PlatformEventSource> &source);
+
+  protected:
+    /// \copydoc Platform::pumpEvents()
+    virtual void pumpEvents();
+
+  private:
+    TimePoint startTime;
+    bool textInputActive;
+    std::shared_ptr<PlatformEventSource> eventSource;
+};
+}
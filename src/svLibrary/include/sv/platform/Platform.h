@@ -12,34 +12,49 @@
 /// Operating system events (such as keypresses) are converted to an
 /// intermediate format to be fed to the engine.
 ///
+/// Events wait in a fixed-size ring until they are polled, and the text of
+/// text input events is kept in a fixed-size arena, so pumping events never
+/// allocates. Implementations translate operating system events in
+/// 'pumpEvents', which is called whenever the ring has been emptied.
+///
 /// Based off Quake 3 Arena's operating system abstraction.
 ///
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <memory>
-#include <queue>
+
+#include <sv/Clock.h>
 
 namespace sv {
 enum class PlatformEventType {
     None = 0,  // No event, but time field is still valid
     Key,       // value1 is key code, value2 is down flag (1 for down)
-    TextInput, // data is user's text input
+    TextInput, // text is user's text input, textLength bytes long
     Mouse,     // value1 and value2 are relative, signed, x/y mouse movements
     // Packet,     // TODO
     Quit,
 };
 
+/// Most events waiting to be polled, further events are dropped
+const size_t PLATFORM_EVENT_QUEUE_SIZE = 1024;
+
+/// Most bytes of text input waiting to be polled, further text is dropped
+const size_t PLATFORM_TEXT_ARENA_SIZE = 4096;
+
 struct PlatformEvent {
     PlatformEvent()
         : time(0), type(PlatformEventType::None), value1(0), value2(0),
-          data(nullptr) {}
+          text(nullptr), textLength(0) {}
 
     uint32_t time;
     PlatformEventType type;
     int value1, value2;
-    std::shared_ptr<std::vector<char> > data;
+    /// Not NULL-terminated. Points into the platform's text arena, valid until
+    /// every waiting event has been polled and events are polled again.
+    const char *text;
+    uint32_t textLength;
 };
 
 /// Operating System abstraction
@@ -71,6 +86,13 @@ class Platform {
     ///-------------------------------------------------------------------------
     virtual uint32_t getMilliseconds() const = 0;
 
+    ///-------------------------------------------------------------------------
+    /// Get the current time on the monotonic clock, for frame pacing and
+    /// profiling. Unlike 'getMilliseconds', it has nanosecond resolution and
+    /// doesn't wrap.
+    ///-------------------------------------------------------------------------
+    virtual TimePoint getTime() const;
+
     ///-------------------------------------------------------------------------
     /// Get oldest event on the event queue.
     ///
@@ -78,12 +100,38 @@ class Platform {
     /// here.
     /// \returns True if there is an event to get, false if there is not.
     ///-------------------------------------------------------------------------
-    virtual bool getNextEvent(PlatformEvent *event) = 0;
+    bool getNextEvent(PlatformEvent *event);
 
     ///-------------------------------------------------------------------------
-    /// Push an event onto the queue
+    /// Take up to \p maxEvents of the oldest events on the event queue,
+    /// fetching new events from the operating system if none are waiting.
+    ///
+    /// \returns Number of events written to \p events.
     ///-------------------------------------------------------------------------
-    void queueEvent(const PlatformEvent &event);
+    size_t pollEvents(PlatformEvent *events, size_t maxEvents);
+
+    ///-------------------------------------------------------------------------
+    /// Push an event onto the queue.
+    ///
+    /// \returns False if the queue is full, in which case the event is
+    /// dropped.
+    ///-------------------------------------------------------------------------
+    bool queueEvent(const PlatformEvent &event);
+
+    ///-------------------------------------------------------------------------
+    /// Push a text input event onto the queue, copying \p text into the text
+    /// arena.
+    ///
+    /// \returns False if the queue or the text arena is full, in which case
+    /// the event is dropped.
+    ///-------------------------------------------------------------------------
+    bool queueTextEvent(uint32_t time, const char *text, size_t textLength);
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of events dropped because the queue or the text arena
+    /// was full.
+    ///-------------------------------------------------------------------------
+    size_t getNumDroppedEvents() const;
 
     ///-------------------------------------------------------------------------
     /// Start interpreting keyboard events as text entry.
@@ -110,7 +158,28 @@ class Platform {
     // static Platform *getSingletonPtr();
 
   protected:
-    typedef std::queue<PlatformEvent> EventQueue;
-    EventQueue queue;
+    Platform();
+
+    ///-------------------------------------------------------------------------
+    /// Translate waiting operating system events and queue them with
+    /// 'queueEvent' and 'queueTextEvent'. Called when the queue is empty.
+    ///-------------------------------------------------------------------------
+    virtual void pumpEvents() = 0;
+
+    ///-------------------------------------------------------------------------
+    /// \returns Number of events that can be queued before the queue is full.
+    ///-------------------------------------------------------------------------
+    size_t getNumFreeEvents() const;
+
+  private:
+    // Ring of waiting events, the oldest at 'eventHead'
+    PlatformEvent events[PLATFORM_EVENT_QUEUE_SIZE];
+    size_t eventHead;
+    size_t numEvents;
+    size_t numDroppedEvents;
+
+    // Text of waiting text input events, emptied along with the queue
+    char textArena[PLATFORM_TEXT_ARENA_SIZE];
+    size_t textArenaSize;
 };
 }
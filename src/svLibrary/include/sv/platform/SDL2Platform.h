@@ -26,9 +26,6 @@ class SDL2Platform : public Platform {
     /// \copydoc Platform::getMilliseconds()
     virtual uint32_t getMilliseconds() const;
 
-    /// \copydoc Platform::getNextEvent()
-    virtual bool getNextEvent(PlatformEvent *event);
-
     /// \copydoc Platform::startTextInput()
     virtual void startTextInput();
 
@@ -37,5 +34,9 @@ class SDL2Platform : public Platform {
 
     /// \copydoc Platform::isTextInputActive()
     virtual bool isTextInputActive() const;
+
+  protected:
+    /// \copydoc Platform::pumpEvents()
+    virtual void pumpEvents();
 };
 }
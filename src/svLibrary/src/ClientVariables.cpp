@@ -1,30 +1,450 @@
 #include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <sstream>
 
 #include <sv/ClientVariables.h>
+#include <sv/Globals.h>
+#include <sv/console/Console.h>
+#include <sv/network/Stream.h>
 
 namespace sv {
+namespace {
+// Parse all of \p value as a number, without leading whitespace
+bool parseNumber(const std::string &value, double *valueOut) {
+    if (value.empty() || std::isspace((unsigned char)value[0])) {
+        return false;
+    }
+
+    errno           = 0;
+    char *end       = nullptr;
+    double parsed   = std::strtod(value.c_str(), &end);
+    bool wholeValue = end == value.c_str() + value.size();
+    if (!wholeValue || errno == ERANGE || std::isnan(parsed)) {
+        return false;
+    }
+
+    *valueOut = parsed;
+    return true;
+}
+
+bool parseInteger(const std::string &value, double *valueOut) {
+    if (value.empty() || std::isspace((unsigned char)value[0])) {
+        return false;
+    }
+
+    errno           = 0;
+    char *end       = nullptr;
+    long parsed     = std::strtol(value.c_str(), &end, 10);
+    bool wholeValue = end == value.c_str() + value.size();
+    if (!wholeValue || errno == ERANGE) {
+        return false;
+    }
+
+    *valueOut = (double)parsed;
+    return true;
+}
+
+int clampToInt(double value) {
+    if (value <= (double)std::numeric_limits<int>::min()) {
+        return std::numeric_limits<int>::min();
+    } else if (value >= (double)std::numeric_limits<int>::max()) {
+        return std::numeric_limits<int>::max();
+    }
+
+    return (int)value;
+}
+
+// Nine significant digits, so the value reads back (e.g. on a client or
+// from the archive) as exactly the same float
+std::string formatFloat(float value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+std::string formatInt(int value) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%d", value);
+    return buffer;
+}
+
+// Longest name and value that can be replicated
+const size_t MAX_REPLICATED_NAME_SIZE  = 255;
+const size_t MAX_REPLICATED_VALUE_SIZE = 65535;
+
+// Bytes used by a replicated variable: name size, name, value size, value
+size_t getReplicatedSize(const ClientVariable &variable) {
+    return 1 + variable.name.size() + 2 + variable.value.size();
+}
+
+// Quote \p value so the console reads it back as one token, \returns false
+// if it can't be
+bool quoteArgument(const std::string &value, std::string *quotedOut) {
+    if (value.find_first_of("\n\r") != std::string::npos) {
+        return false;
+    }
+
+    char quote = '"';
+    if (value.find('"') != std::string::npos) {
+        if (value.find('\'') != std::string::npos) {
+            return false;
+        }
+        quote = '\'';
+    }
+
+    *quotedOut = quote + value + quote;
+    return true;
+}
+}
+
+ClientVariables::ClientVariables()
+    : nameIndex(nullptr), cheatsEnabled(false), archiveSaveInterval(0.0f),
+      archiveTimer(0.0f), archiveDirty(false) {
+    svCommandTableInit(&variableTable);
+}
+
+ClientVariables::~ClientVariables() {
+    if (archiveDirty && !archivePath.empty()) {
+        saveArchive();
+    }
+
+    setNameIndex(nullptr);
+    svCommandTableFree(&variableTable);
+}
+
+CVar ClientVariables::registerInt(const std::string &name, int defaultValue,
+                                  int minValue, int maxValue,
+                                  uint32_t flags) {
+    return registerVariable(name, ClientVariableType::Enum::Int, minValue,
+                            maxValue, formatInt(defaultValue), flags);
+}
+
+CVar ClientVariables::registerFloat(const std::string &name,
+                                    float defaultValue, float minValue,
+                                    float maxValue, uint32_t flags) {
+    return registerVariable(name, ClientVariableType::Enum::Float, minValue,
+                            maxValue, formatFloat(defaultValue), flags);
+}
+
+CVar ClientVariables::registerString(const std::string &name,
+                                     const std::string &defaultValue,
+                                     uint32_t flags) {
+    return registerVariable(name, ClientVariableType::Enum::String, 0.0, 0.0,
+                            defaultValue, flags);
+}
+
+CVar ClientVariables::find(const std::string &name) const {
+    ClientVariable *variable = findVariable(name);
+    if (variable == nullptr || !variable->registered) {
+        return CVar();
+    }
+
+    return CVar(variable);
+}
+
+bool ClientVariables::set(CVar cvar, const std::string &value) {
+    if (!cvar.isValid() || !isWritable(*cvar.variable)) {
+        return false;
+    }
+
+    ClientVariable &variable = *cvar.variable;
+    std::string oldValue     = variable.value;
+    if (!assign(variable, value)) {
+        return false;
+    }
+    changed(variable, oldValue);
+
+    return true;
+}
+
+bool ClientVariables::setInt(CVar cvar, int value) {
+    if (!cvar.isValid() ||
+        cvar.variable->type == ClientVariableType::Enum::String) {
+        return set(cvar, formatInt(value));
+    }
+
+    if (!isWritable(*cvar.variable)) {
+        return false;
+    }
+
+    ClientVariable &variable = *cvar.variable;
+    std::string oldValue     = variable.value;
+    assignNumber(variable, value);
+    changed(variable, oldValue);
+
+    return true;
+}
+
+bool ClientVariables::setFloat(CVar cvar, float value) {
+    if (!cvar.isValid() ||
+        cvar.variable->type == ClientVariableType::Enum::String) {
+        return set(cvar, formatFloat(value));
+    }
+
+    if (!isWritable(*cvar.variable) || std::isnan(value)) {
+        return false;
+    }
+
+    ClientVariable &variable = *cvar.variable;
+    std::string oldValue     = variable.value;
+    assignNumber(variable, value);
+    changed(variable, oldValue);
+
+    return true;
+}
+
+void ClientVariables::reset(CVar cvar) {
+    if (cvar.isValid()) {
+        ClientVariable &variable = *cvar.variable;
+        std::string oldValue     = variable.value;
+        assign(variable, variable.defaultValue);
+        changed(variable, oldValue);
+    }
+}
+
+void ClientVariables::setCallback(CVar cvar,
+                                  const ClientVariableCallback &callback) {
+    if (cvar.isValid()) {
+        cvar.variable->callback = callback;
+    }
+}
+
+void ClientVariables::setCheatsEnabled(bool enabled) {
+    cheatsEnabled = enabled;
+
+    if (!enabled) {
+        for (ClientVariable &variable : variables) {
+            if (variable.registered &&
+                (variable.flags & ClientVariableFlags::Enum::Cheat)) {
+                reset(CVar(&variable));
+            }
+        }
+    }
+}
+
+bool ClientVariables::areCheatsEnabled() const { return cheatsEnabled; }
+
+void ClientVariables::queueAllReplicated() {
+    for (size_t i = 0; i < variables.size(); ++i) {
+        ClientVariable &variable = variables[i];
+        if (variable.registered &&
+            (variable.flags & ClientVariableFlags::Enum::Replicated) &&
+            !variable.replicationQueued) {
+            variable.replicationQueued = true;
+            replicationQueue.push_back((int)i);
+        }
+    }
+}
+
+size_t ClientVariables::getNumQueuedReplicated() const {
+    return replicationQueue.size();
+}
+
+size_t ClientVariables::writeReplicated(void *buffer, size_t bufferSize) {
+    // Drop variables too big to ever be sent
+    for (auto it = replicationQueue.begin(); it != replicationQueue.end();) {
+        ClientVariable &variable = variables[*it];
+        if (variable.name.size() > MAX_REPLICATED_NAME_SIZE ||
+            variable.value.size() > MAX_REPLICATED_VALUE_SIZE) {
+            sv::globals::log(LogArea::Enum::Common, LogLevel::Enum::Warning,
+                             "Client variable '" + variable.name +
+                                 "' is too big to replicate.");
+            variable.replicationQueued = false;
+            it                         = replicationQueue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Find how many queued variables fit after the count
+    size_t count = 0;
+    size_t size  = 2;
+    while (count < replicationQueue.size() &&
+           count < std::numeric_limits<uint16_t>::max()) {
+        size_t variableSize =
+            getReplicatedSize(variables[replicationQueue[count]]);
+        if (size + variableSize > bufferSize) {
+            break;
+        }
+        size += variableSize;
+        ++count;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    net::WriteStream stream(buffer, bufferSize);
+    stream.writeUint16((uint16_t)count);
+    for (size_t i = 0; i < count; ++i) {
+        ClientVariable &variable   = variables[replicationQueue.front()];
+        variable.replicationQueued = false;
+        replicationQueue.pop_front();
+
+        stream.writeUint8((uint8_t)variable.name.size());
+        stream.writeBytes(variable.name.data(), variable.name.size());
+        stream.writeUint16((uint16_t)variable.value.size());
+        stream.writeBytes(variable.value.data(), variable.value.size());
+    }
+
+    return stream.getBytesWritten();
+}
+
+bool ClientVariables::readReplicated(const void *data, size_t dataSize) {
+    net::ReadStream stream(data, dataSize);
+
+    uint16_t count = 0;
+    if (!stream.readUint16(&count)) {
+        return false;
+    }
+
+    std::string name;
+    std::string value;
+    for (uint16_t i = 0; i < count; ++i) {
+        uint8_t nameSize   = 0;
+        uint16_t valueSize = 0;
+        if (!stream.readUint8(&nameSize)) {
+            return false;
+        }
+        name.resize(nameSize);
+        if (!stream.readBytes(&name[0], nameSize) ||
+            !stream.readUint16(&valueSize)) {
+            return false;
+        }
+        value.resize(valueSize);
+        if (!stream.readBytes(&value[0], valueSize)) {
+            return false;
+        }
+
+        // Only variables this side replicates too, the server can't set or
+        // create anything else
+        ClientVariable *variable = findVariable(name);
+        if (variable == nullptr || !variable->registered ||
+            !(variable->flags & ClientVariableFlags::Enum::Replicated)) {
+            continue;
+        }
+
+        // The server decides, but the change isn't sent back
+        std::string oldValue = variable->value;
+        if (!assign(*variable, value)) {
+            sv::globals::log(LogArea::Enum::Common, LogLevel::Enum::Warning,
+                             "Replicated client variable '" + name +
+                                 "' can't be '" + value + "'.");
+        }
+        changed(*variable, oldValue, false);
+    }
+
+    return true;
+}
+
+void ClientVariables::setArchiveFile(const std::string &path,
+                                     float saveInterval) {
+    archivePath         = path;
+    archiveSaveInterval = saveInterval;
+    archiveTimer        = 0.0f;
+}
+
+void ClientVariables::update(float deltaTime) {
+    if (!archiveDirty || archiveSaveInterval <= 0.0f || archivePath.empty()) {
+        return;
+    }
+
+    archiveTimer += deltaTime;
+    if (archiveTimer >= archiveSaveInterval) {
+        saveArchive();
+    }
+}
+
+bool ClientVariables::saveArchive() {
+    if (archivePath.empty()) {
+        return false;
+    }
+
+    // Build the whole file first so it is written at once
+    std::string contents;
+    for (int index : archivedVariables) {
+        const ClientVariable &variable = variables[index];
+
+        std::string name;
+        std::string value;
+        if (!quoteArgument(variable.name, &name) ||
+            !quoteArgument(variable.value, &value)) {
+            sv::globals::log(LogArea::Enum::Common, LogLevel::Enum::Warning,
+                             "Client variable '" + variable.name +
+                                 "' can't be archived.");
+            continue;
+        }
+
+        contents += "set " + name + " " + value + "\n";
+    }
+
+    // Try again at the next interval if this fails
+    archiveTimer = 0.0f;
+
+    std::ofstream file(archivePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        sv::globals::log(LogArea::Enum::Common, LogLevel::Enum::Error,
+                         "Failed to open archive file '" + archivePath + "'.");
+        return false;
+    }
+
+    file.write(contents.data(), contents.size());
+    if (!file.good()) {
+        sv::globals::log(LogArea::Enum::Common, LogLevel::Enum::Error,
+                         "Failed to write archive file '" + archivePath +
+                             "'.");
+        return false;
+    }
+
+    archiveDirty = false;
+
+    return true;
+}
+
+bool ClientVariables::isArchiveDirty() const { return archiveDirty; }
+
+void ClientVariables::setNameIndex(svPrefixIndex *index) {
+    for (const ClientVariable &variable : variables) {
+        // Removed variables leave empty slots
+        if (variable.name.empty()) {
+            continue;
+        }
+        if (nameIndex != nullptr) {
+            svPrefixIndexRemove(nameIndex, variable.name.c_str(),
+                                ConsoleNameKind::Enum::Variable);
+        }
+        if (index != nullptr) {
+            svPrefixIndexInsert(index, variable.name.c_str(),
+                                ConsoleNameKind::Enum::Variable);
+        }
+    }
+
+    nameIndex = index;
+}
+
 bool ClientVariables::getFloatValue(const std::string &variableName,
                                     float *valueOut) const {
     bool result = false;
 
     if (valueOut != nullptr) {
-        // Find variable
-        std::vector<ClientVariable>::const_iterator it =
-            std::find_if(variables.begin(), variables.end(),
-                         [&](const ClientVariable &varIt) {
-                             return varIt.name == variableName;
-                         });
+        const ClientVariable *variable = findVariable(variableName);
 
-        // If found
-        if (it != variables.end()) {
-            // Check if valid float
-            if (isFloat(it->value)) {
-                // Set valueOut
-                std::istringstream iss(it->value);
-                iss >> std::noskipws >> *valueOut;
-                result = true;
-            }
+        if (variable != nullptr && variable->registered &&
+            variable->type != ClientVariableType::Enum::String) {
+            *valueOut = variable->floatValue;
+            result    = true;
+        }
+        // Check if valid float
+        else if (variable != nullptr && isFloat(variable->value)) {
+            // Set valueOut
+            std::istringstream iss(variable->value);
+            iss >> std::noskipws >> *valueOut;
+            result = true;
         }
     }
 
@@ -36,22 +456,19 @@ bool ClientVariables::getIntValue(const std::string &variableName,
     bool result = false;
 
     if (valueOut != nullptr) {
-        // Find variable
-        std::vector<ClientVariable>::const_iterator it =
-            std::find_if(variables.begin(), variables.end(),
-                         [&](const ClientVariable &varIt) {
-                             return varIt.name == variableName;
-                         });
+        const ClientVariable *variable = findVariable(variableName);
 
-        // If found
-        if (it != variables.end()) {
-            // Check if valid int
-            if (isInt(it->value)) {
-                // Set valueOut
-                std::istringstream iss(it->value);
-                iss >> std::noskipws >> *valueOut;
-                result = true;
-            }
+        if (variable != nullptr && variable->registered &&
+            variable->type == ClientVariableType::Enum::Int) {
+            *valueOut = variable->intValue;
+            result    = true;
+        }
+        // Check if valid int
+        else if (variable != nullptr && isInt(variable->value)) {
+            // Set valueOut
+            std::istringstream iss(variable->value);
+            iss >> std::noskipws >> *valueOut;
+            result = true;
         }
     }
 
@@ -63,17 +480,12 @@ bool ClientVariables::getStringValue(const std::string &variableName,
     bool result = false;
 
     if (valueOut != nullptr) {
-        // Find variable
-        std::vector<ClientVariable>::const_iterator it =
-            std::find_if(variables.begin(), variables.end(),
-                         [&](const ClientVariable &varIt) {
-                             return varIt.name == variableName;
-                         });
+        const ClientVariable *variable = findVariable(variableName);
 
         // If found
-        if (it != variables.end()) {
+        if (variable != nullptr) {
             // Set valueOut
-            *valueOut = it->value;
+            *valueOut = variable->value;
             result    = true;
         }
     }
@@ -81,76 +493,225 @@ bool ClientVariables::getStringValue(const std::string &variableName,
     return result;
 }
 
-void ClientVariables::setFloatValue(const std::string &variableName,
+bool ClientVariables::setFloatValue(const std::string &variableName,
                                     float value) {
+    ClientVariable *variable = findVariable(variableName);
+    if (variable != nullptr && variable->registered) {
+        return setFloat(CVar(variable), value);
+    }
+
     // Convert float to string
     std::ostringstream buffer;
     buffer << value;
 
-    // Try to find existing variable with given name
-    std::vector<ClientVariable>::iterator it = std::find_if(
-        variables.begin(), variables.end(), [&](const ClientVariable &varIt) {
-            return varIt.name == variableName;
-        });
+    return setStringValue(variableName, buffer.str());
+}
 
-    // If found, set it's value
-    if (it != variables.end()) {
-        it->value = buffer.str();
+bool ClientVariables::setIntValue(const std::string &variableName, int value) {
+    ClientVariable *variable = findVariable(variableName);
+    if (variable != nullptr && variable->registered) {
+        return setInt(CVar(variable), value);
     }
-    // Else create new client variable
-    else {
-        variables.push_back(ClientVariable(variableName, buffer.str()));
-    }
-}
 
-void ClientVariables::setIntValue(const std::string &variableName, int value) {
     // Convert int to string
     std::ostringstream buffer;
     buffer << value;
 
+    return setStringValue(variableName, buffer.str());
+}
+
+bool ClientVariables::setStringValue(const std::string &variableName,
+                                     const std::string &value) {
     // Try to find existing variable with given name
-    std::vector<ClientVariable>::iterator it = std::find_if(
-        variables.begin(), variables.end(), [&](const ClientVariable &varIt) {
-            return varIt.name == variableName;
-        });
+    ClientVariable *variable = findVariable(variableName);
 
+    // If registered, it decides what values it takes
+    if (variable != nullptr && variable->registered) {
+        return set(CVar(variable), value);
+    }
     // If found, set it's value
-    if (it != variables.end()) {
-        it->value = buffer.str();
+    else if (variable != nullptr) {
+        variable->value = value;
     }
     // Else create new client variable
     else {
-        variables.push_back(ClientVariable(variableName, buffer.str()));
+        addVariable(variableName, value);
     }
+
+    return true;
 }
 
-void ClientVariables::setStringValue(const std::string &variableName,
-                                     const std::string &value) {
-    // Try to find existing variable with given name
-    std::vector<ClientVariable>::iterator it = std::find_if(
-        variables.begin(), variables.end(), [&](const ClientVariable &varIt) {
-            return varIt.name == variableName;
-        });
+void ClientVariables::removeVariable(const std::string &variableName) {
+    int index = svCommandTableRemove(&variableTable, variableName.c_str());
+    if (index >= 0) {
+        if (nameIndex != nullptr) {
+            svPrefixIndexRemove(nameIndex, variableName.c_str(),
+                                ConsoleNameKind::Enum::Variable);
+        }
+        if (variables[index].replicationQueued) {
+            replicationQueue.erase(std::find(replicationQueue.begin(),
+                                             replicationQueue.end(), index));
+        }
+        if (variables[index].flags & ClientVariableFlags::Enum::Archive) {
+            archivedVariables.erase(std::find(archivedVariables.begin(),
+                                              archivedVariables.end(), index));
+        }
 
-    // If found, set it's value
-    if (it != variables.end()) {
-        it->value = value;
+        // Keep the slot so other variables don't move, it's reused by the
+        // next variable added
+        variables[index] = ClientVariable();
+        freeVariables.push_back(index);
     }
-    // Else create new client variable
-    else {
-        variables.push_back(ClientVariable(variableName, value));
+}
+
+ClientVariable *ClientVariables::findVariable(const std::string &name) const {
+    int index = svCommandTableFind(&variableTable, name.c_str());
+    if (index < 0) {
+        return nullptr;
+    }
+
+    return const_cast<ClientVariable *>(&variables[index]);
+}
+
+ClientVariable *ClientVariables::addVariable(const std::string &name,
+                                             const std::string &value) {
+    int index = 0;
+    if (!freeVariables.empty()) {
+        index = freeVariables.back();
+        freeVariables.pop_back();
+    } else {
+        index = (int)variables.size();
+        variables.push_back(ClientVariable());
     }
+
+    variables[index] = ClientVariable(name, value);
+    svCommandTableInsert(&variableTable, name.c_str(), index);
+    if (nameIndex != nullptr) {
+        svPrefixIndexInsert(nameIndex, name.c_str(),
+                            ConsoleNameKind::Enum::Variable);
+    }
+
+    return &variables[index];
 }
 
-void ClientVariables::removeVariable(const std::string &variableName) {
-    for (size_t i = 0; i < variables.size(); ++i) {
-        if (variables[i].name == variableName) {
-            // Copy last element to this element (element to be removed) and pop
-            // last element off vector
-            variables[i] = variables[variables.size() - 1];
-            variables.pop_back();
+CVar ClientVariables::registerVariable(const std::string &name,
+                                       ClientVariableType::Enum type,
+                                       double minValue, double maxValue,
+                                       const std::string &defaultValue,
+                                       uint32_t flags) {
+    ClientVariable *variable = findVariable(name);
+
+    if (variable != nullptr && variable->registered) {
+        if (variable->type != type) {
+            sv::globals::log(LogArea::Enum::Common, LogLevel::Enum::Error,
+                             "Client variable '" + name +
+                                 "' already registered with another type.");
+            return CVar();
         }
+
+        return CVar(variable);
     }
+
+    // Value set before the variable was registered, e.g. by a config file
+    std::string setValue;
+    bool wasSet = variable != nullptr;
+    if (wasSet) {
+        setValue = variable->value;
+    } else {
+        variable = addVariable(name, defaultValue);
+    }
+
+    variable->registered   = true;
+    variable->type         = type;
+    variable->minValue     = minValue;
+    variable->maxValue     = maxValue;
+    variable->defaultValue = defaultValue;
+    variable->flags        = flags;
+
+    assign(*variable, defaultValue);
+    if (wasSet && !(flags & ClientVariableFlags::Enum::ReadOnly) &&
+        !assign(*variable, setValue)) {
+        sv::globals::log(LogArea::Enum::Common, LogLevel::Enum::Warning,
+                         "Client variable '" + name + "' can't be '" +
+                             setValue + "', using default value.");
+    }
+    variable->dirty = variable->value != variable->defaultValue;
+
+    int index = svCommandTableFind(&variableTable, name.c_str());
+    if (flags & ClientVariableFlags::Enum::Archive) {
+        archivedVariables.push_back(index);
+    }
+    if ((flags & ClientVariableFlags::Enum::Replicated) && variable->dirty) {
+        variable->replicationQueued = true;
+        replicationQueue.push_back(index);
+    }
+
+    return CVar(variable);
+}
+
+bool ClientVariables::assign(ClientVariable &variable,
+                             const std::string &value) {
+    bool result = true;
+
+    if (variable.type == ClientVariableType::Enum::String) {
+        variable.value = value;
+    } else {
+        double number = 0.0;
+        result        = (variable.type == ClientVariableType::Enum::Int)
+                     ? parseInteger(value, &number)
+                     : parseNumber(value, &number);
+        if (result) {
+            assignNumber(variable, number);
+        }
+    }
+
+    return result;
+}
+
+void ClientVariables::assignNumber(ClientVariable &variable, double value) {
+    value = std::max(variable.minValue, std::min(variable.maxValue, value));
+
+    if (variable.type == ClientVariableType::Enum::Int) {
+        variable.intValue   = clampToInt(value);
+        variable.floatValue = (float)variable.intValue;
+        variable.value      = formatInt(variable.intValue);
+    } else {
+        variable.floatValue = (float)value;
+        variable.intValue   = clampToInt(variable.floatValue);
+        variable.value      = formatFloat(variable.floatValue);
+    }
+}
+
+void ClientVariables::changed(ClientVariable &variable,
+                              const std::string &oldValue, bool replicate) {
+    if (variable.value != oldValue) {
+        variable.dirty = true;
+
+        if (variable.flags & ClientVariableFlags::Enum::Archive) {
+            if (!archiveDirty) {
+                archiveTimer = 0.0f;
+            }
+            archiveDirty = true;
+        }
+        if (replicate &&
+            (variable.flags & ClientVariableFlags::Enum::Replicated) &&
+            !variable.replicationQueued) {
+            variable.replicationQueued = true;
+            // Handles point into 'variables', a deque, so this is its index
+            replicationQueue.push_back(
+                svCommandTableFind(&variableTable, variable.name.c_str()));
+        }
+
+        if (variable.callback) {
+            variable.callback(variable);
+        }
+    }
+}
+
+bool ClientVariables::isWritable(const ClientVariable &variable) const {
+    uint32_t flags = variable.flags;
+    return !(flags & ClientVariableFlags::Enum::ReadOnly) &&
+           (cheatsEnabled || !(flags & ClientVariableFlags::Enum::Cheat));
 }
 
 bool isFloat(const std::string &value) {
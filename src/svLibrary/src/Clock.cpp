@@ -0,0 +1,73 @@
+#include <thread>
+
+#include <sv/Clock.h>
+#include <sv/System.h>
+
+#if SV_PLATFORM_POSIX
+#include <errno.h>
+#include <time.h>
+#elif SV_PLATFORM_WINDOWS
+#include <windows.h>
+#endif
+
+namespace sv {
+namespace Clock {
+TimePoint now() {
+#if SV_PLATFORM_POSIX
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return TimePoint((int64_t)t.tv_sec * 1000000000 + t.tv_nsec);
+#elif SV_PLATFORM_WINDOWS
+    static LARGE_INTEGER frequency = []() {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return f;
+    }();
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    // Split to avoid overflowing when multiplying by 1e9
+    const int64_t seconds = counter.QuadPart / frequency.QuadPart;
+    const int64_t rest    = counter.QuadPart % frequency.QuadPart;
+    return TimePoint(seconds * 1000000000 +
+                     rest * 1000000000 / frequency.QuadPart);
+#endif
+}
+}
+
+void sleepUntil(TimePoint deadline, int64_t spinNanoseconds) {
+    const TimePoint wake = deadline - spinNanoseconds;
+
+#if SV_PLATFORM_LINUX
+    if (Clock::now() < wake) {
+        struct timespec t;
+        t.tv_sec  = (time_t)(wake.nanoseconds / 1000000000);
+        t.tv_nsec = (long)(wake.nanoseconds % 1000000000);
+        // Woken early by a signal, sleep the rest
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) ==
+               EINTR) {
+        }
+    }
+#elif SV_PLATFORM_POSIX
+    int64_t remaining = wake - Clock::now();
+    while (remaining > 0) {
+        struct timespec t;
+        t.tv_sec  = (time_t)(remaining / 1000000000);
+        t.tv_nsec = (long)(remaining % 1000000000);
+        nanosleep(&t, NULL);
+        remaining = wake - Clock::now();
+    }
+#elif SV_PLATFORM_WINDOWS
+    const int64_t remaining = wake - Clock::now();
+    if (remaining > 0) {
+        Sleep((DWORD)(remaining / 1000000));
+    }
+#endif
+
+    // Yield rather than burn the core, other threads may need it
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+}
@@ -2,6 +2,7 @@
 #include <sv/System.h>
 
 #if SV_PLATFORM_POSIX
+#include <errno.h>
 #include <time.h>
 #elif SV_PLATFORM_WINDOWS
 #endif
@@ -78,8 +79,13 @@ void sleep(float seconds) {
 #if SV_PLATFORM_POSIX
         struct timespec t;
         t.tv_sec  = (time_t)seconds;
-        t.tv_nsec = 0;
-        nanosleep(&t, NULL);
+        t.tv_nsec = (long)((seconds - (float)t.tv_sec) * 1e9f);
+        if (t.tv_nsec > 999999999) {
+            t.tv_nsec = 999999999;
+        }
+        // Woken early by a signal, sleep the rest
+        while (nanosleep(&t, &t) != 0 && errno == EINTR) {
+        }
 #elif SV_PLATFORM_WINDOWS
         Sleep((int)(seconds * 1000.0f));
 #endif
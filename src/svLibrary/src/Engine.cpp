@@ -1,19 +1,46 @@
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <sstream>
 
 #include <sv/Engine.h>
+#include <sv/FixedTimestep.h>
 #include <sv/Globals.h>
 #include <sv/ProgramOptions.h>
+#include <sv/platform/NullPlatform.h>
 #include <sv/platform/SDL2Platform.h>
 
 namespace sv {
+namespace {
+// Add the phase times of \p frame to \p stats
+void addFrameTimes(const EngineFrameTimes &frame, EngineRunStats *stats) {
+    EngineFrameTimes &total   = stats->total;
+    EngineFrameTimes &longest = stats->longest;
+
+    total.events += frame.events;
+    total.simulation += frame.simulation;
+    total.render += frame.render;
+    total.wait += frame.wait;
+    total.frame += frame.frame;
+
+    longest.events     = std::max(longest.events, frame.events);
+    longest.simulation = std::max(longest.simulation, frame.simulation);
+    longest.render     = std::max(longest.render, frame.render);
+    longest.wait       = std::max(longest.wait, frame.wait);
+    longest.frame      = std::max(longest.frame, frame.frame);
+
+    stats->last = frame;
+}
+}
+
 Engine::Engine() {
     isInitialized = false;
-    platform      = std::shared_ptr<Platform>(new SDL2Platform());
+    quitRequested = false;
 }
 
 Engine::~Engine() {
     if (isInitialized == true) {
+        jobSystem.shutdown();
         platform->shutdown();
     }
 }
@@ -23,6 +50,25 @@ bool Engine::initialize(int argc, char *argv[]) {
 
     ProgramOptions options(argc, (const char **)argv);
 
+    // Dedicated servers and benchmarks run without a display, and without
+    // starting SDL at all
+    if (options.checkOption("--headless") >= 0) {
+        platform = std::shared_ptr<Platform>(new NullPlatform());
+    } else {
+        platform = std::shared_ptr<Platform>(new SDL2Platform());
+    }
+
+    int numJobThreads         = -1;
+    int32_t jobThreadsIndex   = options.checkOption("--jobthreads");
+    const char *jobThreadsArg = nullptr;
+    if (jobThreadsIndex >= 0) {
+        jobThreadsArg = options.getOption(jobThreadsIndex + 1);
+    }
+    if (jobThreadsArg != nullptr) {
+        numJobThreads = std::atoi(jobThreadsArg);
+    }
+    isInitialized &= jobSystem.initialize(numJobThreads);
+
     // Find game to load
     // std::string game("default");
     // int32_t optionIndex = options.checkOption("--game");
@@ -48,4 +94,92 @@ uint32_t Engine::getMilliseconds() const {
     assert(isInitialized == true);
     return platform->getMilliseconds();
 }
+
+TimePoint Engine::getTime() const {
+    assert(isInitialized == true);
+    return platform->getTime();
+}
+
+bool Engine::run(EngineCallbacks &callbacks, const EngineRunOptions &options) {
+    if (isInitialized == false || options.tickRate <= 0.0 ||
+        options.maxTicksPerFrame <= 0 || options.frameRate < 0.0) {
+        return false;
+    }
+
+    FixedTimestep timestep(secondsToNanoseconds(1.0 / options.tickRate),
+                           options.maxTicksPerFrame);
+    int64_t frameNanoseconds = 0;
+    if (options.frameRate > 0.0) {
+        frameNanoseconds = secondsToNanoseconds(1.0 / options.frameRate);
+    }
+
+    quitRequested = false;
+    runStats      = EngineRunStats();
+
+    TimePoint frameStart = platform->getTime();
+    TimePoint deadline   = frameStart + frameNanoseconds;
+    TimePoint lastFrame  = frameStart;
+    while (quitRequested == false &&
+           (options.maxFrames == 0 || runStats.numFrames < options.maxFrames)) {
+        EngineFrameTimes times;
+
+        if (client.update(*platform) == false) {
+            quitRequested = true;
+            break;
+        }
+        jobSystem.executeMainThreadJobs();
+        TimePoint eventsEnd = platform->getTime();
+        times.events        = eventsEnd - frameStart;
+
+        // Simulate the time since the last frame started
+        const int numTicks = timestep.advance(frameStart - lastFrame);
+        lastFrame          = frameStart;
+        for (int i = 0; i < numTicks; ++i) {
+            callbacks.tick(*this, timestep.getTickSeconds());
+            ++runStats.numTicks;
+        }
+        TimePoint simulationEnd = platform->getTime();
+        times.simulation        = simulationEnd - eventsEnd;
+
+        callbacks.render(*this, timestep.getAlpha());
+        TimePoint renderEnd = platform->getTime();
+        times.render        = renderEnd - simulationEnd;
+
+        TimePoint frameEnd = renderEnd;
+        if (frameNanoseconds > 0) {
+            sleepUntil(deadline);
+            frameEnd = platform->getTime();
+
+            // After a frame longer than a whole frame, pace from now rather
+            // than rushing frames to catch up
+            deadline = deadline + frameNanoseconds;
+            if (frameEnd > deadline) {
+                deadline = frameEnd + frameNanoseconds;
+            }
+        }
+        times.wait  = frameEnd - renderEnd;
+        times.frame = frameEnd - frameStart;
+
+        ++runStats.numFrames;
+        runStats.numDroppedTicks = timestep.getNumDroppedTicks();
+        addFrameTimes(times, &runStats);
+
+        frameStart = frameEnd;
+    }
+
+    return true;
+}
+
+void Engine::quit() { quitRequested = true; }
+
+const EngineRunStats &Engine::getRunStats() const { return runStats; }
+
+Platform &Engine::getPlatform() {
+    assert(isInitialized == true);
+    return *platform;
+}
+
+Client &Engine::getClient() { return client; }
+
+JobSystem &Engine::getJobSystem() { return jobSystem; }
 }
@@ -0,0 +1,42 @@
+#include <cassert>
+
+#include <sv/FixedTimestep.h>
+
+namespace sv {
+FixedTimestep::FixedTimestep(int64_t tickNanoseconds_, int maxTicksPerFrame_)
+    : tickNanoseconds(tickNanoseconds_), maxTicksPerFrame(maxTicksPerFrame_),
+      accumulator(0), numDroppedTicks(0) {
+    assert(tickNanoseconds > 0 && maxTicksPerFrame > 0);
+}
+
+int FixedTimestep::advance(int64_t elapsedNanoseconds) {
+    if (elapsedNanoseconds > 0) {
+        accumulator += elapsedNanoseconds;
+    }
+
+    int64_t numTicks = accumulator / tickNanoseconds;
+    accumulator -= numTicks * tickNanoseconds;
+
+    // Drop whole ticks beyond the cap, keeping the fraction for 'getAlpha'
+    if (numTicks > maxTicksPerFrame) {
+        numDroppedTicks += (uint64_t)(numTicks - maxTicksPerFrame);
+        numTicks = maxTicksPerFrame;
+    }
+
+    return (int)numTicks;
+}
+
+double FixedTimestep::getAlpha() const {
+    return (double)accumulator / (double)tickNanoseconds;
+}
+
+int64_t FixedTimestep::getTickNanoseconds() const { return tickNanoseconds; }
+
+double FixedTimestep::getTickSeconds() const {
+    return (double)tickNanoseconds * 1e-9;
+}
+
+uint64_t FixedTimestep::getNumDroppedTicks() const { return numDroppedTicks; }
+
+void FixedTimestep::reset() { accumulator = 0; }
+}
@@ -31,14 +31,29 @@ bool Client::initialize(const ProgramOptions &options) {
                 new UnbindAllCommand(input));
             std::shared_ptr<SetCommand> setCmd(new SetCommand(cvars));
             std::shared_ptr<EchoCommand> echoCmd(new EchoCommand());
+            std::shared_ptr<WaitCommand> waitCmd(new WaitCommand());
+            std::shared_ptr<AliasCommand> aliasCmd(new AliasCommand());
+            std::shared_ptr<UnaliasCommand> unaliasCmd(new UnaliasCommand());
             std::shared_ptr<ExecCommand> execCmd(
                 new ExecCommand(resourceCache));
+            std::shared_ptr<FindCommand> findCmd(new FindCommand());
+            std::shared_ptr<NetSimCommand> netSimCmd(
+                new NetSimCommand(simulator));
+            std::shared_ptr<NetStatsCommand> netStatsCmd(
+                new NetStatsCommand(connection));
 
             console.registerCommand("bind", bindCmd);
             console.registerCommand("unbindall", unbindAllCmd);
             console.registerCommand("set", setCmd);
             console.registerCommand("echo", echoCmd);
+            console.registerCommand("wait", waitCmd);
+            console.registerCommand("alias", aliasCmd);
+            console.registerCommand("unalias", unaliasCmd);
             console.registerCommand("exec", execCmd);
+            console.registerCommand("find", findCmd);
+            console.registerCommand("net_sim", netSimCmd);
+            console.registerCommand("net_stats", netStatsCmd);
+            cvars.setNameIndex(console.getNameIndex());
 
             // Load config file
             std::string configFilePath("config.cfg");
@@ -92,4 +107,17 @@ bool Client::initialize(const ProgramOptions &options) {
 
     return result;
 }
+
+bool Client::update(Platform &platform) {
+    dispatcher.dispatch(platform);
+
+    console.executeSubmitted();
+    console.executeBuffered(0, CLIENT_BUFFER_SECONDS);
+
+    return !dispatcher.wasQuitRequested();
+}
+
+Console &Client::getConsole() { return console; }
+
+InputDispatcher &Client::getInputDispatcher() { return dispatcher; }
 }
@@ -0,0 +1,169 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <sv/console/CommandTable.h>
+
+/* Marks the slot of a removed name, so probing continues past it */
+static char svCommandTableRemovedName;
+
+#define SV_COMMAND_TABLE_MIN_CAPACITY 16
+
+/**
+ * \returns Slot holding \p name, or the empty slot it would be inserted at if
+ * \p name is not in the table.
+ *
+ * \pre Table has at least one empty slot.
+ */
+static svCommandTableSlot *svCommandTableProbe(const svCommandTable *table,
+                                               const char *name,
+                                               unsigned int hash) {
+    unsigned int mask         = (unsigned int)table->capacity - 1;
+    unsigned int i            = hash & mask;
+    svCommandTableSlot *reuse = NULL;
+
+    for (;;) {
+        svCommandTableSlot *slot = table->slots + i;
+        if (slot->name == NULL) {
+            /* Not in the table, prefer reusing a removed name's slot */
+            return (reuse != NULL) ? reuse : slot;
+        } else if (slot->name == &svCommandTableRemovedName) {
+            if (reuse == NULL) {
+                reuse = slot;
+            }
+        } else if (slot->hash == hash && strcmp(slot->name, name) == 0) {
+            return slot;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+/**
+ * Move all names into a new array of \p capacity slots, dropping the slots of
+ * removed names.
+ *
+ * \returns 0 if no error, other if memory could not be allocated.
+ */
+static int svCommandTableResize(svCommandTable *table, int capacity) {
+    svCommandTableSlot *slots =
+        (svCommandTableSlot *)calloc(capacity, sizeof(svCommandTableSlot));
+    if (slots == NULL) {
+        return -1;
+    }
+
+    svCommandTableSlot *oldSlots = table->slots;
+    int oldCapacity              = table->capacity;
+
+    table->slots      = slots;
+    table->capacity   = capacity;
+    table->numRemoved = 0;
+
+    for (int i = 0; i < oldCapacity; ++i) {
+        svCommandTableSlot *slot = oldSlots + i;
+        if (slot->name != NULL && slot->name != &svCommandTableRemovedName) {
+            *svCommandTableProbe(table, slot->name, slot->hash) = *slot;
+        }
+    }
+
+    free(oldSlots);
+
+    return 0;
+}
+
+void svCommandTableInit(svCommandTable *table) {
+    table->slots      = NULL;
+    table->capacity   = 0;
+    table->count      = 0;
+    table->numRemoved = 0;
+}
+
+void svCommandTableFree(svCommandTable *table) {
+    for (int i = 0; i < table->capacity; ++i) {
+        char *name = table->slots[i].name;
+        if (name != NULL && name != &svCommandTableRemovedName) {
+            free(name);
+        }
+    }
+    free(table->slots);
+
+    svCommandTableInit(table);
+}
+
+unsigned int svCommandTableHash(const char *str) {
+    unsigned int hash = 2166136261u;
+    while (*str) {
+        hash ^= (unsigned char)*str;
+        hash *= 16777619u;
+        ++str;
+    }
+
+    return hash;
+}
+
+int svCommandTableFind(const svCommandTable *table, const char *name) {
+    if (table->count == 0) {
+        return -1;
+    }
+
+    svCommandTableSlot *slot =
+        svCommandTableProbe(table, name, svCommandTableHash(name));
+    if (slot->name == NULL || slot->name == &svCommandTableRemovedName) {
+        return -1;
+    }
+
+    return slot->value;
+}
+
+int svCommandTableInsert(svCommandTable *table, const char *name, int value) {
+    /* Keep at most three quarters of the slots in use so probes stay short */
+    if ((table->count + table->numRemoved + 1) * 4 > table->capacity * 3) {
+        int capacity = SV_COMMAND_TABLE_MIN_CAPACITY;
+        while ((table->count + 1) * 2 > capacity) {
+            capacity *= 2;
+        }
+        if (svCommandTableResize(table, capacity) != 0) {
+            return -1;
+        }
+    }
+
+    unsigned int hash        = svCommandTableHash(name);
+    svCommandTableSlot *slot = svCommandTableProbe(table, name, hash);
+    if (slot->name == NULL || slot->name == &svCommandTableRemovedName) {
+        size_t size = strlen(name) + 1; /* +1 for NULL-terminator */
+        char *copy  = (char *)malloc(size);
+        if (copy == NULL) {
+            return -1;
+        }
+        memcpy(copy, name, size);
+
+        if (slot->name == &svCommandTableRemovedName) {
+            --table->numRemoved;
+        }
+        slot->name = copy;
+        slot->hash = hash;
+        ++table->count;
+    }
+    slot->value = value;
+
+    return 0;
+}
+
+int svCommandTableRemove(svCommandTable *table, const char *name) {
+    if (table->count == 0) {
+        return -1;
+    }
+
+    svCommandTableSlot *slot =
+        svCommandTableProbe(table, name, svCommandTableHash(name));
+    if (slot->name == NULL || slot->name == &svCommandTableRemovedName) {
+        return -1;
+    }
+
+    int value = slot->value;
+    free(slot->name);
+    slot->name = &svCommandTableRemovedName;
+    --table->count;
+    ++table->numRemoved;
+
+    return value;
+}
@@ -157,6 +157,53 @@ int svCommandsSeparate(char *token[], svCommand command[],
     return 0;
 }
 
+int svCommandsSeparateInPlace(char *token[], svCommand command[],
+                              svCommandError *error) {
+    if (token == NULL) {
+        return 0;
+    }
+
+    int c     = 0;
+    int first = 0;
+    int i     = 0;
+    for (; token[i] != NULL; ++i) {
+        if (svCommandsIsSeparator(token[i])) {
+            if (i == first) {
+                /* Separator with no command before it */
+                if (error != NULL) {
+                    error->errorCode = (i == 0) ? -2 : -1;
+                    error->tokenPos  = (i == 0) ? 0 : i - 1;
+                }
+                return -1;
+            }
+
+            command[c].first = first;
+            command[c].last  = i - 1; /* Don't include separator */
+            command[c].sep   = token[i];
+            ++c;
+
+            /* Advance first index */
+            first = i + 1;
+        }
+    }
+
+    /* Last command need not be followed by a separator */
+    if (first < i) {
+        command[c].first = first;
+        command[c].last  = i - 1;
+        command[c].sep   = SV_SEP_SEQ;
+        ++c;
+    }
+
+    /* Token array is valid, terminate each command's arguments in place */
+    for (int j = 0; j < c; ++j) {
+        command[j].argv            = token + command[j].first;
+        token[command[j].last + 1] = NULL;
+    }
+
+    return c;
+}
+
 void svCommandsFreeContents(svCommand command[]) {
     svCommand *it = command;
     /* Iterate thru commands */
@@ -1,3 +1,5 @@
+#include <chrono>
+#include <cstdarg>
 #include <cstdio>
 #include <cstring>
 #include <sstream>
@@ -10,38 +12,281 @@ extern "C" {
 }
 
 namespace sv {
+namespace {
+// Number of recently executed lines kept already parsed
+const size_t CONSOLE_LINE_CACHE_SIZE = 32;
+
+// Deepest an alias may expand to other aliases, stops an alias expanding to
+// itself forever
+const size_t CONSOLE_MAX_ALIAS_DEPTH = 32;
+
+// Copy the contents of \p buffer into \p str
+void copyOutput(const svOutputBuffer &buffer, std::string *str) {
+    size_t size = svOutputBufferGetSize(&buffer);
+    str->resize(size + 1);
+    svOutputBufferCopy(&buffer, &(*str)[0], size + 1);
+    str->resize(size);
+}
+
+void copyMatches(const std::vector<svPrefixIndexMatch> &matches,
+                 size_t numMatches, std::vector<ConsoleCompletion> *out) {
+    out->resize(numMatches);
+    for (size_t i = 0; i < numMatches; ++i) {
+        (*out)[i].name.assign(matches[i].name, matches[i].length);
+        (*out)[i].kinds = matches[i].kinds;
+    }
+}
+}
+
+struct Console::ParseScratch {
+    std::string line;
+    std::vector<char *> tokens;
+    std::vector<svCommand> commands;
+    // Index of the entry each command names, see 'executeCommands'
+    std::vector<int> entryIndices;
+};
+
+struct Console::CachedLine {
+    CachedLine() : hash(0), lastUsed(0) {}
+
+    unsigned int hash;
+    // Value of 'lineCacheClock' when last used, 0 if never used
+    uint64_t lastUsed;
+    CompiledLine compiled;
+};
+
+struct Console::Submission {
+    std::string line;
+    std::promise<ConsoleCommandResult> promise;
+    Submission *next;
+};
+
+CompiledLine::CompiledLine()
+    : numCommands(0), console(nullptr), entriesVersion(0) {}
+
+const std::string &CompiledLine::getLine() const { return line; }
+
+int CompiledLine::getNumCommands() const { return numCommands; }
+
+Console::Console()
+    : entriesVersion(0), outputStringValid(false), errorStringValid(false),
+      executeDepth(0), lineCache(new CachedLine[CONSOLE_LINE_CACHE_SIZE]),
+      lineCacheClock(0), numLineCacheHits(0), waitFrames(0),
+      executingBuffer(false), submissions(nullptr) {
+    svCommandTableInit(&entryTable);
+    svPrefixIndexInit(&nameIndex);
+    svOutputBufferInit(&outputBuffer, SV_OUTPUT_BUFFER_DEFAULT_MAX_SIZE);
+    svOutputBufferInit(&errorBuffer, SV_OUTPUT_BUFFER_DEFAULT_MAX_SIZE);
+}
+
+Console::~Console() {
+    // Don't leave anyone waiting on a submission forever
+    Submission *submission = submissions.exchange(nullptr);
+    while (submission != nullptr) {
+        Submission *next = submission->next;
+
+        ConsoleCommandResult result;
+        result.command.swap(submission->line);
+        result.succeeded = false;
+        result.error     = "Console destroyed before input was executed.";
+        submission->promise.set_value(std::move(result));
+        delete submission;
+
+        submission = next;
+    }
+
+    svCommandTableFree(&entryTable);
+    svPrefixIndexFree(&nameIndex);
+    svOutputBufferFree(&outputBuffer);
+    svOutputBufferFree(&errorBuffer);
+}
+
 void Console::registerCommand(const std::string &name,
                               const std::shared_ptr<ConsoleCommand> &command) {
-    consoleCommands[name] = command;
+    ConsoleEntry entry;
+    entry.name    = name;
+    entry.command = command;
+    setEntry(entry);
 }
 
 void Console::removeCommand(const std::string &name) {
-    consoleCommands.erase(name);
+    int index = findEntry(name);
+    if (index >= 0 && entries[index].command != nullptr) {
+        removeEntry(index);
+    }
 }
 
 bool Console::commandWithNameExists(const std::string &name) const {
+    int index = findEntry(name);
+
+    return (index >= 0 && entries[index].command != nullptr);
+}
+
+bool Console::registerAlias(const std::string &name, const std::string &line) {
+    bool result = false;
+
+    if (!commandWithNameExists(name)) {
+        ConsoleEntry entry;
+        entry.name  = name;
+        entry.alias = line;
+        setEntry(entry);
+
+        result = true;
+    }
+
+    return result;
+}
+
+void Console::removeAlias(const std::string &name) {
+    int index = findEntry(name);
+    if (index >= 0 && entries[index].command == nullptr) {
+        removeEntry(index);
+    }
+}
+
+bool Console::aliasWithNameExists(const std::string &name) const {
+    int index = findEntry(name);
+
+    return (index >= 0 && entries[index].command == nullptr);
+}
+
+bool Console::getAlias(const std::string &name, std::string *line) const {
     bool result = false;
 
-    auto search = consoleCommands.find(name);
-    // Command with name found
-    if (search != consoleCommands.end()) {
+    int index = findEntry(name);
+    if (index >= 0 && entries[index].command == nullptr) {
+        *line  = entries[index].alias;
         result = true;
     }
 
     return result;
 }
 
+size_t Console::getNumLineCacheHits() const { return numLineCacheHits; }
+
+void Console::complete(const std::string &prefix, size_t maxMatches,
+                       std::vector<ConsoleCompletion> *matchesOut,
+                       uint32_t kinds) const {
+    std::vector<svPrefixIndexMatch> matches(maxMatches);
+    size_t numMatches = svPrefixIndexComplete(&nameIndex, prefix.c_str(), kinds,
+                                              matches.data(), maxMatches);
+    copyMatches(matches, numMatches, matchesOut);
+}
+
+std::string Console::getCommonPrefix(const std::string &prefix) const {
+    std::string result(prefix.size() + 64, '\0');
+    for (;;) {
+        svPrefixIndexGetCommonPrefix(&nameIndex, prefix.c_str(), &result[0],
+                                     result.size());
+        size_t length = std::strlen(result.c_str());
+        // Filling the string means it may have been cut short
+        if (length < result.size() - 1) {
+            result.resize(length);
+            return result;
+        }
+        result.assign(result.size() * 2, '\0');
+    }
+}
+
+void Console::search(const std::string &pattern, size_t maxMatches,
+                     std::vector<ConsoleCompletion> *matchesOut,
+                     uint32_t kinds) const {
+    std::vector<svPrefixIndexMatch> matches(maxMatches);
+    size_t numMatches = svPrefixIndexSearch(&nameIndex, pattern.c_str(), kinds,
+                                            matches.data(), maxMatches);
+    copyMatches(matches, numMatches, matchesOut);
+}
+
+svPrefixIndex *Console::getNameIndex() { return &nameIndex; }
+
 void Console::appendToOutputBuffer(const std::string &outputStr) {
-    outputBuffer += outputStr;
+    svOutputBufferAppend(&outputBuffer, outputStr.data(), outputStr.size());
+    outputStringValid = false;
 }
 
 void Console::appendToErrorBuffer(const std::string &errorStr) {
-    errorBuffer += errorStr;
+    svOutputBufferAppend(&errorBuffer, errorStr.data(), errorStr.size());
+    errorStringValid = false;
+}
+
+void Console::printToOutputBuffer(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    svOutputBufferVPrint(&outputBuffer, format, args);
+    va_end(args);
+    outputStringValid = false;
 }
 
-const std::string &Console::getOutputBuffer() const { return outputBuffer; }
+void Console::printToErrorBuffer(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    svOutputBufferVPrint(&errorBuffer, format, args);
+    va_end(args);
+    errorStringValid = false;
+}
+
+const std::string &Console::getOutputBuffer() const {
+    if (!outputStringValid) {
+        copyOutput(outputBuffer, &outputString);
+        outputStringValid = true;
+    }
+
+    return outputString;
+}
+
+const std::string &Console::getErrorBuffer() const {
+    if (!errorStringValid) {
+        copyOutput(errorBuffer, &errorString);
+        errorStringValid = true;
+    }
+
+    return errorString;
+}
 
-const std::string &Console::getErrorBuffer() const { return errorBuffer; }
+void Console::drainOutputBuffer(svOutputBufferCallback callback,
+                                void *userData) {
+    svOutputBufferDrain(&outputBuffer, callback, userData);
+    outputStringValid = false;
+}
+
+void Console::drainErrorBuffer(svOutputBufferCallback callback,
+                               void *userData) {
+    svOutputBufferDrain(&errorBuffer, callback, userData);
+    errorStringValid = false;
+}
+
+void Console::setOutputCallback(svOutputBufferCallback callback,
+                                void *userData) {
+    svOutputBufferSetCallback(&outputBuffer, callback, userData);
+}
+
+void Console::setErrorCallback(svOutputBufferCallback callback,
+                               void *userData) {
+    svOutputBufferSetCallback(&errorBuffer, callback, userData);
+}
+
+void Console::setOutputBufferMaxSize(size_t maxSize) {
+    svOutputBufferSetMaxSize(&outputBuffer, maxSize);
+    svOutputBufferSetMaxSize(&errorBuffer, maxSize);
+}
+
+size_t Console::getNumDroppedOutput() const {
+    return svOutputBufferGetNumDropped(&outputBuffer) +
+           svOutputBufferGetNumDropped(&errorBuffer);
+}
+
+void Console::clearOutput() {
+    svOutputBufferClear(&outputBuffer);
+    svOutputBufferClear(&errorBuffer);
+    outputStringValid = false;
+    errorStringValid  = false;
+}
+
+void Console::takeOutput(ConsoleCommandResult *result) {
+    copyOutput(outputBuffer, &result->output);
+    copyOutput(errorBuffer, &result->error);
+    clearOutput();
+}
 
 void Console::appendString(const std::string &str) {
     inputBuffer += str;
@@ -50,130 +295,553 @@ void Console::appendString(const std::string &str) {
   // seperator?
 
 bool Console::execute() {
-    bool result = true;
-
     // Output and error buffers are cleared each time execute is called
-    outputBuffer.clear();
-    errorBuffer.clear();
+    clearOutput();
+
+    ParseScratch &scratch = getParseScratch();
+
+    // Take the input, leaving the scratch line's storage for the next input
+    scratch.line.swap(inputBuffer);
+    inputBuffer.clear();
+
+    bool result = executeLine(scratch);
+
+    inputBuffer.clear();
+
+    return result;
+}
+
+bool Console::executeString(const std::string &str) {
+    inputBuffer.clear();
+    clearOutput();
+
+    appendString(str);
+    bool result = execute();
+
+    return result;
+}
+
+bool Console::compile(const std::string &line, CompiledLine *compiled) {
+    ParseScratch &scratch = getParseScratch();
+    scratch.line.assign(line);
+
+    const int numCommands = parseLine(scratch);
+    if (numCommands < 0) {
+        return false;
+    }
+
+    storeLine(scratch, numCommands, compiled);
+    compiled->line = line;
+
+    return true;
+}
+
+bool Console::execute(const CompiledLine &compiled) {
+    clearOutput();
+
+    ParseScratch &scratch = getParseScratch();
+    const int numCommands = restoreLine(compiled, scratch);
+
+    return executeCommands(scratch, numCommands, compiled);
+}
 
-    // Validate input buffer
+bool Console::bufferString(const std::string &str) {
+    bool result = false;
+
+    if (splitCommands(str, &splitBuffer)) {
+        commandBuffer.insert(commandBuffer.end(), splitBuffer.begin(),
+                             splitBuffer.end());
+        result = true;
+    }
+
+    return result;
+}
+
+bool Console::insertString(const std::string &str) {
+    bool result = false;
+
+    if (splitCommands(str, &splitBuffer)) {
+        commandBuffer.insert(commandBuffer.begin(), splitBuffer.begin(),
+                             splitBuffer.end());
+        result = true;
+    }
+
+    return result;
+}
+
+size_t Console::executeBuffered(size_t maxCommands, double maxSeconds) {
+    // Commands executing from the buffer can't execute the buffer themselves
+    if (executingBuffer) {
+        return 0;
+    }
+
+    if (waitFrames > 0) {
+        --waitFrames;
+        if (waitFrames > 0) {
+            return 0;
+        }
+    }
+
+    executingBuffer = true;
+
+    const auto start   = std::chrono::steady_clock::now();
+    size_t numExecuted = 0;
+    while (!commandBuffer.empty() && waitFrames == 0) {
+        if (maxCommands > 0 && numExecuted >= maxCommands) {
+            break;
+        }
+        if (maxSeconds > 0.0 && numExecuted > 0) {
+            const std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= maxSeconds) {
+                break;
+            }
+        }
+
+        BufferedCommand command = std::move(commandBuffer.front());
+        commandBuffer.pop_front();
+        ++numExecuted;
+
+        clearOutput();
+
+        ConsoleCommandResult result;
+        result.command = command.line;
+
+        int index = svCommandTableFind(&entryTable, command.name.c_str());
+        if (index >= 0 && entries[index].command == nullptr) {
+            // Alias, queue its commands in its place. Commands it queues
+            // count as nested, so one that queues itself stops.
+            if (command.depth > CONSOLE_MAX_ALIAS_DEPTH) {
+                std::ostringstream errorMsg;
+                errorMsg << "Alias '" << command.name;
+                errorMsg << "' nested too deeply.";
+                appendToErrorBuffer(errorMsg.str());
+
+                result.succeeded = false;
+            } else if (splitCommands(entries[index].alias, &splitBuffer)) {
+                for (size_t i = 0; i < splitBuffer.size(); ++i) {
+                    splitBuffer[i].depth = command.depth + 1;
+                }
+                commandBuffer.insert(commandBuffer.begin(),
+                                     splitBuffer.begin(), splitBuffer.end());
+                result.succeeded = true;
+            } else {
+                result.succeeded = false;
+            }
+        } else {
+            ParseScratch &scratch = getParseScratch();
+            scratch.line.swap(command.line);
+
+            result.succeeded = executeLine(scratch);
+        }
+
+        takeOutput(&result);
+        bufferedResults.push_back(std::move(result));
+    }
+
+    executingBuffer = false;
+
+    return numExecuted;
+}
+
+void Console::wait(unsigned int frames) { waitFrames = frames; }
+
+bool Console::isExecutingBuffer() const { return executingBuffer; }
+
+size_t Console::getNumBufferedCommands() const { return commandBuffer.size(); }
+
+void Console::clearBuffer() {
+    commandBuffer.clear();
+    waitFrames = 0;
+}
+
+const std::vector<ConsoleCommandResult> &Console::getBufferedResults() const {
+    return bufferedResults;
+}
+
+void Console::clearBufferedResults() { bufferedResults.clear(); }
+
+std::future<ConsoleCommandResult> Console::submit(const std::string &str) {
+    Submission *submission = new Submission();
+    submission->line       = str;
+    std::future<ConsoleCommandResult> result =
+        submission->promise.get_future();
+
+    // Push onto the list of submissions, retrying if another thread pushed
+    // first
+    submission->next = submissions.load(std::memory_order_relaxed);
+    while (!submissions.compare_exchange_weak(submission->next, submission,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    }
+
+    return result;
+}
+
+size_t Console::executeSubmitted() {
+    // Take every submission so far, leaving an empty list for new ones
+    Submission *newestFirst = submissions.exchange(nullptr,
+                                                   std::memory_order_acquire);
+
+    // Reverse into the order submitted
+    Submission *submission = nullptr;
+    while (newestFirst != nullptr) {
+        Submission *next  = newestFirst->next;
+        newestFirst->next = submission;
+        submission        = newestFirst;
+        newestFirst       = next;
+    }
+
+    // Keep the owning thread's output (and any callbacks it streams to),
+    // submitted input's output only goes to its result
+    svOutputBuffer savedOutput = outputBuffer;
+    svOutputBuffer savedError  = errorBuffer;
+    svOutputBufferInit(&outputBuffer, savedOutput.maxSize);
+    svOutputBufferInit(&errorBuffer, savedError.maxSize);
+
+    size_t numExecuted = 0;
+    while (submission != nullptr) {
+        Submission *next = submission->next;
+
+        clearOutput();
+
+        ConsoleCommandResult result;
+        result.command = submission->line;
+
+        ParseScratch &scratch = getParseScratch();
+        scratch.line.swap(submission->line);
+        result.succeeded = executeLine(scratch);
+
+        takeOutput(&result);
+        submission->promise.set_value(std::move(result));
+        delete submission;
+
+        ++numExecuted;
+        submission = next;
+    }
+
+    svOutputBufferFree(&outputBuffer);
+    svOutputBufferFree(&errorBuffer);
+    outputBuffer      = savedOutput;
+    errorBuffer       = savedError;
+    outputStringValid = false;
+    errorStringValid  = false;
+
+    return numExecuted;
+}
+
+bool Console::splitCommands(const std::string &str,
+                            std::vector<BufferedCommand> *commands) {
+    commands->clear();
+
+    ParseScratch &scratch = getParseScratch();
+    scratch.line.assign(str);
+
+    const int numCommands = parseLine(scratch);
+    if (numCommands < 0) {
+        return false;
+    }
+
+    commands->resize(numCommands);
+    for (int i = 0; i < numCommands; ++i) {
+        const svCommand &command  = scratch.commands[i];
+        BufferedCommand &buffered = (*commands)[i];
+
+        buffered.name.assign(command.argv[0]);
+        buffered.line.assign(command.argv[0]);
+        buffered.depth = 0;
+        for (int j = 1; command.argv[j] != nullptr; ++j) {
+            buffered.line += ' ';
+            buffered.line += command.argv[j];
+        }
+    }
+
+    return true;
+}
+
+int Console::findEntry(const std::string &name) const {
+    return svCommandTableFind(&entryTable, name.c_str());
+}
+
+void Console::setEntry(const ConsoleEntry &entry) {
+    ++entriesVersion;
+
+    int index = findEntry(entry.name);
+    if (index >= 0) {
+        svPrefixIndexRemove(&nameIndex, entry.name.c_str(),
+                            getEntryKind(entries[index]));
+        svPrefixIndexInsert(&nameIndex, entry.name.c_str(),
+                            getEntryKind(entry));
+        entries[index] = entry;
+    } else {
+        svPrefixIndexInsert(&nameIndex, entry.name.c_str(),
+                            getEntryKind(entry));
+        entries.push_back(entry);
+        svCommandTableInsert(&entryTable, entry.name.c_str(),
+                             (int)entries.size() - 1);
+    }
+}
+
+uint32_t Console::getEntryKind(const ConsoleEntry &entry) {
+    return (entry.command != nullptr) ? ConsoleNameKind::Enum::Command
+                                      : ConsoleNameKind::Enum::Alias;
+}
+
+void Console::removeEntry(int index) {
+    ++entriesVersion;
+
+    svCommandTableRemove(&entryTable, entries[index].name.c_str());
+    svPrefixIndexRemove(&nameIndex, entries[index].name.c_str(),
+                        getEntryKind(entries[index]));
+
+    // Move last entry into the removed entry's place
+    if (index != (int)entries.size() - 1) {
+        entries[index] = std::move(entries.back());
+        svCommandTableInsert(&entryTable, entries[index].name.c_str(), index);
+    }
+    entries.pop_back();
+}
+
+int Console::parseLine(ParseScratch &scratch) {
+    // Enough tokens for any line of this length, see svTokenizerTokenizeInPlace
+    const size_t maxTokens = scratch.line.size() / 2 + 2;
+    // Grown separately, 'restoreLine' may have grown either one alone
+    if (scratch.tokens.size() < maxTokens) {
+        scratch.tokens.resize(maxTokens);
+    }
+    if (scratch.commands.size() < maxTokens) {
+        scratch.commands.resize(maxTokens);
+    }
+    char **token = &scratch.tokens[0];
+
+    // Tokenize line
     svTokenizerError tokenizerError;
-    if (svTokenizerValidateInput(inputBuffer.c_str(), &tokenizerError) != 0) {
+    if (svTokenizerTokenizeInPlace(&scratch.line[0], token, (int)maxTokens,
+                                   &tokenizerError) < 0) {
         // Error occurred
         switch (tokenizerError.errorCode) {
         case -1: {
             std::ostringstream errorMsg;
             errorMsg << "String not closed at position ";
             errorMsg << tokenizerError.characterPos << ".";
-            errorBuffer += errorMsg.str();
+            appendToErrorBuffer(errorMsg.str());
             break;
         }
         default: { break; }
         }
 
-        result = false;
-    } else {
-        // No error occurred during tokenization
-        // Allocate tokens array
-        unsigned int numTokens =
-            svTokenizerGetNumTokens(inputBuffer.c_str(), NULL) +
-            1; // NULL for error out because we already validated input above
-        char **token = (char **)malloc(sizeof(char **) * numTokens);
-        memset(token, '\0', sizeof(char *) * numTokens);
-        svTokenizerTokenize(&inputBuffer[0], token, NULL);
-
-        // Validate token array
-        svCommandError commandError;
-        if (svCommandsValidateTokenArray(token, &commandError) != 0) {
-            // Error occurred
-            switch (commandError.errorCode) {
-            case -1: {
-                // Two successive commands are separated by more than one
-                // command seperator
-                std::ostringstream errorMsg;
-                errorMsg << "Two successive commands are separated by more "
-                            "than one command separator:";
-                errorMsg << " " << token[commandError.tokenPos - 1];
-                errorMsg << " " << token[commandError.tokenPos];
-                errorMsg << " " << token[commandError.tokenPos + 1];
-                errorBuffer += errorMsg.str();
-                break;
-            }
-            case -2: {
-                std::ostringstream errorMsg;
-                errorMsg << "First token is a command separator.";
-                errorBuffer += errorMsg.str();
-                break;
-            }
-            default:
-                break;
-            }
+        return -1;
+    }
 
-            result = false;
-        } else {
-            // No error occurred
-            // Allocate space for commands, +1 for NULL command required.
-            unsigned int numCommands = svCommandsGetNum(token, NULL) + 1;
-            svCommand *commands =
-                (svCommand *)malloc(sizeof(svCommand) * numCommands);
-            memset(commands, '\0', sizeof(svCommand) * numCommands);
-            svCommandsMakeNullCommand(commands + numCommands - 1);
-
-            svCommandsSeparate(token, commands, NULL); // Already valid input
-
-            // Process commands
-            // For each command (ignoring NULL command): calculate argc, send
-            // argv, argc to console command
-            for (unsigned int i = 0; i < numCommands - 1; ++i) {
-                svCommand *command = commands + i;
-
-                auto search =
-                    consoleCommands.find(std::string(command->argv[0]));
-                if (search != consoleCommands.end()) {
-                    // Command with name found
-                    // Calc argc
-                    int argc = 0;
-                    for (int j = 0; command->argv[j] != NULL; ++j) {
-                        ++argc;
-                    }
-
-                    result =
-                        search->second->execute(*this, argc, command->argv);
-                    // Don't execute any more commands
-                    if (result == false) {
-                        break;
-                    }
-                } else {
-                    std::ostringstream errorMsg;
-                    errorMsg << "No command with name '";
-                    errorMsg << std::string(command->argv[0]) << "'.";
-                    errorBuffer += errorMsg.str();
-
-                    result = false;
-                    // Don't execute any more commands
-                    break;
-                }
-            }
+    // Separate tokens into commands
+    svCommandError commandError;
+    const int numCommands =
+        svCommandsSeparateInPlace(token, &scratch.commands[0], &commandError);
+    if (numCommands < 0) {
+        // Error occurred
+        switch (commandError.errorCode) {
+        case -1: {
+            // Two successive commands are separated by more than one
+            // command seperator
+            std::ostringstream errorMsg;
+            errorMsg << "Two successive commands are separated by more "
+                        "than one command separator:";
+            errorMsg << " " << token[commandError.tokenPos - 1];
+            errorMsg << " " << token[commandError.tokenPos];
+            errorMsg << " " << token[commandError.tokenPos + 1];
+            appendToErrorBuffer(errorMsg.str());
+            break;
+        }
+        case -2: {
+            std::ostringstream errorMsg;
+            errorMsg << "First token is a command separator.";
+            appendToErrorBuffer(errorMsg.str());
+            break;
+        }
+        default:
+            break;
+        }
+    }
 
-            svCommandsFreeContents(commands);
-            free(commands);
+    return numCommands;
+}
+
+Console::ParseScratch &Console::getParseScratch() {
+    if (parseScratch.size() <= executeDepth) {
+        parseScratch.emplace_back(new ParseScratch());
+    }
+
+    return *parseScratch[executeDepth];
+}
+
+bool Console::executeLine(ParseScratch &scratch) {
+    // Look for the line in the cache, and the least recently used line
+    const unsigned int hash = svCommandTableHash(scratch.line.c_str());
+    CachedLine *cached      = nullptr;
+    CachedLine *leastRecent = &lineCache[0];
+    for (size_t i = 0; i < CONSOLE_LINE_CACHE_SIZE; ++i) {
+        CachedLine &entry = lineCache[i];
+        if (entry.lastUsed != 0 && entry.hash == hash &&
+            entry.compiled.line == scratch.line) {
+            cached = &entry;
+            break;
+        }
+        if (entry.lastUsed < leastRecent->lastUsed) {
+            leastRecent = &entry;
+        }
+    }
+
+    int numCommands = 0;
+    if (cached != nullptr) {
+        numCommands      = restoreLine(cached->compiled, scratch);
+        cached->lastUsed = ++lineCacheClock;
+        ++numLineCacheHits;
+    } else {
+        // Replace least recently used line, once parsed successfully
+        cached           = leastRecent;
+        cached->lastUsed = 0;
+        cached->compiled.line.assign(scratch.line);
+        cached->hash = hash;
+
+        numCommands = parseLine(scratch);
+        if (numCommands < 0) {
+            return false;
         }
 
-        free(token);
+        storeLine(scratch, numCommands, &cached->compiled);
+        cached->lastUsed = ++lineCacheClock;
     }
 
-    inputBuffer.clear();
+    return executeCommands(scratch, numCommands, cached->compiled);
+}
 
-    return result;
+void Console::storeLine(const ParseScratch &scratch, int numCommands,
+                        CompiledLine *compiled) {
+    // Tokens end with the NULL after the last command
+    const int numTokens =
+        (numCommands > 0) ? scratch.commands[numCommands - 1].last + 1 : 0;
+    compiled->tokenized.assign(scratch.line);
+    const char *base = scratch.line.c_str();
+    compiled->tokenOffsets.resize(numTokens + 1);
+    for (int i = 0; i <= numTokens; ++i) {
+        compiled->tokenOffsets[i] = (scratch.tokens[i] == nullptr)
+                                        ? -1
+                                        : (int)(scratch.tokens[i] - base);
+    }
+    compiled->commands.assign(scratch.commands.begin(),
+                              scratch.commands.begin() + numCommands);
+    compiled->sepOffsets.resize(numCommands);
+    for (int i = 0; i < numCommands; ++i) {
+        const char *sep   = compiled->commands[i].sep;
+        const bool inLine = sep >= base && sep < base + scratch.line.size();
+
+        compiled->sepOffsets[i]    = inLine ? (int)(sep - base) : -1;
+        compiled->commands[i].sep  = nullptr;
+        compiled->commands[i].argv = nullptr;
+    }
+    compiled->numCommands = numCommands;
+
+    // Entries are looked up again on the next execution
+    compiled->console = nullptr;
 }
 
-bool Console::executeString(const std::string &str) {
-    inputBuffer.clear();
-    outputBuffer.clear();
-    errorBuffer.clear();
+int Console::restoreLine(const CompiledLine &compiled,
+                         ParseScratch &scratch) {
+    const size_t numTokens = compiled.tokenOffsets.size();
+    if (scratch.tokens.size() < numTokens) {
+        scratch.tokens.resize(numTokens);
+    }
+    if (scratch.commands.size() < compiled.commands.size()) {
+        scratch.commands.resize(compiled.commands.size());
+    }
+    char **token = scratch.tokens.data();
 
-    appendString(str);
-    bool result = execute();
+    // Commands may have changed their arguments last time, start again from
+    // the tokenized line
+    scratch.line.assign(compiled.tokenized);
+    char *base = &scratch.line[0];
+    for (size_t i = 0; i < numTokens; ++i) {
+        const int offset = compiled.tokenOffsets[i];
+        token[i]         = (offset < 0) ? nullptr : base + offset;
+    }
+    for (int i = 0; i < compiled.numCommands; ++i) {
+        const int sepOffset      = compiled.sepOffsets[i];
+        scratch.commands[i]      = compiled.commands[i];
+        scratch.commands[i].argv = token + compiled.commands[i].first;
+        scratch.commands[i].sep  = (sepOffset < 0) ? SV_SEP_SEQ
+                                                   : base + sepOffset;
+    }
+
+    return compiled.numCommands;
+}
+
+bool Console::executeCommands(ParseScratch &scratch, int numCommands,
+                              const CompiledLine &compiled) {
+    bool result = true;
+
+    // Copy the entries the commands name, \p compiled may be changed or
+    // destroyed by the commands (e.g. a key binding rebinding its key)
+    if (compiled.console != this || compiled.entriesVersion != entriesVersion) {
+        compiled.entryIndices.resize(numCommands);
+        for (int i = 0; i < numCommands; ++i) {
+            compiled.entryIndices[i] =
+                svCommandTableFind(&entryTable, scratch.commands[i].argv[0]);
+        }
+        compiled.console        = this;
+        compiled.entriesVersion = entriesVersion;
+    }
+    scratch.entryIndices.assign(compiled.entryIndices.begin(),
+                                compiled.entryIndices.end());
+    const uint64_t version = entriesVersion;
+
+    ++executeDepth;
+
+    // Process commands
+    // For each command: send argv, argc to console command
+    for (int i = 0; i < numCommands; ++i) {
+        const svCommand &command = scratch.commands[i];
+
+        // Look up the entry again if an earlier command changed the entries
+        const int index =
+            (entriesVersion == version)
+                ? scratch.entryIndices[i]
+                : svCommandTableFind(&entryTable, command.argv[0]);
+        if (index >= 0 && entries[index].command != nullptr) {
+            // Command with name found
+            const int argc = command.last - command.first + 1;
+
+            result = entries[index].command->execute(*this, argc, command.argv);
+        } else if (index >= 0) {
+            // Alias with name found, execute its line in place of the command
+            if (executeDepth > CONSOLE_MAX_ALIAS_DEPTH) {
+                std::ostringstream errorMsg;
+                errorMsg << "Alias '" << command.argv[0];
+                errorMsg << "' nested too deeply.";
+                appendToErrorBuffer(errorMsg.str());
+
+                result = false;
+            } else {
+                ParseScratch &aliasScratch = getParseScratch();
+                aliasScratch.line.assign(entries[index].alias);
+
+                result = executeLine(aliasScratch);
+            }
+        } else {
+            std::ostringstream errorMsg;
+            errorMsg << "No command with name '";
+            errorMsg << std::string(command.argv[0]) << "'.";
+            appendToErrorBuffer(errorMsg.str());
+
+            result = false;
+        }
+
+        // Don't execute any more commands
+        if (result == false) {
+            break;
+        }
+    }
+
+    --executeDepth;
 
     return result;
 }
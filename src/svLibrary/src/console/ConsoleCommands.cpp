@@ -1,3 +1,9 @@
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 
 #include <sv/Common.h>
@@ -13,9 +19,14 @@ bool BindCommand::execute(Console &console, int argc, char *argv[]) {
     } else {
         char *keyName   = sv::stripSurroundingQuotes(argv[1]);
         char *cmdString = sv::stripSurroundingQuotes(argv[2]);
-        inputSystem.bind(keyName, cmdString);
 
-        result = true;
+        Keycodes::Enum keycode;
+        if (!getKeycodeFromName(keyName, &keycode)) {
+            console.printToErrorBuffer("No key with name '%s'.\n", keyName);
+        } else {
+            // Compiled now, so invalid input is reported when bound
+            result = inputSystem.bind(keycode, cmdString, console);
+        }
     }
 
     return result;
@@ -34,6 +45,17 @@ bool UnbindAllCommand::execute(Console &console, int argc, char *argv[]) {
     return result;
 }
 
+bool ActionCommand::execute(Console &console, int argc, char *argv[]) {
+    // Arguments (e.g. the key and time Quake passes) are ignored
+    if (press) {
+        inputSystem.pressAction(action);
+    } else {
+        inputSystem.releaseAction(action);
+    }
+
+    return true;
+}
+
 bool SetCommand::execute(Console &console, int argc, char *argv[]) {
     bool result = false;
 
@@ -43,8 +65,11 @@ bool SetCommand::execute(Console &console, int argc, char *argv[]) {
     } else {
         char *cvarName  = sv::stripSurroundingQuotes(argv[1]);
         char *cvarValue = sv::stripSurroundingQuotes(argv[2]);
-        cvars.setStringValue(cvarName, cvarValue);
-        result = true;
+        result          = cvars.setStringValue(cvarName, cvarValue);
+        if (!result) {
+            console.printToErrorBuffer("Can't set '%s' to '%s'.\n", cvarName,
+                                       cvarValue);
+        }
     }
 
     return result;
@@ -67,8 +92,13 @@ bool ExecCommand::execute(Console &console, int argc, char *argv[]) {
             const size_t fileSize = handle->getResourceSize();
 
             // File found
-            result = console.executeString(
-                std::string((char *)handle->getResourceBuffer(), fileSize));
+            const std::string contents((char *)handle->getResourceBuffer(),
+                                       fileSize);
+            if (console.isExecutingBuffer()) {
+                result = console.insertString(contents);
+            } else {
+                result = console.executeString(contents);
+            }
         } else {
             // File not found
             std::stringstream err;
@@ -88,12 +118,295 @@ bool EchoCommand::execute(Console &console, int argc, char *argv[]) {
     } else {
         const char *msg = sv::stripSurroundingQuotes(argv[1]);
 
-        console.appendToOutputBuffer(msg);
-        console.appendToOutputBuffer(std::string("\n"));
+        console.printToOutputBuffer("%s\n", msg);
+
+        result = true;
+    }
+
+    return result;
+}
+
+bool WaitCommand::execute(Console &console, int argc, char *argv[]) {
+    bool result = false;
+
+    if (argc == 1) {
+        console.wait(1);
+        result = true;
+    } else if (argc == 2) {
+        const char *framesStr = sv::stripSurroundingQuotes(argv[1]);
+
+        // strtoul takes a sign (and wraps "-1" to ULONG_MAX) and leading
+        // spaces, only plain digits are a number of frames
+        char *end            = nullptr;
+        unsigned long frames = 0;
+        if (isdigit((unsigned char)framesStr[0])) {
+            errno  = 0;
+            frames = strtoul(framesStr, &end, 10);
+        }
+        if (end != nullptr && *end == '\0' && errno != ERANGE && frames > 0 &&
+            frames <= UINT_MAX) {
+            console.wait((unsigned int)frames);
+            result = true;
+        }
+    }
+
+    if (!result) {
+        console.appendToErrorBuffer("Usage: wait [\"frames\"]\n");
+    }
+
+    return result;
+}
+
+bool AliasCommand::execute(Console &console, int argc, char *argv[]) {
+    bool result = false;
+
+    if (argc == 2) {
+        const char *name = sv::stripSurroundingQuotes(argv[1]);
+
+        std::string line;
+        if (console.getAlias(name, &line)) {
+            console.appendToOutputBuffer(std::string(name) + ": " + line +
+                                         "\n");
+            result = true;
+        } else {
+            std::stringstream err;
+            err << "No alias with name '" << name << "'." << std::endl;
+            console.appendToErrorBuffer(err.str());
+        }
+    } else if (argc == 3) {
+        const char *name = sv::stripSurroundingQuotes(argv[1]);
+        const char *line = sv::stripSurroundingQuotes(argv[2]);
+
+        if (console.registerAlias(name, line)) {
+            result = true;
+        } else {
+            std::stringstream err;
+            err << "Can't alias '" << name << "', it is a command."
+                << std::endl;
+            console.appendToErrorBuffer(err.str());
+        }
+    } else {
+        console.appendToErrorBuffer(
+            "Usage: alias \"name\" [\"COMMAND_STRING\"]\n");
+    }
+
+    return result;
+}
+
+bool UnaliasCommand::execute(Console &console, int argc, char *argv[]) {
+    bool result = false;
+
+    if (argc != 2) {
+        console.appendToErrorBuffer("Usage: unalias \"name\"\n");
+    } else {
+        console.removeAlias(sv::stripSurroundingQuotes(argv[1]));
+        result = true;
+    }
+
+    return result;
+}
+
+bool FindCommand::execute(Console &console, int argc, char *argv[]) {
+    // Most names printed
+    const size_t maxMatches = 32;
+
+    bool result = false;
+
+    if (argc != 2) {
+        console.appendToErrorBuffer("Usage: find \"pattern\"\n");
+    } else {
+        std::vector<ConsoleCompletion> matches;
+        console.search(sv::stripSurroundingQuotes(argv[1]), maxMatches,
+                       &matches);
+
+        for (const ConsoleCompletion &match : matches) {
+            const char *kind = "variable";
+            if (match.kinds & ConsoleNameKind::Enum::Command) {
+                kind = "command";
+            } else if (match.kinds & ConsoleNameKind::Enum::Alias) {
+                kind = "alias";
+            }
+            console.printToOutputBuffer("%s (%s)\n", match.name.c_str(), kind);
+        }
 
         result = true;
     }
 
     return result;
 }
+
+namespace {
+// Parse a finite non-negative number, \returns false if \p str isn't one.
+bool parseNonNegative(const char *str, double *valueOut) {
+    char *end    = nullptr;
+    double value = strtod(str, &end);
+
+    if (end == str || *end != '\0' || !(value >= 0.0) ||
+        !std::isfinite(value)) {
+        return false;
+    }
+
+    *valueOut = value;
+    return true;
+}
+}
+
+bool NetSimCommand::execute(Console &console, int argc, char *argv[]) {
+    bool result = false;
+
+    net::NetworkConditions conditions = simulator.getConditions();
+
+    if (argc == 1) {
+        std::stringstream out;
+        out << "net_sim " << (simulator.isEnabled() ? "on" : "off")
+            << ": latency " << conditions.latency * 1000.0f << "ms, jitter "
+            << conditions.jitter * 1000.0f << "ms ("
+            << (conditions.jitterDistribution ==
+                        net::JitterDistribution::Enum::Normal
+                    ? "normal"
+                    : "uniform")
+            << "), loss " << conditions.packetLoss * 100.0f
+            << "%, duplicate " << conditions.duplicates * 100.0f
+            << "%, bandwidth " << conditions.bandwidth << " bytes/s, queue "
+            << conditions.queueSize << " bytes" << std::endl;
+        console.appendToOutputBuffer(out.str());
+
+        result = true;
+    } else if (argc == 2) {
+        const char *arg = sv::stripSurroundingQuotes(argv[1]);
+
+        if (strcmp(arg, "on") == 0) {
+            simulator.setEnabled(true);
+            result = true;
+        } else if (strcmp(arg, "off") == 0) {
+            simulator.setEnabled(false);
+            result = true;
+        }
+    } else if (argc == 3) {
+        const char *setting = sv::stripSurroundingQuotes(argv[1]);
+        const char *arg     = sv::stripSurroundingQuotes(argv[2]);
+        double value        = 0.0;
+
+        if (strcmp(setting, "distribution") == 0) {
+            if (strcmp(arg, "uniform") == 0) {
+                conditions.jitterDistribution =
+                    net::JitterDistribution::Enum::Uniform;
+                result = true;
+            } else if (strcmp(arg, "normal") == 0) {
+                conditions.jitterDistribution =
+                    net::JitterDistribution::Enum::Normal;
+                result = true;
+            }
+        } else if (parseNonNegative(arg, &value)) {
+            // Byte counts and seeds must fit before they are converted
+            const bool isUint32 = value <= (double)UINT32_MAX;
+            result              = true;
+
+            if (strcmp(setting, "latency") == 0) {
+                conditions.latency = (float)(value / 1000.0);
+            } else if (strcmp(setting, "jitter") == 0) {
+                conditions.jitter = (float)(value / 1000.0);
+            } else if (strcmp(setting, "loss") == 0 && value <= 100.0) {
+                conditions.packetLoss = (float)(value / 100.0);
+            } else if (strcmp(setting, "duplicate") == 0 && value <= 100.0) {
+                conditions.duplicates = (float)(value / 100.0);
+            } else if (strcmp(setting, "bandwidth") == 0 && isUint32) {
+                conditions.bandwidth = (uint32_t)value;
+            } else if (strcmp(setting, "queue") == 0 && isUint32) {
+                conditions.queueSize = (uint32_t)value;
+            } else if (strcmp(setting, "seed") == 0 && isUint32) {
+                simulator.seed((uint32_t)value);
+            } else {
+                result = false;
+            }
+        }
+
+        if (result) {
+            simulator.setConditions(conditions);
+        }
+    }
+
+    if (!result) {
+        console.appendToErrorBuffer(
+            "Usage: net_sim [\"on\"|\"off\"]\n"
+            "       net_sim \"latency\"|\"jitter\" \"ms\"\n"
+            "       net_sim \"loss\"|\"duplicate\" \"percent\"\n"
+            "       net_sim \"bandwidth\"|\"queue\" \"bytes\"\n"
+            "       net_sim \"distribution\" \"uniform\"|\"normal\"\n"
+            "       net_sim \"seed\" \"n\"\n");
+    }
+
+    return result;
+}
+
+bool NetStatsCommand::execute(Console &console, int argc, char *argv[]) {
+    bool result = false;
+
+    if (argc == 1) {
+        console.printToOutputBuffer(
+            "net_stats: %s\n",
+            net::formatStatistics(connection.getStatistics()).c_str());
+
+        result = true;
+    } else if (argc == 3) {
+        const char *setting = sv::stripSurroundingQuotes(argv[1]);
+        const char *arg     = sv::stripSurroundingQuotes(argv[2]);
+        double value        = 0.0;
+
+        if (strcmp(setting, "log") == 0 && parseNonNegative(arg, &value)) {
+            connection.setStatsLogInterval((float)value);
+            result = true;
+        }
+    }
+
+    if (!result) {
+        console.appendToErrorBuffer("Usage: net_stats\n"
+                                    "       net_stats \"log\" \"seconds\"\n");
+    }
+
+    return result;
+}
+
+NetCaptureCommand::~NetCaptureCommand() { connection.setCapture(nullptr); }
+
+bool NetCaptureCommand::execute(Console &console, int argc, char *argv[]) {
+    bool result     = false;
+    bool validUsage = true;
+
+    if (argc == 1) {
+        if (capture.isOpen()) {
+            console.printToOutputBuffer("net_capture: %zu records, %zu bytes\n",
+                                        capture.getNumRecords(),
+                                        capture.getSize());
+        } else {
+            console.printToOutputBuffer("net_capture: off\n");
+        }
+
+        result = true;
+    } else if (argc == 2) {
+        const char *arg = sv::stripSurroundingQuotes(argv[1]);
+
+        connection.setCapture(nullptr);
+        if (strcmp(arg, "off") == 0) {
+            capture.close();
+            result = true;
+        } else if (capture.open(arg)) {
+            connection.setCapture(&capture);
+            result = true;
+        } else {
+            console.appendToErrorBuffer(
+                std::string("net_capture: Failed to open ") + arg + "\n");
+        }
+    } else {
+        validUsage = false;
+    }
+
+    if (!validUsage) {
+        console.appendToErrorBuffer("Usage: net_capture\n"
+                                    "       net_capture \"file\"\n"
+                                    "       net_capture \"off\"\n");
+    }
+
+    return result;
+}
 }
@@ -0,0 +1,263 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sv/console/OutputBuffer.h>
+
+static char *svOutputBufferChunkData(svOutputBufferChunk *chunk) {
+    return (char *)(chunk + 1);
+}
+
+/**
+ * Add an empty chunk to the end of \p buffer, reusing a spare chunk if there is
+ * one.
+ *
+ * \returns New last chunk, NULL if memory could not be allocated.
+ */
+static svOutputBufferChunk *svOutputBufferAddChunk(svOutputBuffer *buffer) {
+    svOutputBufferChunk *chunk = buffer->spare;
+    if (chunk != NULL) {
+        buffer->spare = chunk->next;
+    } else {
+        chunk = (svOutputBufferChunk *)malloc(sizeof(svOutputBufferChunk) +
+                                              SV_OUTPUT_BUFFER_CHUNK_SIZE + 1);
+        if (chunk == NULL) {
+            return NULL;
+        }
+    }
+
+    chunk->next = NULL;
+    chunk->size = 0;
+
+    if (buffer->last != NULL) {
+        buffer->last->next = chunk;
+    } else {
+        buffer->first = chunk;
+    }
+    buffer->last = chunk;
+
+    return chunk;
+}
+
+/**
+ * \returns Number of bytes that may be added before reaching the cap.
+ */
+static size_t svOutputBufferGetRoom(const svOutputBuffer *buffer) {
+    if (buffer->maxSize == 0) {
+        return (size_t)-1;
+    }
+
+    return (buffer->size < buffer->maxSize) ? buffer->maxSize - buffer->size
+                                            : 0;
+}
+
+/**
+ * Keep \p size bytes just written to the free space of \p chunk, as much as
+ * the cap allows, or pass them to the callback.
+ *
+ * \returns Number of bytes kept.
+ */
+static size_t svOutputBufferCommit(svOutputBuffer *buffer,
+                                   svOutputBufferChunk *chunk, size_t size) {
+    if (buffer->callback != NULL) {
+        if (size > 0) {
+            buffer->callback(buffer->userData,
+                             svOutputBufferChunkData(chunk) + chunk->size,
+                             size);
+        }
+        return size;
+    }
+
+    size_t room = svOutputBufferGetRoom(buffer);
+    size_t kept = (size < room) ? size : room;
+
+    chunk->size += kept;
+    buffer->size += kept;
+    buffer->numDropped += size - kept;
+
+    return kept;
+}
+
+static void svOutputBufferFreeChunks(svOutputBufferChunk *chunk) {
+    while (chunk != NULL) {
+        svOutputBufferChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+void svOutputBufferInit(svOutputBuffer *buffer, size_t maxSize) {
+    memset(buffer, 0, sizeof(svOutputBuffer));
+    buffer->maxSize = maxSize;
+}
+
+void svOutputBufferFree(svOutputBuffer *buffer) {
+    svOutputBufferFreeChunks(buffer->first);
+    svOutputBufferFreeChunks(buffer->spare);
+
+    buffer->first      = NULL;
+    buffer->last       = NULL;
+    buffer->spare      = NULL;
+    buffer->size       = 0;
+    buffer->numDropped = 0;
+}
+
+void svOutputBufferClear(svOutputBuffer *buffer) {
+    if (buffer->last != NULL) {
+        buffer->last->next = buffer->spare;
+        buffer->spare      = buffer->first;
+    }
+
+    buffer->first      = NULL;
+    buffer->last       = NULL;
+    buffer->size       = 0;
+    buffer->numDropped = 0;
+}
+
+void svOutputBufferSetMaxSize(svOutputBuffer *buffer, size_t maxSize) {
+    buffer->maxSize = maxSize;
+}
+
+void svOutputBufferSetCallback(svOutputBuffer *buffer,
+                               svOutputBufferCallback callback,
+                               void *userData) {
+    buffer->callback = callback;
+    buffer->userData = userData;
+}
+
+size_t svOutputBufferAppend(svOutputBuffer *buffer, const char *data,
+                            size_t size) {
+    if (buffer->callback != NULL) {
+        if (size > 0) {
+            buffer->callback(buffer->userData, data, size);
+        }
+        return size;
+    }
+
+    size_t room    = svOutputBufferGetRoom(buffer);
+    size_t kept    = (size < room) ? size : room;
+    size_t written = 0;
+
+    while (written < kept) {
+        svOutputBufferChunk *chunk = buffer->last;
+        if (chunk == NULL || chunk->size == SV_OUTPUT_BUFFER_CHUNK_SIZE) {
+            chunk = svOutputBufferAddChunk(buffer);
+            if (chunk == NULL) {
+                break;
+            }
+        }
+
+        size_t space = SV_OUTPUT_BUFFER_CHUNK_SIZE - chunk->size;
+        size_t count = (kept - written < space) ? kept - written : space;
+        memcpy(svOutputBufferChunkData(chunk) + chunk->size, data + written,
+               count);
+        chunk->size += count;
+        written += count;
+    }
+
+    buffer->size += written;
+    buffer->numDropped += size - written;
+
+    return written;
+}
+
+size_t svOutputBufferPrint(svOutputBuffer *buffer, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t result = svOutputBufferVPrint(buffer, format, args);
+    va_end(args);
+
+    return result;
+}
+
+size_t svOutputBufferVPrint(svOutputBuffer *buffer, const char *format,
+                            va_list args) {
+    size_t result = 0;
+
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+
+    svOutputBufferChunk *chunk = buffer->last;
+    if (chunk == NULL || chunk->size == SV_OUTPUT_BUFFER_CHUNK_SIZE) {
+        chunk = svOutputBufferAddChunk(buffer);
+    }
+
+    if (chunk != NULL) {
+        /* Print straight into the free space of the last chunk, which fits
+         * most output */
+        size_t space = SV_OUTPUT_BUFFER_CHUNK_SIZE - chunk->size;
+        int length =
+            vsnprintf(svOutputBufferChunkData(chunk) + chunk->size, space + 1,
+                      format, args);
+
+        if (length < 0) {
+            /* Encoding error, nothing printed */
+        } else if ((size_t)length <= space) {
+            result = svOutputBufferCommit(buffer, chunk, (size_t)length);
+        } else if ((size_t)length <= SV_OUTPUT_BUFFER_CHUNK_SIZE &&
+                   (chunk = svOutputBufferAddChunk(buffer)) != NULL) {
+            /* Didn't fit, print again into a new chunk */
+            vsnprintf(svOutputBufferChunkData(chunk),
+                      SV_OUTPUT_BUFFER_CHUNK_SIZE + 1, format, argsCopy);
+            result = svOutputBufferCommit(buffer, chunk, (size_t)length);
+        } else {
+            /* Longer than a chunk, print somewhere big enough and copy */
+            char *printed = (char *)malloc((size_t)length + 1);
+            if (printed != NULL) {
+                vsnprintf(printed, (size_t)length + 1, format, argsCopy);
+                result = svOutputBufferAppend(buffer, printed, (size_t)length);
+                free(printed);
+            }
+        }
+    }
+
+    va_end(argsCopy);
+
+    return result;
+}
+
+size_t svOutputBufferGetSize(const svOutputBuffer *buffer) {
+    return buffer->size;
+}
+
+size_t svOutputBufferGetNumDropped(const svOutputBuffer *buffer) {
+    return buffer->numDropped;
+}
+
+size_t svOutputBufferCopy(const svOutputBuffer *buffer, char *out,
+                          size_t outSize) {
+    if (outSize == 0) {
+        return 0;
+    }
+
+    size_t copied = 0;
+    for (svOutputBufferChunk *chunk = buffer->first;
+         chunk != NULL && copied < outSize - 1; chunk = chunk->next) {
+        size_t count = (chunk->size < outSize - 1 - copied)
+                           ? chunk->size
+                           : outSize - 1 - copied;
+        memcpy(out + copied, svOutputBufferChunkData(chunk), count);
+        copied += count;
+    }
+    out[copied] = '\0';
+
+    return copied;
+}
+
+void svOutputBufferForEach(const svOutputBuffer *buffer,
+                           svOutputBufferCallback callback, void *userData) {
+    for (svOutputBufferChunk *chunk = buffer->first; chunk != NULL;
+         chunk = chunk->next) {
+        /* Output printed into a chunk that didn't fit leaves it empty */
+        if (chunk->size > 0) {
+            callback(userData, svOutputBufferChunkData(chunk), chunk->size);
+        }
+    }
+}
+
+void svOutputBufferDrain(svOutputBuffer *buffer,
+                         svOutputBufferCallback callback, void *userData) {
+    svOutputBufferForEach(buffer, callback, userData);
+    svOutputBufferClear(buffer);
+}
@@ -0,0 +1,669 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <sv/console/PrefixIndex.h>
+
+/* Patterns up to this long are searched without allocating */
+#define SV_PREFIX_INDEX_MAX_STACK_PATTERN 64
+
+static unsigned char svPrefixIndexFold(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c - 'A' + 'a') : c;
+}
+
+/**
+ * \returns Bit standing for \p c in svPrefixIndexNode::chars.
+ */
+static uint64_t svPrefixIndexCharBit(unsigned char c) {
+    c = svPrefixIndexFold(c);
+    if (c >= 'a' && c <= 'z') {
+        return (uint64_t)1 << (c - 'a');
+    } else if (c >= '0' && c <= '9') {
+        return (uint64_t)1 << (26 + c - '0');
+    }
+
+    return (uint64_t)1 << (36 + c % 28);
+}
+
+static uint64_t svPrefixIndexGetChars(const char *str, size_t length) {
+    uint64_t chars = 0;
+    for (size_t i = 0; i < length; ++i) {
+        chars |= svPrefixIndexCharBit((unsigned char)str[i]);
+    }
+
+    return chars;
+}
+
+/**
+ * Work out the characters and shortest name below \p node again from its
+ * children, after its label or children change.
+ */
+static void svPrefixIndexUpdateNode(svPrefixIndexNode *node) {
+    node->chars     = svPrefixIndexGetChars(node->label, node->labelLength);
+    node->minLength = (node->name != NULL) ? strlen(node->name) : (size_t)-1;
+
+    for (int i = 0; i < node->numChildren; ++i) {
+        const svPrefixIndexNode *child = node->children[i];
+        node->chars |= child->chars;
+        if (child->minLength < node->minLength) {
+            node->minLength = child->minLength;
+        }
+    }
+}
+
+/**
+ * \returns New node with no name or children and a copy of \p length bytes of
+ * \p label, NULL if memory could not be allocated.
+ */
+static svPrefixIndexNode *svPrefixIndexNewNode(const char *label,
+                                               size_t length) {
+    svPrefixIndexNode *node =
+        (svPrefixIndexNode *)calloc(1, sizeof(svPrefixIndexNode));
+    if (node == NULL) {
+        return NULL;
+    }
+
+    node->label = (char *)malloc(length > 0 ? length : 1);
+    if (node->label == NULL) {
+        free(node);
+        return NULL;
+    }
+    memcpy(node->label, label, length);
+    node->labelLength = length;
+    node->chars       = svPrefixIndexGetChars(label, length);
+
+    return node;
+}
+
+/**
+ * Free the children of \p node and everything below them, and the name and
+ * label of \p node itself.
+ */
+static void svPrefixIndexFreeNode(svPrefixIndexNode *node) {
+    for (int i = 0; i < node->numChildren; ++i) {
+        svPrefixIndexFreeNode(node->children[i]);
+        free(node->children[i]);
+    }
+    free(node->children);
+    free(node->name);
+    free(node->label);
+}
+
+/**
+ * \returns Child of \p node whose label starts with \p c, NULL if none. The
+ * index of the child, or where it would be inserted, is written to \p at.
+ */
+static svPrefixIndexNode *svPrefixIndexFindChild(const svPrefixIndexNode *node,
+                                                 unsigned char c, int *at) {
+    int low  = 0;
+    int high = node->numChildren;
+    while (low < high) {
+        int middle          = (low + high) / 2;
+        unsigned char first = (unsigned char)node->children[middle]->label[0];
+        if (first < c) {
+            low = middle + 1;
+        } else if (first > c) {
+            high = middle;
+        } else {
+            *at = middle;
+            return node->children[middle];
+        }
+    }
+
+    *at = low;
+    return NULL;
+}
+
+/**
+ * Insert \p child into the children of \p node at \p at.
+ *
+ * \returns 0 if no error, other if memory could not be allocated.
+ */
+static int svPrefixIndexAddChild(svPrefixIndexNode *node, int at,
+                                 svPrefixIndexNode *child) {
+    if (node->numChildren == node->childCapacity) {
+        int capacity = (node->childCapacity > 0) ? node->childCapacity * 2 : 2;
+        svPrefixIndexNode **children = (svPrefixIndexNode **)realloc(
+            node->children, capacity * sizeof(svPrefixIndexNode *));
+        if (children == NULL) {
+            return -1;
+        }
+        node->children      = children;
+        node->childCapacity = capacity;
+    }
+
+    memmove(node->children + at + 1, node->children + at,
+            (node->numChildren - at) * sizeof(svPrefixIndexNode *));
+    node->children[at] = child;
+    ++node->numChildren;
+
+    return 0;
+}
+
+static size_t svPrefixIndexCommonLength(const char *a, size_t aLength,
+                                        const char *b, size_t bLength) {
+    size_t length = 0;
+    while (length < aLength && length < bLength && a[length] == b[length]) {
+        ++length;
+    }
+
+    return length;
+}
+
+/**
+ * \returns Node where \p name ends, NULL if there is none.
+ */
+static svPrefixIndexNode *svPrefixIndexFindNode(const svPrefixIndex *index,
+                                                const char *name) {
+    svPrefixIndexNode *node = (svPrefixIndexNode *)&index->root;
+    size_t length           = strlen(name);
+
+    while (length > 0) {
+        int at;
+        svPrefixIndexNode *child =
+            svPrefixIndexFindChild(node, (unsigned char)name[0], &at);
+        if (child == NULL || child->labelLength > length ||
+            memcmp(child->label, name, child->labelLength) != 0) {
+            return NULL;
+        }
+
+        node = child;
+        name += child->labelLength;
+        length -= child->labelLength;
+    }
+
+    return node;
+}
+
+/**
+ * \returns Highest node whose path starts with \p prefix, NULL if no node's
+ * does. The number of bytes of its label past the end of \p prefix is written
+ * to \p extra.
+ */
+static const svPrefixIndexNode *
+svPrefixIndexFindPrefix(const svPrefixIndex *index, const char *prefix,
+                        size_t *extra) {
+    const svPrefixIndexNode *node = &index->root;
+    size_t length                 = strlen(prefix);
+
+    *extra = 0;
+    while (length > 0) {
+        int at;
+        const svPrefixIndexNode *child =
+            svPrefixIndexFindChild(node, (unsigned char)prefix[0], &at);
+        if (child == NULL) {
+            return NULL;
+        }
+
+        size_t common = svPrefixIndexCommonLength(
+            child->label, child->labelLength, prefix, length);
+        if (common == length) {
+            *extra = child->labelLength - common;
+            return child;
+        } else if (common < child->labelLength) {
+            return NULL;
+        }
+
+        node = child;
+        prefix += common;
+        length -= common;
+    }
+
+    return node;
+}
+
+/**
+ * Free the child of \p node at \p at if it has no name or children, or merge
+ * it with its only child if it has no name.
+ */
+static void svPrefixIndexCompact(svPrefixIndexNode *node, int at) {
+    svPrefixIndexNode *child = node->children[at];
+    if (child->name != NULL || child->numChildren > 1) {
+        return;
+    }
+
+    if (child->numChildren == 0) {
+        svPrefixIndexFreeNode(child);
+        free(child);
+        memmove(node->children + at, node->children + at + 1,
+                (node->numChildren - at - 1) * sizeof(svPrefixIndexNode *));
+        --node->numChildren;
+        return;
+    }
+
+    svPrefixIndexNode *grandchild = child->children[0];
+    size_t length = child->labelLength + grandchild->labelLength;
+    char *label   = (char *)malloc(length);
+    if (label == NULL) {
+        /* Leave it unmerged, which is still a valid trie */
+        return;
+    }
+    memcpy(label, child->label, child->labelLength);
+    memcpy(label + child->labelLength, grandchild->label,
+           grandchild->labelLength);
+
+    free(grandchild->label);
+    grandchild->label       = label;
+    grandchild->labelLength = length;
+    node->children[at]      = grandchild;
+    svPrefixIndexUpdateNode(grandchild);
+
+    child->numChildren = 0;
+    svPrefixIndexFreeNode(child);
+    free(child);
+}
+
+/**
+ * Take \p kinds from the name \p length bytes of \p name below \p node.
+ *
+ * \returns 1 if the name was removed, 0 otherwise.
+ */
+static int svPrefixIndexRemoveBelow(svPrefixIndexNode *node, const char *name,
+                                    size_t length, unsigned int kinds,
+                                    unsigned int *oldKinds) {
+    if (length == 0) {
+        if (node->name == NULL) {
+            return 0;
+        }
+
+        *oldKinds = node->kinds;
+        node->kinds &= ~kinds;
+        if (node->kinds != 0) {
+            return 0;
+        }
+
+        free(node->name);
+        node->name = NULL;
+        --node->count;
+        svPrefixIndexUpdateNode(node);
+        return 1;
+    }
+
+    int at;
+    svPrefixIndexNode *child =
+        svPrefixIndexFindChild(node, (unsigned char)name[0], &at);
+    if (child == NULL || child->labelLength > length ||
+        memcmp(child->label, name, child->labelLength) != 0) {
+        return 0;
+    }
+
+    if (!svPrefixIndexRemoveBelow(child, name + child->labelLength,
+                                  length - child->labelLength, kinds,
+                                  oldKinds)) {
+        return 0;
+    }
+
+    --node->count;
+    svPrefixIndexCompact(node, at);
+    svPrefixIndexUpdateNode(node);
+
+    return 1;
+}
+
+typedef struct svPrefixIndexCollector {
+    unsigned int kinds;
+    svPrefixIndexMatch *matches;
+    size_t maxMatches;
+    size_t numMatches;
+} svPrefixIndexCollector;
+
+/**
+ * Add names at and below \p node, in byte order, until the collector is full.
+ */
+static void svPrefixIndexCollect(const svPrefixIndexNode *node, size_t length,
+                                 svPrefixIndexCollector *collector) {
+    if (node->name != NULL && (node->kinds & collector->kinds)) {
+        svPrefixIndexMatch *match = collector->matches + collector->numMatches;
+        match->name               = node->name;
+        match->length             = length;
+        match->kinds              = node->kinds;
+        match->score              = 0;
+        ++collector->numMatches;
+    }
+
+    for (int i = 0; i < node->numChildren &&
+                    collector->numMatches < collector->maxMatches;
+         ++i) {
+        const svPrefixIndexNode *child = node->children[i];
+        svPrefixIndexCollect(child, length + child->labelLength, collector);
+    }
+}
+
+typedef struct svPrefixIndexSearcher {
+    const char *pattern;
+    size_t patternLength;
+    const uint64_t *needed; /* Characters in each suffix of the pattern */
+    unsigned int kinds;
+    svPrefixIndexMatch *matches; /* Best first */
+    size_t maxMatches;
+    size_t numMatches;
+} svPrefixIndexSearcher;
+
+/**
+ * \returns 1 if a name of \p length with \p score might be better than the
+ * worst match kept, or there is room for it.
+ */
+static int svPrefixIndexMightKeep(const svPrefixIndexSearcher *searcher,
+                                  int score, size_t length) {
+    if (searcher->numMatches < searcher->maxMatches) {
+        return 1;
+    }
+
+    /* Names visited later are later in byte order, so only a lower score or
+     * a shorter name is better */
+    const svPrefixIndexMatch *worst =
+        searcher->matches + searcher->numMatches - 1;
+    return score < worst->score ||
+           (score == worst->score && length < worst->length);
+}
+
+static void svPrefixIndexKeep(svPrefixIndexSearcher *searcher,
+                              const svPrefixIndexNode *node, size_t length,
+                              int score) {
+    if (!svPrefixIndexMightKeep(searcher, score, length)) {
+        return;
+    }
+
+    size_t at = searcher->numMatches;
+    if (at == searcher->maxMatches) {
+        --at;
+    }
+    while (at > 0 && (score < searcher->matches[at - 1].score ||
+                      (score == searcher->matches[at - 1].score &&
+                       length < searcher->matches[at - 1].length))) {
+        searcher->matches[at] = searcher->matches[at - 1];
+        --at;
+    }
+
+    svPrefixIndexMatch *match = searcher->matches + at;
+    match->name               = node->name;
+    match->length             = length;
+    match->kinds              = node->kinds;
+    match->score              = score;
+
+    if (searcher->numMatches < searcher->maxMatches) {
+        ++searcher->numMatches;
+    }
+}
+
+/**
+ * Search at and below \p node, whose path is \p length bytes long and matches
+ * the first \p matched bytes of the pattern, ending at \p end.
+ */
+static void svPrefixIndexSearchBelow(svPrefixIndexSearcher *searcher,
+                                     const svPrefixIndexNode *node,
+                                     size_t length, size_t matched,
+                                     size_t end) {
+    /* The rest of the pattern can only make the score and length grow */
+    size_t remaining    = searcher->patternLength - matched;
+    int lowestScore     = (int)(((matched == searcher->patternLength)
+                                     ? end
+                                     : length + remaining) -
+                               searcher->patternLength);
+    size_t lowestLength = (length + remaining > node->minLength)
+                              ? length + remaining
+                              : node->minLength;
+    if (!svPrefixIndexMightKeep(searcher, lowestScore, lowestLength)) {
+        return;
+    }
+
+    if (remaining == 0 && node->name != NULL &&
+        (node->kinds & searcher->kinds)) {
+        svPrefixIndexKeep(searcher, node, length, lowestScore);
+    }
+
+    for (int i = 0; i < node->numChildren; ++i) {
+        const svPrefixIndexNode *child = node->children[i];
+        if (searcher->needed[matched] & ~child->chars) {
+            /* Rest of the pattern isn't found below the child */
+            continue;
+        }
+
+        size_t childMatched = matched;
+        size_t childEnd     = end;
+        for (size_t j = 0;
+             j < child->labelLength && childMatched < searcher->patternLength;
+             ++j) {
+            if (svPrefixIndexFold((unsigned char)child->label[j]) ==
+                svPrefixIndexFold(
+                    (unsigned char)searcher->pattern[childMatched])) {
+                ++childMatched;
+                childEnd = length + j + 1;
+            }
+        }
+
+        svPrefixIndexSearchBelow(searcher, child, length + child->labelLength,
+                                 childMatched, childEnd);
+    }
+}
+
+void svPrefixIndexInit(svPrefixIndex *index) {
+    memset(index, 0, sizeof(svPrefixIndex));
+}
+
+void svPrefixIndexFree(svPrefixIndex *index) {
+    svPrefixIndexFreeNode(&index->root);
+    svPrefixIndexInit(index);
+}
+
+int svPrefixIndexInsert(svPrefixIndex *index, const char *name,
+                        unsigned int kinds) {
+    svPrefixIndexNode *node = svPrefixIndexFindNode(index, name);
+    if (node != NULL && node->name != NULL) {
+        node->kinds |= kinds;
+        return 0;
+    }
+
+    size_t nameLength = strlen(name);
+    char *copy        = (char *)malloc(nameLength + 1);
+    if (copy == NULL) {
+        return -1;
+    }
+    memcpy(copy, name, nameLength + 1);
+
+    node               = &index->root;
+    const char *rest   = name;
+    size_t restLength  = nameLength;
+    while (restLength > 0) {
+        int at;
+        svPrefixIndexNode *child =
+            svPrefixIndexFindChild(node, (unsigned char)rest[0], &at);
+
+        if (child == NULL) {
+            child = svPrefixIndexNewNode(rest, restLength);
+            if (child == NULL || svPrefixIndexAddChild(node, at, child) != 0) {
+                if (child != NULL) {
+                    svPrefixIndexFreeNode(child);
+                    free(child);
+                }
+                free(copy);
+                return -1;
+            }
+        } else {
+            size_t common = svPrefixIndexCommonLength(
+                child->label, child->labelLength, rest, restLength);
+
+            if (common < child->labelLength) {
+                /* Split the edge where the name leaves it */
+                svPrefixIndexNode *split =
+                    svPrefixIndexNewNode(child->label, common);
+                if (split == NULL ||
+                    svPrefixIndexAddChild(split, 0, child) != 0) {
+                    if (split != NULL) {
+                        svPrefixIndexFreeNode(split);
+                        free(split);
+                    }
+                    free(copy);
+                    return -1;
+                }
+
+                memmove(child->label, child->label + common,
+                        child->labelLength - common);
+                child->labelLength -= common;
+                svPrefixIndexUpdateNode(child);
+                split->count       = child->count;
+                split->minLength   = child->minLength;
+                split->chars       |= child->chars;
+                node->children[at] = split;
+                child              = split;
+            }
+        }
+
+        node = child;
+        rest += child->labelLength;
+        restLength -= child->labelLength;
+    }
+
+    node->name  = copy;
+    node->kinds = kinds;
+
+    /* Count the name on its path, now that nothing can fail */
+    node       = &index->root;
+    size_t end = 0; /* Length of the path to the end of the node's label */
+    for (;;) {
+        size_t start = end - node->labelLength;
+        ++node->count;
+        node->chars |= svPrefixIndexGetChars(name + start, nameLength - start);
+        if (node->count == 1 || nameLength < node->minLength) {
+            node->minLength = nameLength;
+        }
+        if (end == nameLength) {
+            break;
+        }
+
+        int at;
+        node = svPrefixIndexFindChild(node, (unsigned char)name[end], &at);
+        end += node->labelLength;
+    }
+
+    return 0;
+}
+
+unsigned int svPrefixIndexRemove(svPrefixIndex *index, const char *name,
+                                 unsigned int kinds) {
+    unsigned int oldKinds = 0;
+    svPrefixIndexRemoveBelow(&index->root, name, strlen(name), kinds,
+                             &oldKinds);
+
+    return oldKinds;
+}
+
+unsigned int svPrefixIndexFind(const svPrefixIndex *index, const char *name) {
+    const svPrefixIndexNode *node = svPrefixIndexFindNode(index, name);
+    return (node != NULL && node->name != NULL) ? node->kinds : 0;
+}
+
+size_t svPrefixIndexGetCount(const svPrefixIndex *index) {
+    return index->root.count;
+}
+
+size_t svPrefixIndexCountPrefix(const svPrefixIndex *index,
+                                const char *prefix) {
+    size_t extra;
+    const svPrefixIndexNode *node =
+        svPrefixIndexFindPrefix(index, prefix, &extra);
+
+    return (node != NULL) ? node->count : 0;
+}
+
+size_t svPrefixIndexComplete(const svPrefixIndex *index, const char *prefix,
+                             unsigned int kinds, svPrefixIndexMatch *matches,
+                             size_t maxMatches) {
+    size_t extra;
+    const svPrefixIndexNode *node =
+        svPrefixIndexFindPrefix(index, prefix, &extra);
+    if (node == NULL || maxMatches == 0) {
+        return 0;
+    }
+
+    svPrefixIndexCollector collector;
+    collector.kinds      = kinds;
+    collector.matches    = matches;
+    collector.maxMatches = maxMatches;
+    collector.numMatches = 0;
+    svPrefixIndexCollect(node, strlen(prefix) + extra, &collector);
+
+    return collector.numMatches;
+}
+
+size_t svPrefixIndexGetCommonPrefix(const svPrefixIndex *index,
+                                    const char *prefix, char *out,
+                                    size_t outSize) {
+    if (outSize == 0) {
+        return 0;
+    }
+
+    size_t length = strlen(prefix);
+    size_t copied = (length < outSize - 1) ? length : outSize - 1;
+    memcpy(out, prefix, copied);
+
+    size_t extra;
+    const svPrefixIndexNode *node =
+        svPrefixIndexFindPrefix(index, prefix, &extra);
+    if (node == NULL || node->count == 0) {
+        out[copied] = '\0';
+        return 0;
+    }
+
+    /* Follow the path while it doesn't branch */
+    const char *label = node->label + node->labelLength - extra;
+    for (;;) {
+        size_t count = (extra < outSize - 1 - copied) ? extra
+                                                      : outSize - 1 - copied;
+        if (count > 0) {
+            memcpy(out + copied, label, count);
+            copied += count;
+        }
+
+        if (node->name != NULL || node->numChildren != 1) {
+            break;
+        }
+        node  = node->children[0];
+        label = node->label;
+        extra = node->labelLength;
+    }
+    out[copied] = '\0';
+
+    return svPrefixIndexCountPrefix(index, prefix);
+}
+
+size_t svPrefixIndexSearch(const svPrefixIndex *index, const char *pattern,
+                           unsigned int kinds, svPrefixIndexMatch *matches,
+                           size_t maxMatches) {
+    if (maxMatches == 0) {
+        return 0;
+    }
+
+    size_t patternLength = strlen(pattern);
+    uint64_t stackNeeded[SV_PREFIX_INDEX_MAX_STACK_PATTERN + 1];
+    uint64_t *needed = stackNeeded;
+    if (patternLength > SV_PREFIX_INDEX_MAX_STACK_PATTERN) {
+        needed = (uint64_t *)malloc((patternLength + 1) * sizeof(uint64_t));
+        if (needed == NULL) {
+            return 0;
+        }
+    }
+
+    needed[patternLength] = 0;
+    for (size_t i = patternLength; i > 0; --i) {
+        needed[i - 1] =
+            needed[i] | svPrefixIndexCharBit((unsigned char)pattern[i - 1]);
+    }
+
+    svPrefixIndexSearcher searcher;
+    searcher.pattern       = pattern;
+    searcher.patternLength = patternLength;
+    searcher.needed        = needed;
+    searcher.kinds         = kinds;
+    searcher.matches       = matches;
+    searcher.maxMatches    = maxMatches;
+    searcher.numMatches    = 0;
+    if (index->root.count > 0) {
+        svPrefixIndexSearchBelow(&searcher, &index->root, 0, 0, 0);
+    }
+
+    if (needed != stackNeeded) {
+        free(needed);
+    }
+
+    return searcher.numMatches;
+}
@@ -4,13 +4,16 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <sv/console/CommandTable.h>
 #include <sv/console/Commands.h>
+#include <sv/console/OutputBuffer.h>
 #include <sv/console/Shell.h>
 #include <sv/console/Tokenizer.h>
 
-#define SV_SHELL_OUT_BUFFER_SIZE 1024
-static char svOutputBuffer[SV_SHELL_OUT_BUFFER_SIZE];
-static char svErrorBuffer[SV_SHELL_OUT_BUFFER_SIZE];
+static svOutputBuffer svShellOutputBuffer = {
+    .maxSize = SV_OUTPUT_BUFFER_DEFAULT_MAX_SIZE};
+static svOutputBuffer svShellErrorBuffer = {
+    .maxSize = SV_OUTPUT_BUFFER_DEFAULT_MAX_SIZE};
 
 typedef struct svShellCommand {
     const char *cmdName;
@@ -20,17 +23,21 @@ typedef struct svShellCommand {
 #define SV_SHELL_MAX_COMMANDS 256
 static svShellCommand svShellCommands[SV_SHELL_MAX_COMMANDS];
 static int svShellCommandsNum = 0;
+/* Index of each command in 'svShellCommands' by name */
+static svCommandTable svShellCommandTable;
 
 int svShellAddCommand(const char *commandName,
                       int (*commandFunction)(int, char **)) {
     if (svShellCommandsNum == SV_SHELL_MAX_COMMANDS - 1) {
         return -1;
     }
-    for (int i = 0; i < svShellCommandsNum; ++i) {
-        /* Attempt to find existing command */
-        if (strcmp(commandName, svShellCommands[i].cmdName) == 0) {
-            return -2;
-        }
+    /* Attempt to find existing command */
+    if (svCommandTableFind(&svShellCommandTable, commandName) >= 0) {
+        return -2;
+    }
+    if (svCommandTableInsert(&svShellCommandTable, commandName,
+                             svShellCommandsNum) != 0) {
+        return -1;
     }
 
     svShellCommands[svShellCommandsNum].cmdName = commandName;
@@ -41,22 +48,14 @@ int svShellAddCommand(const char *commandName,
 }
 
 void svShellRemoveCommand(const char *commandName) {
-    for (int i = 0; i < svShellCommandsNum; ++i) {
-        /* Find command to remove */
-        if (strcmp(commandName, svShellCommands[i].cmdName) == 0) {
-            /* If last command, merely reduce the number of shell commands and
-             * let next command overwrite */
-            if (i != svShellCommandsNum - 1) {
-                /* Remove command by shifting every command after back one pos
-                 */
-                for (int j = i; j < svShellCommandsNum - 1; ++j) {
-                    svShellCommands[j].cmdName = svShellCommands[j + 1].cmdName;
-                    svShellCommands[j].cmdFunc = svShellCommands[j + 1].cmdFunc;
-                }
-            }
-
-            --svShellCommandsNum;
-            break;
+    int i = svCommandTableRemove(&svShellCommandTable, commandName);
+    if (i >= 0) {
+        /* Move last command into the removed command's place */
+        --svShellCommandsNum;
+        if (i != svShellCommandsNum) {
+            svShellCommands[i] = svShellCommands[svShellCommandsNum];
+            svCommandTableInsert(&svShellCommandTable,
+                                 svShellCommands[i].cmdName, i);
         }
     }
 }
@@ -65,18 +64,34 @@ int svShellExecute(const char *inputLine) {
     int result = 0;
 
     /* Clear output and error buffers */
-    memset(svOutputBuffer, '\0', SV_SHELL_OUT_BUFFER_SIZE);
-    memset(svErrorBuffer, '\0', SV_SHELL_OUT_BUFFER_SIZE);
-
-    /* Validate input line */
+    svOutputBufferClear(&svShellOutputBuffer);
+    svOutputBufferClear(&svShellErrorBuffer);
+
+    /* Copy input line into a buffer we can modify, followed by the token and
+     * command arrays so the whole line is parsed in one allocation */
+    size_t inputLineLength = strlen(inputLine) + 1; /* +1 for NULL-terminator */
+    int maxTokens          = (int)(inputLineLength / 2 + 2);
+    size_t tokensOffset =
+        (inputLineLength + sizeof(char *) - 1) / sizeof(char *) *
+        sizeof(char *);
+    size_t commandsOffset = tokensOffset + sizeof(char *) * maxTokens;
+    char *parseBuffer =
+        (char *)malloc(commandsOffset + sizeof(svCommand) * maxTokens);
+    char *inputLineCopy = parseBuffer;
+    char **token        = (char **)(parseBuffer + tokensOffset);
+    svCommand *commands = (svCommand *)(parseBuffer + commandsOffset);
+    memcpy(inputLineCopy, inputLine, inputLineLength);
+
+    /* Tokenize input line */
     svTokenizerError tokenizerError;
-    if (svTokenizerValidateInput(inputLine, &tokenizerError) != 0) {
+    if (svTokenizerTokenizeInPlace(inputLineCopy, token, maxTokens,
+                                   &tokenizerError) < 0) {
         /* Error occurred */
         switch (tokenizerError.errorCode) {
         case -1: {
-            snprintf(svErrorBuffer, SV_SHELL_OUT_BUFFER_SIZE, "%s%d.",
-                     "String not closed at position ",
-                     tokenizerError.characterPos);
+            svOutputBufferPrint(&svShellErrorBuffer, "%s%d.",
+                                "String not closed at position ",
+                                tokenizerError.characterPos);
             break;
         }
         default:
@@ -85,32 +100,18 @@ int svShellExecute(const char *inputLine) {
 
         result = -1;
     } else {
-        /* Copy input line into a buffer we can modify */
-        size_t inputLineLength =
-            strlen(inputLine) + 1; /* +1 for NULL-terminator */
-        char *inputLineCopy = (char *)malloc(sizeof(char) * inputLineLength);
-        memset(inputLineCopy, '\0', inputLineLength);
-        snprintf(inputLineCopy, inputLineLength, "%s", inputLine);
-
-        /** Allocate tokens array */
-        int numTokens = svTokenizerGetNumTokens(inputLine, NULL) +
-                        1; /* NULL for error out
-                        * because we already
-                        * validated input above */
-        char **token = (char **)malloc(sizeof(char **) * numTokens);
-        memset(token, '\0', sizeof(char *) * numTokens);
-        svTokenizerTokenize(inputLineCopy, token, NULL);
-
-        /* Validate token array */
+        /* Separate tokens into commands */
         svCommandError commandError;
-        if (svCommandsValidateTokenArray(token, &commandError) != 0) {
+        int numCommands =
+            svCommandsSeparateInPlace(token, commands, &commandError);
+        if (numCommands < 0) {
             /* Error occurred */
             switch (commandError.errorCode) {
             case -1:
                 /* Two successive commands are separated by more than one
                  * command separator */
-                snprintf(
-                    svErrorBuffer, SV_SHELL_OUT_BUFFER_SIZE,
+                svOutputBufferPrint(
+                    &svShellErrorBuffer,
                     "Two successive commands are separated by more than one "
                     "command separator: %s %s %s",
                     token[commandError.tokenPos - 1],
@@ -119,8 +120,8 @@ int svShellExecute(const char *inputLine) {
                 break;
             case -2:
                 /* First token is a command separator */
-                snprintf(svErrorBuffer, SV_SHELL_OUT_BUFFER_SIZE,
-                         "First token is a command separator.");
+                svOutputBufferPrint(&svShellErrorBuffer,
+                                    "First token is a command separator.");
                 break;
             default:
                 break;
@@ -128,100 +129,78 @@ int svShellExecute(const char *inputLine) {
 
             result = -1;
         } else {
-            /* Allocate space for commands, +1 for NULL command required. */
-            int numCommands = svCommandsGetNum(token, NULL) + 1;
-            svCommand *commands =
-                (svCommand *)malloc(sizeof(svCommand) * numCommands);
-            memset(commands, '\0', sizeof(svCommand) * numCommands);
-            svCommandsMakeNullCommand(commands + numCommands - 1);
-
-            svCommandsSeparate(token, commands, NULL);
-
             /* Process commands */
-            /* For each command (ignoring NULL command),
-             * calc argc, send argv, argc to matchin funcptr (if any) */
-            for (int i = 0; i < numCommands - 1; ++i) {
+            /* For each command, send argv, argc to matching funcptr (if any) */
+            for (int i = 0; i < numCommands && result == 0; ++i) {
                 svCommand *command = commands + i;
                 /* Find matching shell command */
-                int found = 0;
-                for (int j = 0; j < svShellCommandsNum; ++j) {
-                    if (strcmp(command->argv[0], svShellCommands[j].cmdName) ==
-                        0) {
-                        found = 1;
-                        /* Calc argc */
-                        int argc = 0;
-                        for (int k = 0; command->argv[k] != NULL; ++k) {
-                            ++argc;
-                        }
-
-                        int result =
-                            svShellCommands[j].cmdFunc(argc, command->argv);
-                        if (result != 0) {
-                            free(commands);
-                            free(token);
-                            free(inputLineCopy);
-
-                            return -1;
-                        }
-
-                        break;
-                    }
-                }
+                int j =
+                    svCommandTableFind(&svShellCommandTable, command->argv[0]);
+                if (j >= 0) {
+                    int argc = command->last - command->first + 1;
 
-                if (found == 0) {
-                    snprintf(svErrorBuffer, SV_SHELL_OUT_BUFFER_SIZE,
-                             "No command with name '%s'.", command->argv[0]);
-
-                    free(commands);
-                    free(token);
-                    free(inputLineCopy);
+                    if (svShellCommands[j].cmdFunc(argc, command->argv) != 0) {
+                        result = -1;
+                    }
+                } else {
+                    svOutputBufferPrint(&svShellErrorBuffer,
+                                        "No command with name '%s'.",
+                                        command->argv[0]);
 
-                    return -1;
+                    result = -1;
                 }
             }
-
-            free(commands);
         }
-
-        free(token);
-        free(inputLineCopy);
     }
 
+    free(parseBuffer);
+
     return result;
 }
 
 size_t svShellGetOutputBufferSize() {
-    return ((strlen(svOutputBuffer) + 1) * sizeof(char));
+    return (svOutputBufferGetSize(&svShellOutputBuffer) + 1) * sizeof(char);
 }
 
 void svShellGetOutputBuffer(void *outBuffer) {
-    snprintf(outBuffer, svShellGetOutputBufferSize(), "%s", svOutputBuffer);
+    svOutputBufferCopy(&svShellOutputBuffer, (char *)outBuffer,
+                       svShellGetOutputBufferSize());
 }
 
 size_t svShellGetErrorBufferSize() {
-    return ((strlen(svErrorBuffer) + 1) * sizeof(char));
+    return (svOutputBufferGetSize(&svShellErrorBuffer) + 1) * sizeof(char);
 }
 
 void svShellGetErrorBuffer(void *outBuffer) {
-    snprintf(outBuffer, svShellGetErrorBufferSize(), "%s", svErrorBuffer);
+    svOutputBufferCopy(&svShellErrorBuffer, (char *)outBuffer,
+                       svShellGetErrorBufferSize());
+}
+
+void svShellSetOutputBufferMaxSize(size_t maxSize) {
+    svOutputBufferSetMaxSize(&svShellOutputBuffer, maxSize);
+    svOutputBufferSetMaxSize(&svShellErrorBuffer, maxSize);
+}
+
+void svShellSetOutputCallback(svOutputBufferCallback callback,
+                              void *userData) {
+    svOutputBufferSetCallback(&svShellOutputBuffer, callback, userData);
+}
+
+void svShellSetErrorCallback(svOutputBufferCallback callback,
+                             void *userData) {
+    svOutputBufferSetCallback(&svShellErrorBuffer, callback, userData);
 }
 
 void svShellPrintOutputBuffer(const char *format, ...) {
     va_list argptr;
     va_start(argptr, format);
-    /* Find current end of buffer */
-    size_t endOffset = strlen(svOutputBuffer);
-    vsnprintf(svOutputBuffer + endOffset, SV_SHELL_OUT_BUFFER_SIZE - endOffset,
-              format, argptr);
+    svOutputBufferVPrint(&svShellOutputBuffer, format, argptr);
     va_end(argptr);
 }
 
 void svShellPrintErrorBuffer(const char *format, ...) {
     va_list argptr;
     va_start(argptr, format);
-    /* Find current end of buffer */
-    size_t endOffset = strlen(svErrorBuffer);
-    vsnprintf(svErrorBuffer + endOffset, SV_SHELL_OUT_BUFFER_SIZE - endOffset,
-              format, argptr);
+    svOutputBufferVPrint(&svShellErrorBuffer, format, argptr);
     va_end(argptr);
 }
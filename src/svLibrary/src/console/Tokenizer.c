@@ -34,6 +34,10 @@ static int svTokenizerFindOpenStrings(const char *inputLine,
         /* Ignore escape characters */
         if (*it == '\\') {
             ++it;
+            /* Trailing escape character */
+            if (*it == '\0') {
+                break;
+            }
         } else {
             /* A string has been opened */
             if (svTokenizerIsQuoteCharacter(*it)) {
@@ -53,6 +57,9 @@ static int svTokenizerFindOpenStrings(const char *inputLine,
                     if (*it == '\\') {
                         ++it;
                         /* If we don't find a close, return 1 */
+                        if (*it == '\0') {
+                            return 1;
+                        }
                     } else if (*it == '\0') {
                         return 1;
                     }
@@ -200,7 +207,9 @@ int svTokenizerTokenize(char *inputLine, char *token[],
         /* If escape character, skip over it and next character */
         if (*it == '\\') {
             ++it;
-            ++it;
+            if (*it) {
+                ++it;
+            }
         } else {
             /* If is quote character */
             if (svTokenizerIsQuoteCharacter(*it)) {
@@ -256,3 +265,112 @@ int svTokenizerTokenize(char *inputLine, char *token[],
     /* Else return no error */
     return 0;
 }
+
+int svTokenizerTokenizeInPlace(char *inputLine, char *token[], int maxTokens,
+                               svTokenizerError *error) {
+    int numTokens = 0;
+
+    /* Characters are read from 'it' and written back to 'out', which lags
+     * behind once an empty string has been removed */
+    const char *it = inputLine;
+    char *out      = inputLine;
+
+    /* Start of the token being read, NULL if between tokens */
+    char *tokenStart = NULL;
+    /* Whether the token has a string, so it is kept even if that is empty */
+    int tokenHasString = 0;
+
+    char currentQuoteType   = '\0';
+    const char *stringStart = NULL; /* Opening quote in the input line */
+    char *stringStartOut    = NULL; /* Opening quote in the output */
+
+    while (*it) {
+        if (currentQuoteType == '\0' && svTokenizerIsWhitespaceCharacter(*it)) {
+            if (tokenStart != NULL) {
+                /* End the token, even if it was only empty strings */
+                if (out != tokenStart || tokenHasString) {
+                    if (numTokens >= maxTokens - 1) {
+                        if (error != NULL) {
+                            error->errorCode    = -2;
+                            error->characterPos = (int)(it - inputLine);
+                        }
+                        return -1;
+                    }
+                    token[numTokens] = tokenStart;
+                    ++numTokens;
+                    *out = '\0';
+                    ++out;
+                }
+                tokenStart = NULL;
+            }
+            ++it;
+            continue;
+        }
+
+        if (tokenStart == NULL) {
+            tokenStart     = out;
+            tokenHasString = 0;
+        }
+
+        if (*it == '\\') {
+            /* Keep escape character and the character it escapes */
+            *out = *it;
+            ++out;
+            ++it;
+            if (*it) {
+                *out = *it;
+                ++out;
+                ++it;
+            }
+        } else if (svTokenizerIsQuoteCharacter(*it) &&
+                   currentQuoteType == '\0') {
+            /* Open a new string */
+            tokenHasString   = 1;
+            currentQuoteType = *it;
+            stringStart      = it;
+            stringStartOut   = out;
+            *out             = *it;
+            ++out;
+            ++it;
+        } else if (*it == currentQuoteType) {
+            /* Close the string, removing it if it is empty */
+            if (out - 1 == stringStartOut) {
+                out = stringStartOut;
+            } else {
+                *out = *it;
+                ++out;
+            }
+            currentQuoteType = '\0';
+            ++it;
+        } else {
+            *out = *it;
+            ++out;
+            ++it;
+        }
+    }
+
+    if (currentQuoteType != '\0') {
+        if (error != NULL) {
+            error->errorCode    = -1;
+            error->characterPos = (int)(stringStart - inputLine);
+        }
+        return -1;
+    }
+
+    if (tokenStart != NULL && (out != tokenStart || tokenHasString)) {
+        if (numTokens >= maxTokens - 1) {
+            if (error != NULL) {
+                error->errorCode    = -2;
+                error->characterPos = (int)(it - inputLine);
+            }
+            return -1;
+        }
+        token[numTokens] = tokenStart;
+        ++numTokens;
+    }
+    *out = '\0';
+
+    token[numTokens] = NULL;
+
+    return numTokens;
+}
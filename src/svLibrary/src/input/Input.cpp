@@ -1,18 +1,23 @@
+#include <utility>
+
 #include <sv/input/Input.h>
 
 namespace sv {
+Input::Input()
+    : bindings(NUM_KEYCODE_INDICES), keyActions(NUM_KEYCODE_INDICES, -1) {
+    svCommandTableInit(&actionTable);
+}
+
+Input::~Input() { svCommandTableFree(&actionTable); }
+
 // \returns Binding associated with given key name or nullptr if no binding
 // exists for that key name.
 Binding *Input::findBinding(const std::string &keyName) {
     Binding *binding = nullptr;
 
-    for (size_t i = 0; i < bindings.size(); ++i) {
-        Binding *bindingIt = &bindings[i];
-
-        if (bindingIt->keyName == keyName) {
-            binding = bindingIt;
-            break;
-        }
+    Keycodes::Enum keycode;
+    if (getKeycodeFromName(keyName, &keycode)) {
+        binding = findBinding(keycode);
     }
 
     return binding;
@@ -23,18 +28,26 @@ Binding *Input::findBinding(const std::string &keyName) {
 const Binding *Input::findBinding(const std::string &keyName) const {
     const Binding *binding = nullptr;
 
-    for (size_t i = 0; i < bindings.size(); ++i) {
-        const Binding *bindingIt = &bindings[i];
-
-        if (bindingIt->keyName == keyName) {
-            binding = bindingIt;
-            break;
-        }
+    Keycodes::Enum keycode;
+    if (getKeycodeFromName(keyName, &keycode)) {
+        binding = findBinding(keycode);
     }
 
     return binding;
 }
 
+Binding *Input::findBinding(Keycodes::Enum keycode) {
+    const int index = getKeycodeIndex(keycode);
+
+    return (index >= 0 && bindings[index].bound) ? &bindings[index] : nullptr;
+}
+
+const Binding *Input::findBinding(Keycodes::Enum keycode) const {
+    const int index = getKeycodeIndex(keycode);
+
+    return (index >= 0 && bindings[index].bound) ? &bindings[index] : nullptr;
+}
+
 std::string Input::getBinding(const std::string &keyName) const {
     std::string cmdString;
 
@@ -46,18 +59,191 @@ std::string Input::getBinding(const std::string &keyName) const {
     return cmdString;
 }
 
-void Input::clearAllBindings() { bindings.clear(); }
+void Input::clearAllBindings() {
+    for (Binding &binding : bindings) {
+        binding = Binding();
+    }
+}
+
+bool Input::bind(const std::string &keyName, const std::string &commandStr) {
+    bool result = false;
+
+    Keycodes::Enum keycode;
+    if (getKeycodeFromName(keyName, &keycode)) {
+        result = bind(keycode, commandStr);
+    }
+
+    return result;
+}
+
+bool Input::bind(Keycodes::Enum keycode, const std::string &commandStr) {
+    const int index = getKeycodeIndex(keycode);
+    if (index < 0) {
+        return false;
+    }
+
+    Binding &binding  = bindings[index];
+    binding.keycode   = keycode;
+    binding.cmdString = commandStr;
+    binding.bound     = true;
+    binding.compiled  = false;
+
+    return true;
+}
+
+bool Input::bind(Keycodes::Enum keycode, const std::string &commandStr,
+                 Console &console) {
+    const int index = getKeycodeIndex(keycode);
+    if (index < 0) {
+        return false;
+    }
+
+    Binding binding;
+    binding.keycode   = keycode;
+    binding.cmdString = commandStr;
+    binding.bound     = true;
+    if (!prepareBinding(binding, console)) {
+        return false;
+    }
+
+    bindings[index] = std::move(binding);
+
+    return true;
+}
+
+bool Input::execute(Keycodes::Enum keycode, Console &console) {
+    Binding *binding = findBinding(keycode);
+    if (binding == nullptr || !prepareBinding(*binding, console)) {
+        return false;
+    }
+
+    return console.execute(binding->commands);
+}
 
-void Input::bind(const std::string &keyName, const std::string &commandStr) {
-    Binding *binding = findBinding(keyName);
+bool Input::prepareBinding(Binding &binding, Console &console) {
+    if (binding.compiled) {
+        return true;
+    }
 
-    // if no binding already exists for that key, add one
-    if (binding == nullptr) {
-        bindings.push_back(Binding(keyName, commandStr));
+    if (!console.compile(binding.cmdString, &binding.commands)) {
+        return false;
     }
-    // else change existing binding
-    else {
-        binding->cmdString = commandStr;
+
+    // "+name" of a registered action, held without the console
+    const std::string &cmdString = binding.cmdString;
+    binding.action               = -1;
+    if (binding.commands.getNumCommands() == 1 && cmdString.size() > 1 &&
+        cmdString[0] == '+' &&
+        cmdString.find_first_of(" \t;\"'") == std::string::npos) {
+        binding.action = findAction(cmdString.substr(1));
     }
+
+    // Other "+command" lines are released with "-command"
+    binding.hasRelease = false;
+    if (binding.action < 0 && binding.commands.getNumCommands() == 1 &&
+        !cmdString.empty() && cmdString[0] == '+') {
+        const std::string release = "-" + cmdString.substr(1);
+        binding.hasRelease = console.compile(release, &binding.releaseCommands);
+    }
+
+    binding.compiled = true;
+
+    return true;
+}
+
+int Input::registerAction(const std::string &name) {
+    int action = findAction(name);
+    if (action < 0 && (int)actionNames.size() < MAX_INPUT_ACTIONS) {
+        action = (int)actionNames.size();
+        actionNames.push_back(name);
+        actionPresses.push_back(0);
+        svCommandTableInsert(&actionTable, name.c_str(), action);
+
+        // Bindings of "+name" resolve to the action from now on
+        for (Binding &binding : bindings) {
+            binding.compiled = false;
+        }
+    }
+
+    return action;
+}
+
+int Input::findAction(const std::string &name) const {
+    return svCommandTableFind(&actionTable, name.c_str());
+}
+
+void Input::pressAction(int action) {
+    if (action >= 0 && action < (int)actionPresses.size()) {
+        ++actionPresses[action];
+        if (!actionsDown[action]) {
+            actionsDown[action]    = true;
+            actionsPressed[action] = true;
+        }
+    }
+}
+
+void Input::releaseAction(int action) {
+    if (action >= 0 && action < (int)actionPresses.size() &&
+        actionPresses[action] > 0) {
+        --actionPresses[action];
+        if (actionPresses[action] == 0) {
+            actionsDown[action]     = false;
+            actionsReleased[action] = true;
+        }
+    }
+}
+
+bool Input::isActionDown(int action) const {
+    return action >= 0 && action < MAX_INPUT_ACTIONS && actionsDown[action];
+}
+
+bool Input::wasActionPressed(int action) const {
+    return action >= 0 && action < MAX_INPUT_ACTIONS && actionsPressed[action];
+}
+
+bool Input::wasActionReleased(int action) const {
+    return action >= 0 && action < MAX_INPUT_ACTIONS &&
+           actionsReleased[action];
+}
+
+const InputActionBits &Input::getActionsDown() const { return actionsDown; }
+
+void Input::beginFrame() {
+    actionsPressed.reset();
+    actionsReleased.reset();
+}
+
+bool Input::handleKey(Keycodes::Enum keycode, bool down, Console &console) {
+    const int index = getKeycodeIndex(keycode);
+    // Ignore key repeats, and releases of keys that weren't seen going down
+    if (index < 0 || keysDown[index] == down) {
+        return true;
+    }
+    keysDown[index] = down;
+
+    if (!down && keyActions[index] >= 0) {
+        releaseAction(keyActions[index]);
+        keyActions[index] = -1;
+        return true;
+    }
+
+    Binding *binding = findBinding(keycode);
+    if (binding == nullptr || !prepareBinding(*binding, console)) {
+        return binding == nullptr;
+    }
+
+    bool result = true;
+    if (binding->action >= 0) {
+        if (down) {
+            pressAction(binding->action);
+            keyActions[index] = binding->action;
+        }
+    } else if (down) {
+        result = console.execute(binding->commands);
+    } else if (binding->hasRelease) {
+        result = console.execute(binding->releaseCommands);
+    }
+
+    return result;
 }
 }
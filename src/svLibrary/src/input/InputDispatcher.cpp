@@ -0,0 +1,80 @@
+#include <memory>
+
+#include <sv/console/ConsoleCommands.h>
+#include <sv/input/InputDispatcher.h>
+
+namespace sv {
+InputDispatcher::InputDispatcher(Input &input_, Console &console_)
+    : input(input_), console(console_), batch(INPUT_DISPATCHER_BATCH_SIZE),
+      mouseDeltaX(0), mouseDeltaY(0), quitRequested(false) {}
+
+int InputDispatcher::registerAction(const std::string &name) {
+    const int action = input.registerAction(name);
+    if (action >= 0) {
+        console.registerCommand(
+            "+" + name, std::make_shared<ActionCommand>(input, action, true));
+        console.registerCommand(
+            "-" + name, std::make_shared<ActionCommand>(input, action, false));
+    }
+
+    return action;
+}
+
+size_t InputDispatcher::dispatch(Platform &platform) {
+    input.beginFrame();
+    mouseDeltaX = 0;
+    mouseDeltaY = 0;
+    textInput.clear();
+
+    size_t numEvents = 0;
+    for (;;) {
+        const size_t numBatched =
+            platform.pollEvents(batch.data(), batch.size());
+        dispatch(batch.data(), numBatched);
+        numEvents += numBatched;
+
+        // A full batch may have left events behind
+        if (numBatched < batch.size()) {
+            break;
+        }
+    }
+
+    return numEvents;
+}
+
+void InputDispatcher::dispatch(const PlatformEvent *events, size_t numEvents) {
+    for (size_t i = 0; i < numEvents; ++i) {
+        const PlatformEvent &event = events[i];
+
+        switch (event.type) {
+        case PlatformEventType::Key: {
+            input.handleKey((Keycodes::Enum)event.value1, event.value2 != 0,
+                            console);
+            break;
+        }
+        case PlatformEventType::Mouse: {
+            mouseDeltaX += event.value1;
+            mouseDeltaY += event.value2;
+            break;
+        }
+        case PlatformEventType::TextInput: {
+            textInput.append(event.text, event.textLength);
+            break;
+        }
+        case PlatformEventType::Quit: {
+            quitRequested = true;
+            break;
+        }
+        default: { break; }
+        }
+    }
+}
+
+int InputDispatcher::getMouseDeltaX() const { return mouseDeltaX; }
+
+int InputDispatcher::getMouseDeltaY() const { return mouseDeltaY; }
+
+const std::string &InputDispatcher::getTextInput() const { return textInput; }
+
+bool InputDispatcher::wasQuitRequested() const { return quitRequested; }
+}
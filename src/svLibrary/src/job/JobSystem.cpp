@@ -0,0 +1,340 @@
+#include <cassert>
+
+#include <sv/job/JobSystem.h>
+
+namespace sv {
+namespace {
+// Job system and index of the calling thread, if it is one of its threads
+thread_local JobSystem *threadJobSystem = nullptr;
+thread_local int threadIndex            = -1;
+
+// State of the calling thread's generator for picking steal victims
+thread_local uint32_t stealRandomState = 0;
+
+// \returns Next number from the calling thread's xorshift generator
+uint32_t nextStealRandom() {
+    uint32_t x = stealRandomState;
+    if (x == 0) {
+        x = 2463534242u ^ (uint32_t)(threadIndex + 1);
+    }
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    stealRandomState = x;
+
+    return x;
+}
+}
+
+JobDeque::JobDeque(size_t capacity)
+    : slots(new Slot[capacity]), mask((int64_t)capacity - 1), top(0),
+      bottom(0) {
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+}
+
+bool JobDeque::push(const QueuedJob &job) {
+    const int64_t b = bottom.load(std::memory_order_relaxed);
+    const int64_t t = top.load(std::memory_order_acquire);
+    if (b - t > mask) {
+        return false;
+    }
+
+    Slot &slot = slots[b & mask];
+    slot.function.store(job.job.function, std::memory_order_relaxed);
+    slot.data.store(job.job.data, std::memory_order_relaxed);
+    slot.counter.store(job.counter, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release);
+
+    return true;
+}
+
+bool JobDeque::pop(QueuedJob *job) {
+    const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // Empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Slot &slot        = slots[b & mask];
+    job->job.function = slot.function.load(std::memory_order_relaxed);
+    job->job.data     = slot.data.load(std::memory_order_relaxed);
+    job->counter      = slot.counter.load(std::memory_order_relaxed);
+
+    bool result = true;
+    if (t == b) {
+        // Last job, race thieves for it
+        result = top.compare_exchange_strong(t, t + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+bool JobDeque::steal(QueuedJob *job) {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return false;
+    }
+
+    Slot &slot        = slots[t & mask];
+    job->job.function = slot.function.load(std::memory_order_relaxed);
+    job->job.data     = slot.data.load(std::memory_order_relaxed);
+    job->counter      = slot.counter.load(std::memory_order_relaxed);
+
+    return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed);
+}
+
+size_t JobDeque::getSize() const {
+    const int64_t b = bottom.load(std::memory_order_relaxed);
+    const int64_t t = top.load(std::memory_order_relaxed);
+
+    return (b > t) ? (size_t)(b - t) : 0;
+}
+
+JobSystem::JobSystem()
+    : initialized(false), numSharedJobs(0), numQueuedJobs(0),
+      numSleepingWorkers(0), running(false), numStolenJobs(0) {}
+
+JobSystem::~JobSystem() { shutdown(); }
+
+bool JobSystem::initialize(int numWorkerThreads) {
+    if (initialized) {
+        return false;
+    }
+
+    if (numWorkerThreads < 0) {
+        numWorkerThreads = (int)std::thread::hardware_concurrency() - 1;
+        numWorkerThreads = std::max(numWorkerThreads, 0);
+    }
+
+    for (int i = 0; i < numWorkerThreads + 1; ++i) {
+        deques.push_back(std::unique_ptr<JobDeque>(new JobDeque()));
+    }
+
+    initialized     = true;
+    threadJobSystem = this;
+    threadIndex     = 0;
+
+    running.store(true);
+    for (int i = 1; i < numWorkerThreads + 1; ++i) {
+        workers.push_back(std::thread(&JobSystem::workerMain, this, i));
+    }
+
+    return true;
+}
+
+void JobSystem::shutdown() {
+    if (!initialized) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running.store(false);
+    }
+    wakeCondition.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    deques.clear();
+    sharedJobs.clear();
+    numSharedJobs.store(0);
+    numQueuedJobs.store(0);
+
+    if (threadJobSystem == this) {
+        threadJobSystem = nullptr;
+        threadIndex     = -1;
+    }
+    initialized = false;
+}
+
+int JobSystem::getNumThreads() const { return (int)deques.size(); }
+
+int JobSystem::getThreadIndex() const {
+    return (threadJobSystem == this) ? threadIndex : -1;
+}
+
+void JobSystem::run(const Job &job, JobCounter *counter) {
+    run(&job, 1, counter);
+}
+
+void JobSystem::run(const Job *jobs, size_t numJobs, JobCounter *counter) {
+    if (counter != nullptr) {
+        counter->value.fetch_add((int)numJobs, std::memory_order_relaxed);
+    }
+
+    QueuedJob queued;
+    queued.counter = counter;
+
+    if (!initialized) {
+        for (size_t i = 0; i < numJobs; ++i) {
+            queued.job = jobs[i];
+            execute(queued);
+        }
+        return;
+    }
+
+    // Counted before they can be taken, so the count never drops below 0
+    numQueuedJobs.fetch_add((int64_t)numJobs);
+
+    const int index = getThreadIndex();
+    for (size_t i = 0; i < numJobs; ++i) {
+        queued.job = jobs[i];
+        if (index < 0 || !deques[index]->push(queued)) {
+            std::lock_guard<std::mutex> lock(sharedMutex);
+            sharedJobs.push_back(queued);
+            numSharedJobs.fetch_add(1);
+        }
+    }
+
+    // Sleeping workers count themselves before checking for jobs, so either
+    // they see the jobs or they are seen here
+    const int numSleeping = numSleepingWorkers.load();
+    if (numSleeping > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (numJobs > 1 && numSleeping > 1) {
+            wakeCondition.notify_all();
+        } else {
+            wakeCondition.notify_one();
+        }
+    }
+}
+
+void JobSystem::wait(const JobCounter &counter) {
+    const int index = getThreadIndex();
+    while (!counter.isDone()) {
+        if (index == 0) {
+            executeMainThreadJobs();
+        }
+        if (!runNextJob(index)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::runOnMainThread(const Job &job, JobCounter *counter) {
+    if (counter != nullptr) {
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    QueuedJob queued;
+    queued.job     = job;
+    queued.counter = counter;
+
+    std::lock_guard<std::mutex> lock(mainThreadMutex);
+    mainThreadJobs.push_back(queued);
+}
+
+size_t JobSystem::executeMainThreadJobs() {
+    size_t numRun = 0;
+
+    // Run outside the lock, so jobs can queue more main thread jobs
+    std::vector<QueuedJob> jobs;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+            jobs.swap(mainThreadJobs);
+        }
+        if (jobs.empty()) {
+            break;
+        }
+
+        for (const QueuedJob &job : jobs) {
+            execute(job);
+        }
+        numRun += jobs.size();
+        jobs.clear();
+    }
+
+    return numRun;
+}
+
+uint64_t JobSystem::getNumStolenJobs() const {
+    return numStolenJobs.load(std::memory_order_relaxed);
+}
+
+bool JobSystem::runNextJob(int index) {
+    if (!initialized) {
+        return false;
+    }
+
+    QueuedJob job;
+    bool found = (index >= 0 && deques[index]->pop(&job)) ||
+                 stealJob(index, &job);
+
+    if (!found && numSharedJobs.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        if (!sharedJobs.empty()) {
+            job = sharedJobs.front();
+            sharedJobs.pop_front();
+            numSharedJobs.fetch_sub(1);
+            found = true;
+        }
+    }
+
+    if (found) {
+        numQueuedJobs.fetch_sub(1);
+        execute(job);
+    }
+
+    return found;
+}
+
+bool JobSystem::stealJob(int index, QueuedJob *job) {
+    const size_t numDeques = deques.size();
+    const size_t start     = nextStealRandom() % numDeques;
+    for (size_t i = 0; i < numDeques; ++i) {
+        const size_t victim = (start + i) % numDeques;
+        if ((int)victim != index && deques[victim]->steal(job)) {
+            numStolenJobs.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::execute(const QueuedJob &job) {
+    job.job.function(job.job.data);
+    if (job.counter != nullptr) {
+        job.counter->value.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void JobSystem::workerMain(int index) {
+    threadJobSystem = this;
+    threadIndex     = index;
+
+    int numIdleSpins = 0;
+    while (running.load(std::memory_order_relaxed)) {
+        if (runNextJob(index)) {
+            numIdleSpins = 0;
+        } else if (++numIdleSpins < JOB_IDLE_SPINS) {
+            std::this_thread::yield();
+        } else {
+            numIdleSpins = 0;
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            numSleepingWorkers.fetch_add(1);
+            wakeCondition.wait(lock, [this] {
+                return !running.load() || numQueuedJobs.load() > 0;
+            });
+            numSleepingWorkers.fetch_sub(1);
+        }
+    }
+
+    threadJobSystem = nullptr;
+    threadIndex     = -1;
+}
+}
@@ -0,0 +1,78 @@
+#include <cstring>
+#include <ctime>
+
+#include <sv/network/ConnectToken.h>
+#include <sv/network/Stream.h>
+
+namespace sv {
+namespace net {
+namespace {
+// Protocol id and expiry time, authenticated along with the private data so a
+// token can't be used for another protocol or have its expiry extended
+const size_t TOKEN_ADDITIONAL_DATA_SIZE = 12;
+
+void writeAdditionalData(uint32_t protocolId, uint64_t expireTimestamp,
+                         uint8_t *data) {
+    WriteStream stream(data, TOKEN_ADDITIONAL_DATA_SIZE);
+    stream.writeUint32(protocolId);
+    stream.writeUint32((uint32_t)(expireTimestamp >> 32));
+    stream.writeUint32((uint32_t)expireTimestamp);
+}
+}
+
+void generateConnectToken(const uint8_t *privateKey, uint32_t protocolId,
+                          uint64_t clientId, uint64_t expireTimestamp,
+                          ConnectToken *token) {
+    token->expireTimestamp = expireTimestamp;
+    randomBytes(token->nonce, sizeof(token->nonce));
+    randomBytes(token->clientToServerKey, sizeof(token->clientToServerKey));
+    randomBytes(token->serverToClientKey, sizeof(token->serverToClientKey));
+
+    uint8_t plaintext[CONNECT_TOKEN_PRIVATE_SIZE - CRYPTO_TAG_SIZE];
+    WriteStream stream(plaintext, sizeof(plaintext));
+    stream.writeUint32((uint32_t)(clientId >> 32));
+    stream.writeUint32((uint32_t)clientId);
+    stream.writeBytes(token->clientToServerKey, CRYPTO_KEY_SIZE);
+    stream.writeBytes(token->serverToClientKey, CRYPTO_KEY_SIZE);
+
+    uint8_t additionalData[TOKEN_ADDITIONAL_DATA_SIZE];
+    writeAdditionalData(protocolId, expireTimestamp, additionalData);
+
+    aeadEncrypt(privateKey, token->nonce, additionalData,
+                sizeof(additionalData), plaintext, sizeof(plaintext),
+                token->privateData, token->privateData + sizeof(plaintext));
+
+    memset(plaintext, 0, sizeof(plaintext));
+}
+
+bool readConnectToken(const uint8_t *privateKey, uint32_t protocolId,
+                      uint64_t expireTimestamp, const uint8_t *nonce,
+                      const uint8_t *privateData,
+                      ConnectTokenPrivate *result) {
+    uint8_t additionalData[TOKEN_ADDITIONAL_DATA_SIZE];
+    writeAdditionalData(protocolId, expireTimestamp, additionalData);
+
+    uint8_t plaintext[CONNECT_TOKEN_PRIVATE_SIZE - CRYPTO_TAG_SIZE];
+    if (!aeadDecrypt(privateKey, nonce, additionalData, sizeof(additionalData),
+                     privateData, sizeof(plaintext),
+                     privateData + sizeof(plaintext), plaintext)) {
+        return false;
+    }
+
+    ReadStream stream(plaintext, sizeof(plaintext));
+    uint32_t high = 0;
+    uint32_t low  = 0;
+    stream.readUint32(&high);
+    stream.readUint32(&low);
+    result->clientId = ((uint64_t)high << 32) | low;
+    stream.readBytes(result->clientToServerKey, CRYPTO_KEY_SIZE);
+    stream.readBytes(result->serverToClientKey, CRYPTO_KEY_SIZE);
+
+    memset(plaintext, 0, sizeof(plaintext));
+
+    return true;
+}
+
+uint64_t getTokenTimestamp() { return (uint64_t)std::time(nullptr); }
+}
+}
@@ -1,11 +1,120 @@
 #include <cassert>
 #include <cstring>
+#include <string>
 
 #include <sv/Globals.h>
 #include <sv/network/Connection.h>
+#include <sv/network/Crypto.h>
+#include <sv/network/Stream.h>
 
 namespace sv {
 namespace net {
+namespace {
+namespace PacketType {
+enum Enum : uint8_t {
+    Payload,
+    Fragment,
+    FragmentNack,
+    KeepAlive,
+    ConnectionRequest,
+    ConnectionChallenge,
+    ConnectionResponse
+};
+}
+
+// Protocol id, packet type, sequence number, ack and ack bits
+const size_t PACKET_HEADER_SIZE = 13;
+
+// Protocol id and packet type
+const size_t HANDSHAKE_HEADER_SIZE = 5;
+
+// Message id, fragment index, number of fragments and fragment size
+const size_t FRAGMENT_HEADER_SIZE = 6;
+
+// Expiry time, nonce and encrypted part of the connect token, and the
+// client's nonce
+const size_t REQUEST_BODY_SIZE =
+    8 + CRYPTO_NONCE_SIZE + CONNECT_TOKEN_PRIVATE_SIZE + CRYPTO_NONCE_SIZE;
+
+// Server's nonce and the challenge token
+const size_t CHALLENGE_BODY_SIZE =
+    CRYPTO_NONCE_SIZE + CONNECTION_CHALLENGE_TOKEN_SIZE;
+
+// Address type, port and address bytes
+const size_t ADDRESS_SIZE = 19;
+
+// Client id, expiry, address, token keys and nonces inside a challenge token
+const size_t CHALLENGE_PLAINTEXT_SIZE =
+    CONNECTION_CHALLENGE_TOKEN_SIZE - 8 - CRYPTO_TAG_SIZE;
+
+// A session's key, from one of the token's keys and both sides' nonces, so
+// neither side alone can make the session reuse an earlier one's keys
+void deriveSessionKey(const uint8_t *tokenKey, const uint8_t *clientNonce,
+                      const uint8_t *serverNonce, uint8_t *sessionKey) {
+    deriveKey(tokenKey, clientNonce, sessionKey);
+    deriveKey(sessionKey, serverNonce, sessionKey);
+}
+
+void writeUint64(WriteStream &stream, uint64_t value) {
+    stream.writeUint32((uint32_t)(value >> 32));
+    stream.writeUint32((uint32_t)value);
+}
+
+bool readUint64(ReadStream &stream, uint64_t *value) {
+    uint32_t high = 0;
+    uint32_t low  = 0;
+    if (stream.readUint32(&high) && stream.readUint32(&low)) {
+        *value = ((uint64_t)high << 32) | low;
+        return true;
+    }
+
+    return false;
+}
+
+void writeAddress(WriteStream &stream, const Address &address) {
+    uint8_t bytes[16] = {};
+    if (address.getType() == AddressType::Enum::IPv6) {
+        memcpy(bytes, address.getIPv6(), sizeof(bytes));
+    } else {
+        WriteStream ipv4(bytes, sizeof(bytes));
+        ipv4.writeUint32(address.getAddress());
+    }
+
+    stream.writeUint8(address.getType());
+    stream.writeUint16(address.getPort());
+    stream.writeBytes(bytes, sizeof(bytes));
+}
+
+Address readAddress(ReadStream &stream) {
+    uint8_t type      = 0;
+    uint16_t port     = 0;
+    uint8_t bytes[16] = {};
+    stream.readUint8(&type);
+    stream.readUint16(&port);
+    stream.readBytes(bytes, sizeof(bytes));
+
+    Address result;
+    if (type == AddressType::Enum::IPv6) {
+        result = Address(bytes, port);
+    } else if (type == AddressType::Enum::IPv4) {
+        uint32_t ipv4 = 0;
+        ReadStream ipv4Stream(bytes, sizeof(bytes));
+        ipv4Stream.readUint32(&ipv4);
+        result = Address(ipv4, port);
+    }
+
+    return result;
+}
+
+// Nonce for the packet with the given encryption sequence number
+void makeNonce(uint64_t sequence, uint8_t *nonce) {
+    memset(nonce, 0, CRYPTO_NONCE_SIZE);
+    for (size_t i = 0; i < 8; ++i) {
+        nonce[4 + i] = (uint8_t)(sequence >> (i * 8));
+    }
+}
+}
+
 Connection::~Connection() {
     if (isRunning == true) {
         stop();
@@ -29,11 +138,27 @@ bool Connection::start(int16_t port) {
     return result;
 }
 
+bool Connection::startReplay() {
+    bool result = false;
+
+    if (isRunning == false) {
+        isRunning   = true;
+        isReplaying = true;
+        result      = true;
+    } else {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Warning,
+                         "Tried to replay on a connection already running.");
+    }
+
+    return result;
+}
+
 void Connection::stop() {
     if (isRunning) {
         clearData();
         socket.close();
-        isRunning = false;
+        isRunning   = false;
+        isReplaying = false;
     }
 }
 
@@ -50,6 +175,37 @@ void Connection::connect(const Address &serverAddress) {
     address = serverAddress;
 }
 
+void Connection::connect(const Address &serverAddress,
+                         const ConnectToken &token) {
+    connect(serverAddress);
+
+    // The session starts once the server's challenge (and nonce) arrives
+    hasConnectToken = true;
+    connectToken    = token;
+    randomBytes(clientNonce, sizeof(clientNonce));
+
+    // Send the first request on the next update
+    handshakeAccumulator = CONNECTION_HANDSHAKE_SEND_INTERVAL;
+}
+
+void Connection::setPrivateKey(const uint8_t *key) {
+    hasPrivateKey = key != nullptr;
+    if (hasPrivateKey) {
+        memcpy(privateKey, key, sizeof(privateKey));
+        randomBytes(challengeKey, sizeof(challengeKey));
+        // Challenges made with an earlier key no longer decrypt
+        hasAcceptedChallenge  = false;
+        lastAcceptedChallenge = 0;
+    } else {
+        memset(privateKey, 0, sizeof(privateKey));
+        memset(challengeKey, 0, sizeof(challengeKey));
+    }
+}
+
+bool Connection::isSecure() const { return secure; }
+
+uint64_t Connection::getClientId() const { return clientId; }
+
 ConnectionMode::Enum Connection::getMode() const { return mode; }
 
 ConnectionState::Enum Connection::getState() const { return state; }
@@ -57,6 +213,41 @@ ConnectionState::Enum Connection::getState() const { return state; }
 void Connection::update(float deltaTime) {
     assert(isRunning && "Connection not running!");
     if (isRunning) {
+        // Release any packets the network simulator is done delaying
+        socket.update(deltaTime);
+
+        updateHandshake(deltaTime);
+
+        stats.update(deltaTime);
+
+        // Send queued payloads as bandwidth allows
+        ConnectionStatistics current = stats.getStatistics();
+        scheduler.update(deltaTime, current.rtt, current.packetLoss);
+        while (canSendPayloads() && scheduler.dequeue(&queuedPayload)) {
+            sendPayload(queuedPayload.empty() ? nullptr : &queuedPayload[0],
+                        queuedPayload.size());
+        }
+
+        // Ask for any fragments that have stopped arriving
+        nacks.clear();
+        reassembly.update(deltaTime, &nacks);
+        if (canSendPayloads()) {
+            for (size_t i = 0; i < nacks.size(); ++i) {
+                sendNack(nacks[i]);
+            }
+        }
+
+        if (statsLogInterval > 0.0f &&
+            state == ConnectionState::Enum::Connected) {
+            statsLogAccumulator += deltaTime;
+            if (statsLogAccumulator >= statsLogInterval) {
+                statsLogAccumulator = 0.0f;
+                sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Event,
+                                 std::string("Connection stats: ") +
+                                     formatStatistics(getStatistics()));
+            }
+        }
+
         timeoutAccumulator += deltaTime;
         // If we reached timeout
         if (timeoutAccumulator > timeout) {
@@ -77,68 +268,635 @@ void Connection::update(float deltaTime) {
     }
 }
 
-bool Connection::sendPacket(const void *data, size_t dataSize) {
+void Connection::setSimulator(NetworkSimulator *simulator) {
+    socket.setSimulator(simulator);
+}
+
+void Connection::setCapture(PacketCapture *capture) {
+    socket.setCapture(capture);
+}
+
+void Connection::setMaxPacketSize(size_t size) {
+    if (size < CONNECTION_MIN_PACKET_SIZE) {
+        size = CONNECTION_MIN_PACKET_SIZE;
+    } else if (size > CONNECTION_MAX_PACKET_SIZE) {
+        size = CONNECTION_MAX_PACKET_SIZE;
+    }
+
+    maxPacketSize = size;
+    sendBuffer.resize(maxPacketSize);
+}
+
+size_t Connection::getMaxPacketSize() const { return maxPacketSize; }
+
+void Connection::setBandwidth(uint32_t bytesPerSecond) {
+    scheduler.setBandwidth(bytesPerSecond);
+}
+
+uint32_t Connection::getBandwidth() const { return scheduler.getBandwidth(); }
+
+void Connection::setMaxQueueSize(size_t bytes) {
+    scheduler.setMaxQueueSize(bytes);
+}
+
+CongestionMode::Enum Connection::getCongestionMode() const {
+    return scheduler.getCongestionMode();
+}
+
+ConnectionStatistics Connection::getStatistics() const {
+    ConnectionStatistics result = stats.getStatistics();
+    result.pendingMessages      = reassembly.getNumPending();
+    result.queuedMessages       = scheduler.getNumQueued();
+    result.queuedBytes          = scheduler.getQueuedBytes();
+
+    return result;
+}
+
+void Connection::setStatsLogInterval(float interval) {
+    statsLogInterval    = interval > 0.0f ? interval : 0.0f;
+    statsLogAccumulator = 0.0f;
+}
+
+float Connection::getStatsLogInterval() const { return statsLogInterval; }
+
+void Connection::writeHeader(WriteStream &stream, uint8_t packetType) const {
+    stream.writeUint32(protocolId);
+    stream.writeUint8(packetType);
+    stream.writeUint16(stats.getLocalSequence());
+    stream.writeUint16(stats.getAck());
+    stream.writeUint32(stats.getAckBits());
+    if (secure) {
+        stream.writeUint32(sendSequence);
+    }
+}
+
+bool Connection::sendBuffered(size_t size) {
+    if (secure) {
+        const size_t headerSize = PACKET_HEADER_SIZE + 4;
+        if (size < headerSize || size + CRYPTO_TAG_SIZE > sendBuffer.size()) {
+            return false;
+        }
+
+        // Running out of sequence numbers would mean reusing a nonce
+        if (sendSequence == 0xFFFFFFFF) {
+            sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                             "Secure connection ran out of sequence numbers.");
+            return false;
+        }
+
+        // Header is authenticated but left readable
+        uint8_t nonce[CRYPTO_NONCE_SIZE];
+        makeNonce(sendSequence, nonce);
+        aeadEncrypt(sendKey, nonce, &sendBuffer[0], headerSize,
+                    &sendBuffer[headerSize], size - headerSize,
+                    &sendBuffer[headerSize], &sendBuffer[size]);
+        size += CRYPTO_TAG_SIZE;
+        ++sendSequence;
+    }
+
+    // Nowhere to send to while replaying, act as if it was sent
+    bool result = isReplaying || socket.send(address, &sendBuffer[0], size);
+    if (result) {
+        stats.packetSent(size);
+        scheduler.consume(size);
+    }
+
+    return result;
+}
+
+size_t Connection::getMaxPayloadSize() const {
+    return (size_t)getFragmentSize() * FRAGMENT_MAX_FRAGMENTS;
+}
+
+uint16_t Connection::getFragmentSize() const {
+    return (uint16_t)(maxPacketSize - getPacketOverhead() -
+                      FRAGMENT_HEADER_SIZE);
+}
+
+size_t Connection::getPacketOverhead() const {
+    return PACKET_HEADER_SIZE + (secure ? CONNECTION_SECURE_OVERHEAD : 0);
+}
+
+bool Connection::canSendPayloads() const {
+    // A secure connection has nothing to send payloads with until the server
+    // has accepted it
+    return address.isValid() &&
+           (!(hasConnectToken || hasPrivateKey) ||
+            state == ConnectionState::Enum::Connected);
+}
+
+bool Connection::sendPacket(const void *data, size_t dataSize,
+                            SendPriority::Enum priority) {
     bool result = false;
 
     assert(isRunning && "Connection not running!");
     if (isRunning) {
-        if (address.getAddress() != 0) {
-            uint8_t packet[dataSize + 4];
-            // Copy protocol id to packet
-            packet[0] = (uint8_t)(protocolId >> 24);
-            packet[1] = (uint8_t)((protocolId >> 16) & 0xFF);
-            packet[2] = (uint8_t)((protocolId >> 8) & 0xFF);
-            packet[3] = (uint8_t)(protocolId & 0xFF);
-            memcpy(&packet[4], data, dataSize);
+        if (canSendPayloads()) {
+            if (dataSize > getMaxPayloadSize()) {
+                sv::globals::log(LogArea::Enum::Network,
+                                 LogLevel::Enum::Warning,
+                                 "Packet too large to send.");
+            } else if (scheduler.canSend(priority)) {
+                result = sendPayload(data, dataSize);
+            } else {
+                result = scheduler.enqueue(data, dataSize, priority);
+            }
+        }
+    }
 
-            // Send packet
-            result = socket.send(address, packet, dataSize + 4);
+    return result;
+}
+
+bool Connection::sendPayload(const void *data, size_t dataSize) {
+    bool result = false;
+
+    if (getPacketOverhead() + dataSize <= maxPacketSize) {
+        // Fits in a single packet
+        WriteStream stream(&sendBuffer[0], sendBuffer.size());
+        writeHeader(stream, PacketType::Enum::Payload);
+        stream.writeBytes(data, dataSize);
+
+        result = sendBuffered(stream.getBytesWritten());
+    } else {
+        // Split into fragments, keeping a copy of the payload around in case
+        // any fragments need to be resent
+        uint16_t fragmentSize = getFragmentSize();
+        uint16_t messageId =
+            sentMessages.addMessage(data, dataSize, fragmentSize);
+        size_t numFragments = getNumFragments(dataSize, fragmentSize);
+
+        result = true;
+        for (size_t i = 0; i < numFragments; ++i) {
+            result &= sendFragment(messageId, (uint8_t)i);
         }
     }
 
     return result;
 }
 
+bool Connection::sendFragment(uint16_t messageId, uint8_t index) {
+    bool result = false;
+
+    const uint8_t *data   = nullptr;
+    size_t size           = 0;
+    uint8_t numFragments  = 0;
+    uint16_t fragmentSize = 0;
+    if (sentMessages.getFragment(messageId, index, &data, &size, &numFragments,
+                                 &fragmentSize)) {
+        WriteStream stream(&sendBuffer[0], sendBuffer.size());
+        writeHeader(stream, PacketType::Enum::Fragment);
+        stream.writeUint16(messageId);
+        stream.writeUint8(index);
+        stream.writeUint8(numFragments);
+        stream.writeUint16(fragmentSize);
+        stream.writeBytes(data, size);
+
+        if (!stream.hasFailed()) {
+            result = sendBuffered(stream.getBytesWritten());
+        }
+    }
+
+    return result;
+}
+
+bool Connection::sendNack(const FragmentNack &nack) {
+    WriteStream stream(&sendBuffer[0], sendBuffer.size());
+    writeHeader(stream, PacketType::Enum::FragmentNack);
+    stream.writeUint16(nack.messageId);
+    stream.writeUint8(nack.numFragments);
+    stream.writeBytes(nack.missing, (nack.numFragments + 7) / 8);
+
+    return sendBuffered(stream.getBytesWritten());
+}
+
+bool Connection::sendKeepAlive() {
+    WriteStream stream(&sendBuffer[0], sendBuffer.size());
+    writeHeader(stream, PacketType::Enum::KeepAlive);
+
+    return sendBuffered(stream.getBytesWritten());
+}
+
+void Connection::startSession(const uint8_t *sendKey_,
+                              const uint8_t *receiveKey_) {
+    secure = true;
+    memcpy(sendKey, sendKey_, sizeof(sendKey));
+    memcpy(receiveKey, receiveKey_, sizeof(receiveKey));
+    sendSequence = 0;
+    replayProtection.reset();
+}
+
+void Connection::updateHandshake(float deltaTime) {
+    if (!hasConnectToken || state != ConnectionState::Enum::Connecting) {
+        return;
+    }
+
+    handshakeAccumulator += deltaTime;
+    if (handshakeAccumulator < CONNECTION_HANDSHAKE_SEND_INTERVAL) {
+        return;
+    }
+    handshakeAccumulator = 0.0f;
+
+    // Keep asking in case requests or challenges were lost, answering
+    // the challenge the session was started with
+    uint8_t request[REQUEST_BODY_SIZE];
+    WriteStream stream(request, sizeof(request));
+    writeUint64(stream, connectToken.expireTimestamp);
+    stream.writeBytes(connectToken.nonce, sizeof(connectToken.nonce));
+    stream.writeBytes(connectToken.privateData,
+                      sizeof(connectToken.privateData));
+    stream.writeBytes(clientNonce, sizeof(clientNonce));
+    sendHandshake(PacketType::Enum::ConnectionRequest, request,
+                  sizeof(request), CONNECTION_REQUEST_SIZE);
+
+    if (hasChallenge) {
+        sendHandshake(PacketType::Enum::ConnectionResponse, challengeToken,
+                      sizeof(challengeToken), 0);
+    }
+}
+
+void Connection::sendHandshake(uint8_t packetType, const uint8_t *body,
+                               size_t bodySize, size_t paddedSize) {
+    uint8_t packet[CONNECTION_REQUEST_SIZE] = {};
+    WriteStream stream(packet, sizeof(packet));
+    stream.writeUint32(protocolId);
+    stream.writeUint8(packetType);
+    stream.writeBytes(body, bodySize);
+
+    size_t size = stream.getBytesWritten();
+    if (paddedSize > size && paddedSize <= sizeof(packet)) {
+        size = paddedSize;
+    }
+
+    if (!stream.hasFailed() && !isReplaying) {
+        socket.send(address, packet, size);
+    }
+}
+
+void Connection::processHandshake(const Address &sender, uint8_t packetType,
+                                  const uint8_t *body, size_t bodySize) {
+    ReadStream stream(body, bodySize);
+
+    switch (packetType) {
+    case PacketType::Enum::ConnectionRequest: {
+        // Only a secure server answers requests, and only ones padded to
+        // full size so the challenge is smaller than the request
+        if (!hasPrivateKey || mode != ConnectionMode::Enum::Server ||
+            bodySize + HANDSHAKE_HEADER_SIZE != CONNECTION_REQUEST_SIZE) {
+            break;
+        }
+
+        uint64_t expireTimestamp = 0;
+        uint8_t nonce[CRYPTO_NONCE_SIZE];
+        readUint64(stream, &expireTimestamp);
+        stream.readBytes(nonce, sizeof(nonce));
+        const uint8_t *privateData = body + stream.getBytesRead();
+        // Requests are padded, so the client's nonce is always there
+        uint8_t requestClientNonce[CRYPTO_NONCE_SIZE];
+        memcpy(requestClientNonce, privateData + CONNECT_TOKEN_PRIVATE_SIZE,
+               sizeof(requestClientNonce));
+
+        ConnectTokenPrivate token;
+        if (stream.hasFailed() || expireTimestamp < getTokenTimestamp() ||
+            !readConnectToken(privateKey, protocolId, expireTimestamp, nonce,
+                              privateData, &token)) {
+            break;
+        }
+
+        // Busy with another client
+        if (state == ConnectionState::Enum::Connected &&
+            (sender != address || token.clientId != clientId)) {
+            break;
+        }
+
+        uint8_t serverNonce[CRYPTO_NONCE_SIZE];
+        randomBytes(serverNonce, sizeof(serverNonce));
+
+        // Everything needed to accept the client goes in the challenge, so
+        // nothing is kept until the client proves it owns its address
+        uint8_t plaintext[CHALLENGE_PLAINTEXT_SIZE];
+        WriteStream plain(plaintext, sizeof(plaintext));
+        writeUint64(plain, token.clientId);
+        writeUint64(plain, expireTimestamp);
+        writeAddress(plain, sender);
+        plain.writeBytes(token.clientToServerKey, CRYPTO_KEY_SIZE);
+        plain.writeBytes(token.serverToClientKey, CRYPTO_KEY_SIZE);
+        plain.writeBytes(requestClientNonce, sizeof(requestClientNonce));
+        plain.writeBytes(serverNonce, sizeof(serverNonce));
+
+        uint8_t challenge[CONNECTION_CHALLENGE_TOKEN_SIZE];
+        WriteStream out(challenge, sizeof(challenge));
+        writeUint64(out, challengeSequence);
+
+        uint8_t challengeNonce[CRYPTO_NONCE_SIZE];
+        makeNonce(challengeSequence, challengeNonce);
+        ++challengeSequence;
+
+        uint8_t additionalData[4];
+        WriteStream additional(additionalData, sizeof(additionalData));
+        additional.writeUint32(protocolId);
+
+        aeadEncrypt(challengeKey, challengeNonce, additionalData,
+                    sizeof(additionalData), plaintext, sizeof(plaintext),
+                    challenge + 8, challenge + 8 + sizeof(plaintext));
+        memset(plaintext, 0, sizeof(plaintext));
+
+        uint8_t packet[HANDSHAKE_HEADER_SIZE + CHALLENGE_BODY_SIZE];
+        WriteStream packetStream(packet, sizeof(packet));
+        packetStream.writeUint32(protocolId);
+        packetStream.writeUint8(PacketType::Enum::ConnectionChallenge);
+        packetStream.writeBytes(serverNonce, sizeof(serverNonce));
+        packetStream.writeBytes(challenge, sizeof(challenge));
+        if (!isReplaying) {
+            socket.send(sender, packet, sizeof(packet));
+        }
+        break;
+    }
+    case PacketType::Enum::ConnectionChallenge: {
+        // Answer with the next response, the challenge can only be checked
+        // by the server. Only the first is taken, as the session's keys
+        // depend on its nonce.
+        if (hasConnectToken && !hasChallenge &&
+            state == ConnectionState::Enum::Connecting && sender == address &&
+            bodySize == CHALLENGE_BODY_SIZE) {
+            uint8_t serverNonce[CRYPTO_NONCE_SIZE];
+            stream.readBytes(serverNonce, sizeof(serverNonce));
+            stream.readBytes(challengeToken, sizeof(challengeToken));
+            hasChallenge = true;
+
+            uint8_t clientToServerKey[CRYPTO_KEY_SIZE];
+            uint8_t serverToClientKey[CRYPTO_KEY_SIZE];
+            deriveSessionKey(connectToken.clientToServerKey, clientNonce,
+                             serverNonce, clientToServerKey);
+            deriveSessionKey(connectToken.serverToClientKey, clientNonce,
+                             serverNonce, serverToClientKey);
+            startSession(clientToServerKey, serverToClientKey);
+            memset(clientToServerKey, 0, sizeof(clientToServerKey));
+            memset(serverToClientKey, 0, sizeof(serverToClientKey));
+
+            sendHandshake(PacketType::Enum::ConnectionResponse, challengeToken,
+                          sizeof(challengeToken), 0);
+        }
+        break;
+    }
+    case PacketType::Enum::ConnectionResponse: {
+        if (!hasPrivateKey || mode != ConnectionMode::Enum::Server ||
+            bodySize != CONNECTION_CHALLENGE_TOKEN_SIZE) {
+            break;
+        }
+
+        uint64_t sequence = 0;
+        readUint64(stream, &sequence);
+
+        uint8_t challengeNonce[CRYPTO_NONCE_SIZE];
+        makeNonce(sequence, challengeNonce);
+
+        uint8_t additionalData[4];
+        WriteStream additional(additionalData, sizeof(additionalData));
+        additional.writeUint32(protocolId);
+
+        uint8_t plaintext[CHALLENGE_PLAINTEXT_SIZE];
+        if (!aeadDecrypt(challengeKey, challengeNonce, additionalData,
+                         sizeof(additionalData), body + 8, sizeof(plaintext),
+                         body + 8 + sizeof(plaintext), plaintext)) {
+            break;
+        }
+
+        ReadStream plain(plaintext, sizeof(plaintext));
+        uint64_t responseClientId = 0;
+        uint64_t expireTimestamp  = 0;
+        readUint64(plain, &responseClientId);
+        readUint64(plain, &expireTimestamp);
+        Address challengeAddress = readAddress(plain);
+        uint8_t clientToServerKey[CRYPTO_KEY_SIZE];
+        uint8_t serverToClientKey[CRYPTO_KEY_SIZE];
+        uint8_t responseClientNonce[CRYPTO_NONCE_SIZE];
+        uint8_t serverNonce[CRYPTO_NONCE_SIZE];
+        plain.readBytes(clientToServerKey, sizeof(clientToServerKey));
+        plain.readBytes(serverToClientKey, sizeof(serverToClientKey));
+        plain.readBytes(responseClientNonce, sizeof(responseClientNonce));
+        plain.readBytes(serverNonce, sizeof(serverNonce));
+        memset(plaintext, 0, sizeof(plaintext));
+
+        // Must come from the address the challenge was sent to
+        if (plain.hasFailed() || challengeAddress != sender ||
+            expireTimestamp < getTokenTimestamp()) {
+            memset(clientToServerKey, 0, sizeof(clientToServerKey));
+            memset(serverToClientKey, 0, sizeof(serverToClientKey));
+            break;
+        }
+
+        // A challenge is accepted once, so a recorded response can't start
+        // another session with the same keys
+        const bool accepted =
+            hasAcceptedChallenge && sequence <= lastAcceptedChallenge;
+
+        if (state != ConnectionState::Enum::Connected && !accepted) {
+            clearData();
+            state                 = ConnectionState::Enum::Connected;
+            address               = sender;
+            clientId              = responseClientId;
+            hasAcceptedChallenge  = true;
+            lastAcceptedChallenge = sequence;
+
+            deriveSessionKey(clientToServerKey, responseClientNonce,
+                             serverNonce, clientToServerKey);
+            deriveSessionKey(serverToClientKey, responseClientNonce,
+                             serverNonce, serverToClientKey);
+            startSession(serverToClientKey, clientToServerKey);
+            sendKeepAlive();
+        } else if (state == ConnectionState::Enum::Connected &&
+                   sender == address && responseClientId == clientId &&
+                   sequence == lastAcceptedChallenge) {
+            // Client missed the keep alive
+            sendKeepAlive();
+        }
+        memset(clientToServerKey, 0, sizeof(clientToServerKey));
+        memset(serverToClientKey, 0, sizeof(serverToClientKey));
+        break;
+    }
+    default: { break; }
+    }
+}
+
 size_t Connection::receivePacket(void *buffer, size_t bufferSize) {
     size_t bytesReceived = 0;
 
     assert(isRunning && "Connection not running!");
-    if (isRunning) {
-        uint8_t packet[bufferSize + 4];
-
-        Address sender;
-        size_t bytesRead = socket.receive(sender, packet, bufferSize + 4);
-
-        // If we recognize the first four bytes as the protocolId
-        if (bytesRead > 4 &&
-            (packet[0] == (uint8_t)(protocolId >> 24) &&
-             (packet[1] == (uint8_t)((protocolId >> 16) & 0xFF)) &&
-             (packet[2] == (uint8_t)((protocolId >> 8) & 0xFF)) &&
-             (packet[3] == (uint8_t)(protocolId & 0xFF)))) {
-
-            if (mode == ConnectionMode::Enum::Server &&
-                state != ConnectionState::Enum::Connected) {
-                // Server accepts connection from client
-                state = ConnectionState::Enum::Connected;
-                // Keep track of who sent the packet
-                address = sender;
+    if (isRunning && !isReplaying) {
+        // Keep reading until we have a payload to return (fragments and
+        // NACKs are handled internally) or there is nothing left to read
+        while (bytesReceived == 0) {
+            Address sender;
+            size_t bytesRead =
+                socket.receive(sender, &receiveBuffer[0], receiveBuffer.size());
+            if (bytesRead == 0) {
+                break;
             }
 
-            // If sender matches the server/client we have/want a connection
-            // with
-            if (sender == address) {
-                if (mode == ConnectionMode::Enum::Client &&
-                    state == ConnectionState::Enum::Connecting) {
-                    // Client completes connection with server
-                    state = ConnectionState::Enum::Connected;
-                }
+            bytesReceived = processPacket(sender, &receiveBuffer[0], bytesRead,
+                                          buffer, bufferSize);
+        }
+    }
+
+    return bytesReceived;
+}
+
+size_t Connection::injectPacket(const Address &sender, const uint8_t *packet,
+                                size_t packetSize, void *buffer,
+                                size_t bufferSize) {
+    size_t bytesReceived = 0;
 
-                // We successfully received a packet, reset timeout accumulator
-                timeoutAccumulator = 0.0f;
-                memcpy(buffer, &packet[4], bufferSize - 4);
+    assert(isRunning && "Connection not running!");
+    if (isRunning && packet != nullptr) {
+        bytesReceived =
+            processPacket(sender, packet, packetSize, buffer, bufferSize);
+    }
 
-                bytesReceived = bufferSize - 4;
+    return bytesReceived;
+}
+
+size_t Connection::processPacket(const Address &sender, const uint8_t *packet,
+                                 size_t packetSize, void *buffer,
+                                 size_t bufferSize) {
+    size_t bytesReceived = 0;
+
+    ReadStream header(packet, packetSize);
+    uint32_t packetProtocolId = 0;
+    uint8_t packetType        = 0;
+    header.readUint32(&packetProtocolId);
+    header.readUint8(&packetType);
+
+    // If we recognize the first four bytes as the protocolId
+    if (header.hasFailed() || packetProtocolId != protocolId) {
+        return 0;
+    }
+
+    if (packetType >= PacketType::Enum::ConnectionRequest) {
+        processHandshake(sender, packetType, packet + HANDSHAKE_HEADER_SIZE,
+                         packetSize - HANDSHAKE_HEADER_SIZE);
+        return 0;
+    }
+
+    uint16_t sequence = 0;
+    uint16_t ack      = 0;
+    uint32_t ackBits  = 0;
+    header.readUint16(&sequence);
+    header.readUint16(&ack);
+    header.readUint32(&ackBits);
+
+    const uint8_t *body = packet + header.getBytesRead();
+    size_t bodySize     = header.getBytesRemaining();
+
+    if (hasConnectToken || hasPrivateKey) {
+        // Only authenticated packets from the other end of a secure
+        // connection are accepted
+        uint32_t encryptionSequence = 0;
+        header.readUint32(&encryptionSequence);
+        if (header.hasFailed() || !secure || sender != address ||
+            header.getBytesRemaining() < CRYPTO_TAG_SIZE ||
+            replayProtection.isReplay(encryptionSequence)) {
+            return 0;
+        }
+
+        uint8_t nonce[CRYPTO_NONCE_SIZE];
+        makeNonce(encryptionSequence, nonce);
+        bodySize = header.getBytesRemaining() - CRYPTO_TAG_SIZE;
+        if (!aeadDecrypt(receiveKey, nonce, packet, header.getBytesRead(),
+                         packet + header.getBytesRead(), bodySize,
+                         packet + header.getBytesRead() + bodySize,
+                         &decryptBuffer[0])) {
+            return 0;
+        }
+        replayProtection.packetReceived(encryptionSequence);
+        body = &decryptBuffer[0];
+    } else if (header.hasFailed()) {
+        return 0;
+    }
+
+    if (mode == ConnectionMode::Enum::Server &&
+        state != ConnectionState::Enum::Connected) {
+        // Server accepts connection from client
+        state = ConnectionState::Enum::Connected;
+        // Keep track of who sent the packet
+        address = sender;
+    }
+
+    // If sender matches the server/client we have/want a connection
+    // with
+    if (sender == address) {
+        if (mode == ConnectionMode::Enum::Client &&
+            state == ConnectionState::Enum::Connecting) {
+            // Client completes connection with server
+            state = ConnectionState::Enum::Connected;
+        }
+
+        // We successfully received a packet, reset timeout accumulator
+        timeoutAccumulator = 0.0f;
+
+        stats.packetReceived(sequence, packetSize);
+        stats.processAcks(ack, ackBits);
+
+        ReadStream stream(body, bodySize);
+        switch (packetType) {
+        case PacketType::Enum::Payload: {
+            size_t payloadSize = stream.getBytesRemaining();
+            if (payloadSize <= bufferSize) {
+                stream.readBytes(buffer, payloadSize);
+                bytesReceived = payloadSize;
+            } else {
+                sv::globals::log(LogArea::Enum::Network,
+                                 LogLevel::Enum::Warning,
+                                 "Received packet larger than buffer.");
+            }
+            break;
+        }
+        case PacketType::Enum::Fragment: {
+            uint16_t messageId    = 0;
+            uint8_t index         = 0;
+            uint8_t numFragments  = 0;
+            uint16_t fragmentSize = 0;
+            stream.readUint16(&messageId);
+            stream.readUint8(&index);
+            stream.readUint8(&numFragments);
+            stream.readUint16(&fragmentSize);
+
+            // Peers fragment with the same packet size and overhead
+            reassembly.setLimits(getFragmentSize(), getMaxPayloadSize());
+            if (!stream.hasFailed() &&
+                reassembly.addFragment(messageId, index, numFragments,
+                                       fragmentSize,
+                                       body + stream.getBytesRead(),
+                                       stream.getBytesRemaining(), &message)) {
+                if (message.size() <= bufferSize) {
+                    if (!message.empty()) {
+                        memcpy(buffer, &message[0], message.size());
+                    }
+                    bytesReceived = message.size();
+                } else {
+                    sv::globals::log(LogArea::Enum::Network,
+                                     LogLevel::Enum::Warning,
+                                     "Received packet larger than buffer.");
+                }
+            }
+            break;
+        }
+        case PacketType::Enum::FragmentNack: {
+            FragmentNack nack;
+            stream.readUint16(&nack.messageId);
+            stream.readUint8(&nack.numFragments);
+            stream.readBytes(nack.missing, (nack.numFragments + 7) / 8);
+
+            if (!stream.hasFailed()) {
+                // Resend only the fragments the other end is missing
+                for (size_t i = 0; i < nack.numFragments; ++i) {
+                    if (isFragmentBitSet(nack.missing, i)) {
+                        sendFragment(nack.messageId, (uint8_t)i);
+                    }
+                }
             }
+            break;
+        }
+        default: { break; }
         }
     }
 
@@ -149,6 +907,25 @@ void Connection::clearData() {
     state              = ConnectionState::Enum::Disconnected;
     timeoutAccumulator = 0.0f;
     address            = Address();
+
+    reassembly.clear();
+    sentMessages.clear();
+    scheduler.clear();
+
+    stats.reset();
+    statsLogAccumulator = 0.0f;
+
+    hasConnectToken      = false;
+    hasChallenge         = false;
+    handshakeAccumulator = 0.0f;
+    memset(&connectToken, 0, sizeof(connectToken));
+
+    secure       = false;
+    clientId     = 0;
+    sendSequence = 0;
+    memset(sendKey, 0, sizeof(sendKey));
+    memset(receiveKey, 0, sizeof(receiveKey));
+    replayProtection.reset();
 }
 }
 }
@@ -0,0 +1,243 @@
+#include <cmath>
+#include <sstream>
+
+#include <sv/network/ConnectionStats.h>
+
+namespace sv {
+namespace net {
+std::string formatStatistics(const ConnectionStatistics &stats) {
+    std::stringstream out;
+    out << "rtt " << stats.rtt * 1000.0f << "ms, jitter "
+        << stats.rttJitter * 1000.0f << "ms, loss " << stats.packetLoss * 100.0f
+        << "%, out " << stats.sentBandwidth << " bytes/s, in "
+        << stats.receivedBandwidth << " bytes/s, sent " << stats.packetsSent
+        << " (" << stats.bytesSent << " bytes), received "
+        << stats.packetsReceived << " (" << stats.bytesReceived
+        << " bytes), acked " << stats.packetsAcked << ", lost "
+        << stats.packetsLost << ", pending messages " << stats.pendingMessages
+        << ", queued " << stats.queuedMessages << " (" << stats.queuedBytes
+        << " bytes)";
+
+    return out.str();
+}
+
+ConnectionStats::ConnectionStats(float bandwidthWindow_)
+    : bandwidthWindow(bandwidthWindow_ > 0.0f ? bandwidthWindow_ : 1.0f) {
+    reset();
+}
+
+uint16_t ConnectionStats::getLocalSequence() const { return localSequence; }
+
+uint16_t ConnectionStats::getAck() const { return remoteSequence; }
+
+bool ConnectionStats::wasReceived(uint16_t sequence) const {
+    return received[sequence % CONNECTION_STATS_HISTORY_SIZE] ==
+           (int32_t)sequence;
+}
+
+uint32_t ConnectionStats::getAckBits() const {
+    uint32_t ackBits = 0;
+
+    if (hasReceived) {
+        for (uint32_t i = 0; i < 32; ++i) {
+            if (wasReceived((uint16_t)(remoteSequence - i))) {
+                ackBits |= (uint32_t)1 << i;
+            }
+        }
+    }
+
+    return ackBits;
+}
+
+void ConnectionStats::packetSent(size_t size) {
+    SentPacket &packet = sent[localSequence % CONNECTION_STATS_HISTORY_SIZE];
+    packet.valid       = true;
+    packet.acked       = false;
+    packet.lost        = false;
+    packet.sequence    = localSequence;
+    packet.time        = time;
+
+    ++localSequence;
+    ++packetsSent;
+    bytesSent += size;
+    sentBuckets[currentBucket % CONNECTION_STATS_BANDWIDTH_BUCKETS] += size;
+}
+
+void ConnectionStats::packetReceived(uint16_t sequence, size_t size) {
+    ++packetsReceived;
+    bytesReceived += size;
+    receivedBuckets[currentBucket % CONNECTION_STATS_BANDWIDTH_BUCKETS] += size;
+
+    if (hasReceived && !isSequenceMoreRecent(sequence, remoteSequence) &&
+        (uint16_t)(remoteSequence - sequence) >=
+            CONNECTION_STATS_HISTORY_SIZE) {
+        // Too old to be acked
+        return;
+    }
+
+    if (!hasReceived || isSequenceMoreRecent(sequence, remoteSequence)) {
+        hasReceived    = true;
+        remoteSequence = sequence;
+    }
+
+    // Slots hold the full sequence number, so entries left over from packets
+    // that were skipped never match
+    received[sequence % CONNECTION_STATS_HISTORY_SIZE] = sequence;
+}
+
+void ConnectionStats::processAcks(uint16_t ack, uint32_t ackBits) {
+    for (uint32_t i = 0; i < 32 && ackBits != 0; ++i, ackBits >>= 1) {
+        if ((ackBits & 1) == 0) {
+            continue;
+        }
+
+        uint16_t sequence  = (uint16_t)(ack - i);
+        SentPacket &packet = sent[sequence % CONNECTION_STATS_HISTORY_SIZE];
+        if (!packet.valid || packet.acked || packet.sequence != sequence) {
+            continue;
+        }
+
+        packet.acked = true;
+        ++packetsAcked;
+
+        if (packet.lost) {
+            // Ack arrived after we gave up on it, it wasn't lost after all
+            packet.lost = false;
+            --packetsLost;
+            continue;
+        }
+
+        // Smooth as per RFC 6298
+        float sample = (float)(time - packet.time);
+        if (!hasRttSample) {
+            hasRttSample = true;
+            rtt          = sample;
+            rttJitter    = sample / 2.0f;
+        } else {
+            rttJitter = 0.75f * rttJitter + 0.25f * std::fabs(rtt - sample);
+            rtt       = 0.875f * rtt + 0.125f * sample;
+        }
+    }
+}
+
+void ConnectionStats::update(float deltaTime) {
+    if (deltaTime > 0.0f) {
+        time += deltaTime;
+    }
+
+    advanceBuckets();
+
+    for (size_t i = 0; i < CONNECTION_STATS_HISTORY_SIZE; ++i) {
+        SentPacket &packet = sent[i];
+        if (packet.valid && !packet.acked && !packet.lost &&
+            time - packet.time > CONNECTION_STATS_ACK_TIMEOUT) {
+            packet.lost = true;
+            ++packetsLost;
+        }
+    }
+}
+
+void ConnectionStats::advanceBuckets() {
+    const double bucketDuration =
+        bandwidthWindow / CONNECTION_STATS_BANDWIDTH_BUCKETS;
+    uint64_t bucket = (uint64_t)(time / bucketDuration);
+
+    if (bucket - currentBucket >= CONNECTION_STATS_BANDWIDTH_BUCKETS) {
+        for (size_t i = 0; i < CONNECTION_STATS_BANDWIDTH_BUCKETS; ++i) {
+            sentBuckets[i]     = 0;
+            receivedBuckets[i] = 0;
+        }
+    } else {
+        for (uint64_t b = currentBucket + 1; b <= bucket; ++b) {
+            sentBuckets[b % CONNECTION_STATS_BANDWIDTH_BUCKETS]     = 0;
+            receivedBuckets[b % CONNECTION_STATS_BANDWIDTH_BUCKETS] = 0;
+        }
+    }
+    currentBucket = bucket;
+}
+
+float ConnectionStats::getBandwidth(const uint64_t *buckets) const {
+    const double bucketDuration =
+        bandwidthWindow / CONNECTION_STATS_BANDWIDTH_BUCKETS;
+
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < CONNECTION_STATS_BANDWIDTH_BUCKETS; ++i) {
+        bytes += buckets[i];
+    }
+
+    // Window covers the full buckets before the current one, and as much of
+    // the current one as has elapsed
+    double covered = (CONNECTION_STATS_BANDWIDTH_BUCKETS - 1) * bucketDuration +
+                     (time - currentBucket * bucketDuration);
+    if (covered > time) {
+        covered = time;
+    }
+    if (covered < bucketDuration) {
+        covered = bucketDuration;
+    }
+
+    return (float)(bytes / covered);
+}
+
+ConnectionStatistics ConnectionStats::getStatistics() const {
+    ConnectionStatistics stats;
+
+    stats.rtt               = rtt;
+    stats.rttJitter         = rttJitter;
+    stats.sentBandwidth     = getBandwidth(sentBuckets);
+    stats.receivedBandwidth = getBandwidth(receivedBuckets);
+    stats.packetsSent       = packetsSent;
+    stats.packetsReceived   = packetsReceived;
+    stats.packetsAcked      = packetsAcked;
+    stats.packetsLost       = packetsLost;
+    stats.bytesSent         = bytesSent;
+    stats.bytesReceived     = bytesReceived;
+
+    size_t numAcked = 0;
+    size_t numLost  = 0;
+    for (size_t i = 0; i < CONNECTION_STATS_HISTORY_SIZE; ++i) {
+        if (sent[i].valid) {
+            if (sent[i].acked) {
+                ++numAcked;
+            } else if (sent[i].lost) {
+                ++numLost;
+            }
+        }
+    }
+    if (numAcked + numLost > 0) {
+        stats.packetLoss = (float)numLost / (numAcked + numLost);
+    }
+
+    return stats;
+}
+
+void ConnectionStats::reset() {
+    time           = 0.0;
+    localSequence  = 0;
+    remoteSequence = 0;
+    hasReceived    = false;
+
+    for (size_t i = 0; i < CONNECTION_STATS_HISTORY_SIZE; ++i) {
+        sent[i]     = SentPacket();
+        received[i] = -1;
+    }
+
+    hasRttSample = false;
+    rtt          = 0.0f;
+    rttJitter    = 0.0f;
+
+    currentBucket = 0;
+    for (size_t i = 0; i < CONNECTION_STATS_BANDWIDTH_BUCKETS; ++i) {
+        sentBuckets[i]     = 0;
+        receivedBuckets[i] = 0;
+    }
+
+    packetsSent     = 0;
+    packetsReceived = 0;
+    packetsAcked    = 0;
+    packetsLost     = 0;
+    bytesSent       = 0;
+    bytesReceived   = 0;
+}
+}
+}
@@ -0,0 +1,460 @@
+#include <cstdlib>
+#include <cstring>
+
+#include <sv/Globals.h>
+#include <sv/System.h>
+#include <sv/network/Crypto.h>
+
+#if SV_PLATFORM_POSIX
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#elif SV_PLATFORM_WINDOWS
+#include <random>
+#endif
+
+#if SV_PLATFORM_LINUX
+#include <sys/syscall.h>
+#endif
+
+namespace sv {
+namespace net {
+namespace {
+uint32_t load32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+void store32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+void store64(uint8_t *p, uint64_t value) {
+    store32(p, (uint32_t)value);
+    store32(p + 4, (uint32_t)(value >> 32));
+}
+
+inline uint32_t rotateLeft(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+inline void quarterRound(uint32_t &a, uint32_t &b, uint32_t &c,
+                         uint32_t &d) {
+    a += b;
+    d = rotateLeft(d ^ a, 16);
+    c += d;
+    b = rotateLeft(b ^ c, 12);
+    a += b;
+    d = rotateLeft(d ^ a, 8);
+    c += d;
+    b = rotateLeft(b ^ c, 7);
+}
+
+// Padding to the next multiple of 16 bytes in the AEAD construction
+const uint8_t ZERO_PADDING[16] = {};
+
+// Authenticate additional data and ciphertext as in RFC 8439 section 2.8
+void aeadTag(const uint8_t *key, const uint8_t *nonce, const uint8_t *aad,
+             size_t aadSize, const uint8_t *ciphertext, size_t size,
+             uint8_t *tag) {
+    uint8_t block[CHACHA20_BLOCK_SIZE];
+    chacha20Block(key, 0, nonce, block);
+
+    Poly1305 mac(block);
+    if (aadSize > 0) {
+        mac.update(aad, aadSize);
+        mac.update(ZERO_PADDING, (16 - aadSize % 16) % 16);
+    }
+    if (size > 0) {
+        mac.update(ciphertext, size);
+        mac.update(ZERO_PADDING, (16 - size % 16) % 16);
+    }
+
+    uint8_t lengths[16];
+    store64(lengths, aadSize);
+    store64(lengths + 8, size);
+    mac.update(lengths, sizeof(lengths));
+    mac.finish(tag);
+
+    memset(block, 0, sizeof(block));
+}
+}
+
+void chacha20Block(const uint8_t *key, uint32_t counter, const uint8_t *nonce,
+                   uint8_t *block) {
+    uint32_t state[16];
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    for (int i = 0; i < 8; ++i) {
+        state[4 + i] = load32(key + i * 4);
+    }
+    state[12] = counter;
+    state[13] = load32(nonce);
+    state[14] = load32(nonce + 4);
+    state[15] = load32(nonce + 8);
+
+    uint32_t x[16];
+    memcpy(x, state, sizeof(x));
+    for (int i = 0; i < 10; ++i) {
+        // Columns
+        quarterRound(x[0], x[4], x[8], x[12]);
+        quarterRound(x[1], x[5], x[9], x[13]);
+        quarterRound(x[2], x[6], x[10], x[14]);
+        quarterRound(x[3], x[7], x[11], x[15]);
+        // Diagonals
+        quarterRound(x[0], x[5], x[10], x[15]);
+        quarterRound(x[1], x[6], x[11], x[12]);
+        quarterRound(x[2], x[7], x[8], x[13]);
+        quarterRound(x[3], x[4], x[9], x[14]);
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        store32(block + i * 4, x[i] + state[i]);
+    }
+}
+
+void chacha20Xor(const uint8_t *key, uint32_t counter, const uint8_t *nonce,
+                 const uint8_t *input, uint8_t *output, size_t size) {
+    uint8_t block[CHACHA20_BLOCK_SIZE];
+
+    while (size > 0) {
+        chacha20Block(key, counter++, nonce, block);
+
+        size_t blockSize = size < sizeof(block) ? size : sizeof(block);
+        for (size_t i = 0; i < blockSize; ++i) {
+            output[i] = input[i] ^ block[i];
+        }
+
+        input += blockSize;
+        output += blockSize;
+        size -= blockSize;
+    }
+
+    memset(block, 0, sizeof(block));
+}
+
+Poly1305::Poly1305(const uint8_t *key) : buffered(0) {
+    // Clamp r
+    r[0] = load32(key + 0) & 0x3ffffff;
+    r[1] = (load32(key + 3) >> 2) & 0x3ffff03;
+    r[2] = (load32(key + 6) >> 4) & 0x3ffc0ff;
+    r[3] = (load32(key + 9) >> 6) & 0x3f03fff;
+    r[4] = (load32(key + 12) >> 8) & 0x00fffff;
+
+    for (int i = 0; i < 5; ++i) {
+        h[i] = 0;
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        pad[i] = load32(key + 16 + i * 4);
+    }
+}
+
+void Poly1305::update(const uint8_t *data, size_t size) {
+    // Top up a partial block first
+    if (buffered > 0) {
+        size_t want = sizeof(buffer) - buffered;
+        if (want > size) {
+            want = size;
+        }
+        memcpy(buffer + buffered, data, want);
+        buffered += want;
+        data += want;
+        size -= want;
+
+        if (buffered < sizeof(buffer)) {
+            return;
+        }
+        blocks(buffer, sizeof(buffer), false);
+        buffered = 0;
+    }
+
+    size_t whole = size & ~(size_t)15;
+    if (whole > 0) {
+        blocks(data, whole, false);
+        data += whole;
+        size -= whole;
+    }
+
+    if (size > 0) {
+        memcpy(buffer, data, size);
+        buffered = size;
+    }
+}
+
+void Poly1305::blocks(const uint8_t *data, size_t size, bool final) {
+    const uint32_t hibit = final ? 0 : (1u << 24);
+
+    const uint32_t r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+    const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    uint32_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+
+    while (size >= 16) {
+        // h += m
+        h0 += load32(data + 0) & 0x3ffffff;
+        h1 += (load32(data + 3) >> 2) & 0x3ffffff;
+        h2 += (load32(data + 6) >> 4) & 0x3ffffff;
+        h3 += (load32(data + 9) >> 6) & 0x3ffffff;
+        h4 += (load32(data + 12) >> 8) | hibit;
+
+        // h *= r
+        uint64_t d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 +
+                      (uint64_t)h2 * s3 + (uint64_t)h3 * s2 +
+                      (uint64_t)h4 * s1;
+        uint64_t d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 +
+                      (uint64_t)h2 * s4 + (uint64_t)h3 * s3 +
+                      (uint64_t)h4 * s2;
+        uint64_t d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 +
+                      (uint64_t)h2 * r0 + (uint64_t)h3 * s4 +
+                      (uint64_t)h4 * s3;
+        uint64_t d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 +
+                      (uint64_t)h2 * r1 + (uint64_t)h3 * r0 +
+                      (uint64_t)h4 * s4;
+        uint64_t d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 +
+                      (uint64_t)h2 * r2 + (uint64_t)h3 * r1 +
+                      (uint64_t)h4 * r0;
+
+        // Partial reduction mod 2^130 - 5
+        uint32_t c = (uint32_t)(d0 >> 26);
+        h0         = (uint32_t)d0 & 0x3ffffff;
+        d1 += c;
+        c  = (uint32_t)(d1 >> 26);
+        h1 = (uint32_t)d1 & 0x3ffffff;
+        d2 += c;
+        c  = (uint32_t)(d2 >> 26);
+        h2 = (uint32_t)d2 & 0x3ffffff;
+        d3 += c;
+        c  = (uint32_t)(d3 >> 26);
+        h3 = (uint32_t)d3 & 0x3ffffff;
+        d4 += c;
+        c  = (uint32_t)(d4 >> 26);
+        h4 = (uint32_t)d4 & 0x3ffffff;
+        h0 += c * 5;
+        c  = h0 >> 26;
+        h0 = h0 & 0x3ffffff;
+        h1 += c;
+
+        data += 16;
+        size -= 16;
+    }
+
+    h[0] = h0;
+    h[1] = h1;
+    h[2] = h2;
+    h[3] = h3;
+    h[4] = h4;
+}
+
+void Poly1305::finish(uint8_t *tag) {
+    // Last partial block is padded with a 1 then zeros
+    if (buffered > 0) {
+        buffer[buffered++] = 1;
+        while (buffered < sizeof(buffer)) {
+            buffer[buffered++] = 0;
+        }
+        blocks(buffer, sizeof(buffer), true);
+        buffered = 0;
+    }
+
+    // Fully carry h
+    uint32_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+    uint32_t c = h1 >> 26;
+    h1 &= 0x3ffffff;
+    h2 += c;
+    c = h2 >> 26;
+    h2 &= 0x3ffffff;
+    h3 += c;
+    c = h3 >> 26;
+    h3 &= 0x3ffffff;
+    h4 += c;
+    c = h4 >> 26;
+    h4 &= 0x3ffffff;
+    h0 += c * 5;
+    c = h0 >> 26;
+    h0 &= 0x3ffffff;
+    h1 += c;
+
+    // Compute h - p = h + 5 - 2^130
+    uint32_t g0 = h0 + 5;
+    c           = g0 >> 26;
+    g0 &= 0x3ffffff;
+    uint32_t g1 = h1 + c;
+    c           = g1 >> 26;
+    g1 &= 0x3ffffff;
+    uint32_t g2 = h2 + c;
+    c           = g2 >> 26;
+    g2 &= 0x3ffffff;
+    uint32_t g3 = h3 + c;
+    c           = g3 >> 26;
+    g3 &= 0x3ffffff;
+    uint32_t g4 = h4 + c - (1u << 26);
+
+    // Select h if h < p, or h - p if h >= p, without branching
+    uint32_t mask = (g4 >> 31) - 1;
+    g0 &= mask;
+    g1 &= mask;
+    g2 &= mask;
+    g3 &= mask;
+    g4 &= mask;
+    mask = ~mask;
+    h0   = (h0 & mask) | g0;
+    h1   = (h1 & mask) | g1;
+    h2   = (h2 & mask) | g2;
+    h3   = (h3 & mask) | g3;
+    h4   = (h4 & mask) | g4;
+
+    // h = h % 2^128
+    h0 = h0 | (h1 << 26);
+    h1 = (h1 >> 6) | (h2 << 20);
+    h2 = (h2 >> 12) | (h3 << 14);
+    h3 = (h3 >> 18) | (h4 << 8);
+
+    // tag = (h + pad) % 2^128
+    uint64_t f = (uint64_t)h0 + pad[0];
+    store32(tag + 0, (uint32_t)f);
+    f = (uint64_t)h1 + pad[1] + (f >> 32);
+    store32(tag + 4, (uint32_t)f);
+    f = (uint64_t)h2 + pad[2] + (f >> 32);
+    store32(tag + 8, (uint32_t)f);
+    f = (uint64_t)h3 + pad[3] + (f >> 32);
+    store32(tag + 12, (uint32_t)f);
+
+    // Don't leave the key lying around
+    memset(r, 0, sizeof(r));
+    memset(h, 0, sizeof(h));
+    memset(pad, 0, sizeof(pad));
+}
+
+void poly1305(const uint8_t *key, const uint8_t *data, size_t size,
+              uint8_t *tag) {
+    Poly1305 mac(key);
+    mac.update(data, size);
+    mac.finish(tag);
+}
+
+void aeadEncrypt(const uint8_t *key, const uint8_t *nonce, const uint8_t *aad,
+                 size_t aadSize, const uint8_t *plaintext, size_t size,
+                 uint8_t *ciphertext, uint8_t *tag) {
+    chacha20Xor(key, 1, nonce, plaintext, ciphertext, size);
+    aeadTag(key, nonce, aad, aadSize, ciphertext, size, tag);
+}
+
+bool aeadDecrypt(const uint8_t *key, const uint8_t *nonce, const uint8_t *aad,
+                 size_t aadSize, const uint8_t *ciphertext, size_t size,
+                 const uint8_t *tag, uint8_t *plaintext) {
+    uint8_t expected[CRYPTO_TAG_SIZE];
+    aeadTag(key, nonce, aad, aadSize, ciphertext, size, expected);
+
+    if (!constantTimeEqual(expected, tag, CRYPTO_TAG_SIZE)) {
+        return false;
+    }
+
+    chacha20Xor(key, 1, nonce, ciphertext, plaintext, size);
+    return true;
+}
+
+bool constantTimeEqual(const uint8_t *a, const uint8_t *b, size_t size) {
+    uint8_t difference = 0;
+    for (size_t i = 0; i < size; ++i) {
+        difference |= a[i] ^ b[i];
+    }
+
+    return difference == 0;
+}
+
+void deriveKey(const uint8_t *key, const uint8_t *nonce, uint8_t *derived) {
+    uint8_t block[CHACHA20_BLOCK_SIZE];
+    chacha20Block(key, 0, nonce, block);
+    memcpy(derived, block, CRYPTO_KEY_SIZE);
+    memset(block, 0, sizeof(block));
+}
+
+void randomBytes(void *data, size_t size) {
+    uint8_t *bytes = (uint8_t *)data;
+
+#if SV_PLATFORM_LINUX && defined(SYS_getrandom)
+    // getrandom blocks only until the kernel's generator is first seeded,
+    // called through syscall so older C libraries without it still build
+    while (size > 0) {
+        const long result = syscall(SYS_getrandom, bytes, size, 0);
+        if (result > 0) {
+            bytes += result;
+            size -= (size_t)result;
+        } else if (result < 0 && errno != EINTR) {
+            break;
+        }
+    }
+#endif
+
+#if SV_PLATFORM_POSIX
+    // Kernels without getrandom
+    if (size > 0) {
+        const int file = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+        while (file >= 0 && size > 0) {
+            const ssize_t result = read(file, bytes, size);
+            if (result > 0) {
+                bytes += result;
+                size -= (size_t)result;
+            } else if (result == 0 || errno != EINTR) {
+                break;
+            }
+        }
+        if (file >= 0) {
+            close(file);
+        }
+    }
+#elif SV_PLATFORM_WINDOWS
+    // MSVC's random_device is backed by the system's generator (rand_s)
+    std::random_device device;
+    while (size > 0) {
+        const uint32_t value = device();
+        for (size_t i = 0; i < sizeof(value) && size > 0; ++i, --size) {
+            *bytes++ = (uint8_t)(value >> (i * 8));
+        }
+    }
+#endif
+
+    // Handing out predictable keys would be worse than stopping
+    if (size > 0) {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                         "Could not read the system's random number "
+                         "generator.");
+        std::abort();
+    }
+}
+namespace {
+// Marks an empty slot of the replay protection window
+const uint64_t REPLAY_EMPTY = 0xFFFFFFFFFFFFFFFFull;
+}
+
+ReplayProtection::ReplayProtection() { reset(); }
+
+bool ReplayProtection::isReplay(uint64_t sequence) const {
+    if (sequence + REPLAY_PROTECTION_WINDOW <= mostRecent) {
+        return true;
+    }
+
+    const uint64_t slot = received[sequence % REPLAY_PROTECTION_WINDOW];
+    return slot != REPLAY_EMPTY && slot >= sequence;
+}
+
+void ReplayProtection::packetReceived(uint64_t sequence) {
+    if (sequence > mostRecent) {
+        mostRecent = sequence;
+    }
+    received[sequence % REPLAY_PROTECTION_WINDOW] = sequence;
+}
+
+void ReplayProtection::reset() {
+    mostRecent = 0;
+    for (size_t i = 0; i < REPLAY_PROTECTION_WINDOW; ++i) {
+        received[i] = REPLAY_EMPTY;
+    }
+}
+}
+}
@@ -0,0 +1,223 @@
+#include <cstring>
+
+#include <sv/network/Fragments.h>
+
+namespace sv {
+namespace net {
+size_t getNumFragments(size_t size, size_t fragmentSize) {
+    size_t result = 0;
+
+    if (fragmentSize > 0) {
+        result = (size + fragmentSize - 1) / fragmentSize;
+    }
+
+    return result;
+}
+
+FragmentReassembly::FragmentReassembly(float timeout_, float nackDelay_)
+    : timeout(timeout_), nackDelay(nackDelay_),
+      maxFragmentSize(FRAGMENT_DEFAULT_MAX_FRAGMENT_SIZE),
+      maxMessageSize(FRAGMENT_DEFAULT_MAX_MESSAGE_SIZE), numCompleted(0) {}
+
+void FragmentReassembly::setLimits(uint16_t maxFragmentSize_,
+                                   size_t maxMessageSize_) {
+    maxFragmentSize = maxFragmentSize_;
+    maxMessageSize  = maxMessageSize_;
+}
+
+bool FragmentReassembly::isCompleted(uint16_t messageId) const {
+    size_t count = numCompleted < FRAGMENT_COMPLETED_HISTORY_SIZE
+                       ? numCompleted
+                       : FRAGMENT_COMPLETED_HISTORY_SIZE;
+    for (size_t i = 0; i < count; ++i) {
+        if (completed[i] == messageId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool FragmentReassembly::addFragment(uint16_t messageId, uint8_t index,
+                                     uint8_t numFragments,
+                                     uint16_t fragmentSize,
+                                     const uint8_t *data, size_t size,
+                                     std::vector<uint8_t> *messageOut) {
+    // Reject malformed fragments: every fragment but the last must be
+    // exactly 'fragmentSize' bytes
+    if (numFragments == 0 || index >= numFragments || fragmentSize == 0 ||
+        size == 0 || size > fragmentSize ||
+        (index + 1 < numFragments && size != fragmentSize)) {
+        return false;
+    }
+
+    // Sizes come from the sender, bound the buffer they would have us
+    // allocate
+    if (fragmentSize > maxFragmentSize ||
+        (size_t)numFragments * fragmentSize > maxMessageSize) {
+        return false;
+    }
+
+    if (isCompleted(messageId)) {
+        return false;
+    }
+
+    // Find slot already reassembling this message, or the slot to reuse
+    Slot *slot   = nullptr;
+    Slot *oldest = &slots[0];
+    for (size_t i = 0; i < FRAGMENT_POOL_SIZE; ++i) {
+        if (slots[i].active && slots[i].messageId == messageId) {
+            slot = &slots[i];
+            break;
+        }
+        if (oldest->active &&
+            (!slots[i].active || slots[i].idleTime > oldest->idleTime)) {
+            oldest = &slots[i];
+        }
+    }
+
+    if (slot == nullptr) {
+        slot               = oldest;
+        slot->active       = true;
+        slot->messageId    = messageId;
+        slot->numFragments = numFragments;
+        slot->fragmentSize = fragmentSize;
+        slot->numReceived  = 0;
+        slot->messageSize  = 0;
+        slot->nackTime     = 0.0f;
+        memset(slot->received, 0, sizeof(slot->received));
+        slot->buffer.resize((size_t)numFragments * fragmentSize);
+    } else if (slot->numFragments != numFragments ||
+               slot->fragmentSize != fragmentSize) {
+        // Doesn't agree with fragments already received
+        return false;
+    }
+
+    slot->idleTime = 0.0f;
+
+    if (isFragmentBitSet(slot->received, index)) {
+        // Duplicate
+        return false;
+    }
+
+    slot->received[index / 8] |= (uint8_t)(1 << (index % 8));
+    ++slot->numReceived;
+    memcpy(&slot->buffer[(size_t)index * fragmentSize], data, size);
+    if (index + 1 == numFragments) {
+        slot->messageSize = (size_t)index * fragmentSize + size;
+    }
+
+    if (slot->numReceived < slot->numFragments) {
+        return false;
+    }
+
+    // Message complete
+    if (messageOut != nullptr) {
+        messageOut->assign(slot->buffer.begin(),
+                           slot->buffer.begin() + slot->messageSize);
+    }
+    completed[numCompleted % FRAGMENT_COMPLETED_HISTORY_SIZE] = messageId;
+    ++numCompleted;
+    slot->active = false;
+
+    return true;
+}
+
+void FragmentReassembly::update(float deltaTime,
+                                std::vector<FragmentNack> *nacksOut) {
+    for (size_t i = 0; i < FRAGMENT_POOL_SIZE; ++i) {
+        Slot &slot = slots[i];
+        if (!slot.active) {
+            continue;
+        }
+
+        slot.idleTime += deltaTime;
+        slot.nackTime += deltaTime;
+
+        if (slot.idleTime > timeout) {
+            slot.active = false;
+        } else if (slot.idleTime >= nackDelay && slot.nackTime >= nackDelay) {
+            slot.nackTime = 0.0f;
+
+            if (nacksOut != nullptr) {
+                FragmentNack nack;
+                nack.messageId    = slot.messageId;
+                nack.numFragments = slot.numFragments;
+                for (size_t f = 0; f < slot.numFragments; ++f) {
+                    if (!isFragmentBitSet(slot.received, f)) {
+                        nack.missing[f / 8] |= (uint8_t)(1 << (f % 8));
+                    }
+                }
+                nacksOut->push_back(nack);
+            }
+        }
+    }
+}
+
+size_t FragmentReassembly::getNumPending() const {
+    size_t result = 0;
+
+    for (size_t i = 0; i < FRAGMENT_POOL_SIZE; ++i) {
+        if (slots[i].active) {
+            ++result;
+        }
+    }
+
+    return result;
+}
+
+void FragmentReassembly::clear() {
+    for (size_t i = 0; i < FRAGMENT_POOL_SIZE; ++i) {
+        slots[i].active = false;
+    }
+    numCompleted = 0;
+}
+
+uint16_t FragmentSendBuffer::addMessage(const void *data, size_t size,
+                                        uint16_t fragmentSize) {
+    uint16_t messageId = nextMessageId++;
+
+    Entry &entry       = entries[messageId % FRAGMENT_SEND_BUFFER_SIZE];
+    entry.active       = true;
+    entry.messageId    = messageId;
+    entry.fragmentSize = fragmentSize;
+    entry.data.assign((const uint8_t *)data, (const uint8_t *)data + size);
+
+    return messageId;
+}
+
+bool FragmentSendBuffer::getFragment(uint16_t messageId, uint8_t index,
+                                     const uint8_t **dataOut, size_t *sizeOut,
+                                     uint8_t *numFragmentsOut,
+                                     uint16_t *fragmentSizeOut) const {
+    const Entry &entry = entries[messageId % FRAGMENT_SEND_BUFFER_SIZE];
+    if (!entry.active || entry.messageId != messageId) {
+        return false;
+    }
+
+    size_t numFragments =
+        getNumFragments(entry.data.size(), entry.fragmentSize);
+    if (index >= numFragments) {
+        return false;
+    }
+
+    size_t offset    = (size_t)index * entry.fragmentSize;
+    size_t remaining = entry.data.size() - offset;
+
+    *dataOut         = &entry.data[offset];
+    *sizeOut         = remaining < entry.fragmentSize ? remaining
+                                                      : entry.fragmentSize;
+    *numFragmentsOut = (uint8_t)numFragments;
+    *fragmentSizeOut = entry.fragmentSize;
+
+    return true;
+}
+
+void FragmentSendBuffer::clear() {
+    for (size_t i = 0; i < FRAGMENT_SEND_BUFFER_SIZE; ++i) {
+        entries[i].active = false;
+        entries[i].data.clear();
+    }
+}
+}
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cmath>
+
+#include <sv/network/NetworkSimulator.h>
+
+namespace sv {
+namespace net {
+NetworkSimulator::NetworkSimulator(uint32_t seed_)
+    : enabled(false), generator(seed_), time(0.0), linkFreeTime(0.0),
+      nextOrder(0), numSent(0), numDropped(0), numDuplicated(0) {}
+
+void NetworkSimulator::seed(uint32_t seed_) { generator.seed(seed_); }
+
+void NetworkSimulator::setConditions(const NetworkConditions &conditions_) {
+    conditions = conditions_;
+}
+
+const NetworkConditions &NetworkSimulator::getConditions() const {
+    return conditions;
+}
+
+void NetworkSimulator::setEnabled(bool enabled_) { enabled = enabled_; }
+
+bool NetworkSimulator::isEnabled() const { return enabled; }
+
+double NetworkSimulator::random() {
+    // Use the raw generator output rather than a std:: distribution, whose
+    // results differ between standard library implementations
+    return generator() / 4294967296.0;
+}
+
+double NetworkSimulator::getDelay() {
+    double delay = conditions.latency;
+
+    if (conditions.jitter > 0.0f) {
+        switch (conditions.jitterDistribution) {
+        case JitterDistribution::Enum::Uniform: {
+            delay += (random() * 2.0 - 1.0) * conditions.jitter;
+            break;
+        }
+        case JitterDistribution::Enum::Normal: {
+            // Box-Muller transform
+            double u1 = 1.0 - random(); // (0, 1], safe to take log of
+            double u2 = random();
+            delay += std::sqrt(-2.0 * std::log(u1)) *
+                     std::cos(2.0 * 3.14159265358979323846 * u2) *
+                     conditions.jitter;
+            break;
+        }
+        default: { break; }
+        }
+    }
+
+    return delay > 0.0 ? delay : 0.0;
+}
+
+void NetworkSimulator::schedule(double deliveryTime,
+                                const Address &destination, const void *data,
+                                size_t size) {
+    PendingPacket packet;
+    packet.deliveryTime = deliveryTime;
+    packet.order        = nextOrder++;
+    packet.destination  = destination;
+    packet.data.assign((const uint8_t *)data, (const uint8_t *)data + size);
+
+    // Keep pending packets ordered by delivery time, packets due at the same
+    // time are delivered in the order they were scheduled
+    std::deque<PendingPacket>::iterator it = std::upper_bound(
+        pending.begin(), pending.end(), packet,
+        [](const PendingPacket &a, const PendingPacket &b) {
+            return a.deliveryTime < b.deliveryTime ||
+                   (a.deliveryTime == b.deliveryTime && a.order < b.order);
+        });
+    pending.insert(it, packet);
+}
+
+void NetworkSimulator::sendPacket(const Address &destination, const void *data,
+                                  size_t size) {
+    ++numSent;
+
+    if (!enabled) {
+        schedule(time, destination, data, size);
+        return;
+    }
+
+    if (random() < conditions.packetLoss) {
+        ++numDropped;
+        return;
+    }
+
+    // Packets wait for the link to finish transmitting the packets before
+    // them
+    double sendTime = time;
+    if (conditions.bandwidth > 0) {
+        double backlog = linkFreeTime > time ? linkFreeTime - time : 0.0;
+        if (conditions.queueSize > 0 &&
+            backlog * conditions.bandwidth + size > conditions.queueSize) {
+            ++numDropped;
+            return;
+        }
+
+        sendTime     = time + backlog + (double)size / conditions.bandwidth;
+        linkFreeTime = sendTime;
+    }
+
+    schedule(sendTime + getDelay(), destination, data, size);
+
+    if (random() < conditions.duplicates) {
+        ++numDuplicated;
+        schedule(sendTime + getDelay(), destination, data, size);
+    }
+}
+
+void NetworkSimulator::update(float deltaTime) {
+    if (deltaTime > 0.0f) {
+        time += deltaTime;
+    }
+}
+
+bool NetworkSimulator::getNextPacket(Address *destination,
+                                     std::vector<uint8_t> *data) {
+    bool result = false;
+
+    // A disabled simulator releases everything it holds
+    if (!pending.empty() &&
+        (!enabled || pending.front().deliveryTime <= time)) {
+        if (destination != nullptr) {
+            *destination = pending.front().destination;
+        }
+        if (data != nullptr) {
+            data->swap(pending.front().data);
+        }
+        pending.pop_front();
+
+        result = true;
+    }
+
+    return result;
+}
+
+size_t NetworkSimulator::getNumPending() const { return pending.size(); }
+
+uint64_t NetworkSimulator::getNumSent() const { return numSent; }
+
+uint64_t NetworkSimulator::getNumDropped() const { return numDropped; }
+
+uint64_t NetworkSimulator::getNumDuplicated() const { return numDuplicated; }
+}
+}
@@ -0,0 +1,345 @@
+#include <cstring>
+
+#include <sv/Globals.h>
+#include <sv/network/Connection.h>
+#include <sv/network/PacketCapture.h>
+#include <sv/network/Stream.h>
+
+namespace sv {
+namespace net {
+namespace {
+// Magic and version
+const size_t FILE_HEADER_SIZE = 6;
+
+// Type and timestamp
+const size_t RECORD_HEADER_SIZE = 5;
+
+// Address type, port, address and datagram size
+const size_t DATAGRAM_HEADER_SIZE = 1 + 2 + 16 + 2;
+
+// Records are collected in memory and written in blocks of this size
+const size_t FLUSH_SIZE = 64 * 1024;
+
+uint32_t floatToBits(float value) {
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(uint32_t bits) {
+    float value = 0.0f;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+}
+
+PacketCapture::PacketCapture() : numRecords(0), size(0) {}
+
+PacketCapture::~PacketCapture() { close(); }
+
+bool PacketCapture::open(const std::string &path) {
+    close();
+
+    file.open(path.c_str(), std::ofstream::binary | std::ofstream::trunc);
+    if (!file.is_open()) {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                         "Failed to open packet capture file: " + path);
+        return false;
+    }
+
+    buffer.resize(FILE_HEADER_SIZE);
+    WriteStream stream(&buffer[0], buffer.size());
+    stream.writeUint32(PACKET_CAPTURE_MAGIC);
+    stream.writeUint16(PACKET_CAPTURE_VERSION);
+
+    lastRecordTime = std::chrono::steady_clock::now();
+    numRecords     = 0;
+    size           = buffer.size();
+
+    return true;
+}
+
+void PacketCapture::close() {
+    if (file.is_open()) {
+        flush();
+        file.close();
+    }
+    buffer.clear();
+}
+
+bool PacketCapture::isOpen() const { return file.is_open(); }
+
+void PacketCapture::recordSent(const Address &destination, const void *data,
+                               size_t size) {
+    writeDatagram(CaptureRecordType::Enum::Sent, destination, data, size);
+}
+
+void PacketCapture::recordReceived(const Address &sender, const void *data,
+                                   size_t size) {
+    writeDatagram(CaptureRecordType::Enum::Received, sender, data, size);
+}
+
+void PacketCapture::recordUpdate(float deltaTime) {
+    if (isOpen()) {
+        writeRecordHeader(CaptureRecordType::Enum::Update);
+
+        size_t start = buffer.size();
+        buffer.resize(start + sizeof(uint32_t));
+        WriteStream stream(&buffer[start], sizeof(uint32_t));
+        stream.writeUint32(floatToBits(deltaTime));
+
+        size += sizeof(uint32_t);
+        if (buffer.size() >= FLUSH_SIZE) {
+            flush();
+        }
+    }
+}
+
+size_t PacketCapture::getNumRecords() const { return numRecords; }
+
+size_t PacketCapture::getSize() const { return size; }
+
+void PacketCapture::writeRecordHeader(CaptureRecordType::Enum type) {
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                          now - lastRecordTime)
+                          .count();
+    if (elapsed > 0xFFFFFFFF) {
+        elapsed = 0xFFFFFFFF;
+    }
+
+    // Only move the reference point forward by what was written, so
+    // rounding never accumulates
+    lastRecordTime += std::chrono::microseconds(elapsed);
+
+    size_t start = buffer.size();
+    buffer.resize(start + RECORD_HEADER_SIZE);
+    WriteStream stream(&buffer[start], RECORD_HEADER_SIZE);
+    stream.writeUint8(type);
+    stream.writeUint32((uint32_t)elapsed);
+
+    ++numRecords;
+    size += RECORD_HEADER_SIZE;
+}
+
+void PacketCapture::writeDatagram(CaptureRecordType::Enum type,
+                                  const Address &address, const void *data,
+                                  size_t dataSize) {
+    if (isOpen() && data != nullptr && dataSize > 0 && dataSize <= 0xFFFF) {
+        writeRecordHeader(type);
+
+        size_t start = buffer.size();
+        buffer.resize(start + DATAGRAM_HEADER_SIZE + dataSize);
+        WriteStream stream(&buffer[start], DATAGRAM_HEADER_SIZE + dataSize);
+        stream.writeUint8(address.getType());
+        stream.writeUint16(address.getPort());
+        if (address.getType() == AddressType::Enum::IPv6) {
+            stream.writeBytes(address.getIPv6(), 16);
+        } else {
+            stream.writeUint32(address.getAddress());
+        }
+        stream.writeUint16((uint16_t)dataSize);
+        stream.writeBytes(data, dataSize);
+
+        buffer.resize(start + stream.getBytesWritten());
+        size += stream.getBytesWritten();
+        if (buffer.size() >= FLUSH_SIZE) {
+            flush();
+        }
+    }
+}
+
+void PacketCapture::flush() {
+    if (!buffer.empty()) {
+        file.write((const char *)&buffer[0], buffer.size());
+        buffer.clear();
+    }
+}
+
+PacketCaptureReader::PacketCaptureReader()
+    : position(0), time(0.0), failed(false) {}
+
+bool PacketCaptureReader::open(const std::string &path) {
+    std::ifstream in(path.c_str(), std::ifstream::ate | std::ifstream::binary);
+    if (!in.is_open()) {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                         "Failed to open packet capture file: " + path);
+        return false;
+    }
+
+    std::streamsize fileSize = in.tellg();
+    in.seekg(0, std::ios::beg);
+
+    std::vector<uint8_t> data(fileSize > 0 ? (size_t)fileSize : 0);
+    if (!data.empty() && !in.read((char *)&data[0], fileSize)) {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                         "Failed to read packet capture file: " + path);
+        return false;
+    }
+
+    return load(data.empty() ? nullptr : &data[0], data.size());
+}
+
+bool PacketCaptureReader::load(const void *data, size_t dataSize) {
+    contents.clear();
+    position = 0;
+    time     = 0.0;
+    failed   = false;
+
+    ReadStream stream(data, dataSize);
+    uint32_t magic   = 0;
+    uint16_t version = 0;
+    stream.readUint32(&magic);
+    stream.readUint16(&version);
+
+    if (stream.hasFailed() || magic != PACKET_CAPTURE_MAGIC) {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                         "Not a packet capture.");
+        failed = true;
+        return false;
+    }
+
+    if (version != PACKET_CAPTURE_VERSION) {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                         "Unsupported packet capture version.");
+        failed = true;
+        return false;
+    }
+
+    contents.assign((const uint8_t *)data, (const uint8_t *)data + dataSize);
+    position = FILE_HEADER_SIZE;
+
+    return true;
+}
+
+bool PacketCaptureReader::readRecord(CaptureRecord *record) {
+    if (failed || position >= contents.size()) {
+        return false;
+    }
+
+    ReadStream stream(&contents[position], contents.size() - position);
+    uint8_t type     = 0;
+    uint32_t elapsed = 0;
+    stream.readUint8(&type);
+    stream.readUint32(&elapsed);
+
+    CaptureRecord result;
+    result.type = (CaptureRecordType::Enum)type;
+    result.time = time + elapsed / 1000000.0;
+
+    switch (type) {
+    case CaptureRecordType::Enum::Sent:
+    case CaptureRecordType::Enum::Received: {
+        uint8_t addressType = 0;
+        uint16_t port       = 0;
+        uint16_t dataSize   = 0;
+        stream.readUint8(&addressType);
+        stream.readUint16(&port);
+        if (addressType == AddressType::Enum::IPv6) {
+            uint8_t bytes[16];
+            if (stream.readBytes(bytes, sizeof(bytes))) {
+                result.address = Address(bytes, port);
+            }
+        } else {
+            uint32_t address = 0;
+            if (stream.readUint32(&address) &&
+                addressType == AddressType::Enum::IPv4) {
+                result.address = Address(address, port);
+            }
+        }
+        stream.readUint16(&dataSize);
+
+        if (!stream.hasFailed() && stream.getBytesRemaining() >= dataSize) {
+            result.data = &contents[position + stream.getBytesRead()];
+            result.size = dataSize;
+            position += stream.getBytesRead() + dataSize;
+        } else {
+            failed = true;
+        }
+        break;
+    }
+    case CaptureRecordType::Enum::Update: {
+        uint32_t bits = 0;
+        stream.readUint32(&bits);
+        result.deltaTime = bitsToFloat(bits);
+        if (!stream.hasFailed()) {
+            position += stream.getBytesRead();
+        } else {
+            failed = true;
+        }
+        break;
+    }
+    default: {
+        failed = true;
+        break;
+    }
+    }
+
+    if (failed || stream.hasFailed()) {
+        failed = true;
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Warning,
+                         "Packet capture is corrupt or cut short.");
+        return false;
+    }
+
+    time = result.time;
+    if (record != nullptr) {
+        *record = result;
+    }
+
+    return true;
+}
+
+void PacketCaptureReader::rewind() {
+    position = contents.empty() ? 0 : FILE_HEADER_SIZE;
+    time     = 0.0;
+    failed   = false;
+}
+
+bool PacketCaptureReader::hasFailed() const { return failed; }
+
+ConnectionReplay::ConnectionReplay(Connection &connection_,
+                                   PacketCaptureReader &reader_)
+    : connection(connection_), reader(reader_), finished(false), time(0.0),
+      packetsReplayed(0), updatesReplayed(0) {}
+
+size_t ConnectionReplay::receivePacket(void *buffer, size_t bufferSize) {
+    size_t bytesReceived = 0;
+
+    CaptureRecord record;
+    while (bytesReceived == 0 && !finished) {
+        if (!reader.readRecord(&record)) {
+            finished = true;
+            break;
+        }
+
+        time = record.time;
+        switch (record.type) {
+        case CaptureRecordType::Enum::Received: {
+            bytesReceived = connection.injectPacket(
+                record.address, record.data, record.size, buffer, bufferSize);
+            ++packetsReplayed;
+            break;
+        }
+        case CaptureRecordType::Enum::Update: {
+            connection.update(record.deltaTime);
+            ++updatesReplayed;
+            break;
+        }
+        default: { break; }
+        }
+    }
+
+    return bytesReceived;
+}
+
+bool ConnectionReplay::isFinished() const { return finished; }
+
+double ConnectionReplay::getTime() const { return time; }
+
+size_t ConnectionReplay::getPacketsReplayed() const { return packetsReplayed; }
+
+size_t ConnectionReplay::getUpdatesReplayed() const { return updatesReplayed; }
+}
+}
@@ -0,0 +1,543 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <future>
+
+#include <sv/Globals.h>
+#include <sv/console/Console.h>
+#include <sv/network/Crypto.h>
+#include <sv/network/Rcon.h>
+
+namespace sv {
+namespace net {
+namespace {
+// Protocol id and packet type
+const size_t HEADER_SIZE = 5;
+
+// Session id, request id, succeeded, chunk index, number of chunks, stream and
+// chunk size
+const size_t OUTPUT_HEADER_SIZE = HEADER_SIZE + 4 + 4 + 1 + 2 + 2 + 1 + 2;
+
+// Seconds a client waits for a reply before sending a request again
+const float RESEND_INTERVAL = 0.25f;
+
+// Session id of no session, never handed out
+const uint32_t NO_SESSION = 0;
+
+// Ends the last chunk of output that didn't fit in RCON_MAX_CHUNKS
+const char TRUNCATED_MARKER[] = "\n[output truncated]\n";
+const size_t TRUNCATED_MARKER_SIZE = sizeof(TRUNCATED_MARKER) - 1;
+
+void writeHeader(WriteStream &stream, RconPacketType::Enum type) {
+    stream.writeUint32(RCON_PROTOCOL_ID);
+    stream.writeUint8((uint8_t)type);
+}
+
+// \returns False if the packet isn't an rcon packet.
+bool readHeader(ReadStream &stream, RconPacketType::Enum *type) {
+    uint32_t protocolId = 0;
+    uint8_t packetType  = 0;
+    if (!stream.readUint32(&protocolId) || protocolId != RCON_PROTOCOL_ID ||
+        !stream.readUint8(&packetType) ||
+        packetType >= RconPacketType::Enum::Count) {
+        return false;
+    }
+
+    *type = (RconPacketType::Enum)packetType;
+
+    return true;
+}
+
+// Split \p text into chunks, adding one (stream, offset, size) per chunk
+struct Chunk {
+    RconStream::Enum stream;
+    size_t offset;
+    size_t size;
+    // Followed by TRUNCATED_MARKER
+    bool truncated;
+};
+
+// \returns False if \p text didn't fit in RCON_MAX_CHUNKS.
+bool addChunks(RconStream::Enum stream, const std::string &text,
+               std::vector<Chunk> *chunks) {
+    size_t offset = 0;
+    for (; offset < text.size() && chunks->size() < RCON_MAX_CHUNKS;
+         offset += RCON_MAX_CHUNK_SIZE) {
+        Chunk chunk;
+        chunk.stream    = stream;
+        chunk.offset    = offset;
+        chunk.size      = std::min(RCON_MAX_CHUNK_SIZE, text.size() - offset);
+        chunk.truncated = false;
+        chunks->push_back(chunk);
+    }
+
+    return offset >= text.size();
+}
+}
+
+bool isLoopback(const Address &address) {
+    static const uint8_t ipv6Loopback[16] = {0, 0, 0, 0, 0, 0, 0, 0,
+                                             0, 0, 0, 0, 0, 0, 0, 1};
+
+    bool result = false;
+
+    if (address.getType() == AddressType::Enum::IPv4) {
+        result = address.getA() == 127;
+    } else if (address.getType() == AddressType::Enum::IPv6) {
+        result = std::equal(ipv6Loopback, ipv6Loopback + 16,
+                            address.getIPv6());
+    }
+
+    return result;
+}
+
+RconServer::RconServer(Console &console_)
+    : console(console_), buffer(RCON_MAX_PACKET_SIZE), numCommandsExecuted(0) {
+}
+
+RconServer::~RconServer() { stop(); }
+
+bool RconServer::start(uint16_t port, const std::string &password_) {
+    if (socket.isOpen()) {
+        return false;
+    }
+
+    if (password_.empty() || password_.size() > RCON_MAX_PASSWORD_SIZE) {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                         "Rcon password must be between 1 and " +
+                             std::to_string(RCON_MAX_PASSWORD_SIZE) +
+                             " characters.");
+        return false;
+    }
+
+    if (!socket.open(port)) {
+        return false;
+    }
+
+    password = password_;
+
+    return true;
+}
+
+void RconServer::stop() {
+    sessions.clear();
+    password.clear();
+    socket.close();
+}
+
+bool RconServer::isRunning() const { return socket.isOpen(); }
+
+void RconServer::update(float deltaTime) {
+    if (!socket.isOpen()) {
+        return;
+    }
+
+    for (size_t i = 0; i < sessions.size();) {
+        sessions[i].idleTime += deltaTime;
+        if (sessions[i].idleTime > RCON_SESSION_TIMEOUT) {
+            sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Event,
+                             "Rcon session from " +
+                                 sessions[i].address.toString() +
+                                 " timed out.");
+            sessions[i] = std::move(sessions.back());
+            sessions.pop_back();
+        } else {
+            ++i;
+        }
+    }
+
+    // Bounded so a flood of packets can't stall the frame, the rest wait for
+    // the next update
+    for (size_t i = 0; i < RCON_MAX_PACKETS_PER_UPDATE; ++i) {
+        Address sender;
+        size_t size = socket.receive(sender, buffer.data(), buffer.size());
+        if (size == 0) {
+            break;
+        }
+
+        if (isLoopback(sender)) {
+            handlePacket(sender, buffer.data(), size);
+        }
+    }
+}
+
+size_t RconServer::getNumSessions() const { return sessions.size(); }
+
+uint64_t RconServer::getNumCommandsExecuted() const {
+    return numCommandsExecuted;
+}
+
+void RconServer::handlePacket(const Address &sender, const uint8_t *data,
+                              size_t size) {
+    ReadStream stream(data, size);
+    RconPacketType::Enum type;
+    if (!readHeader(stream, &type)) {
+        return;
+    }
+
+    if (type == RconPacketType::Enum::Login) {
+        handleLogin(sender, stream);
+        return;
+    }
+
+    uint32_t sessionId = NO_SESSION;
+    if (!stream.readUint32(&sessionId)) {
+        return;
+    }
+
+    Session *session = findSession(sessionId, sender);
+    if (session == nullptr) {
+        return;
+    }
+    session->idleTime = 0.0f;
+
+    if (type == RconPacketType::Enum::Command) {
+        handleCommand(*session, stream);
+    } else if (type == RconPacketType::Enum::Logout) {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Event,
+                         "Rcon session from " + sender.toString() +
+                             " logged out.");
+        removeSession(sessionId);
+    }
+}
+
+void RconServer::handleLogin(const Address &sender, ReadStream &stream) {
+    uint8_t passwordSize = 0;
+    uint8_t received[RCON_MAX_PASSWORD_SIZE];
+    bool accepted = stream.readUint8(&passwordSize) &&
+                    passwordSize == password.size() &&
+                    stream.readBytes(received, passwordSize) &&
+                    constantTimeEqual(received,
+                                      (const uint8_t *)password.data(),
+                                      password.size());
+
+    Session *session = nullptr;
+    if (accepted) {
+        // A client that didn't hear it was accepted logs in again, give it
+        // the session it already has
+        for (size_t i = 0; i < sessions.size(); ++i) {
+            if (sessions[i].address == sender) {
+                session = &sessions[i];
+            }
+        }
+
+        if (session == nullptr && sessions.size() < RCON_MAX_SESSIONS) {
+            Session newSession;
+            do {
+                randomBytes(&newSession.id, sizeof(newSession.id));
+            } while (newSession.id == NO_SESSION);
+            newSession.address       = sender;
+            newSession.idleTime      = 0.0f;
+            newSession.lastRequestId = 0;
+            sessions.push_back(newSession);
+            session = &sessions.back();
+
+            sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Event,
+                             "Rcon session from " + sender.toString() +
+                                 " logged in.");
+        }
+    } else {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Warning,
+                         "Rcon login from " + sender.toString() +
+                             " rejected.");
+    }
+
+    uint8_t reply[HEADER_SIZE + 4];
+    WriteStream replyStream(reply, sizeof(reply));
+    if (session != nullptr) {
+        session->idleTime = 0.0f;
+        writeHeader(replyStream, RconPacketType::Enum::LoginAccepted);
+        replyStream.writeUint32(session->id);
+    } else {
+        writeHeader(replyStream, RconPacketType::Enum::LoginRejected);
+    }
+    socket.send(sender, reply, replyStream.getBytesWritten());
+}
+
+void RconServer::handleCommand(Session &session, ReadStream &stream) {
+    uint32_t requestId = 0;
+    uint16_t lineSize  = 0;
+    if (!stream.readUint32(&requestId) || !stream.readUint16(&lineSize) ||
+        lineSize > RCON_MAX_LINE_SIZE ||
+        stream.getBytesRemaining() < lineSize) {
+        return;
+    }
+
+    // Request ids start at 1, so a session's first command is never mistaken
+    // for a retry
+    if (requestId == session.lastRequestId) {
+        sendResponse(session);
+        return;
+    }
+
+    std::string line(lineSize, '\0');
+    stream.readBytes(&line[0], lineSize);
+
+    // Submitted rather than executed directly, so the host's own output and
+    // error buffers are left as they were. Anything other threads submitted
+    // is executed too, as the game loop would next frame.
+    std::future<ConsoleCommandResult> future = console.submit(line);
+    console.executeSubmitted();
+    const ConsoleCommandResult result = future.get();
+    ++numCommandsExecuted;
+
+    const bool succeeded      = result.succeeded;
+    const std::string &output = result.output;
+    const std::string &error  = result.error;
+
+    std::vector<Chunk> chunks;
+    bool complete = addChunks(RconStream::Enum::Output, output, &chunks);
+    complete = addChunks(RconStream::Enum::Error, error, &chunks) && complete;
+    if (chunks.empty()) {
+        // Always answer, even with nothing to say
+        Chunk empty = {RconStream::Enum::Output, 0, 0, false};
+        chunks.push_back(empty);
+    } else if (!complete) {
+        // Say the output was cut short rather than stop silently
+        Chunk &last    = chunks.back();
+        last.size      = std::min(last.size,
+                                  RCON_MAX_CHUNK_SIZE - TRUNCATED_MARKER_SIZE);
+        last.truncated = true;
+    }
+
+    session.lastRequestId = requestId;
+    session.response.resize(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const std::string &text =
+            chunks[i].stream == RconStream::Enum::Output ? output : error;
+
+        const size_t chunkSize =
+            chunks[i].size + (chunks[i].truncated ? TRUNCATED_MARKER_SIZE : 0);
+
+        std::vector<uint8_t> &packet = session.response[i];
+        packet.resize(OUTPUT_HEADER_SIZE + chunkSize);
+
+        WriteStream packetStream(packet.data(), packet.size());
+        writeHeader(packetStream, RconPacketType::Enum::Output);
+        packetStream.writeUint32(session.id);
+        packetStream.writeUint32(requestId);
+        packetStream.writeUint8(succeeded ? 1 : 0);
+        packetStream.writeUint16((uint16_t)i);
+        packetStream.writeUint16((uint16_t)chunks.size());
+        packetStream.writeUint8((uint8_t)chunks[i].stream);
+        packetStream.writeUint16((uint16_t)chunkSize);
+        packetStream.writeBytes(text.data() + chunks[i].offset,
+                                chunks[i].size);
+        if (chunks[i].truncated) {
+            packetStream.writeBytes(TRUNCATED_MARKER, TRUNCATED_MARKER_SIZE);
+        }
+        assert(!packetStream.hasFailed());
+    }
+
+    sendResponse(session);
+}
+
+RconServer::Session *RconServer::findSession(uint32_t id,
+                                             const Address &address) {
+    Session *result = nullptr;
+
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        // A session only belongs to the address that logged in
+        if (sessions[i].id == id && sessions[i].address == address) {
+            result = &sessions[i];
+            break;
+        }
+    }
+
+    return result;
+}
+
+void RconServer::removeSession(uint32_t id) {
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        if (sessions[i].id == id) {
+            sessions[i] = std::move(sessions.back());
+            sessions.pop_back();
+            break;
+        }
+    }
+}
+
+void RconServer::sendResponse(const Session &session) {
+    for (size_t i = 0; i < session.response.size(); ++i) {
+        socket.send(session.address, session.response[i].data(),
+                    session.response[i].size());
+    }
+}
+
+RconClient::RconClient()
+    : connected(false), sessionId(NO_SESSION), nextRequestId(1),
+      buffer(RCON_MAX_PACKET_SIZE) {}
+
+RconClient::~RconClient() { close(); }
+
+bool RconClient::open(uint16_t port) { return socket.open(port); }
+
+void RconClient::close() {
+    disconnect();
+    socket.close();
+}
+
+bool RconClient::connect(const Address &address, const std::string &password,
+                         float timeout) {
+    if (!socket.isOpen() || password.size() > RCON_MAX_PASSWORD_SIZE) {
+        return false;
+    }
+
+    disconnect();
+    server = address;
+
+    uint8_t packet[HEADER_SIZE + 1 + RCON_MAX_PASSWORD_SIZE];
+    WriteStream stream(packet, sizeof(packet));
+    writeHeader(stream, RconPacketType::Enum::Login);
+    stream.writeUint8((uint8_t)password.size());
+    stream.writeBytes(password.data(), password.size());
+
+    bool rejected = false;
+    request(packet, stream.getBytesWritten(), timeout,
+            [&](RconPacketType::Enum type, ReadStream &reply) {
+                if (type == RconPacketType::Enum::LoginAccepted) {
+                    connected = reply.readUint32(&sessionId);
+                } else if (type == RconPacketType::Enum::LoginRejected) {
+                    rejected = true;
+                }
+                return connected || rejected;
+            });
+
+    return connected;
+}
+
+void RconClient::disconnect() {
+    if (connected) {
+        uint8_t packet[HEADER_SIZE + 4];
+        WriteStream stream(packet, sizeof(packet));
+        writeHeader(stream, RconPacketType::Enum::Logout);
+        stream.writeUint32(sessionId);
+        socket.send(server, packet, stream.getBytesWritten());
+    }
+
+    connected = false;
+    sessionId = NO_SESSION;
+}
+
+bool RconClient::isConnected() const { return connected; }
+
+bool RconClient::execute(const std::string &line, float timeout,
+                         RconResult *result) {
+    if (!connected || line.size() > RCON_MAX_LINE_SIZE) {
+        return false;
+    }
+
+    const uint32_t requestId = nextRequestId++;
+
+    uint8_t packet[HEADER_SIZE + 4 + 4 + 2 + RCON_MAX_LINE_SIZE];
+    WriteStream stream(packet, sizeof(packet));
+    writeHeader(stream, RconPacketType::Enum::Command);
+    stream.writeUint32(sessionId);
+    stream.writeUint32(requestId);
+    stream.writeUint16((uint16_t)line.size());
+    stream.writeBytes(line.data(), line.size());
+
+    // Chunks can arrive in any order, keep them until all are here
+    std::vector<std::string> chunks;
+    std::vector<uint8_t> streams;
+    size_t numReceived = 0;
+    bool succeeded     = false;
+
+    bool complete = request(
+        packet, stream.getBytesWritten(), timeout,
+        [&](RconPacketType::Enum type, ReadStream &reply) {
+            uint32_t replySession = 0;
+            uint32_t replyRequest = 0;
+            uint8_t replySucceeded = 0;
+            uint16_t chunkIndex    = 0;
+            uint16_t numChunks     = 0;
+            uint8_t chunkStream    = 0;
+            uint16_t chunkSize     = 0;
+            if (type != RconPacketType::Enum::Output ||
+                !reply.readUint32(&replySession) ||
+                !reply.readUint32(&replyRequest) ||
+                !reply.readUint8(&replySucceeded) ||
+                !reply.readUint16(&chunkIndex) ||
+                !reply.readUint16(&numChunks) ||
+                !reply.readUint8(&chunkStream) ||
+                !reply.readUint16(&chunkSize) || replySession != sessionId ||
+                replyRequest != requestId || numChunks == 0 ||
+                chunkIndex >= numChunks ||
+                (!chunks.empty() && numChunks != chunks.size()) ||
+                reply.getBytesRemaining() < chunkSize) {
+                return false;
+            }
+
+            if (chunks.empty()) {
+                chunks.resize(numChunks);
+                streams.resize(numChunks, 0xff);
+            }
+
+            // Duplicates arrive when the request was resent
+            if (streams[chunkIndex] == 0xff) {
+                chunks[chunkIndex].resize(chunkSize);
+                if (chunkSize > 0) {
+                    reply.readBytes(&chunks[chunkIndex][0], chunkSize);
+                }
+                streams[chunkIndex] = chunkStream;
+                succeeded           = replySucceeded != 0;
+                ++numReceived;
+            }
+
+            return numReceived == chunks.size();
+        });
+
+    if (complete) {
+        result->succeeded = succeeded;
+        result->output.clear();
+        result->error.clear();
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            if (streams[i] == RconStream::Enum::Error) {
+                result->error += chunks[i];
+            } else {
+                result->output += chunks[i];
+            }
+        }
+    }
+
+    return complete;
+}
+
+template <typename Handler>
+bool RconClient::request(const uint8_t *packet, size_t size, float timeout,
+                         Handler handle) {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+
+    bool done        = false;
+    float nextResend = 0.0f;
+    while (!done) {
+        float elapsed =
+            std::chrono::duration<float>(Clock::now() - start).count();
+        if (elapsed >= timeout) {
+            break;
+        }
+
+        if (elapsed >= nextResend) {
+            socket.send(server, packet, size);
+            nextResend = elapsed + RESEND_INTERVAL;
+        }
+
+        socket.wait(std::min(nextResend, timeout) - elapsed);
+
+        Address sender;
+        size_t received;
+        while (!done && (received = socket.receive(sender, buffer.data(),
+                                                   buffer.size())) > 0) {
+            ReadStream reply(buffer.data(), received);
+            RconPacketType::Enum type;
+            if (sender == server && readHeader(reply, &type)) {
+                done = handle(type, reply);
+            }
+        }
+    }
+
+    return done;
+}
+}
+}
@@ -0,0 +1,225 @@
+#include <sv/network/SendScheduler.h>
+
+namespace sv {
+namespace net {
+namespace {
+// Seconds conditions must be good to leave bad mode, initially and at most
+const float INITIAL_PENALTY_TIME = 4.0f;
+const float MIN_PENALTY_TIME     = 1.0f;
+const float MAX_PENALTY_TIME     = 60.0f;
+
+// Dropping back to bad mode sooner than this after recovering doubles the
+// penalty time, staying good this long halves it
+const float PENALTY_ADJUST_TIME = 10.0f;
+}
+
+TokenBucket::TokenBucket(float rate_, float capacity_)
+    : rate(rate_), capacity(capacity_), tokens(capacity_) {}
+
+void TokenBucket::setRate(float rate_, float capacity_) {
+    rate     = rate_;
+    capacity = capacity_;
+    if (tokens > capacity) {
+        tokens = capacity;
+    }
+}
+
+void TokenBucket::update(float deltaTime) {
+    if (deltaTime > 0.0f) {
+        tokens += rate * deltaTime;
+        if (tokens > capacity) {
+            tokens = capacity;
+        }
+    }
+}
+
+bool TokenBucket::hasTokens() const { return tokens > 0.0f; }
+
+void TokenBucket::consume(size_t amount) { tokens -= (float)amount; }
+
+float TokenBucket::getTokens() const { return tokens; }
+
+void TokenBucket::reset() { tokens = capacity; }
+
+SendScheduler::SendScheduler()
+    : bandwidth(0), maxQueueSize(SEND_SCHEDULER_DEFAULT_MAX_QUEUE_SIZE),
+      numDropped(0) {
+    clear();
+}
+
+void SendScheduler::setBandwidth(uint32_t bytesPerSecond) {
+    bandwidth = bytesPerSecond;
+    updateRate();
+    bucket.reset();
+}
+
+uint32_t SendScheduler::getBandwidth() const { return bandwidth; }
+
+void SendScheduler::setMaxQueueSize(size_t bytes) { maxQueueSize = bytes; }
+
+size_t SendScheduler::getMaxQueueSize() const { return maxQueueSize; }
+
+CongestionMode::Enum SendScheduler::getCongestionMode() const { return mode; }
+
+uint32_t SendScheduler::getSendRate() const {
+    uint32_t result = bandwidth;
+
+    if (mode == CongestionMode::Enum::Bad) {
+        result = (uint32_t)(bandwidth * SEND_SCHEDULER_BAD_RATE_SCALE);
+        if (result == 0 && bandwidth > 0) {
+            result = 1;
+        }
+    }
+
+    return result;
+}
+
+float SendScheduler::getPenaltyTime() const { return penaltyTime; }
+
+void SendScheduler::updateRate() {
+    float rate = (float)getSendRate();
+    bucket.setRate(rate, rate * SEND_SCHEDULER_BURST_TIME);
+}
+
+void SendScheduler::update(float deltaTime, float rtt, float packetLoss) {
+    const bool congested =
+        rtt > SEND_SCHEDULER_BAD_RTT || packetLoss > SEND_SCHEDULER_BAD_LOSS;
+
+    if (mode == CongestionMode::Enum::Good) {
+        if (congested) {
+            // Went bad again soon after recovering, wait longer next time
+            if (goodConditionsTime < PENALTY_ADJUST_TIME) {
+                penaltyTime *= 2.0f;
+                if (penaltyTime > MAX_PENALTY_TIME) {
+                    penaltyTime = MAX_PENALTY_TIME;
+                }
+            }
+
+            mode                 = CongestionMode::Enum::Bad;
+            goodConditionsTime   = 0.0f;
+            penaltyReductionTime = 0.0f;
+            updateRate();
+        } else {
+            goodConditionsTime += deltaTime;
+            penaltyReductionTime += deltaTime;
+
+            // Been good for a while, recover quicker next time
+            if (penaltyReductionTime > PENALTY_ADJUST_TIME) {
+                penaltyReductionTime = 0.0f;
+                penaltyTime /= 2.0f;
+                if (penaltyTime < MIN_PENALTY_TIME) {
+                    penaltyTime = MIN_PENALTY_TIME;
+                }
+            }
+        }
+    } else {
+        if (congested) {
+            goodConditionsTime = 0.0f;
+        } else {
+            goodConditionsTime += deltaTime;
+        }
+
+        if (goodConditionsTime > penaltyTime) {
+            mode                 = CongestionMode::Enum::Good;
+            goodConditionsTime   = 0.0f;
+            penaltyReductionTime = 0.0f;
+            updateRate();
+        }
+    }
+
+    bucket.update(deltaTime);
+}
+
+bool SendScheduler::canSend(SendPriority::Enum priority) const {
+    if (bandwidth > 0 && !bucket.hasTokens()) {
+        return false;
+    }
+
+    for (size_t i = 0; i <= (size_t)priority && i < SEND_PRIORITY_COUNT; ++i) {
+        if (!queues[i].empty()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SendScheduler::consume(size_t size) {
+    if (bandwidth > 0) {
+        bucket.consume(size);
+    }
+}
+
+bool SendScheduler::enqueue(const void *data, size_t size,
+                            SendPriority::Enum priority) {
+    if (size > maxQueueSize || (size_t)priority >= SEND_PRIORITY_COUNT) {
+        ++numDropped;
+        return false;
+    }
+
+    // Make room by dropping the oldest of the least important messages
+    for (size_t i = SEND_PRIORITY_COUNT; i-- > (size_t)priority;) {
+        while (queuedBytes + size > maxQueueSize && !queues[i].empty()) {
+            queuedBytes -= queues[i].front().size();
+            --numQueued;
+            ++numDropped;
+            queues[i].pop_front();
+        }
+    }
+
+    if (queuedBytes + size > maxQueueSize) {
+        ++numDropped;
+        return false;
+    }
+
+    queues[priority].push_back(std::vector<uint8_t>(
+        (const uint8_t *)data, (const uint8_t *)data + size));
+    ++numQueued;
+    queuedBytes += size;
+
+    return true;
+}
+
+bool SendScheduler::dequeue(std::vector<uint8_t> *data) {
+    if (numQueued == 0 || (bandwidth > 0 && !bucket.hasTokens())) {
+        return false;
+    }
+
+    for (size_t i = 0; i < SEND_PRIORITY_COUNT; ++i) {
+        if (!queues[i].empty()) {
+            queuedBytes -= queues[i].front().size();
+            --numQueued;
+            if (data != nullptr) {
+                data->swap(queues[i].front());
+            }
+            queues[i].pop_front();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t SendScheduler::getNumQueued() const { return numQueued; }
+
+size_t SendScheduler::getQueuedBytes() const { return queuedBytes; }
+
+uint64_t SendScheduler::getNumDropped() const { return numDropped; }
+
+void SendScheduler::clear() {
+    for (size_t i = 0; i < SEND_PRIORITY_COUNT; ++i) {
+        queues[i].clear();
+    }
+    numQueued   = 0;
+    queuedBytes = 0;
+
+    mode                 = CongestionMode::Enum::Good;
+    penaltyTime          = INITIAL_PENALTY_TIME;
+    goodConditionsTime   = 0.0f;
+    penaltyReductionTime = 0.0f;
+    updateRate();
+    bucket.reset();
+}
+}
+}
@@ -0,0 +1,229 @@
+#include <cassert>
+#include <chrono>
+
+#include <sv/Globals.h>
+#include <sv/network/ShardedServer.h>
+
+namespace sv {
+namespace net {
+namespace {
+// Longest a worker waits for packets before checking for timeouts and
+// whether it should stop
+const float WORKER_WAIT_TIME = 0.01f;
+}
+
+ShardWorker::ShardWorker(size_t index_, float timeout_, size_t maxClients_,
+                         ShardedServerHandler *handler_)
+    : index(index_), timeout(timeout_), maxClients(maxClients_),
+      handler(handler_), running(false), buffer(SHARD_MAX_PACKET_SIZE),
+      numClients(0), packetsReceived(0), bytesReceived(0), packetsDropped(0) {}
+
+ShardWorker::~ShardWorker() { stop(); }
+
+bool ShardWorker::open(uint16_t port, bool reusePort) {
+    return socket.open(port, reusePort);
+}
+
+void ShardWorker::start() {
+    if (!running && socket.isOpen()) {
+        running = true;
+        thread  = std::thread(&ShardWorker::run, this);
+    }
+}
+
+void ShardWorker::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    for (std::unordered_map<Address, ShardClient>::iterator it =
+             clients.begin();
+         it != clients.end(); ++it) {
+        if (handler != nullptr) {
+            handler->onClientDisconnected(*this, it->second);
+        }
+    }
+    clients.clear();
+    numClients = 0;
+
+    socket.close();
+}
+
+bool ShardWorker::send(const Address &destination, const void *data,
+                       size_t size) {
+    return socket.send(destination, data, size);
+}
+
+size_t ShardWorker::getIndex() const { return index; }
+
+size_t ShardWorker::getNumClients() const { return numClients; }
+
+uint64_t ShardWorker::getPacketsReceived() const { return packetsReceived; }
+
+uint64_t ShardWorker::getBytesReceived() const { return bytesReceived; }
+
+uint64_t ShardWorker::getPacketsDropped() const { return packetsDropped; }
+
+void ShardWorker::run() {
+    std::chrono::steady_clock::time_point last =
+        std::chrono::steady_clock::now();
+
+    while (running) {
+        if (socket.wait(WORKER_WAIT_TIME)) {
+            receivePackets();
+        }
+
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        updateClients(std::chrono::duration<float>(now - last).count());
+        last = now;
+    }
+}
+
+void ShardWorker::receivePackets() {
+    while (true) {
+        Address sender;
+        size_t bytesRead = socket.receive(sender, &buffer[0], buffer.size());
+        if (bytesRead == 0) {
+            break;
+        }
+
+        packetsReceived.fetch_add(1, std::memory_order_relaxed);
+        bytesReceived.fetch_add(bytesRead, std::memory_order_relaxed);
+
+        std::unordered_map<Address, ShardClient>::iterator it =
+            clients.find(sender);
+        if (it == clients.end()) {
+            // Source addresses can be spoofed, don't let them grow the
+            // worker's state without limit
+            if (clients.size() >= maxClients) {
+                packetsDropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            it = clients.insert(std::make_pair(sender, ShardClient())).first;
+            it->second.address = sender;
+            numClients         = clients.size();
+            if (handler != nullptr) {
+                handler->onClientConnected(*this, it->second);
+            }
+        }
+
+        ShardClient &client = it->second;
+        client.idleTime     = 0.0f;
+        ++client.packetsReceived;
+        client.bytesReceived += bytesRead;
+
+        if (handler != nullptr) {
+            handler->onPacket(*this, client, &buffer[0], bytesRead);
+        }
+    }
+}
+
+void ShardWorker::updateClients(float deltaTime) {
+    std::unordered_map<Address, ShardClient>::iterator it = clients.begin();
+    while (it != clients.end()) {
+        it->second.idleTime += deltaTime;
+        if (it->second.idleTime > timeout) {
+            if (handler != nullptr) {
+                handler->onClientDisconnected(*this, it->second);
+            }
+            it = clients.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    numClients = clients.size();
+}
+
+ShardedServer::ShardedServer(float timeout_, size_t maxClientsPerWorker_)
+    : timeout(timeout_), maxClientsPerWorker(maxClientsPerWorker_) {}
+
+ShardedServer::~ShardedServer() { stop(); }
+
+bool ShardedServer::start(uint16_t port, size_t numWorkers,
+                          ShardedServerHandler *handler) {
+    if (isRunning()) {
+        sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Warning,
+                         "Tried to start sharded server already running.");
+        return false;
+    }
+
+    if (numWorkers == 0) {
+        numWorkers = 1;
+    }
+
+    // Open every socket before starting any thread, so a failure leaves
+    // nothing running
+    for (size_t i = 0; i < numWorkers; ++i) {
+        workers.push_back(std::unique_ptr<ShardWorker>(
+            new ShardWorker(i, timeout, maxClientsPerWorker, handler)));
+        if (!workers.back()->open(port, numWorkers > 1)) {
+            workers.clear();
+            sv::globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                             "Failed to open sharded server sockets.");
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->start();
+    }
+
+    return true;
+}
+
+void ShardedServer::stop() {
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->stop();
+    }
+    workers.clear();
+}
+
+bool ShardedServer::isRunning() const { return !workers.empty(); }
+
+size_t ShardedServer::getNumWorkers() const { return workers.size(); }
+
+const ShardWorker &ShardedServer::getWorker(size_t index) const {
+    assert(index < workers.size() && "Worker index out of range!");
+    return *workers[index];
+}
+
+size_t ShardedServer::getNumClients() const {
+    size_t result = 0;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        result += workers[i]->getNumClients();
+    }
+
+    return result;
+}
+
+uint64_t ShardedServer::getPacketsReceived() const {
+    uint64_t result = 0;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        result += workers[i]->getPacketsReceived();
+    }
+
+    return result;
+}
+
+uint64_t ShardedServer::getBytesReceived() const {
+    uint64_t result = 0;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        result += workers[i]->getBytesReceived();
+    }
+
+    return result;
+}
+
+uint64_t ShardedServer::getPacketsDropped() const {
+    uint64_t result = 0;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        result += workers[i]->getPacketsDropped();
+    }
+
+    return result;
+}
+}
+}
@@ -0,0 +1,362 @@
+#include <cassert>
+#include <cstring>
+
+#include <sv/network/Snapshot.h>
+#include <sv/network/Stream.h>
+
+namespace sv {
+namespace net {
+namespace {
+// Fields of an entity that isn't in the baseline are encoded against zero
+const uint32_t zeroFields[SNAPSHOT_MAX_FIELDS] = {0};
+
+// \returns Number of bytes used for the change bits of one entity.
+size_t getChangeMaskSize(uint8_t fieldCount) { return (fieldCount + 7) / 8; }
+
+// Write the fields of \p current that differ from \p previous, preceded by a
+// bit per field indicating whether or not it changed.
+void writeEntityDelta(WriteStream &stream, uint8_t fieldCount,
+                      const uint32_t *previous, const uint32_t *current) {
+    uint8_t mask[SNAPSHOT_MAX_FIELDS / 8] = {0};
+    for (uint8_t i = 0; i < fieldCount; ++i) {
+        if (previous[i] != current[i]) {
+            mask[i / 8] |= (uint8_t)(1 << (i % 8));
+        }
+    }
+
+    stream.writeBytes(mask, getChangeMaskSize(fieldCount));
+    for (uint8_t i = 0; i < fieldCount; ++i) {
+        if (mask[i / 8] & (1 << (i % 8))) {
+            stream.writeUint32(current[i]);
+        }
+    }
+}
+
+// Read fields written by 'writeEntityDelta' on top of \p fields.
+bool readEntityDelta(ReadStream &stream, uint8_t fieldCount,
+                     uint32_t *fields) {
+    uint8_t mask[SNAPSHOT_MAX_FIELDS / 8] = {0};
+    stream.readBytes(mask, getChangeMaskSize(fieldCount));
+    for (uint8_t i = 0; i < fieldCount; ++i) {
+        if (mask[i / 8] & (1 << (i % 8))) {
+            stream.readUint32(&fields[i]);
+        }
+    }
+
+    return !stream.hasFailed();
+}
+
+// Encode \p snapshot against \p baseline (or against an empty world if
+// baseline is nullptr).
+//
+// Format:
+//     uint32  sequence
+//     uint8   sequence - baseline sequence, 0 if no baseline (a snapshot is
+//             never encoded against itself, so 0 is free to mean that)
+//     uint8   field count
+//     uint16  number of removed entities, followed by their ids
+//     uint16  number of changed entities, followed by for each entity:
+//                 uint16  id
+//                 uint8[] change bits, one per field
+//                 uint32  value of each changed field
+size_t writeDelta(const Snapshot &snapshot, const Snapshot *baseline,
+                  void *buffer, size_t bufferSize) {
+    WriteStream stream(buffer, bufferSize);
+    const uint8_t fieldCount = snapshot.getFieldCount();
+
+    stream.writeUint32(snapshot.getSequence());
+    stream.writeUint8(baseline != nullptr ? (uint8_t)(snapshot.getSequence() -
+                                                      baseline->getSequence())
+                                          : 0);
+    stream.writeUint8(fieldCount);
+
+    // Removed entities, both entity lists are sorted by id
+    std::vector<uint16_t> removed;
+    if (baseline != nullptr) {
+        for (size_t i = 0; i < baseline->getNumEntities(); ++i) {
+            uint16_t id = baseline->getEntityId(i);
+            if (snapshot.findEntity(id) == nullptr) {
+                removed.push_back(id);
+            }
+        }
+    }
+    stream.writeUint16((uint16_t)removed.size());
+    for (size_t i = 0; i < removed.size(); ++i) {
+        stream.writeUint16(removed[i]);
+    }
+
+    // Count changed entities first so the count can precede them
+    uint16_t numChanged = 0;
+    for (size_t i = 0; i < snapshot.getNumEntities(); ++i) {
+        const uint32_t *previous =
+            baseline != nullptr ? baseline->findEntity(snapshot.getEntityId(i))
+                                : nullptr;
+        if (previous == nullptr ||
+            memcmp(previous, snapshot.getEntityFields(i),
+                   sizeof(uint32_t) * fieldCount) != 0) {
+            ++numChanged;
+        }
+    }
+    stream.writeUint16(numChanged);
+
+    for (size_t i = 0; i < snapshot.getNumEntities(); ++i) {
+        const uint16_t id       = snapshot.getEntityId(i);
+        const uint32_t *current = snapshot.getEntityFields(i);
+        const uint32_t *previous =
+            baseline != nullptr ? baseline->findEntity(id) : nullptr;
+
+        if (previous == nullptr) {
+            // New entity
+            stream.writeUint16(id);
+            writeEntityDelta(stream, fieldCount, zeroFields, current);
+        } else if (memcmp(previous, current, sizeof(uint32_t) * fieldCount) !=
+                   0) {
+            stream.writeUint16(id);
+            writeEntityDelta(stream, fieldCount, previous, current);
+        }
+    }
+
+    return stream.hasFailed() ? 0 : stream.getBytesWritten();
+}
+}
+
+uint32_t floatToField(float value) {
+    uint32_t field;
+    memcpy(&field, &value, sizeof(field));
+    return field;
+}
+
+float fieldToFloat(uint32_t field) {
+    float value;
+    memcpy(&value, &field, sizeof(value));
+    return value;
+}
+
+Snapshot::Snapshot(uint8_t fieldCount_, uint32_t sequence_)
+    : sequence(sequence_), fieldCount(fieldCount_) {
+    assert(fieldCount <= SNAPSHOT_MAX_FIELDS && "Too many snapshot fields!");
+}
+
+uint32_t Snapshot::getSequence() const { return sequence; }
+
+void Snapshot::setSequence(uint32_t sequence_) { sequence = sequence_; }
+
+uint8_t Snapshot::getFieldCount() const { return fieldCount; }
+
+void Snapshot::reset(uint8_t fieldCount_) {
+    assert(fieldCount_ <= SNAPSHOT_MAX_FIELDS && "Too many snapshot fields!");
+    fieldCount = fieldCount_;
+    ids.clear();
+    fields.clear();
+}
+
+size_t Snapshot::getNumEntities() const { return ids.size(); }
+
+uint16_t Snapshot::getEntityId(size_t index) const { return ids[index]; }
+
+const uint32_t *Snapshot::getEntityFields(size_t index) const {
+    return &fields[index * fieldCount];
+}
+
+size_t Snapshot::lowerBound(uint16_t id) const {
+    // Fast path for entities added in increasing id order
+    if (ids.empty() || ids.back() < id) {
+        return ids.size();
+    }
+
+    size_t first = 0;
+    size_t count = ids.size();
+    while (count > 0) {
+        size_t step = count / 2;
+        if (ids[first + step] < id) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+void Snapshot::setEntity(uint16_t id, const uint32_t *entityFields) {
+    size_t index = lowerBound(id);
+
+    if (index < ids.size() && ids[index] == id) {
+        // Replace existing entity
+        memcpy(&fields[index * fieldCount], entityFields,
+               sizeof(uint32_t) * fieldCount);
+    } else {
+        ids.insert(ids.begin() + index, id);
+        fields.insert(fields.begin() + index * fieldCount, entityFields,
+                      entityFields + fieldCount);
+    }
+}
+
+const uint32_t *Snapshot::findEntity(uint16_t id) const {
+    const uint32_t *result = nullptr;
+
+    size_t index = lowerBound(id);
+    if (index < ids.size() && ids[index] == id) {
+        result = &fields[index * fieldCount];
+    }
+
+    return result;
+}
+
+void Snapshot::removeEntity(uint16_t id) {
+    size_t index = lowerBound(id);
+    if (index < ids.size() && ids[index] == id) {
+        ids.erase(ids.begin() + index);
+        fields.erase(fields.begin() + index * fieldCount,
+                     fields.begin() + (index + 1) * fieldCount);
+    }
+}
+
+void SnapshotHistory::insert(const std::shared_ptr<const Snapshot> &snapshot) {
+    entries[snapshot->getSequence() % SNAPSHOT_HISTORY_SIZE] = snapshot;
+}
+
+std::shared_ptr<const Snapshot>
+SnapshotHistory::find(uint32_t sequence) const {
+    std::shared_ptr<const Snapshot> result;
+
+    const std::shared_ptr<const Snapshot> &entry =
+        entries[sequence % SNAPSHOT_HISTORY_SIZE];
+    if (entry != nullptr && entry->getSequence() == sequence) {
+        result = entry;
+    }
+
+    return result;
+}
+
+void SnapshotHistory::clear() {
+    for (uint32_t i = 0; i < SNAPSHOT_HISTORY_SIZE; ++i) {
+        entries[i].reset();
+    }
+}
+
+size_t
+SnapshotSender::writeSnapshot(const std::shared_ptr<const Snapshot> &snapshot,
+                              void *buffer, size_t bufferSize) {
+    // Find baseline, fall back to a full snapshot if the client hasn't
+    // acknowledged anything recent enough to still be in the history. The
+    // baseline must be older, an offset of 0 means there is none.
+    std::shared_ptr<const Snapshot> baseline;
+    const uint32_t baselineAge = snapshot->getSequence() - lastAcked;
+    if (hasAck && baselineAge > 0 && baselineAge < SNAPSHOT_HISTORY_SIZE) {
+        baseline = history.find(lastAcked);
+        if (baseline != nullptr &&
+            baseline->getFieldCount() != snapshot->getFieldCount()) {
+            baseline.reset();
+        }
+    }
+
+    size_t bytesWritten =
+        writeDelta(*snapshot, baseline.get(), buffer, bufferSize);
+    if (bytesWritten > 0) {
+        history.insert(snapshot);
+    }
+
+    return bytesWritten;
+}
+
+void SnapshotSender::acknowledge(uint32_t sequence) {
+    // Compare using the difference so wrapping sequence numbers work
+    if (hasAck == false || (int32_t)(sequence - lastAcked) > 0) {
+        hasAck    = true;
+        lastAcked = sequence;
+    }
+}
+
+void SnapshotSender::reset() {
+    history.clear();
+    hasAck    = false;
+    lastAcked = 0;
+}
+
+bool SnapshotReceiver::readSnapshot(const void *data, size_t dataSize,
+                                    Snapshot *snapshotOut) {
+    if (snapshotOut == nullptr) {
+        return false;
+    }
+
+    ReadStream stream(data, dataSize);
+
+    uint32_t sequence      = 0;
+    uint8_t baselineOffset = 0;
+    uint8_t fieldCount     = 0;
+    stream.readUint32(&sequence);
+    stream.readUint8(&baselineOffset);
+    stream.readUint8(&fieldCount);
+    if (stream.hasFailed() || fieldCount > SNAPSHOT_MAX_FIELDS) {
+        return false;
+    }
+
+    // Start from the baseline, or an empty world
+    std::shared_ptr<Snapshot> snapshot;
+    if (baselineOffset != 0) {
+        std::shared_ptr<const Snapshot> baseline =
+            history.find(sequence - baselineOffset);
+        if (baseline == nullptr || baseline->getFieldCount() != fieldCount) {
+            return false;
+        }
+        snapshot = std::shared_ptr<Snapshot>(new Snapshot(*baseline));
+        snapshot->setSequence(sequence);
+    } else {
+        snapshot =
+            std::shared_ptr<Snapshot>(new Snapshot(fieldCount, sequence));
+    }
+
+    uint16_t numRemoved = 0;
+    stream.readUint16(&numRemoved);
+    for (uint16_t i = 0; i < numRemoved && !stream.hasFailed(); ++i) {
+        uint16_t id = 0;
+        if (stream.readUint16(&id)) {
+            snapshot->removeEntity(id);
+        }
+    }
+
+    uint16_t numChanged = 0;
+    stream.readUint16(&numChanged);
+    for (uint16_t i = 0; i < numChanged && !stream.hasFailed(); ++i) {
+        uint16_t id = 0;
+        if (stream.readUint16(&id)) {
+            uint32_t fields[SNAPSHOT_MAX_FIELDS] = {0};
+            const uint32_t *previous = snapshot->findEntity(id);
+            if (previous != nullptr) {
+                memcpy(fields, previous, sizeof(uint32_t) * fieldCount);
+            }
+
+            if (readEntityDelta(stream, fieldCount, fields)) {
+                snapshot->setEntity(id, fields);
+            }
+        }
+    }
+
+    if (stream.hasFailed()) {
+        return false;
+    }
+
+    history.insert(snapshot);
+    if (hasReceived == false || (int32_t)(sequence - latestSequence) > 0) {
+        hasReceived    = true;
+        latestSequence = sequence;
+    }
+
+    *snapshotOut = *snapshot;
+
+    return true;
+}
+
+bool SnapshotReceiver::hasReceivedSnapshot() const { return hasReceived; }
+
+uint32_t SnapshotReceiver::getLatestSequence() const { return latestSequence; }
+
+void SnapshotReceiver::reset() {
+    history.clear();
+    hasReceived    = false;
+    latestSequence = 0;
+}
+}
+}
@@ -1,15 +1,23 @@
 #include <sv/System.h>
 
+#include <cstring>
+#include <sstream>
+
 #if SV_PLATFORM_WINDOWS
 #include <winsock2.h>
+#include <ws2tcpip.h>
 #elif SV_PLATFORM_POSIX
+#include <arpa/inet.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <sys/select.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #endif
 
 #include <sv/Globals.h>
+#include <sv/network/NetworkSimulator.h>
+#include <sv/network/PacketCapture.h>
 #include <sv/network/Sockets.h>
 
 namespace sv {
@@ -31,36 +39,147 @@ void shutdownSockets() {
 #endif
 }
 
-uint32_t Address::getAddress() const { return address; }
+namespace {
+const uint8_t zeroIPv6[16] = {0};
+
+// ::ffff:0:0/96, prefix of IPv4 addresses mapped to IPv6
+const uint8_t ipv4MappedPrefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+}
+
+Address::Address(uint16_t a, uint16_t b, uint16_t c, uint16_t d, uint16_t e,
+                 uint16_t f, uint16_t g, uint16_t h, uint16_t port_)
+    : port(port_), type(AddressType::Enum::IPv6) {
+    const uint16_t groups[8] = {a, b, c, d, e, f, g, h};
+
+    uint8_t bytes[16];
+    for (size_t i = 0; i < 8; ++i) {
+        bytes[i * 2]     = (uint8_t)(groups[i] >> 8);
+        bytes[i * 2 + 1] = (uint8_t)(groups[i]);
+    }
+    memcpy(words, bytes, sizeof(words));
+}
+
+Address::Address(const uint8_t (&ipv6Bytes)[16], uint16_t port_)
+    : port(port_), type(AddressType::Enum::IPv6) {
+    memcpy(words, ipv6Bytes, sizeof(words));
+}
+
+uint32_t Address::getAddress() const {
+    return type == AddressType::Enum::IPv4 ? (uint32_t)words[0] : 0;
+}
+
+uint8_t Address::getA() const { return (uint8_t)(getAddress() >> 24); }
+
+uint8_t Address::getB() const { return (uint8_t)(getAddress() >> 16); }
+
+uint8_t Address::getC() const { return (uint8_t)(getAddress() >> 8); }
 
-uint8_t Address::getA() const { return (uint8_t)(address >> 24); }
+uint8_t Address::getD() const { return (uint8_t)(getAddress()); }
 
-uint8_t Address::getB() const { return (uint8_t)(address >> 16); }
+const uint8_t *Address::getIPv6() const {
+    return type == AddressType::Enum::IPv6 ? (const uint8_t *)words : zeroIPv6;
+}
 
-uint8_t Address::getC() const { return (uint8_t)(address >> 8); }
+uint16_t Address::getIPv6Group(size_t index) const {
+    uint16_t result = 0;
 
-uint8_t Address::getD() const { return (uint8_t)(address); }
+    if (index < 8) {
+        const uint8_t *bytes = getIPv6();
+        result = (uint16_t)((bytes[index * 2] << 8) | bytes[index * 2 + 1]);
+    }
+
+    return result;
+}
 
 uint16_t Address::getPort() const { return port; }
 
-bool Address::operator==(const Address &other) const {
-    return (address == other.address) && (port == other.port);
+std::string Address::toString() const {
+    std::stringstream out;
+
+    switch (type) {
+    case AddressType::Enum::IPv4: {
+        out << (int)getA() << "." << (int)getB() << "." << (int)getC() << "."
+            << (int)getD() << ":" << port;
+        break;
+    }
+    case AddressType::Enum::IPv6: {
+        // Find the longest run of zero groups to shorten to '::'
+        size_t bestStart  = 8;
+        size_t bestLength = 0;
+        for (size_t i = 0; i < 8;) {
+            size_t length = 0;
+            while (i + length < 8 && getIPv6Group(i + length) == 0) {
+                ++length;
+            }
+            if (length > 1 && length > bestLength) {
+                bestStart  = i;
+                bestLength = length;
+            }
+            i += length > 0 ? length : 1;
+        }
+
+        out << "[" << std::hex;
+        for (size_t i = 0; i < 8; ++i) {
+            if (i == bestStart) {
+                out << "::";
+                i += bestLength - 1;
+                continue;
+            }
+            if (i > 0 && i != bestStart + bestLength) {
+                out << ":";
+            }
+            out << getIPv6Group(i);
+        }
+        out << std::dec << "]:" << port;
+        break;
+    }
+    default: {
+        out << "none";
+        break;
+    }
+    }
+
+    return out.str();
 }
 
-bool Address::operator!=(const Address &other) const {
-    return !(*this == other);
+bool Address::operator<(const Address &other) const {
+    if (type != other.type) {
+        return type < other.type;
+    }
+    if (words[0] != other.words[0]) {
+        return words[0] < other.words[0];
+    }
+    if (words[1] != other.words[1]) {
+        return words[1] < other.words[1];
+    }
+
+    return port < other.port;
 }
 
 Socket::~Socket() { close(); }
 
-bool Socket::open(uint16_t port) {
+bool Socket::open(uint16_t port, bool reusePort) {
     // Is open already?
     if (isOpen()) {
         close();
     }
 
-    // Open socket
-    socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    // Prefer a dual-stack IPv6 socket, which also handles IPv4 through
+    // IPv4-mapped addresses
+    isIPv6 = true;
+    socket = ::socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    if (socket > 0) {
+        int v6Only = 0;
+        if (setsockopt(socket, IPPROTO_IPV6, IPV6_V6ONLY,
+                       (const char *)&v6Only, sizeof(v6Only)) != 0) {
+            close();
+        }
+    }
+
+    if (socket <= 0) {
+        isIPv6 = false;
+        socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    }
 
     if (socket <= 0) {
         globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
@@ -68,14 +187,48 @@ bool Socket::open(uint16_t port) {
         return false;
     }
 
+    if (reusePort) {
+#if SV_PLATFORM_POSIX && defined(SO_REUSEPORT)
+        int reuse = 1;
+        if (setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, (const char *)&reuse,
+                       sizeof(reuse)) != 0) {
+            close();
+            globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                         "Failed to set SO_REUSEPORT.");
+            return false;
+        }
+#else
+        close();
+        globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                     "SO_REUSEPORT is not supported on this platform.");
+        return false;
+#endif
+    }
+
     // Bind socket to port
-    sockaddr_in address;
-    address.sin_family      = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port =
-        htons(port); // htons - host byte order to network byte order
+    int bindResult = -1;
+    if (isIPv6) {
+        sockaddr_in6 address;
+        memset(&address, 0, sizeof(address));
+        address.sin6_family = AF_INET6;
+        address.sin6_addr   = in6addr_any;
+        address.sin6_port   = htons(port);
+
+        bindResult =
+            bind(socket, (const sockaddr *)&address, sizeof(sockaddr_in6));
+    } else {
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = INADDR_ANY;
+        address.sin_port =
+            htons(port); // htons - host byte order to network byte order
+
+        bindResult =
+            bind(socket, (const sockaddr *)&address, sizeof(sockaddr_in));
+    }
 
-    if (bind(socket, (const sockaddr *)&address, sizeof(sockaddr_in)) < 0) {
+    if (bindResult < 0) {
         close();
         globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
                      "Failed to bind socket.");
@@ -121,21 +274,65 @@ void Socket::close() {
 
 bool Socket::isOpen() const { return socket > 0; }
 
+bool Socket::supportsIPv6() const { return isOpen() && isIPv6; }
+
 bool Socket::send(const Address &destination, const void *data, size_t size) {
+    // Let the simulator decide when (and if) the packet is really sent
+    if (simulator != nullptr && simulator->isEnabled() && data != nullptr &&
+        size > 0) {
+        if (!isOpen()) {
+            return false;
+        }
+
+        simulator->sendPacket(destination, data, size);
+        return true;
+    }
+
+    return sendTo(destination, data, size);
+}
+
+bool Socket::sendTo(const Address &destination, const void *data,
+                    size_t size) {
     if (data != nullptr && size > 0) {
         if (!isOpen()) {
             return false;
         }
 
         // Setup destination address structure
-        sockaddr_in destAddr;
-        destAddr.sin_family      = AF_INET;
-        destAddr.sin_addr.s_addr = htonl(destination.getAddress());
-        destAddr.sin_port        = htons(destination.getPort());
+        sockaddr_storage destAddr;
+        socklen_t destLength = 0;
+        memset(&destAddr, 0, sizeof(destAddr));
+
+        if (isIPv6) {
+            sockaddr_in6 *dest6 = (sockaddr_in6 *)&destAddr;
+            dest6->sin6_family  = AF_INET6;
+            dest6->sin6_port    = htons(destination.getPort());
+            destLength          = sizeof(sockaddr_in6);
+
+            if (destination.getType() == AddressType::Enum::IPv4) {
+                // IPv4-mapped IPv6 address, ::ffff:a.b.c.d
+                uint32_t ipv4 = htonl(destination.getAddress());
+                memcpy(dest6->sin6_addr.s6_addr, ipv4MappedPrefix,
+                       sizeof(ipv4MappedPrefix));
+                memcpy(dest6->sin6_addr.s6_addr + 12, &ipv4, sizeof(ipv4));
+            } else {
+                memcpy(dest6->sin6_addr.s6_addr, destination.getIPv6(), 16);
+            }
+        } else if (destination.getType() != AddressType::Enum::IPv6) {
+            sockaddr_in *dest4     = (sockaddr_in *)&destAddr;
+            dest4->sin_family      = AF_INET;
+            dest4->sin_addr.s_addr = htonl(destination.getAddress());
+            dest4->sin_port        = htons(destination.getPort());
+            destLength             = sizeof(sockaddr_in);
+        } else {
+            globals::log(LogArea::Enum::Network, LogLevel::Enum::Error,
+                         "Can't send to IPv6 address from IPv4 socket.");
+            return false;
+        }
 
         // Send data
         int sentBytes = sendto(socket, (const char *)data, size, 0,
-                               (sockaddr *)&destAddr, sizeof(sockaddr_in));
+                               (sockaddr *)&destAddr, destLength);
 
         // Check for errors
         if (sentBytes != size) {
@@ -143,41 +340,107 @@ bool Socket::send(const Address &destination, const void *data, size_t size) {
                          "Failed to send packet.");
             return false;
         }
+
+        if (capture != nullptr) {
+            capture->recordSent(destination, data, size);
+        }
     }
 
     // No errors
     return true;
 }
 
+bool Socket::wait(float timeout) const {
+    if (!isOpen()) {
+        return false;
+    }
+
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(socket, &readable);
+
+    timeval time;
+    time.tv_sec  = (long)timeout;
+    time.tv_usec = (long)((timeout - (long)timeout) * 1000000.0f);
+
+    return select(socket + 1, &readable, nullptr, nullptr, &time) > 0;
+}
+
 size_t Socket::receive(Address &sender, void *buffer, size_t bufferSize) {
     size_t receivedBytes = 0;
 
-#if SV_PLATFORM_WINDOWS
-    typedef int socklen_t;
-#endif
-
     if (buffer != nullptr && bufferSize > 0) {
         // To retrieve where the packet came from
-        sockaddr_in from;
+        sockaddr_storage from;
         socklen_t fromLength = sizeof(from);
+        memset(&from, 0, sizeof(from));
 
         // Retrieve packet
         int bytesRead = recvfrom(socket, (char *)buffer, bufferSize, 0,
                                  (sockaddr *)&from, &fromLength);
 
         // Return address to caller
-        uint32_t fromAddress = ntohl(from.sin_addr.s_addr);
-        uint16_t fromPort    = ntohs(from.sin_port);
-        sender               = Address(fromAddress, fromPort);
+        if (from.ss_family == AF_INET6) {
+            const sockaddr_in6 *from6 = (const sockaddr_in6 *)&from;
+            const uint8_t *bytes      = from6->sin6_addr.s6_addr;
+            uint16_t fromPort         = ntohs(from6->sin6_port);
+
+            if (memcmp(bytes, ipv4MappedPrefix, sizeof(ipv4MappedPrefix)) ==
+                0) {
+                // IPv4 peer of a dual-stack socket
+                uint32_t fromAddress = 0;
+                memcpy(&fromAddress, bytes + 12, sizeof(fromAddress));
+                sender = Address(ntohl(fromAddress), fromPort);
+            } else {
+                sender = Address(from6->sin6_addr.s6_addr, fromPort);
+            }
+        } else {
+            const sockaddr_in *from4 = (const sockaddr_in *)&from;
+            uint32_t fromAddress     = ntohl(from4->sin_addr.s_addr);
+            uint16_t fromPort        = ntohs(from4->sin_port);
+            sender                   = Address(fromAddress, fromPort);
+        }
 
         if (bytesRead <= 0) {
             receivedBytes = 0;
         } else {
             receivedBytes = bytesRead;
+
+            if (capture != nullptr) {
+                capture->recordReceived(sender, buffer, receivedBytes);
+            }
         }
     }
 
     return receivedBytes;
 }
+
+void Socket::setSimulator(NetworkSimulator *simulator_) {
+    simulator = simulator_;
+}
+
+NetworkSimulator *Socket::getSimulator() const { return simulator; }
+
+void Socket::update(float deltaTime) {
+    if (capture != nullptr) {
+        capture->recordUpdate(deltaTime);
+    }
+
+    if (simulator != nullptr) {
+        simulator->update(deltaTime);
+
+        Address destination;
+        while (simulator->getNextPacket(&destination, &simulatedPacket)) {
+            if (isOpen() && !simulatedPacket.empty()) {
+                sendTo(destination, &simulatedPacket[0],
+                       simulatedPacket.size());
+            }
+        }
+    }
+}
+
+void Socket::setCapture(PacketCapture *capture_) { capture = capture_; }
+
+PacketCapture *Socket::getCapture() const { return capture; }
 }
 }
@@ -0,0 +1,114 @@
+#include <cstring>
+
+#include <sv/network/Stream.h>
+
+namespace sv {
+namespace net {
+bool WriteStream::reserve(size_t size) {
+    if (failed == false && (bufferSize - position) < size) {
+        failed = true;
+    }
+
+    return !failed;
+}
+
+void WriteStream::writeUint8(uint8_t value) {
+    if (reserve(1)) {
+        buffer[position++] = value;
+    }
+}
+
+void WriteStream::writeUint16(uint16_t value) {
+    if (reserve(2)) {
+        buffer[position++] = (uint8_t)(value >> 8);
+        buffer[position++] = (uint8_t)(value & 0xFF);
+    }
+}
+
+void WriteStream::writeUint32(uint32_t value) {
+    if (reserve(4)) {
+        buffer[position++] = (uint8_t)(value >> 24);
+        buffer[position++] = (uint8_t)((value >> 16) & 0xFF);
+        buffer[position++] = (uint8_t)((value >> 8) & 0xFF);
+        buffer[position++] = (uint8_t)(value & 0xFF);
+    }
+}
+
+void WriteStream::writeBytes(const void *data, size_t size) {
+    if (size > 0 && reserve(size)) {
+        memcpy(&buffer[position], data, size);
+        position += size;
+    }
+}
+
+size_t WriteStream::getBytesWritten() const { return position; }
+
+bool WriteStream::hasFailed() const { return failed; }
+
+bool ReadStream::consume(size_t size) {
+    if (failed == false && (bufferSize - position) < size) {
+        failed = true;
+    }
+
+    return !failed;
+}
+
+bool ReadStream::readUint8(uint8_t *valueOut) {
+    bool result = false;
+
+    if (consume(1)) {
+        *valueOut = buffer[position++];
+        result    = true;
+    }
+
+    return result;
+}
+
+bool ReadStream::readUint16(uint16_t *valueOut) {
+    bool result = false;
+
+    if (consume(2)) {
+        *valueOut = (uint16_t)((buffer[position] << 8) | buffer[position + 1]);
+        position += 2;
+        result = true;
+    }
+
+    return result;
+}
+
+bool ReadStream::readUint32(uint32_t *valueOut) {
+    bool result = false;
+
+    if (consume(4)) {
+        *valueOut = ((uint32_t)buffer[position] << 24) |
+                    ((uint32_t)buffer[position + 1] << 16) |
+                    ((uint32_t)buffer[position + 2] << 8) |
+                    (uint32_t)buffer[position + 3];
+        position += 4;
+        result = true;
+    }
+
+    return result;
+}
+
+bool ReadStream::readBytes(void *dataOut, size_t size) {
+    bool result = false;
+
+    if (consume(size)) {
+        if (size > 0) {
+            memcpy(dataOut, &buffer[position], size);
+            position += size;
+        }
+        result = true;
+    }
+
+    return result;
+}
+
+size_t ReadStream::getBytesRead() const { return position; }
+
+size_t ReadStream::getBytesRemaining() const { return bufferSize - position; }
+
+bool ReadStream::hasFailed() const { return failed; }
+}
+}
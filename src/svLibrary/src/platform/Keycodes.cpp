@@ -1,6 +1,135 @@
+#include <cctype>
+#include <cstdint>
+
 #include <sv/platform/Keycodes.h>
 
+extern "C" {
+#include <sv/console/CommandTable.h>
+}
+
 namespace sv {
+namespace {
+// Longest keycode name, see 'getKeycodeFromName'
+const size_t MAX_KEYCODE_NAME_LENGTH = 32;
+
+struct KeycodeName {
+    const char *name;
+    Keycodes::Enum keycode;
+};
+
+#define SV_KEYCODE_NAME(keycode) {#keycode, Keycodes::Enum::keycode}
+const KeycodeName KEYCODE_NAMES[] = {
+    SV_KEYCODE_NAME(KEY_BACKSPACE), SV_KEYCODE_NAME(KEY_TAB),
+    SV_KEYCODE_NAME(KEY_RETURN), SV_KEYCODE_NAME(KEY_ESCAPE),
+    SV_KEYCODE_NAME(KEY_SPACEBAR), SV_KEYCODE_NAME(KEY_EXCLAMATION),
+    SV_KEYCODE_NAME(KEY_DBLQUOTE), SV_KEYCODE_NAME(KEY_HASH),
+    SV_KEYCODE_NAME(KEY_DOLLAR), SV_KEYCODE_NAME(KEY_PERCENT),
+    SV_KEYCODE_NAME(KEY_AMPERSAND), SV_KEYCODE_NAME(KEY_QUOTE),
+    SV_KEYCODE_NAME(KEY_LEFTPAREN), SV_KEYCODE_NAME(KEY_RIGHTPAREN),
+    SV_KEYCODE_NAME(KEY_ASTERISK), SV_KEYCODE_NAME(KEY_PLUS),
+    SV_KEYCODE_NAME(KEY_COMMA), SV_KEYCODE_NAME(KEY_MINUS),
+    SV_KEYCODE_NAME(KEY_PERIOD), SV_KEYCODE_NAME(KEY_SLASH),
+    SV_KEYCODE_NAME(KEY_0), SV_KEYCODE_NAME(KEY_1), SV_KEYCODE_NAME(KEY_2),
+    SV_KEYCODE_NAME(KEY_3), SV_KEYCODE_NAME(KEY_4), SV_KEYCODE_NAME(KEY_5),
+    SV_KEYCODE_NAME(KEY_6), SV_KEYCODE_NAME(KEY_7), SV_KEYCODE_NAME(KEY_8),
+    SV_KEYCODE_NAME(KEY_9), SV_KEYCODE_NAME(KEY_COLON),
+    SV_KEYCODE_NAME(KEY_SEMICOLON), SV_KEYCODE_NAME(KEY_LESS),
+    SV_KEYCODE_NAME(KEY_GREATER), SV_KEYCODE_NAME(KEY_QUESTION),
+    SV_KEYCODE_NAME(KEY_AT), SV_KEYCODE_NAME(KEY_LEFTBRACKET),
+    SV_KEYCODE_NAME(KEY_RIGHTBRACKET), SV_KEYCODE_NAME(KEY_CARET),
+    SV_KEYCODE_NAME(KEY_UNDERSCORE), SV_KEYCODE_NAME(KEY_BACKQUOTE),
+    SV_KEYCODE_NAME(KEY_A), SV_KEYCODE_NAME(KEY_B), SV_KEYCODE_NAME(KEY_C),
+    SV_KEYCODE_NAME(KEY_D), SV_KEYCODE_NAME(KEY_E), SV_KEYCODE_NAME(KEY_F),
+    SV_KEYCODE_NAME(KEY_G), SV_KEYCODE_NAME(KEY_H), SV_KEYCODE_NAME(KEY_I),
+    SV_KEYCODE_NAME(KEY_J), SV_KEYCODE_NAME(KEY_K), SV_KEYCODE_NAME(KEY_L),
+    SV_KEYCODE_NAME(KEY_M), SV_KEYCODE_NAME(KEY_N), SV_KEYCODE_NAME(KEY_O),
+    SV_KEYCODE_NAME(KEY_P), SV_KEYCODE_NAME(KEY_Q), SV_KEYCODE_NAME(KEY_R),
+    SV_KEYCODE_NAME(KEY_S), SV_KEYCODE_NAME(KEY_T), SV_KEYCODE_NAME(KEY_U),
+    SV_KEYCODE_NAME(KEY_V), SV_KEYCODE_NAME(KEY_W), SV_KEYCODE_NAME(KEY_X),
+    SV_KEYCODE_NAME(KEY_Y), SV_KEYCODE_NAME(KEY_Z),
+    SV_KEYCODE_NAME(KEY_DELETE), SV_KEYCODE_NAME(KEY_CAPSLOCK),
+    SV_KEYCODE_NAME(KEY_F1), SV_KEYCODE_NAME(KEY_F2), SV_KEYCODE_NAME(KEY_F3),
+    SV_KEYCODE_NAME(KEY_F4), SV_KEYCODE_NAME(KEY_F5), SV_KEYCODE_NAME(KEY_F6),
+    SV_KEYCODE_NAME(KEY_F7), SV_KEYCODE_NAME(KEY_F8), SV_KEYCODE_NAME(KEY_F9),
+    SV_KEYCODE_NAME(KEY_F10), SV_KEYCODE_NAME(KEY_F11),
+    SV_KEYCODE_NAME(KEY_F12), SV_KEYCODE_NAME(KEY_PRINTSCREEN),
+    SV_KEYCODE_NAME(KEY_SCROLLLOCK), SV_KEYCODE_NAME(KEY_PAUSE),
+    SV_KEYCODE_NAME(KEY_INSERT), SV_KEYCODE_NAME(KEY_HOME),
+    SV_KEYCODE_NAME(KEY_PAGEUP), SV_KEYCODE_NAME(KEY_END),
+    SV_KEYCODE_NAME(KEY_PAGEDOWN), SV_KEYCODE_NAME(KEY_RIGHTARROW),
+    SV_KEYCODE_NAME(KEY_LEFTARROW), SV_KEYCODE_NAME(KEY_DOWNARROW),
+    SV_KEYCODE_NAME(KEY_UPARROW), SV_KEYCODE_NAME(KEY_LEFTCTRL),
+    SV_KEYCODE_NAME(KEY_LEFTSHIFT), SV_KEYCODE_NAME(KEY_LEFTALT),
+    SV_KEYCODE_NAME(KEY_LEFTGUI), SV_KEYCODE_NAME(KEY_RIGHTCTRL),
+    SV_KEYCODE_NAME(KEY_RIGHTSHIFT), SV_KEYCODE_NAME(KEY_RIGHTALT),
+    SV_KEYCODE_NAME(KEY_MOUSE1), SV_KEYCODE_NAME(KEY_MOUSE2),
+    SV_KEYCODE_NAME(KEY_MOUSE3), SV_KEYCODE_NAME(KEY_MOUSE4),
+    SV_KEYCODE_NAME(KEY_MOUSE5), SV_KEYCODE_NAME(KEY_MWHEELDOWN),
+    SV_KEYCODE_NAME(KEY_MWHEELUP),
+};
+#undef SV_KEYCODE_NAME
+
+// Keycode of each name and name of each keycode index, built on first use
+struct KeycodeNameTables {
+    KeycodeNameTables() : byIndex() {
+        svCommandTableInit(&byName);
+        for (const KeycodeName &keycodeName : KEYCODE_NAMES) {
+            svCommandTableInsert(&byName, keycodeName.name,
+                                 (int)keycodeName.keycode);
+            byIndex[getKeycodeIndex(keycodeName.keycode)] = keycodeName.name;
+        }
+    }
+    ~KeycodeNameTables() { svCommandTableFree(&byName); }
+
+    svCommandTable byName;
+    const char *byIndex[NUM_KEYCODE_INDICES];
+};
+
+const KeycodeNameTables &getKeycodeNameTables() {
+    static const KeycodeNameTables tables;
+    return tables;
+}
+}
+
+int getKeycodeIndex(Keycodes::Enum keycode) {
+    // Keys other than ASCII are 0x40000000 or'd with a value below 256
+    const uint32_t code = (uint32_t)keycode;
+    if (code < 128) {
+        return (int)code;
+    } else if ((code & ~0xFFu) == 0x40000000u) {
+        return 128 + (int)(code & 0xFFu);
+    }
+
+    return -1;
+}
+
+bool getKeycodeFromName(const std::string &name, Keycodes::Enum *keycodeOut) {
+    if (name.size() > MAX_KEYCODE_NAME_LENGTH) {
+        return false;
+    }
+
+    char upper[MAX_KEYCODE_NAME_LENGTH + 1];
+    for (size_t i = 0; i < name.size(); ++i) {
+        upper[i] = (char)std::toupper((unsigned char)name[i]);
+    }
+    upper[name.size()] = '\0';
+
+    const int keycode =
+        svCommandTableFind(&getKeycodeNameTables().byName, upper);
+    if (keycode < 0) {
+        return false;
+    }
+
+    *keycodeOut = (Keycodes::Enum)keycode;
+    return true;
+}
+
+const char *getKeycodeName(Keycodes::Enum keycode) {
+    const int index = getKeycodeIndex(keycode);
+
+    return (index >= 0) ? getKeycodeNameTables().byIndex[index] : nullptr;
+}
+
 std::string getKeycodeString(Keycodes::Enum keycode) {
     std::string str = "UNKNOWN KEY";
 
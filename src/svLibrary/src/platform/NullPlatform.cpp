@@ -0,0 +1,83 @@
+#include <sv/platform/NullPlatform.h>
+
+namespace sv {
+ScriptedEventSource::ScriptedEventSource() : nextEvent(0) {}
+
+void ScriptedEventSource::addEvent(const PlatformEvent &event) {
+    ScriptedEvent scripted;
+    scripted.event = event;
+    events.push_back(scripted);
+}
+
+void ScriptedEventSource::addTextEvent(uint32_t time,
+                                       const std::string &text) {
+    ScriptedEvent scripted;
+    scripted.event.time = time;
+    scripted.event.type = PlatformEventType::TextInput;
+    scripted.text       = text;
+    events.push_back(scripted);
+}
+
+size_t ScriptedEventSource::getNumRemainingEvents() const {
+    return events.size() - nextEvent;
+}
+
+void ScriptedEventSource::pumpEvents(Platform &platform,
+                                     uint32_t milliseconds) {
+    while (nextEvent < events.size() &&
+           events[nextEvent].event.time <= milliseconds) {
+        const ScriptedEvent &scripted = events[nextEvent];
+
+        bool queued   = false;
+        bool canQueue = true;
+        if (scripted.event.type == PlatformEventType::TextInput) {
+            queued   = platform.queueTextEvent(scripted.event.time,
+                                               scripted.text.data(),
+                                               scripted.text.size());
+            // Won't fit even in an empty arena, dropped (and counted) once
+            canQueue = scripted.text.size() <= PLATFORM_TEXT_ARENA_SIZE;
+        } else {
+            queued = platform.queueEvent(scripted.event);
+        }
+
+        // Leave the rest for when the queue has been emptied
+        if (!queued && canQueue) {
+            break;
+        }
+        ++nextEvent;
+    }
+}
+
+NullPlatform::NullPlatform()
+    : startTime(Clock::now()), textInputActive(false) {}
+
+bool NullPlatform::initialize() {
+    startTime       = Clock::now();
+    textInputActive = false;
+
+    return true;
+}
+
+void NullPlatform::shutdown() {}
+
+uint32_t NullPlatform::getMilliseconds() const {
+    return (uint32_t)((Clock::now() - startTime) / 1000000);
+}
+
+void NullPlatform::startTextInput() { textInputActive = true; }
+
+void NullPlatform::stopTextInput() { textInputActive = false; }
+
+bool NullPlatform::isTextInputActive() const { return textInputActive; }
+
+void NullPlatform::setEventSource(
+    const std::shared_ptr<PlatformEventSource> &source) {
+    eventSource = source;
+}
+
+void NullPlatform::pumpEvents() {
+    if (eventSource != nullptr) {
+        eventSource->pumpEvents(*this, getMilliseconds());
+    }
+}
+}
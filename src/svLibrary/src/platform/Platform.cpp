@@ -1,9 +1,75 @@
 #include <cassert>
+#include <cstring>
 
 #include <sv/platform/Platform.h>
 
 namespace sv {
-void Platform::queueEvent(const PlatformEvent &event) { queue.push(event); }
+Platform::Platform()
+    : eventHead(0), numEvents(0), numDroppedEvents(0), textArenaSize(0) {}
+
+TimePoint Platform::getTime() const { return Clock::now(); }
+
+bool Platform::getNextEvent(PlatformEvent *event) {
+    return (event != nullptr && pollEvents(event, 1) == 1);
+}
+
+size_t Platform::pollEvents(PlatformEvent *eventsOut, size_t maxEvents) {
+    if (numEvents == 0) {
+        // Text of events already polled is no longer needed
+        eventHead     = 0;
+        textArenaSize = 0;
+        pumpEvents();
+    }
+
+    size_t numPolled = 0;
+    while (numPolled < maxEvents && numEvents > 0) {
+        eventsOut[numPolled] = events[eventHead];
+        eventHead            = (eventHead + 1) % PLATFORM_EVENT_QUEUE_SIZE;
+        --numEvents;
+        ++numPolled;
+    }
+
+    return numPolled;
+}
+
+bool Platform::queueEvent(const PlatformEvent &event) {
+    if (numEvents == PLATFORM_EVENT_QUEUE_SIZE) {
+        ++numDroppedEvents;
+        return false;
+    }
+
+    events[(eventHead + numEvents) % PLATFORM_EVENT_QUEUE_SIZE] = event;
+    ++numEvents;
+
+    return true;
+}
+
+bool Platform::queueTextEvent(uint32_t time, const char *text,
+                              size_t textLength) {
+    if (numEvents == PLATFORM_EVENT_QUEUE_SIZE ||
+        textLength > PLATFORM_TEXT_ARENA_SIZE - textArenaSize) {
+        ++numDroppedEvents;
+        return false;
+    }
+
+    char *textCopy = textArena + textArenaSize;
+    memcpy(textCopy, text, textLength);
+    textArenaSize += textLength;
+
+    PlatformEvent event;
+    event.time       = time;
+    event.type       = PlatformEventType::TextInput;
+    event.text       = textCopy;
+    event.textLength = (uint32_t)textLength;
+
+    return queueEvent(event);
+}
+
+size_t Platform::getNumDroppedEvents() const { return numDroppedEvents; }
+
+size_t Platform::getNumFreeEvents() const {
+    return PLATFORM_EVENT_QUEUE_SIZE - numEvents;
+}
 
 // Platform &Platform::getSingleton() {
 //     assert(singleton);
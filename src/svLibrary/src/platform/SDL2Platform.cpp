@@ -33,130 +33,107 @@ void SDL2Platform::shutdown() { SDL_Quit(); }
 
 uint32_t SDL2Platform::getMilliseconds() const { return SDL_GetTicks(); }
 
-bool SDL2Platform::getNextEvent(PlatformEvent *event) {
-    bool result = false;
-
-    if (event != nullptr) {
-        SDL_Event sdlEvent;
-
-        while (SDL_PollEvent(&sdlEvent) != 0) {
-            // There was an event
-            result = true;
-
-            switch (sdlEvent.type) {
-            case SDL_KEYDOWN: {
-                PlatformEvent keyDownEvent;
-
-                keyDownEvent.time = sdlEvent.key.timestamp;
-                keyDownEvent.type = PlatformEventType::Key;
-                keyDownEvent.value1 =
-                    convertSDL2KeyToPlatformKey(sdlEvent.key.keysym.sym);
-                keyDownEvent.value2 = 1;
-
-                queueEvent(keyDownEvent);
-                break;
-            }
-            case SDL_KEYUP: {
-                PlatformEvent keyUpEvent;
-
-                keyUpEvent.time = sdlEvent.key.timestamp;
-                keyUpEvent.type = PlatformEventType::Key;
-                keyUpEvent.value1 =
-                    convertSDL2KeyToPlatformKey(sdlEvent.key.keysym.sym);
-                keyUpEvent.value2 = 0;
-
-                queueEvent(keyUpEvent);
-                break;
-            }
-            case SDL_MOUSEBUTTONDOWN: {
-                PlatformEvent mouseButtonDownEvent;
-
-                mouseButtonDownEvent.time = sdlEvent.button.timestamp;
-                mouseButtonDownEvent.type = PlatformEventType::Key;
-                mouseButtonDownEvent.value1 =
-                    convertSDL2MouseButtonToPlatformKey(sdlEvent.button.button);
-                mouseButtonDownEvent.value2 = 1;
-
-                queueEvent(mouseButtonDownEvent);
-                break;
-            }
-            case SDL_MOUSEBUTTONUP: {
-                PlatformEvent mouseButtonUpEvent;
-
-                mouseButtonUpEvent.time = sdlEvent.button.timestamp;
-                mouseButtonUpEvent.type = PlatformEventType::Key;
-                mouseButtonUpEvent.value1 =
-                    convertSDL2MouseButtonToPlatformKey(sdlEvent.button.button);
-                mouseButtonUpEvent.value2 = 0;
-
-                queueEvent(mouseButtonUpEvent);
-                break;
-            }
-            case SDL_MOUSEWHEEL: {
-                PlatformEvent mouseWheelEvent;
-
-                mouseWheelEvent.time   = sdlEvent.wheel.timestamp;
-                mouseWheelEvent.type   = PlatformEventType::Key;
-                mouseWheelEvent.value1 = sdlEvent.wheel.y > 0
-                                             ? Keycodes::Enum::KEY_MWHEELDOWN
-                                             : Keycodes::Enum::KEY_MWHEELUP;
-                mouseWheelEvent.value2 = 1;
-
-                queueEvent(mouseWheelEvent);
-
-                // Queue 'stop' mouseWheelEvent
-                mouseWheelEvent.value2 = 0;
-
-                queueEvent(mouseWheelEvent);
-                break;
-            }
-            case SDL_MOUSEMOTION: {
-                PlatformEvent mouseMotionEvent;
-
-                mouseMotionEvent.time   = sdlEvent.motion.timestamp;
-                mouseMotionEvent.type   = PlatformEventType::Mouse;
-                mouseMotionEvent.value1 = sdlEvent.motion.xrel;
-                mouseMotionEvent.value2 = sdlEvent.motion.yrel;
-
-                queueEvent(mouseMotionEvent);
-                break;
-            }
-            case SDL_TEXTINPUT: {
-                PlatformEvent textInputEvent;
-
-                textInputEvent.time = sdlEvent.text.timestamp;
-                textInputEvent.type = PlatformEventType::TextInput;
-                size_t len          = strlen(sdlEvent.text.text);
-                textInputEvent.data =
-                    std::shared_ptr<std::vector<char>>(new std::vector<char>(
-                        sdlEvent.text.text, sdlEvent.text.text + len));
-
-                queueEvent(textInputEvent);
-                break;
-            }
-            case SDL_QUIT: {
-                PlatformEvent quitEvent;
-
-                quitEvent.time = sdlEvent.quit.timestamp;
-                quitEvent.type = PlatformEventType::Quit;
-
-                queueEvent(quitEvent);
-                break;
-            }
-            default: { break; }
-            }
+void SDL2Platform::pumpEvents() {
+    SDL_Event sdlEvent;
+
+    // Leave events in SDL's queue rather than drop them, an event may queue
+    // two (see SDL_MOUSEWHEEL)
+    while (getNumFreeEvents() >= 2 && SDL_PollEvent(&sdlEvent) != 0) {
+        switch (sdlEvent.type) {
+        case SDL_KEYDOWN: {
+            PlatformEvent keyDownEvent;
+
+            keyDownEvent.time = sdlEvent.key.timestamp;
+            keyDownEvent.type = PlatformEventType::Key;
+            keyDownEvent.value1 =
+                convertSDL2KeyToPlatformKey(sdlEvent.key.keysym.sym);
+            keyDownEvent.value2 = 1;
+
+            queueEvent(keyDownEvent);
+            break;
         }
+        case SDL_KEYUP: {
+            PlatformEvent keyUpEvent;
 
-        if (!queue.empty()) {
-            // An event exists in the queue
-            result = true;
+            keyUpEvent.time = sdlEvent.key.timestamp;
+            keyUpEvent.type = PlatformEventType::Key;
+            keyUpEvent.value1 =
+                convertSDL2KeyToPlatformKey(sdlEvent.key.keysym.sym);
+            keyUpEvent.value2 = 0;
 
-            *event = queue.front();
-            queue.pop();
+            queueEvent(keyUpEvent);
+            break;
         }
-    }
+        case SDL_MOUSEBUTTONDOWN: {
+            PlatformEvent mouseButtonDownEvent;
 
-    return result;
+            mouseButtonDownEvent.time = sdlEvent.button.timestamp;
+            mouseButtonDownEvent.type = PlatformEventType::Key;
+            mouseButtonDownEvent.value1 =
+                convertSDL2MouseButtonToPlatformKey(sdlEvent.button.button);
+            mouseButtonDownEvent.value2 = 1;
+
+            queueEvent(mouseButtonDownEvent);
+            break;
+        }
+        case SDL_MOUSEBUTTONUP: {
+            PlatformEvent mouseButtonUpEvent;
+
+            mouseButtonUpEvent.time = sdlEvent.button.timestamp;
+            mouseButtonUpEvent.type = PlatformEventType::Key;
+            mouseButtonUpEvent.value1 =
+                convertSDL2MouseButtonToPlatformKey(sdlEvent.button.button);
+            mouseButtonUpEvent.value2 = 0;
+
+            queueEvent(mouseButtonUpEvent);
+            break;
+        }
+        case SDL_MOUSEWHEEL: {
+            PlatformEvent mouseWheelEvent;
+
+            mouseWheelEvent.time   = sdlEvent.wheel.timestamp;
+            mouseWheelEvent.type   = PlatformEventType::Key;
+            mouseWheelEvent.value1 = sdlEvent.wheel.y > 0
+                                         ? Keycodes::Enum::KEY_MWHEELDOWN
+                                         : Keycodes::Enum::KEY_MWHEELUP;
+            mouseWheelEvent.value2 = 1;
+
+            queueEvent(mouseWheelEvent);
+
+            // Queue 'stop' mouseWheelEvent
+            mouseWheelEvent.value2 = 0;
+
+            queueEvent(mouseWheelEvent);
+            break;
+        }
+        case SDL_MOUSEMOTION: {
+            PlatformEvent mouseMotionEvent;
+
+            mouseMotionEvent.time   = sdlEvent.motion.timestamp;
+            mouseMotionEvent.type   = PlatformEventType::Mouse;
+            mouseMotionEvent.value1 = sdlEvent.motion.xrel;
+            mouseMotionEvent.value2 = sdlEvent.motion.yrel;
+
+            queueEvent(mouseMotionEvent);
+            break;
+        }
+        case SDL_TEXTINPUT: {
+            queueTextEvent(sdlEvent.text.timestamp, sdlEvent.text.text,
+                           strlen(sdlEvent.text.text));
+            break;
+        }
+        case SDL_QUIT: {
+            PlatformEvent quitEvent;
+
+            quitEvent.time = sdlEvent.quit.timestamp;
+            quitEvent.type = PlatformEventType::Quit;
+
+            queueEvent(quitEvent);
+            break;
+        }
+        default: { break; }
+        }
+    }
 }
 
 void SDL2Platform::startTextInput() { SDL_StartTextInput(); }
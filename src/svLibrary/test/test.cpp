@@ -4,23 +4,41 @@ TEST(Test, One) { EXPECT_EQ(1, 1); }
 
 #include "test_client.h"
 #include "test_clientvariables.h"
+#include "test_clock.h"
 #include "test_commands.h"
+#include "test_commandtable.h"
 #include "test_common.h"
 #include "test_console.h"
+#include "test_crypto.h"
 #include "test_datetime.h"
 #include "test_engine.h"
+#include "test_fixedtimestep.h"
+#include "test_fragments.h"
 #include "test_input.h"
+#include "test_inputdispatcher.h"
+#include "test_jobsystem.h"
 #include "test_keycodes.h"
 #include "test_log.h"
+#include "test_networksimulator.h"
+#include "test_nullplatform.h"
+#include "test_outputbuffer.h"
+#include "test_packetcapture.h"
+#include "test_platform.h"
+#include "test_prefixindex.h"
 #include "test_programoptions.h"
+#include "test_rcon.h"
 #include "test_resourcecache.h"
 #include "test_resourcefolderpc.h"
 #include "test_scriptinterface.h"
 #include "test_sdl2platform.h"
+#include "test_sendscheduler.h"
+#include "test_shardedserver.h"
 #include "test_shell.h"
+#include "test_snapshot.h"
 #include "test_tokenizer.h"
 #include "test_sockets.h"
 #include "test_connection.h"
+#include "test_connectionstats.h"
 
 int main(int argc, char **argv) {
     sv::globals::logger =
@@ -7,4 +7,12 @@ TEST(Client, Initialize) {
     sv::Client client;
 
     EXPECT_TRUE(client.initialize(sv::ProgramOptions(0, nullptr)));
+
+    // The network simulator and statistics can be reached from the console
+    sv::Console &console = client.getConsole();
+    EXPECT_TRUE(console.executeString("net_sim latency 100"));
+    EXPECT_TRUE(console.executeString("net_sim"));
+    EXPECT_TRUE(console.getOutputBuffer().find("latency 100ms") !=
+                std::string::npos);
+    EXPECT_TRUE(console.executeString("net_stats"));
 }
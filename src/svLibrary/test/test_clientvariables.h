@@ -1,4 +1,8 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
+#include <string>
 
 #include <sv/ClientVariables.h>
 #include <sv/Precision.h>
@@ -174,3 +178,349 @@ TEST(ClientVariables, SetCmd) {
     EXPECT_TRUE(cvars.getFloatValue("sensitivity", &sensitivity));
     EXPECT_TRUE(sv::floatsAreEqual(100.0f, sensitivity));
 }
+
+// Test that registered variables are read through their handles
+TEST(ClientVariables, Register) {
+    sv::ClientVariables cvars;
+    sv::CVar fov   = cvars.registerInt("fov", 90, 60, 120);
+    sv::CVar gamma = cvars.registerFloat("gamma", 1.5f, 0.5f, 3.0f);
+    sv::CVar name  = cvars.registerString("name", "player");
+    EXPECT_TRUE(fov.isValid());
+    EXPECT_EQ(90, fov.getInt());
+    EXPECT_EQ(90.0f, fov.getFloat());
+    EXPECT_EQ(std::string("90"), fov.getString());
+    EXPECT_EQ(1.5f, gamma.getFloat());
+    EXPECT_EQ(1, gamma.getInt());
+    EXPECT_EQ(std::string("player"), name.getString());
+
+    EXPECT_EQ(&fov.getVariable(), &cvars.find("fov").getVariable());
+    EXPECT_FALSE(cvars.find("missing").isValid());
+
+    // Registering again gives the same variable, unless the type differs
+    EXPECT_EQ(&fov.getVariable(), &cvars.registerInt("fov", 70).getVariable());
+    EXPECT_FALSE(cvars.registerFloat("fov", 70.0f).isValid());
+
+    // Handles stay valid as more variables are added
+    for (int i = 0; i < 1000; ++i) {
+        cvars.registerInt("var" + std::to_string(i), i);
+    }
+    EXPECT_EQ(90, fov.getInt());
+    EXPECT_EQ(999, cvars.find("var999").getInt());
+}
+
+// Test that values are parsed, clamped and rejected when set
+TEST(ClientVariables, SetRegistered) {
+    sv::ClientVariables cvars;
+    sv::CVar fov   = cvars.registerInt("fov", 90, 60, 120);
+    sv::CVar gamma = cvars.registerFloat("gamma", 1.5f, 0.5f, 3.0f);
+
+    EXPECT_TRUE(cvars.set(fov, "100"));
+    EXPECT_EQ(100, fov.getInt());
+    EXPECT_TRUE(cvars.set(fov, "500"));
+    EXPECT_EQ(120, fov.getInt());
+    EXPECT_FALSE(cvars.set(fov, "2.5"));
+    EXPECT_FALSE(cvars.set(fov, "wide"));
+    EXPECT_FALSE(cvars.set(fov, " 100"));
+    EXPECT_EQ(120, fov.getInt());
+    EXPECT_TRUE(cvars.setInt(fov, 10));
+    EXPECT_EQ(60, fov.getInt());
+
+    EXPECT_TRUE(cvars.set(gamma, "2.25"));
+    EXPECT_EQ(2.25f, gamma.getFloat());
+    EXPECT_EQ(std::string("2.25"), gamma.getString());
+    EXPECT_TRUE(cvars.setFloat(gamma, -1.0f));
+    EXPECT_EQ(0.5f, gamma.getFloat());
+    EXPECT_FALSE(cvars.set(gamma, "2.25f"));
+
+    cvars.reset(fov);
+    EXPECT_EQ(90, fov.getInt());
+
+    // The string interface goes through the same checks
+    EXPECT_TRUE(cvars.setStringValue("fov", "110"));
+    EXPECT_EQ(110, fov.getInt());
+    EXPECT_FALSE(cvars.setStringValue("fov", "very"));
+    EXPECT_TRUE(cvars.setFloatValue("gamma", 2.0f));
+    EXPECT_EQ(2.0f, gamma.getFloat());
+    int value = 0;
+    EXPECT_TRUE(cvars.getIntValue("fov", &value));
+    EXPECT_EQ(110, value);
+    float gammaValue = 0.0f;
+    EXPECT_TRUE(cvars.getFloatValue("gamma", &gammaValue));
+    EXPECT_EQ(2.0f, gammaValue);
+
+    sv::CVar version = cvars.registerString(
+        "version", "1.0", sv::ClientVariableFlags::Enum::ReadOnly);
+    EXPECT_FALSE(cvars.set(version, "2.0"));
+    EXPECT_FALSE(cvars.setStringValue("version", "2.0"));
+    EXPECT_EQ(std::string("1.0"), version.getString());
+}
+
+// Test that a value set before a variable is registered is kept
+TEST(ClientVariables, RegisterAfterSet) {
+    sv::ClientVariables cvars;
+    cvars.setStringValue("fov", "100");
+    cvars.setStringValue("gamma", "bright");
+
+    sv::CVar fov   = cvars.registerInt("fov", 90, 60, 120);
+    sv::CVar gamma = cvars.registerFloat("gamma", 1.5f);
+    EXPECT_EQ(100, fov.getInt());
+    EXPECT_TRUE(fov.isDirty());
+    // Not a float, so the default is used
+    EXPECT_EQ(1.5f, gamma.getFloat());
+    EXPECT_FALSE(gamma.isDirty());
+}
+
+// Test that changes mark variables dirty and call their callbacks
+TEST(ClientVariables, Callback) {
+    sv::ClientVariables cvars;
+    sv::CVar fov = cvars.registerInt("fov", 90, 60, 120);
+    EXPECT_FALSE(fov.isDirty());
+
+    int numCalls  = 0;
+    int lastValue = 0;
+    cvars.setCallback(fov, [&](const sv::ClientVariable &variable) {
+        ++numCalls;
+        lastValue = variable.intValue;
+    });
+
+    EXPECT_TRUE(cvars.setInt(fov, 100));
+    EXPECT_EQ(1, numCalls);
+    EXPECT_EQ(100, lastValue);
+    EXPECT_TRUE(fov.isDirty());
+    fov.clearDirty();
+
+    // Setting the same value isn't a change
+    EXPECT_TRUE(cvars.set(fov, "100"));
+    EXPECT_EQ(1, numCalls);
+    EXPECT_FALSE(fov.isDirty());
+
+    // Neither is a rejected value
+    EXPECT_FALSE(cvars.set(fov, "wide"));
+    EXPECT_EQ(1, numCalls);
+    EXPECT_FALSE(fov.isDirty());
+}
+
+// Test that removed variables' slots are reused without moving others
+TEST(ClientVariables, RemoveRegistered) {
+    sv::ClientVariables cvars;
+    sv::CVar fov   = cvars.registerInt("fov", 90);
+    sv::CVar gamma = cvars.registerFloat("gamma", 1.5f);
+
+    cvars.removeVariable("fov");
+    EXPECT_FALSE(cvars.find("fov").isValid());
+    int value = 0;
+    EXPECT_FALSE(cvars.getIntValue("fov", &value));
+
+    // Takes the removed variable's slot, others stay where they were
+    sv::CVar name = cvars.registerString("name", "player");
+    EXPECT_EQ(&fov.getVariable(), &name.getVariable());
+    EXPECT_EQ(std::string("player"), name.getString());
+    EXPECT_EQ(&gamma.getVariable(), &cvars.find("gamma").getVariable());
+    EXPECT_EQ(1.5f, gamma.getFloat());
+}
+
+// Test that the 'set' console command reports values it can't set
+TEST(ClientVariables, SetCmdRejected) {
+    sv::ClientVariables cvars;
+    sv::CVar fov = cvars.registerInt("fov", 90, 60, 120);
+    std::shared_ptr<sv::SetCommand> setCmd(new sv::SetCommand(cvars));
+
+    sv::Console console;
+    console.registerCommand("set", setCmd);
+
+    EXPECT_TRUE(console.executeString("set \"fov\" \"100\""));
+    EXPECT_EQ(100, fov.getInt());
+    EXPECT_FALSE(console.executeString("set \"fov\" \"wide\""));
+    EXPECT_EQ(std::string("Can't set 'fov' to 'wide'.\n"),
+              console.getErrorBuffer());
+    EXPECT_EQ(100, fov.getInt());
+}
+
+// Test that cheat variables only change while cheats are enabled
+TEST(ClientVariables, Cheats) {
+    sv::ClientVariables cvars;
+    sv::CVar noclip = cvars.registerInt("noclip", 0, 0, 1,
+                                        sv::ClientVariableFlags::Enum::Cheat);
+
+    EXPECT_FALSE(cvars.areCheatsEnabled());
+    EXPECT_FALSE(cvars.setInt(noclip, 1));
+    EXPECT_FALSE(cvars.setStringValue("noclip", "1"));
+    EXPECT_EQ(0, noclip.getInt());
+
+    cvars.setCheatsEnabled(true);
+    EXPECT_TRUE(cvars.setInt(noclip, 1));
+    EXPECT_EQ(1, noclip.getInt());
+
+    // Disabling cheats undoes them
+    cvars.setCheatsEnabled(false);
+    EXPECT_EQ(0, noclip.getInt());
+}
+
+// Test that only changed replicated variables are sent
+TEST(ClientVariables, Replicate) {
+    const uint32_t replicated = sv::ClientVariableFlags::Enum::Replicated;
+
+    sv::ClientVariables server;
+    sv::CVar gravity  = server.registerFloat("gravity", 800.0f, 0.0f, 2000.0f,
+                                            replicated);
+    sv::CVar timeLimit = server.registerInt("timelimit", 20, 0, 60, replicated);
+    sv::CVar map       = server.registerString("map", "dm1", replicated);
+    sv::CVar fov       = server.registerInt("fov", 90);
+    EXPECT_EQ(0u, server.getNumQueuedReplicated());
+
+    uint8_t buffer[256];
+    EXPECT_EQ(0u, server.writeReplicated(buffer, sizeof(buffer)));
+
+    server.setFloat(gravity, 400.0f);
+    server.setFloat(gravity, 600.0f);
+    server.set(map, "dm2");
+    server.setInt(fov, 100);
+    // Queued once however often it changes, non-replicated aren't queued
+    EXPECT_EQ(2u, server.getNumQueuedReplicated());
+
+    sv::ClientVariables client;
+    sv::CVar clientGravity = client.registerFloat(
+        "gravity", 800.0f, 0.0f, 2000.0f,
+        replicated | sv::ClientVariableFlags::Enum::ReadOnly);
+    sv::CVar clientMap       = client.registerString("map", "dm1", replicated);
+    sv::CVar clientTimeLimit = client.registerInt("timelimit", 20, 0, 60);
+
+    size_t size = server.writeReplicated(buffer, sizeof(buffer));
+    EXPECT_GT(size, 0u);
+    EXPECT_EQ(0u, server.getNumQueuedReplicated());
+    EXPECT_TRUE(client.readReplicated(buffer, size));
+    // Read-only on the client, but the server decides
+    EXPECT_EQ(600.0f, clientGravity.getFloat());
+    EXPECT_EQ(std::string("dm2"), clientMap.getString());
+    // Received changes aren't sent back
+    EXPECT_EQ(0u, client.getNumQueuedReplicated());
+
+    // Variables that don't fit are sent next time
+    server.queueAllReplicated();
+    EXPECT_EQ(3u, server.getNumQueuedReplicated());
+    // Count, "gravity" "600" and "timelimit" "20"
+    size = server.writeReplicated(buffer, 2 + 13 + 14);
+    EXPECT_GT(size, 0u);
+    EXPECT_EQ(1u, server.getNumQueuedReplicated());
+    EXPECT_TRUE(client.readReplicated(buffer, size));
+    EXPECT_EQ(0u, server.writeReplicated(buffer, 4));
+
+    // "map" is still queued
+    server.setInt(timeLimit, 30);
+    EXPECT_EQ(2u, server.getNumQueuedReplicated());
+
+    // Only variables the client replicates too are set
+    size = server.writeReplicated(buffer, sizeof(buffer));
+    EXPECT_TRUE(client.readReplicated(buffer, size));
+    EXPECT_EQ(20, clientTimeLimit.getInt());
+
+    // Nothing is created from the data either
+    sv::ClientVariables empty;
+    EXPECT_TRUE(empty.readReplicated(buffer, size));
+    std::string value;
+    EXPECT_FALSE(empty.getStringValue("map", &value));
+    EXPECT_FALSE(empty.getStringValue("timelimit", &value));
+
+    // Malformed data
+    EXPECT_FALSE(client.readReplicated(buffer, 1));
+    buffer[0] = 0;
+    buffer[1] = 1;
+    EXPECT_FALSE(client.readReplicated(buffer, 2));
+}
+
+// Test that float values are replicated and archived without losing bits
+TEST(ClientVariables, FloatRoundTrip) {
+    const uint32_t flags = sv::ClientVariableFlags::Enum::Replicated |
+                           sv::ClientVariableFlags::Enum::Archive;
+    const float value = 1.23456789f;
+    const char *path  = "/tmp/sv_test_float_archive.cfg";
+    std::remove(path);
+
+    sv::ClientVariables client;
+    sv::CVar clientScale =
+        client.registerFloat("scale", 1.0f, 0.0f, 10.0f, flags);
+    {
+        sv::ClientVariables server;
+        sv::CVar scale =
+            server.registerFloat("scale", 1.0f, 0.0f, 10.0f, flags);
+        server.setArchiveFile(path, 0.0f);
+        server.setFloat(scale, value);
+
+        uint8_t buffer[64];
+        size_t size = server.writeReplicated(buffer, sizeof(buffer));
+        EXPECT_TRUE(client.readReplicated(buffer, size));
+    }
+    const float replicated = clientScale.getFloat();
+    EXPECT_EQ(0, memcmp(&value, &replicated, sizeof(value)));
+
+    sv::ClientVariables loaded;
+    sv::CVar loadedScale =
+        loaded.registerFloat("scale", 1.0f, 0.0f, 10.0f, flags);
+    std::shared_ptr<sv::SetCommand> setCmd(new sv::SetCommand(loaded));
+    sv::Console console;
+    console.registerCommand("set", setCmd);
+
+    std::ifstream file(path);
+    std::string line;
+    EXPECT_TRUE(std::getline(file, line));
+    EXPECT_TRUE(console.executeString(line.c_str()));
+    const float archived = loadedScale.getFloat();
+    EXPECT_EQ(0, memcmp(&value, &archived, sizeof(value)));
+
+    std::remove(path);
+}
+
+// Test that archived variables are saved in a form 'set' reads back
+TEST(ClientVariables, Archive) {
+    const uint32_t archive = sv::ClientVariableFlags::Enum::Archive;
+    const char *path       = "/tmp/sv_test_archive.cfg";
+    std::remove(path);
+
+    {
+        sv::ClientVariables cvars;
+        sv::CVar sensitivity =
+            cvars.registerFloat("sensitivity", 2.0f, 0.1f, 10.0f, archive);
+        sv::CVar name = cvars.registerString("name", "player", archive);
+        cvars.registerInt("fov", 90);
+        cvars.setArchiveFile(path, 1.0f);
+        EXPECT_FALSE(cvars.isArchiveDirty());
+
+        cvars.setFloat(sensitivity, 3.5f);
+        cvars.set(name, "\"quoted\" player");
+        cvars.setIntValue("fov", 100);
+        EXPECT_TRUE(cvars.isArchiveDirty());
+
+        // Saved once the interval has passed
+        cvars.update(0.5f);
+        EXPECT_FALSE(std::ifstream(path).is_open());
+        cvars.update(0.5f);
+        EXPECT_TRUE(std::ifstream(path).is_open());
+        EXPECT_FALSE(cvars.isArchiveDirty());
+
+        // And when destroyed
+        cvars.setFloat(sensitivity, 4.5f);
+    }
+
+    sv::ClientVariables cvars;
+    std::shared_ptr<sv::SetCommand> setCmd(new sv::SetCommand(cvars));
+    sv::Console console;
+    console.registerCommand("set", setCmd);
+
+    std::ifstream file(path);
+    std::string line;
+    int numLines = 0;
+    while (std::getline(file, line)) {
+        EXPECT_TRUE(console.executeString(line.c_str()));
+        ++numLines;
+    }
+    EXPECT_EQ(2, numLines);
+
+    std::string value;
+    EXPECT_TRUE(cvars.getStringValue("sensitivity", &value));
+    EXPECT_EQ(std::string("4.5"), value);
+    EXPECT_TRUE(cvars.getStringValue("name", &value));
+    EXPECT_EQ(std::string("\"quoted\" player"), value);
+    EXPECT_FALSE(cvars.getStringValue("fov", &value));
+
+    std::remove(path);
+}
@@ -0,0 +1,41 @@
+#include <sv/Clock.h>
+#include <sv/Common.h>
+
+TEST(Clock, Now) {
+    sv::TimePoint first  = sv::Clock::now();
+    sv::TimePoint second = sv::Clock::now();
+    EXPECT_LE(first, second);
+    EXPECT_GE(second - first, 0);
+
+    sv::TimePoint later = first + sv::secondsToNanoseconds(1.5);
+    EXPECT_EQ(1500000000, later - first);
+    EXPECT_DOUBLE_EQ(1.5, sv::nanosecondsToSeconds(later - first));
+    EXPECT_TRUE(first < later);
+    EXPECT_TRUE(later != first);
+}
+
+// Test that sleeping until a deadline doesn't wake up before it
+TEST(Clock, SleepUntil) {
+    for (int i = 0; i < 5; ++i) {
+        sv::TimePoint start    = sv::Clock::now();
+        sv::TimePoint deadline = start + 3000000;
+        sv::sleepUntil(deadline);
+        sv::TimePoint woke = sv::Clock::now();
+
+        EXPECT_GE(woke, deadline);
+        // Only catches hangs, a busy machine may wake us up late
+        EXPECT_LT(woke - deadline, 50000000);
+    }
+
+    // Deadline already passed
+    sv::TimePoint start = sv::Clock::now();
+    sv::sleepUntil(start - 1000000);
+    EXPECT_LT(sv::Clock::now() - start, 50000000);
+}
+
+// Test that fractions of a second are slept too
+TEST(Clock, Sleep) {
+    sv::TimePoint start = sv::Clock::now();
+    sv::sleep(0.02f);
+    EXPECT_GE(sv::Clock::now() - start, 19000000);
+}
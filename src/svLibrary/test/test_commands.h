@@ -149,3 +149,49 @@ TEST(Commands, SimpleExample) {
     svCommandsFreeContents(commands);
     free(commands);
 }
+
+// Ensure separating in place gives views into the token array
+TEST(Commands, SeparateInPlace) {
+    char inputLine[] = "echo \"Hello World\" ; exit";
+    char *token[6];
+    EXPECT_EQ(4, svTokenizerTokenizeInPlace(inputLine, token, 6, NULL));
+
+    svCommand commands[4];
+    EXPECT_EQ(2, svCommandsSeparateInPlace(token, commands, NULL));
+
+    EXPECT_EQ(0, commands[0].first);
+    EXPECT_EQ(1, commands[0].last);
+    EXPECT_TRUE(strcmp(commands[0].sep, SV_SEP_SEQ) == 0);
+    EXPECT_EQ(token, commands[0].argv);
+    EXPECT_TRUE(strcmp(commands[0].argv[0], "echo") == 0);
+    EXPECT_TRUE(strcmp(commands[0].argv[1], "\"Hello World\"") == 0);
+    EXPECT_EQ(NULL, commands[0].argv[2]);
+
+    EXPECT_EQ(3, commands[1].first);
+    EXPECT_EQ(3, commands[1].last);
+    EXPECT_TRUE(strcmp(commands[1].argv[0], "exit") == 0);
+    EXPECT_EQ(NULL, commands[1].argv[1]);
+}
+
+// Ensure separating in place reports the same errors as
+// svCommandsValidateTokenArray
+TEST(Commands, SeparateInPlaceErrors) {
+    char inputLine[] = "echo World ; ; exit";
+    char *token[8];
+    EXPECT_EQ(5, svTokenizerTokenizeInPlace(inputLine, token, 8, NULL));
+
+    svCommand commands[5];
+    svCommandError error;
+    EXPECT_TRUE(svCommandsSeparateInPlace(token, commands, &error) < 0);
+    EXPECT_EQ(-1, error.errorCode);
+    EXPECT_EQ(2, error.tokenPos);
+    // Token array is left untouched
+    EXPECT_TRUE(strcmp(token[2], SV_SEP_SEQ) == 0);
+    EXPECT_TRUE(strcmp(token[3], SV_SEP_SEQ) == 0);
+
+    char firstSeparator[] = "; echo";
+    EXPECT_EQ(2, svTokenizerTokenizeInPlace(firstSeparator, token, 8, NULL));
+    EXPECT_TRUE(svCommandsSeparateInPlace(token, commands, &error) < 0);
+    EXPECT_EQ(-2, error.errorCode);
+    EXPECT_EQ(0, error.tokenPos);
+}
@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+#include <sv/console/CommandTable.h>
+}
+
+// Ensure a zeroed table is empty
+TEST(CommandTable, Empty) {
+    svCommandTable table;
+    memset(&table, 0, sizeof(table));
+
+    EXPECT_TRUE(svCommandTableFind(&table, "echo") < 0);
+    EXPECT_TRUE(svCommandTableRemove(&table, "echo") < 0);
+    svCommandTableFree(&table);
+}
+
+// Ensure names can be inserted, replaced, found and removed
+TEST(CommandTable, InsertFindRemove) {
+    svCommandTable table;
+    svCommandTableInit(&table);
+
+    char name[16];
+    snprintf(name, sizeof(name), "echo");
+    EXPECT_EQ(0, svCommandTableInsert(&table, name, 1));
+    EXPECT_EQ(0, svCommandTableInsert(&table, "exec", 2));
+    // Name is copied
+    name[0] = '\0';
+    EXPECT_EQ(1, svCommandTableFind(&table, "echo"));
+    EXPECT_EQ(2, svCommandTableFind(&table, "exec"));
+    EXPECT_EQ(2, table.count);
+
+    EXPECT_EQ(0, svCommandTableInsert(&table, "echo", 3));
+    EXPECT_EQ(3, svCommandTableFind(&table, "echo"));
+    EXPECT_EQ(2, table.count);
+
+    EXPECT_EQ(3, svCommandTableRemove(&table, "echo"));
+    EXPECT_TRUE(svCommandTableFind(&table, "echo") < 0);
+    EXPECT_TRUE(svCommandTableRemove(&table, "echo") < 0);
+    EXPECT_EQ(2, svCommandTableFind(&table, "exec"));
+
+    svCommandTableFree(&table);
+    EXPECT_TRUE(svCommandTableFind(&table, "exec") < 0);
+}
+
+// Ensure the table grows, and names stay reachable as others are removed
+TEST(CommandTable, ManyNames) {
+    svCommandTable table;
+    svCommandTableInit(&table);
+
+    char name[16];
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(name, sizeof(name), "cmd_%d", i);
+        EXPECT_EQ(0, svCommandTableInsert(&table, name, i));
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        snprintf(name, sizeof(name), "cmd_%d", i);
+        EXPECT_EQ(i, svCommandTableRemove(&table, name));
+    }
+    EXPECT_EQ(500, table.count);
+
+    // Add and remove again and again, reusing removed slots
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(0, svCommandTableInsert(&table, "temporary", i));
+        EXPECT_EQ(i, svCommandTableRemove(&table, "temporary"));
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(name, sizeof(name), "cmd_%d", i);
+        EXPECT_EQ((i % 2 == 0) ? -1 : i, svCommandTableFind(&table, name));
+    }
+    EXPECT_TRUE(table.count * 2 <= table.capacity);
+
+    svCommandTableFree(&table);
+}
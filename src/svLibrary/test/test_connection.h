@@ -1,8 +1,10 @@
 // Modified from code provided by Glenn Fiedler (gafferongames.com)
+#include <cstdio>
 #include <cstring>
 
 #include <sv/Common.h>
 #include <sv/network/Connection.h>
+#include <sv/network/PacketCapture.h>
 
 TEST(Connection, TestJoin) {
     EXPECT_TRUE(sv::net::initializeSockets());
@@ -380,3 +382,342 @@ TEST(Connect, TestRejoin) {
 
     sv::net::shutdownSockets();
 }
+
+// Payloads larger than the maximum packet size are fragmented and reassembled
+TEST(Connection, LargePayload) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const int16_t serverPort = 30000;
+    const int16_t clientPort = 30001;
+    const int32_t protocolId = 0x11112222;
+    const float deltaTime    = 0.001f;
+    const float timeout      = 0.1f;
+
+    sv::net::Connection client(protocolId, timeout);
+    sv::net::Connection server(protocolId, timeout);
+
+    EXPECT_TRUE(client.start(clientPort));
+    EXPECT_TRUE(server.start(serverPort));
+
+    client.connect(sv::net::Address(127, 0, 0, 1, serverPort));
+    server.listen();
+
+    std::vector<uint8_t> payload(20000);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = (uint8_t)(i * 31);
+    }
+    EXPECT_TRUE(payload.size() > client.getMaxPacketSize());
+    EXPECT_TRUE(payload.size() <= client.getMaxPayloadSize());
+
+    // Payloads beyond the fragment limit are refused
+    std::vector<uint8_t> tooLarge(client.getMaxPayloadSize() + 1);
+
+    bool received = false;
+    for (int i = 0; i < 100 && !received; ++i) {
+        uint8_t clientPacket[] = "client to server";
+        client.sendPacket(clientPacket, sizeof(clientPacket));
+
+        // Server only learns the client's address once connected
+        if (server.getState() == sv::net::ConnectionState::Enum::Connected) {
+            EXPECT_FALSE(server.sendPacket(&tooLarge[0], tooLarge.size()));
+            EXPECT_TRUE(server.sendPacket(&payload[0], payload.size()));
+        }
+
+        while (true) {
+            std::vector<uint8_t> packet(payload.size());
+            size_t bytesRead = client.receivePacket(&packet[0], packet.size());
+            if (bytesRead == 0) {
+                break;
+            }
+            EXPECT_EQ(payload.size(), bytesRead);
+            EXPECT_TRUE(packet == payload);
+            received = true;
+        }
+
+        while (true) {
+            uint8_t packet[256];
+            size_t bytesRead = server.receivePacket(packet, sizeof(packet));
+            if (bytesRead == 0) {
+                break;
+            }
+            EXPECT_EQ(sizeof(clientPacket), bytesRead);
+        }
+
+        client.update(deltaTime);
+        server.update(deltaTime);
+
+        sv::sleep(deltaTime);
+    }
+
+    EXPECT_TRUE(received);
+
+    sv::net::shutdownSockets();
+}
+
+namespace secureconnection {
+const int16_t serverPort = 30000;
+const int16_t clientPort = 30001;
+const int32_t protocolId = 0x11112222;
+const float deltaTime    = 0.01f;
+const float timeout      = 1.0f;
+
+// Run a client and server for a while, each sending a small payload per
+// update once connected
+void run(sv::net::Connection &client, sv::net::Connection &server,
+         int numUpdates, int *clientReceived, int *serverReceived) {
+    for (int i = 0; i < numUpdates; ++i) {
+        uint8_t clientPacket[] = "client to server";
+        uint8_t serverPacket[] = "server to client";
+        client.sendPacket(clientPacket, sizeof(clientPacket));
+        server.sendPacket(serverPacket, sizeof(serverPacket));
+
+        uint8_t packet[256];
+        size_t bytesRead = 0;
+        while ((bytesRead = client.receivePacket(packet, sizeof(packet))) > 0) {
+            EXPECT_EQ(0, memcmp(serverPacket, packet, sizeof(serverPacket)));
+            ++*clientReceived;
+        }
+        while ((bytesRead = server.receivePacket(packet, sizeof(packet))) > 0) {
+            EXPECT_EQ(0, memcmp(clientPacket, packet, sizeof(clientPacket)));
+            ++*serverReceived;
+        }
+
+        client.update(deltaTime);
+        server.update(deltaTime);
+    }
+}
+}
+
+TEST(Connection, SecureJoin) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    uint8_t privateKey[sv::net::CRYPTO_KEY_SIZE];
+    sv::net::randomBytes(privateKey, sizeof(privateKey));
+
+    sv::net::ConnectToken token;
+    sv::net::generateConnectToken(privateKey, secureconnection::protocolId, 42,
+                                  sv::net::getTokenTimestamp() + 30, &token);
+
+    sv::net::Connection client(secureconnection::protocolId,
+                               secureconnection::timeout);
+    sv::net::Connection server(secureconnection::protocolId,
+                               secureconnection::timeout);
+    EXPECT_TRUE(client.start(secureconnection::clientPort));
+    EXPECT_TRUE(server.start(secureconnection::serverPort));
+
+    server.setPrivateKey(privateKey);
+    server.listen();
+    client.connect(
+        sv::net::Address(127, 0, 0, 1, secureconnection::serverPort), token);
+    // The session's keys need the server's nonce
+    EXPECT_FALSE(client.isSecure());
+
+    // Nothing can be sent until the server accepts the client
+    uint8_t early[] = "too early";
+    EXPECT_FALSE(client.sendPacket(early, sizeof(early)));
+
+    sv::net::PacketCapture capture;
+    EXPECT_TRUE(capture.open("test_secureconnection.svpc"));
+    client.setCapture(&capture);
+
+    int clientReceived = 0;
+    int serverReceived = 0;
+    secureconnection::run(client, server, 50, &clientReceived,
+                          &serverReceived);
+
+    client.setCapture(nullptr);
+    capture.close();
+
+    EXPECT_EQ(sv::net::ConnectionState::Enum::Connected, client.getState());
+    EXPECT_EQ(sv::net::ConnectionState::Enum::Connected, server.getState());
+    EXPECT_TRUE(client.isSecure());
+    EXPECT_TRUE(server.isSecure());
+    EXPECT_EQ(42, server.getClientId());
+    EXPECT_TRUE(clientReceived > 30);
+    EXPECT_TRUE(serverReceived > 30);
+
+    // Fragmented payloads are encrypted too
+    std::vector<uint8_t> payload(5000);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = (uint8_t)(i * 13);
+    }
+    EXPECT_TRUE(server.sendPacket(&payload[0], payload.size()));
+    bool received = false;
+    for (int i = 0; i < 20 && !received; ++i) {
+        std::vector<uint8_t> packet(payload.size());
+        size_t bytesRead = client.receivePacket(&packet[0], packet.size());
+        if (bytesRead > 0) {
+            EXPECT_EQ(payload.size(), bytesRead);
+            EXPECT_TRUE(packet == payload);
+            received = true;
+        }
+        client.update(secureconnection::deltaTime);
+        server.update(secureconnection::deltaTime);
+        sv::sleep(secureconnection::deltaTime);
+    }
+    EXPECT_TRUE(received);
+
+    // Packets recorded off the wire can't be replayed or altered
+    sv::net::PacketCaptureReader reader;
+    EXPECT_TRUE(reader.open("test_secureconnection.svpc"));
+    std::vector<uint8_t> sent;
+    sv::net::CaptureRecord record;
+    while (reader.readRecord(&record)) {
+        if (record.type == sv::net::CaptureRecordType::Enum::Sent &&
+            record.size > sv::net::CONNECTION_SECURE_OVERHEAD + 13) {
+            sent.assign(record.data, record.data + record.size);
+        }
+    }
+    std::remove("test_secureconnection.svpc");
+    EXPECT_FALSE(sent.empty());
+
+    const sv::net::Address clientAddress(127, 0, 0, 1,
+                                         secureconnection::clientPort);
+    uint8_t buffer[256];
+    EXPECT_EQ(0, server.injectPacket(clientAddress, &sent[0], sent.size(),
+                                     buffer, sizeof(buffer)));
+    sent.back() ^= 1;
+    EXPECT_EQ(0, server.injectPacket(clientAddress, &sent[0], sent.size(),
+                                     buffer, sizeof(buffer)));
+
+    client.stop();
+    server.stop();
+
+    sv::net::shutdownSockets();
+}
+
+// A recorded response can't start another session with the same keys, but a
+// client can connect again with the same token
+TEST(Connection, SecureRejectsReplayedResponse) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    uint8_t privateKey[sv::net::CRYPTO_KEY_SIZE];
+    sv::net::randomBytes(privateKey, sizeof(privateKey));
+
+    sv::net::ConnectToken token;
+    sv::net::generateConnectToken(privateKey, secureconnection::protocolId, 7,
+                                  sv::net::getTokenTimestamp() + 30, &token);
+
+    const sv::net::Address serverAddress(127, 0, 0, 1,
+                                         secureconnection::serverPort);
+    const sv::net::Address clientAddress(127, 0, 0, 1,
+                                         secureconnection::clientPort);
+
+    sv::net::Connection server(secureconnection::protocolId,
+                               secureconnection::timeout);
+    EXPECT_TRUE(server.start(secureconnection::serverPort));
+    server.setPrivateKey(privateKey);
+
+    std::vector<uint8_t> response;
+    for (int session = 0; session < 2; ++session) {
+        sv::net::Connection client(secureconnection::protocolId,
+                                   secureconnection::timeout);
+        EXPECT_TRUE(client.start(secureconnection::clientPort));
+        server.listen();
+        client.connect(serverAddress, token);
+
+        sv::net::PacketCapture capture;
+        EXPECT_TRUE(capture.open("test_secureresponse.svpc"));
+        client.setCapture(&capture);
+
+        int clientReceived = 0;
+        int serverReceived = 0;
+        secureconnection::run(client, server, 30, &clientReceived,
+                              &serverReceived);
+
+        client.setCapture(nullptr);
+        capture.close();
+
+        EXPECT_EQ(sv::net::ConnectionState::Enum::Connected,
+                  server.getState());
+        EXPECT_TRUE(clientReceived > 10);
+        EXPECT_TRUE(serverReceived > 10);
+
+        if (session == 0) {
+            sv::net::PacketCaptureReader reader;
+            EXPECT_TRUE(reader.open("test_secureresponse.svpc"));
+            sv::net::CaptureRecord record;
+            while (reader.readRecord(&record)) {
+                if (record.type == sv::net::CaptureRecordType::Enum::Sent &&
+                    record.size ==
+                        5 + sv::net::CONNECTION_CHALLENGE_TOKEN_SIZE) {
+                    response.assign(record.data, record.data + record.size);
+                }
+            }
+        }
+        std::remove("test_secureresponse.svpc");
+        client.stop();
+    }
+    EXPECT_FALSE(response.empty());
+
+    // Sent again once the server is free, the first session's response is
+    // ignored
+    server.listen();
+    uint8_t buffer[256];
+    EXPECT_EQ(0, server.injectPacket(clientAddress, &response[0],
+                                     response.size(), buffer,
+                                     sizeof(buffer)));
+    EXPECT_EQ(sv::net::ConnectionState::Enum::Listening, server.getState());
+    EXPECT_FALSE(server.isSecure());
+
+    server.stop();
+
+    sv::net::shutdownSockets();
+}
+
+// Clients without a valid connect token can't connect to a secure server, or
+// take over its connection
+TEST(Connection, SecureRejectsUnauthorized) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    uint8_t privateKey[sv::net::CRYPTO_KEY_SIZE];
+    uint8_t otherKey[sv::net::CRYPTO_KEY_SIZE];
+    sv::net::randomBytes(privateKey, sizeof(privateKey));
+    sv::net::randomBytes(otherKey, sizeof(otherKey));
+
+    const uint64_t now = sv::net::getTokenTimestamp();
+    sv::net::ConnectToken expired;
+    sv::net::ConnectToken wrongKey;
+    sv::net::generateConnectToken(privateKey, secureconnection::protocolId, 1,
+                                  now - 1, &expired);
+    sv::net::generateConnectToken(otherKey, secureconnection::protocolId, 1,
+                                  now + 30, &wrongKey);
+
+    const sv::net::Address serverAddress(127, 0, 0, 1,
+                                         secureconnection::serverPort);
+
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        sv::net::Connection client(secureconnection::protocolId,
+                                   secureconnection::timeout);
+        sv::net::Connection server(secureconnection::protocolId,
+                                   secureconnection::timeout);
+        EXPECT_TRUE(client.start(secureconnection::clientPort));
+        EXPECT_TRUE(server.start(secureconnection::serverPort));
+        server.setPrivateKey(privateKey);
+        server.listen();
+
+        if (attempt == 0) {
+            // Knowing the protocol id isn't enough
+            client.connect(serverAddress);
+        } else {
+            client.connect(serverAddress, attempt == 1 ? expired : wrongKey);
+        }
+
+        int clientReceived = 0;
+        int serverReceived = 0;
+        secureconnection::run(client, server, 30, &clientReceived,
+                              &serverReceived);
+
+        EXPECT_EQ(sv::net::ConnectionState::Enum::Listening,
+                  server.getState());
+        EXPECT_NE(sv::net::ConnectionState::Enum::Connected,
+                  client.getState());
+        EXPECT_EQ(0, clientReceived);
+        EXPECT_EQ(0, serverReceived);
+
+        client.stop();
+        server.stop();
+    }
+
+    sv::net::shutdownSockets();
+}
@@ -0,0 +1,237 @@
+#include <memory>
+
+#include <sv/Globals.h>
+#include <sv/console/Console.h>
+#include <sv/console/ConsoleCommands.h>
+#include <sv/network/Connection.h>
+#include <sv/network/ConnectionStats.h>
+#include <sv/network/NetworkSimulator.h>
+
+namespace connectionstats {
+// Run a client and server connection exchanging a packet each per update
+void exchangePackets(sv::net::Connection &client, sv::net::Connection &server,
+                     int numUpdates, float deltaTime) {
+    for (int i = 0; i < numUpdates; ++i) {
+        uint8_t clientPacket[] = "client to server";
+        client.sendPacket(clientPacket, sizeof(clientPacket));
+        uint8_t serverPacket[] = "server to client";
+        server.sendPacket(serverPacket, sizeof(serverPacket));
+
+        uint8_t packet[256];
+        while (client.receivePacket(packet, sizeof(packet)) > 0) {
+        }
+        while (server.receivePacket(packet, sizeof(packet)) > 0) {
+        }
+
+        client.update(deltaTime);
+        server.update(deltaTime);
+    }
+}
+}
+
+TEST(ConnectionStats, SequenceWrapAround) {
+    EXPECT_TRUE(sv::net::isSequenceMoreRecent(1, 0));
+    EXPECT_FALSE(sv::net::isSequenceMoreRecent(0, 1));
+    EXPECT_TRUE(sv::net::isSequenceMoreRecent(0, 65535));
+    EXPECT_FALSE(sv::net::isSequenceMoreRecent(65535, 0));
+    EXPECT_FALSE(sv::net::isSequenceMoreRecent(5, 5));
+}
+
+TEST(ConnectionStats, AckBits) {
+    sv::net::ConnectionStats stats;
+    EXPECT_EQ(0, stats.getAckBits());
+
+    stats.packetReceived(0, 10);
+    stats.packetReceived(1, 10);
+    stats.packetReceived(3, 10);
+    EXPECT_EQ(3, stats.getAck());
+    // Bit n is set if 'ack - n' was received
+    EXPECT_EQ(0xD, stats.getAckBits());
+
+    // Out of order packet fills in the gap, but doesn't change the ack
+    stats.packetReceived(2, 10);
+    EXPECT_EQ(3, stats.getAck());
+    EXPECT_EQ(0xF, stats.getAckBits());
+
+    EXPECT_EQ(4, stats.getStatistics().packetsReceived);
+    EXPECT_EQ(40, stats.getStatistics().bytesReceived);
+}
+
+TEST(ConnectionStats, RoundTripTime) {
+    sv::net::ConnectionStats stats;
+
+    for (int i = 0; i < 50; ++i) {
+        uint16_t sequence = stats.getLocalSequence();
+        stats.packetSent(100);
+        stats.update(0.1f);
+        stats.processAcks(sequence, 1);
+    }
+
+    sv::net::ConnectionStatistics result = stats.getStatistics();
+    EXPECT_NEAR(0.1f, result.rtt, 0.001f);
+    EXPECT_NEAR(0.0f, result.rttJitter, 0.001f);
+    EXPECT_EQ(50, result.packetsSent);
+    EXPECT_EQ(50, result.packetsAcked);
+    EXPECT_EQ(0, result.packetsLost);
+    EXPECT_EQ(0.0f, result.packetLoss);
+
+    // Acking the same packet again has no effect
+    stats.processAcks(49, 1);
+    EXPECT_EQ(50, stats.getStatistics().packetsAcked);
+}
+
+TEST(ConnectionStats, PacketLoss) {
+    sv::net::ConnectionStats stats;
+
+    // Ack every other packet
+    for (int i = 0; i < 100; ++i) {
+        uint16_t sequence = stats.getLocalSequence();
+        stats.packetSent(100);
+        stats.update(0.01f);
+        if (i % 2 == 0) {
+            stats.processAcks(sequence, 1);
+        }
+    }
+
+    // Unacked packets are only lost after the ack timeout
+    EXPECT_TRUE(stats.getStatistics().packetsLost < 50);
+    stats.update(sv::net::CONNECTION_STATS_ACK_TIMEOUT);
+
+    sv::net::ConnectionStatistics result = stats.getStatistics();
+    EXPECT_EQ(50, result.packetsLost);
+    EXPECT_EQ(50, result.packetsAcked);
+    EXPECT_FLOAT_EQ(0.5f, result.packetLoss);
+
+    // A late ack means the packet wasn't lost after all
+    stats.processAcks(99, 1);
+    EXPECT_EQ(49, stats.getStatistics().packetsLost);
+}
+
+TEST(ConnectionStats, Bandwidth) {
+    sv::net::ConnectionStats stats(1.0f);
+
+    // 100 bytes sent and 50 received every 0.1s
+    for (int i = 0; i < 30; ++i) {
+        stats.packetSent(100);
+        stats.packetReceived((uint16_t)i, 50);
+        stats.update(0.1f);
+    }
+
+    sv::net::ConnectionStatistics result = stats.getStatistics();
+    EXPECT_NEAR(1000.0f, result.sentBandwidth, 150.0f);
+    EXPECT_NEAR(500.0f, result.receivedBandwidth, 75.0f);
+    EXPECT_EQ(3000, result.bytesSent);
+
+    // Window slides past old traffic
+    stats.update(2.0f);
+    EXPECT_EQ(0.0f, stats.getStatistics().sentBandwidth);
+}
+
+// Round trip time and loss are measured over a simulated network
+TEST(ConnectionStats, Connection) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const int16_t serverPort = 30000;
+    const int16_t clientPort = 30001;
+    const int32_t protocolId = 0x11112222;
+    const float deltaTime    = 0.01f;
+    const float timeout      = 1.0f;
+
+    sv::net::Connection client(protocolId, timeout);
+    sv::net::Connection server(protocolId, timeout);
+
+    sv::net::NetworkConditions conditions;
+    conditions.latency = 0.05f;
+
+    sv::net::NetworkSimulator clientSimulator(1);
+    clientSimulator.setConditions(conditions);
+    clientSimulator.setEnabled(true);
+    client.setSimulator(&clientSimulator);
+
+    conditions.packetLoss = 0.2f;
+    sv::net::NetworkSimulator serverSimulator(2);
+    serverSimulator.setConditions(conditions);
+    serverSimulator.setEnabled(true);
+    server.setSimulator(&serverSimulator);
+
+    EXPECT_TRUE(client.start(clientPort));
+    EXPECT_TRUE(server.start(serverPort));
+
+    client.connect(sv::net::Address(127, 0, 0, 1, serverPort));
+    server.listen();
+
+    connectionstats::exchangePackets(client, server, 300, deltaTime);
+    EXPECT_EQ(sv::net::ConnectionState::Enum::Connected, client.getState());
+    EXPECT_EQ(sv::net::ConnectionState::Enum::Connected, server.getState());
+
+    sv::net::ConnectionStatistics clientStats = client.getStatistics();
+    sv::net::ConnectionStatistics serverStats = server.getStatistics();
+
+    // 50ms each way, plus up to an update of delay on each end
+    EXPECT_TRUE(clientStats.rtt > 0.09f);
+    EXPECT_TRUE(clientStats.rtt < 0.15f);
+    EXPECT_TRUE(serverStats.rtt > 0.09f);
+    EXPECT_TRUE(serverStats.rtt < 0.15f);
+
+    // Only packets sent by the server are lost
+    EXPECT_TRUE(serverStats.packetLoss > 0.1f);
+    EXPECT_TRUE(serverStats.packetLoss < 0.3f);
+    EXPECT_TRUE(clientStats.packetLoss < 0.05f);
+
+    EXPECT_TRUE(clientStats.packetsSent > 0);
+    EXPECT_TRUE(clientStats.bytesSent > clientStats.packetsSent);
+    EXPECT_TRUE(clientStats.sentBandwidth > 0.0f);
+    EXPECT_TRUE(serverStats.receivedBandwidth > 0.0f);
+
+    client.stop();
+    server.stop();
+
+    sv::net::shutdownSockets();
+}
+
+TEST(ConnectionStats, ConsoleCommandAndLog) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const int16_t serverPort = 30000;
+    const int16_t clientPort = 30001;
+    const int32_t protocolId = 0x11112222;
+    const float deltaTime    = 0.01f;
+    const float timeout      = 1.0f;
+
+    sv::net::Connection client(protocolId, timeout);
+    sv::net::Connection server(protocolId, timeout);
+    EXPECT_TRUE(client.start(clientPort));
+    EXPECT_TRUE(server.start(serverPort));
+    client.connect(sv::net::Address(127, 0, 0, 1, serverPort));
+    server.listen();
+
+    sv::Console console;
+    std::shared_ptr<sv::NetStatsCommand> netStatsCmd(
+        new sv::NetStatsCommand(client));
+    console.registerCommand("net_stats", netStatsCmd);
+
+    EXPECT_TRUE(console.executeString("net_stats log 0.5"));
+    EXPECT_FLOAT_EQ(0.5f, client.getStatsLogInterval());
+    EXPECT_FALSE(console.executeString("net_stats log soon"));
+    EXPECT_FALSE(console.executeString("net_stats verbose 1"));
+
+    std::shared_ptr<sv::BufferLog> observer(new sv::BufferLog(
+        sv::LogArea::Enum::Network, sv::LogLevel::Enum::Event));
+    sv::globals::logger->registerObserver(observer);
+
+    connectionstats::exchangePackets(client, server, 60, deltaTime);
+
+    sv::globals::logger->removeObserver(observer);
+
+    EXPECT_TRUE(observer->buffer.find("Connection stats: rtt") !=
+                std::string::npos);
+
+    EXPECT_TRUE(console.executeString("net_stats"));
+    EXPECT_TRUE(console.getOutputBuffer().find("net_stats: rtt") !=
+                std::string::npos);
+
+    client.stop();
+    server.stop();
+
+    sv::net::shutdownSockets();
+}
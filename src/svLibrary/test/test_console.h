@@ -1,6 +1,11 @@
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include <sv/Common.h>
 #include <sv/console/Console.h>
+#include <sv/console/ConsoleCommands.h>
 
 // Test that the error buffer is populated correctly when input line has string
 // not closed
@@ -209,3 +214,566 @@ TEST(Console, CommandWithNameExists) {
     console.removeCommand("fail");
     EXPECT_FALSE(console.commandWithNameExists("fail"));
 }
+
+namespace sv {
+// Executes its arguments as another line of input
+class NestedCmd : public ConsoleCommand {
+  public:
+    NestedCmd() : called(0) {}
+
+    virtual bool execute(Console &console, int argc, char *argv[]) {
+        ++called;
+
+        std::string line;
+        for (int i = 1; i < argc; ++i) {
+            line += std::string(argv[i]) + " ";
+        }
+
+        return console.executeString(line);
+    }
+
+    int called;
+};
+}
+
+// Test that a command executing more input doesn't disturb the commands left
+// to execute on the line that ran it
+TEST(Console, NestedExecution) {
+    sv::Console console;
+    std::shared_ptr<sv::ExampleConsoleCmd> cmd(new sv::ExampleConsoleCmd);
+    std::shared_ptr<sv::NestedCmd> nestedCmd(new sv::NestedCmd);
+
+    console.registerCommand("test", cmd);
+    console.registerCommand("nested", nestedCmd);
+    EXPECT_TRUE(console.executeString(
+        "nested nested test hello world ; nested test hello world"));
+    EXPECT_EQ(3, nestedCmd->called);
+    EXPECT_TRUE(cmd->called);
+
+    // Executing again reuses the same buffers
+    cmd->called = false;
+    EXPECT_TRUE(console.executeString("  test hello world\n"));
+    EXPECT_TRUE(cmd->called);
+    EXPECT_FALSE(console.executeString("nested nested fake"));
+    EXPECT_TRUE(std::string("No command with name 'fake'.") ==
+                console.getErrorBuffer());
+}
+
+// Test that removing a command leaves the others registered
+TEST(Console, RemoveCommandKeepsOthers) {
+    sv::Console console;
+    std::shared_ptr<sv::FailCmd> cmd(new sv::FailCmd);
+
+    const char *names[] = {"a", "b", "c", "d"};
+    for (int i = 0; i < 4; ++i) {
+        console.registerCommand(names[i], cmd);
+    }
+    console.removeCommand("b");
+    console.removeCommand("a");
+
+    EXPECT_FALSE(console.commandWithNameExists("a"));
+    EXPECT_FALSE(console.commandWithNameExists("b"));
+    EXPECT_TRUE(console.commandWithNameExists("c"));
+    EXPECT_TRUE(console.commandWithNameExists("d"));
+}
+
+// Test that an alias executes its line in place of a command
+TEST(Console, Alias) {
+    sv::Console console;
+    std::shared_ptr<sv::ExampleConsoleCmd> cmd(new sv::ExampleConsoleCmd);
+    std::shared_ptr<sv::FailCmd> failCmd(new sv::FailCmd);
+
+    console.registerCommand("test", cmd);
+    console.registerCommand("fail", failCmd);
+    EXPECT_TRUE(console.registerAlias("greet", "test hello world"));
+    EXPECT_TRUE(console.registerAlias("greet_twice", "greet ; greet"));
+    // Commands can't be aliased
+    EXPECT_FALSE(console.registerAlias("test", "fail"));
+
+    EXPECT_TRUE(console.aliasWithNameExists("greet"));
+    EXPECT_FALSE(console.commandWithNameExists("greet"));
+    std::string line;
+    EXPECT_TRUE(console.getAlias("greet_twice", &line));
+    EXPECT_EQ(std::string("greet ; greet"), line);
+
+    EXPECT_TRUE(console.executeString("greet_twice ; greet"));
+    EXPECT_TRUE(cmd->called);
+
+    // Failing alias stops the line
+    EXPECT_TRUE(console.registerAlias("greet", "fail"));
+    cmd->called = false;
+    EXPECT_FALSE(console.executeString("greet ; test hello world"));
+    EXPECT_FALSE(cmd->called);
+
+    console.removeAlias("greet");
+    EXPECT_FALSE(console.aliasWithNameExists("greet"));
+    EXPECT_FALSE(console.executeString("greet"));
+    EXPECT_TRUE(std::string("No command with name 'greet'.") ==
+                console.getErrorBuffer());
+
+    // A command replaces an alias
+    console.registerCommand("greet_twice", failCmd);
+    EXPECT_FALSE(console.aliasWithNameExists("greet_twice"));
+}
+
+// Test that an alias expanding to itself stops
+TEST(Console, AliasLoop) {
+    sv::Console console;
+    EXPECT_TRUE(console.registerAlias("loop", "loop"));
+
+    EXPECT_FALSE(console.executeString("loop"));
+    EXPECT_TRUE(std::string("Alias 'loop' nested too deeply.") ==
+                console.getErrorBuffer());
+}
+
+namespace sv {
+// Strips quotes from its argument in place, like most commands do
+class StripCmd : public ConsoleCommand {
+  public:
+    virtual bool execute(Console &console, int argc, char *argv[]) {
+        EXPECT_EQ(2, argc);
+        console.appendToOutputBuffer(stripSurroundingQuotes(argv[1]));
+
+        return true;
+    }
+};
+}
+
+// Test that lines executed again aren't parsed again, and that commands
+// changing their arguments don't affect the next execution
+TEST(Console, LineCache) {
+    sv::Console console;
+    std::shared_ptr<sv::StripCmd> cmd(new sv::StripCmd);
+    console.registerCommand("strip", cmd);
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(console.executeString("strip \"Hello World\""));
+        EXPECT_EQ(std::string("Hello World"), console.getOutputBuffer());
+    }
+    EXPECT_EQ(2, console.getNumLineCacheHits());
+
+    // Lines with errors are never cached
+    EXPECT_FALSE(console.executeString("strip ; ;"));
+    EXPECT_FALSE(console.executeString("strip ; ;"));
+    EXPECT_EQ(2, console.getNumLineCacheHits());
+
+    // Old lines are forgotten
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(console.executeString("strip " + std::to_string(i)));
+    }
+    EXPECT_EQ(2, console.getNumLineCacheHits());
+    EXPECT_TRUE(console.executeString("strip 99"));
+    EXPECT_EQ(3, console.getNumLineCacheHits());
+    EXPECT_TRUE(console.executeString("strip \"Hello World\""));
+    EXPECT_EQ(3, console.getNumLineCacheHits());
+}
+
+// Test that buffered commands execute over several frames, within budget
+TEST(Console, CommandBuffer) {
+    sv::Console console;
+    std::shared_ptr<sv::EchoCommand> echoCmd(new sv::EchoCommand);
+    std::shared_ptr<sv::FailCmd> failCmd(new sv::FailCmd);
+    console.registerCommand("echo", echoCmd);
+    console.registerCommand("fail", failCmd);
+
+    EXPECT_TRUE(console.bufferString("echo one ; echo two ; fail"));
+    EXPECT_TRUE(console.bufferString("echo \"three four\""));
+    EXPECT_EQ(4, console.getNumBufferedCommands());
+
+    // Nothing executes until asked
+    EXPECT_TRUE(console.getBufferedResults().empty());
+
+    EXPECT_EQ(2, console.executeBuffered(2, 0.0));
+    EXPECT_EQ(2, console.getNumBufferedCommands());
+    // A failing command doesn't stop the rest
+    EXPECT_EQ(2, console.executeBuffered(0, 0.0));
+    EXPECT_EQ(0, console.getNumBufferedCommands());
+    EXPECT_EQ(0, console.executeBuffered(0, 0.0));
+
+    // Output is collected per command
+    const std::vector<sv::ConsoleCommandResult> &results =
+        console.getBufferedResults();
+    EXPECT_EQ(4, results.size());
+    EXPECT_EQ(std::string("echo one"), results[0].command);
+    EXPECT_TRUE(results[0].succeeded);
+    EXPECT_EQ(std::string("one\n"), results[0].output);
+    EXPECT_EQ(std::string("two\n"), results[1].output);
+    EXPECT_FALSE(results[2].succeeded);
+    EXPECT_EQ(std::string("echo \"three four\""), results[3].command);
+    EXPECT_EQ(std::string("three four\n"), results[3].output);
+    console.clearBufferedResults();
+    EXPECT_TRUE(console.getBufferedResults().empty());
+
+    // Invalid input isn't queued
+    EXPECT_FALSE(console.bufferString("echo one ; ; echo two"));
+    EXPECT_EQ(0, console.getNumBufferedCommands());
+
+    // A time budget still executes one command a frame
+    EXPECT_TRUE(console.bufferString("echo one ; echo two"));
+    EXPECT_EQ(1, console.executeBuffered(0, 1e-12));
+    console.clearBuffer();
+    EXPECT_EQ(0, console.getNumBufferedCommands());
+}
+
+// Test that 'wait' spreads buffered commands over frames
+TEST(Console, CommandBufferWait) {
+    sv::Console console;
+    std::shared_ptr<sv::EchoCommand> echoCmd(new sv::EchoCommand);
+    std::shared_ptr<sv::WaitCommand> waitCmd(new sv::WaitCommand);
+    console.registerCommand("echo", echoCmd);
+    console.registerCommand("wait", waitCmd);
+    EXPECT_TRUE(console.registerAlias("jump", "echo up ; wait ; echo down"));
+
+    EXPECT_TRUE(console.bufferString("echo a ; wait ; echo b ; wait 3 ; jump"));
+
+    // echo a, wait
+    EXPECT_EQ(2, console.executeBuffered(0, 0.0));
+    // echo b, wait 3
+    EXPECT_EQ(2, console.executeBuffered(0, 0.0));
+    EXPECT_EQ(0, console.executeBuffered(0, 0.0));
+    EXPECT_EQ(0, console.executeBuffered(0, 0.0));
+    // jump, echo up, wait
+    EXPECT_EQ(3, console.executeBuffered(0, 0.0));
+    // echo down
+    EXPECT_EQ(1, console.executeBuffered(0, 0.0));
+
+    const std::vector<sv::ConsoleCommandResult> &results =
+        console.getBufferedResults();
+    std::string output;
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_TRUE(results[i].succeeded);
+        output += results[i].output;
+    }
+    EXPECT_EQ(std::string("a\nb\nup\ndown\n"), output);
+
+    EXPECT_FALSE(console.executeString("wait 0"));
+    EXPECT_FALSE(console.executeString("wait soon"));
+    // Not wrapped around to a huge number of frames
+    EXPECT_FALSE(console.executeString("wait -1"));
+    EXPECT_FALSE(console.executeString("wait \"+2\""));
+    EXPECT_FALSE(console.executeString("wait \" 2\""));
+    EXPECT_FALSE(console.executeString("wait 99999999999999999999"));
+    EXPECT_TRUE(console.executeString("wait \"2\""));
+}
+
+// Test that a buffered alias expanding to itself stops, even without a budget
+TEST(Console, CommandBufferAliasLoop) {
+    sv::Console console;
+    std::shared_ptr<sv::EchoCommand> echoCmd(new sv::EchoCommand);
+    console.registerCommand("echo", echoCmd);
+    EXPECT_TRUE(console.registerAlias("loop", "echo again ; loop"));
+
+    EXPECT_TRUE(console.bufferString("loop ; echo after"));
+    const size_t numExecuted = console.executeBuffered(0, 0.0);
+    EXPECT_EQ(0, console.getNumBufferedCommands());
+
+    const std::vector<sv::ConsoleCommandResult> &results =
+        console.getBufferedResults();
+    EXPECT_EQ(numExecuted, results.size());
+    EXPECT_LT(numExecuted, 100u);
+    EXPECT_EQ(std::string("Alias 'loop' nested too deeply."),
+              results[results.size() - 2].error);
+    EXPECT_FALSE(results[results.size() - 2].succeeded);
+    // Commands queued after it still execute
+    EXPECT_EQ(std::string("after\n"), results.back().output);
+}
+
+namespace sv {
+// Queues more commands, as 'exec' does from the command buffer
+class InsertCmd : public ConsoleCommand {
+  public:
+    virtual bool execute(Console &console, int argc, char *argv[]) {
+        EXPECT_TRUE(console.isExecutingBuffer());
+        return console.insertString("echo inserted ; wait");
+    }
+};
+}
+
+// Test that inserted commands execute before commands already buffered
+TEST(Console, CommandBufferInsert) {
+    sv::Console console;
+    std::shared_ptr<sv::EchoCommand> echoCmd(new sv::EchoCommand);
+    std::shared_ptr<sv::WaitCommand> waitCmd(new sv::WaitCommand);
+    std::shared_ptr<sv::InsertCmd> insertCmd(new sv::InsertCmd);
+    console.registerCommand("echo", echoCmd);
+    console.registerCommand("wait", waitCmd);
+    console.registerCommand("insert", insertCmd);
+
+    EXPECT_FALSE(console.isExecutingBuffer());
+    EXPECT_TRUE(console.bufferString("insert ; echo last"));
+    EXPECT_EQ(3, console.executeBuffered(0, 0.0));
+    EXPECT_EQ(1, console.executeBuffered(0, 0.0));
+
+    const std::vector<sv::ConsoleCommandResult> &results =
+        console.getBufferedResults();
+    EXPECT_EQ(4, results.size());
+    EXPECT_EQ(std::string("inserted\n"), results[1].output);
+    EXPECT_EQ(std::string("last\n"), results[3].output);
+}
+
+namespace sv {
+// Counts how many times it is executed
+class CountCmd : public ConsoleCommand {
+  public:
+    CountCmd() : count(0) {}
+
+    virtual bool execute(Console &console, int argc, char *argv[]) {
+        ++count;
+        console.appendToOutputBuffer(argv[argc - 1]);
+
+        return true;
+    }
+
+    int count;
+};
+}
+
+// Test that input submitted from several threads executes on the owning
+// thread, with each submission getting its own output
+TEST(Console, Submit) {
+    sv::Console console;
+    std::shared_ptr<sv::CountCmd> cmd(new sv::CountCmd);
+    console.registerCommand("count", cmd);
+
+    const int numThreads       = 4;
+    const int submitsPerThread = 500;
+    std::vector<std::future<sv::ConsoleCommandResult>>
+        futures[numThreads];
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.push_back(std::thread([&console, &futures, t]() {
+            for (int i = 0; i < submitsPerThread; ++i) {
+                futures[t].push_back(console.submit(
+                    "count " + std::to_string(t * submitsPerThread + i)));
+            }
+        }));
+    }
+
+    // Drain while threads are submitting, the owning thread's output stays
+    console.appendToOutputBuffer("mine");
+    size_t numExecuted = 0;
+    while (numExecuted < numThreads * submitsPerThread) {
+        numExecuted += console.executeSubmitted();
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    EXPECT_EQ(0, console.executeSubmitted());
+    EXPECT_EQ(numThreads * submitsPerThread, cmd->count);
+    EXPECT_EQ(std::string("mine"), console.getOutputBuffer());
+
+    for (int t = 0; t < numThreads; ++t) {
+        for (int i = 0; i < submitsPerThread; ++i) {
+            sv::ConsoleCommandResult result = futures[t][i].get();
+            EXPECT_TRUE(result.succeeded);
+            EXPECT_EQ(std::to_string(t * submitsPerThread + i), result.output);
+        }
+    }
+
+    // Errors go to the submission's result
+    std::future<sv::ConsoleCommandResult> bad = console.submit("nothing");
+    EXPECT_EQ(1, console.executeSubmitted());
+    sv::ConsoleCommandResult result = bad.get();
+    EXPECT_FALSE(result.succeeded);
+    EXPECT_EQ(std::string("No command with name 'nothing'."), result.error);
+}
+
+// Test that submissions left when the console is destroyed still complete
+TEST(Console, SubmitUnexecuted) {
+    std::future<sv::ConsoleCommandResult> result;
+    {
+        sv::Console console;
+        result = console.submit("echo never");
+    }
+
+    EXPECT_FALSE(result.get().succeeded);
+}
+
+namespace sv {
+class ListCmd : public ConsoleCommand {
+  public:
+    bool execute(Console &console, int argc, char *argv[]) {
+        for (int i = 0; i < 1000; ++i) {
+            console.printToOutputBuffer("resource %d\n", i);
+        }
+        console.printToErrorBuffer("%d missing", 2);
+
+        return true;
+    }
+};
+}
+
+// Test that long output is kept whole, capped, streamed and drained
+TEST(Console, LongOutput) {
+    sv::Console console;
+    console.registerCommand("list", std::make_shared<sv::ListCmd>());
+
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        expected += "resource " + std::to_string(i) + "\n";
+    }
+
+    EXPECT_TRUE(console.executeString("list"));
+    EXPECT_EQ(expected, console.getOutputBuffer());
+    EXPECT_EQ(std::string("2 missing"), console.getErrorBuffer());
+    EXPECT_EQ(0u, console.getNumDroppedOutput());
+
+    std::string drained;
+    console.drainOutputBuffer(
+        [](void *userData, const char *data, size_t size) {
+            ((std::string *)userData)->append(data, size);
+        },
+        &drained);
+    EXPECT_EQ(expected, drained);
+    EXPECT_EQ(std::string(""), console.getOutputBuffer());
+
+    console.setOutputBufferMaxSize(10);
+    EXPECT_TRUE(console.executeString("list"));
+    EXPECT_EQ(std::string("resource 0"), console.getOutputBuffer());
+    EXPECT_EQ(expected.size() - 10, console.getNumDroppedOutput());
+    console.setOutputBufferMaxSize(0);
+
+    std::string streamed;
+    console.setOutputCallback(
+        [](void *userData, const char *data, size_t size) {
+            ((std::string *)userData)->append(data, size);
+        },
+        &streamed);
+    EXPECT_TRUE(console.executeString("list"));
+    console.setOutputCallback(nullptr, nullptr);
+    EXPECT_EQ(expected, streamed);
+    EXPECT_EQ(std::string(""), console.getOutputBuffer());
+    EXPECT_EQ(std::string("2 missing"), console.getErrorBuffer());
+}
+
+// Test that commands, aliases and variables are found by prefix and pattern
+TEST(Console, Complete) {
+    sv::Console console;
+    std::shared_ptr<sv::EchoCommand> echoCmd(new sv::EchoCommand());
+    std::shared_ptr<sv::FindCommand> findCmd(new sv::FindCommand());
+    console.registerCommand("echo", echoCmd);
+    console.registerCommand("find", findCmd);
+    console.registerCommand("net_stats", echoCmd);
+    console.registerAlias("net_reset", "echo reset");
+
+    sv::ClientVariables cvars;
+    cvars.registerInt("net_rate", 25000);
+    cvars.setNameIndex(console.getNameIndex());
+    cvars.setStringValue("net_sim_latency", "100");
+
+    std::vector<sv::ConsoleCompletion> matches;
+    console.complete("net_", 10, &matches);
+    ASSERT_EQ(4u, matches.size());
+    EXPECT_EQ(std::string("net_rate"), matches[0].name);
+    EXPECT_EQ((uint32_t)sv::ConsoleNameKind::Enum::Variable,
+              matches[0].kinds);
+    EXPECT_EQ(std::string("net_reset"), matches[1].name);
+    EXPECT_EQ((uint32_t)sv::ConsoleNameKind::Enum::Alias, matches[1].kinds);
+    EXPECT_EQ(std::string("net_sim_latency"), matches[2].name);
+    EXPECT_EQ(std::string("net_stats"), matches[3].name);
+    EXPECT_EQ((uint32_t)sv::ConsoleNameKind::Enum::Command, matches[3].kinds);
+
+    console.complete("net_", 10, &matches,
+                     sv::ConsoleNameKind::Enum::Command |
+                         sv::ConsoleNameKind::Enum::Alias);
+    EXPECT_EQ(2u, matches.size());
+
+    EXPECT_EQ(std::string("net_"), console.getCommonPrefix("n"));
+    EXPECT_EQ(std::string("net_sim_latency"),
+              console.getCommonPrefix("net_si"));
+    EXPECT_EQ(std::string("xyz"), console.getCommonPrefix("xyz"));
+
+    // Removed names are no longer found
+    console.removeAlias("net_reset");
+    cvars.removeVariable("net_rate");
+    console.search("nrt", 10, &matches);
+    EXPECT_EQ(0u, matches.size());
+    console.search("nst", 10, &matches);
+    ASSERT_EQ(2u, matches.size());
+    EXPECT_EQ(std::string("net_stats"), matches[0].name);
+    EXPECT_EQ(std::string("net_sim_latency"), matches[1].name);
+
+    EXPECT_TRUE(console.executeString("find nsl"));
+    EXPECT_EQ(std::string("net_sim_latency (variable)\n"),
+              console.getOutputBuffer());
+
+    cvars.setNameIndex(nullptr);
+    console.complete("net_", 10, &matches);
+    EXPECT_EQ(1u, matches.size());
+}
+
+// Test that compiled lines execute without being parsed, and find their
+// commands again once commands are removed or replaced
+TEST(Console, CompiledLine) {
+    sv::Console console;
+    std::shared_ptr<sv::StripCmd> strip(new sv::StripCmd);
+    std::shared_ptr<sv::CountCmd> count(new sv::CountCmd);
+    console.registerCommand("strip", strip);
+    console.registerCommand("count", count);
+
+    sv::CompiledLine line;
+    EXPECT_FALSE(console.compile("strip ; ;", &line));
+    EXPECT_FALSE(console.getErrorBuffer().empty());
+    EXPECT_EQ(0, line.getNumCommands());
+
+    ASSERT_TRUE(console.compile("strip \"Hello World\" ; count 1", &line));
+    EXPECT_EQ(std::string("strip \"Hello World\" ; count 1"), line.getLine());
+    EXPECT_EQ(2, line.getNumCommands());
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(console.execute(line));
+        EXPECT_EQ(std::string("Hello World1"), console.getOutputBuffer());
+    }
+    EXPECT_EQ(3, count->count);
+    EXPECT_EQ(0, console.getNumLineCacheHits());
+
+    console.removeCommand("strip");
+    EXPECT_FALSE(console.execute(line));
+    EXPECT_EQ(3, count->count);
+
+    console.registerCommand("strip", count);
+    EXPECT_TRUE(console.execute(line));
+    EXPECT_EQ(std::string("\"Hello World\"1"), console.getOutputBuffer());
+    EXPECT_EQ(5, count->count);
+
+    console.removeCommand("strip");
+    EXPECT_TRUE(console.registerAlias("strip", "count 2"));
+    EXPECT_TRUE(console.execute(line));
+    EXPECT_EQ(std::string("21"), console.getOutputBuffer());
+    EXPECT_EQ(7, count->count);
+
+    // Nothing to execute
+    EXPECT_TRUE(console.execute(sv::CompiledLine()));
+}
+
+namespace sv {
+// Counts its arguments into the output buffer
+class CountArgsCmd : public ConsoleCommand {
+  public:
+    virtual bool execute(Console &console, int argc, char *argv[]) {
+        console.printToOutputBuffer("%d ", argc - 1);
+        return true;
+    }
+};
+}
+
+// Test that a line with many commands parses after a cached line with many
+// tokens was restored at the same nesting depth
+TEST(Console, RestoredLineThenManyCommands) {
+    sv::Console console;
+    std::shared_ptr<sv::CountArgsCmd> countCmd(new sv::CountArgsCmd);
+    console.registerCommand("count", countCmd);
+
+    std::string longLine = "count";
+    for (int i = 0; i < 40; ++i) {
+        longLine += " " + std::to_string(i);
+    }
+    EXPECT_TRUE(console.executeString(longLine));
+    EXPECT_TRUE(console.registerAlias("a", longLine));
+    EXPECT_TRUE(console.registerAlias(
+        "b", "count ; count ; count ; count ; count"));
+
+    EXPECT_TRUE(console.executeString("a"));
+    EXPECT_EQ(std::string("40 "), console.getOutputBuffer());
+    EXPECT_TRUE(console.executeString("b"));
+    EXPECT_EQ(std::string("0 0 0 0 0 "), console.getOutputBuffer());
+}
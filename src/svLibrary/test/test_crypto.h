@@ -0,0 +1,177 @@
+#include <cstring>
+
+#include <sv/network/ConnectToken.h>
+#include <sv/network/Crypto.h>
+
+namespace crypto {
+const char SUNSCREEN[] = "Ladies and Gentlemen of the class of '99: If I "
+                         "could offer you only one tip for the future, "
+                         "sunscreen would be it.";
+}
+
+// RFC 8439 section 2.4.2
+TEST(Crypto, ChaCha20) {
+    uint8_t key[32];
+    for (int i = 0; i < 32; ++i) {
+        key[i] = (uint8_t)i;
+    }
+    const uint8_t nonce[12] = {0, 0, 0, 0, 0, 0, 0, 0x4a, 0, 0, 0, 0};
+
+    const uint8_t expected[] = {
+        0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 0x41, 0xba, 0x07, 0x28,
+        0xdd, 0x0d, 0x69, 0x81, 0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2,
+        0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b, 0xf9, 0x1b, 0x65, 0xc5,
+        0x52, 0x47, 0x33, 0xab, 0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57,
+        0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 0x8f, 0x53, 0x0c, 0x35,
+        0x9f, 0x08, 0x61, 0xd8, 0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61,
+        0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e, 0x52, 0xbc, 0x51, 0x4d,
+        0x16, 0xcc, 0xf8, 0x06, 0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36,
+        0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 0xb4, 0x0b, 0x8e, 0xed,
+        0xf2, 0x78, 0x5e, 0x42, 0x87, 0x4d};
+    const size_t size = sizeof(crypto::SUNSCREEN) - 1;
+    EXPECT_EQ(sizeof(expected), size);
+
+    uint8_t output[sizeof(expected)];
+    sv::net::chacha20Xor(key, 1, nonce, (const uint8_t *)crypto::SUNSCREEN,
+                         output, size);
+    EXPECT_EQ(0, memcmp(expected, output, size));
+
+    // Decrypting in place gives back the plaintext
+    sv::net::chacha20Xor(key, 1, nonce, output, output, size);
+    EXPECT_EQ(0, memcmp(crypto::SUNSCREEN, output, size));
+}
+
+// RFC 8439 section 2.5.2
+TEST(Crypto, Poly1305) {
+    const uint8_t key[32] = {0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33,
+                             0x7f, 0x44, 0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8,
+                             0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd,
+                             0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b};
+    const char message[] = "Cryptographic Forum Research Group";
+    const uint8_t expected[16] = {0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51,
+                                  0x36, 0xc6, 0xc2, 0x2b, 0x8b, 0xaf,
+                                  0x0c, 0x01, 0x27, 0xa9};
+
+    uint8_t tag[16];
+    sv::net::poly1305(key, (const uint8_t *)message, sizeof(message) - 1, tag);
+    EXPECT_EQ(0, memcmp(expected, tag, sizeof(tag)));
+
+    // Same result fed in uneven pieces
+    sv::net::Poly1305 mac(key);
+    mac.update((const uint8_t *)message, 5);
+    mac.update((const uint8_t *)message + 5, 20);
+    mac.update((const uint8_t *)message + 25, sizeof(message) - 1 - 25);
+    mac.finish(tag);
+    EXPECT_EQ(0, memcmp(expected, tag, sizeof(tag)));
+}
+
+// RFC 8439 section 2.8.2
+TEST(Crypto, Aead) {
+    uint8_t key[32];
+    for (int i = 0; i < 32; ++i) {
+        key[i] = (uint8_t)(0x80 + i);
+    }
+    const uint8_t nonce[12] = {0x07, 0x00, 0x00, 0x00, 0x40, 0x41,
+                               0x42, 0x43, 0x44, 0x45, 0x46, 0x47};
+    const uint8_t aad[12] = {0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1,
+                             0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7};
+
+    const uint8_t expected[] = {
+        0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc,
+        0x53, 0xef, 0x7e, 0xc2, 0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe,
+        0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6, 0x3d, 0xbe, 0xa4, 0x5e,
+        0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+        0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6,
+        0x7e, 0xcd, 0x3b, 0x36, 0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c,
+        0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58, 0xfa, 0xb3, 0x24, 0xe4,
+        0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+        0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65,
+        0x86, 0xce, 0xc6, 0x4b, 0x61, 0x16};
+    const uint8_t expectedTag[16] = {0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09,
+                                     0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb,
+                                     0xd0, 0x60, 0x06, 0x91};
+    const size_t size = sizeof(crypto::SUNSCREEN) - 1;
+
+    uint8_t ciphertext[sizeof(expected)];
+    uint8_t tag[16];
+    sv::net::aeadEncrypt(key, nonce, aad, sizeof(aad),
+                         (const uint8_t *)crypto::SUNSCREEN, size, ciphertext,
+                         tag);
+    EXPECT_EQ(0, memcmp(expected, ciphertext, size));
+    EXPECT_EQ(0, memcmp(expectedTag, tag, sizeof(tag)));
+
+    uint8_t plaintext[sizeof(expected)];
+    EXPECT_TRUE(sv::net::aeadDecrypt(key, nonce, aad, sizeof(aad), ciphertext,
+                                     size, tag, plaintext));
+    EXPECT_EQ(0, memcmp(crypto::SUNSCREEN, plaintext, size));
+
+    // Any change to the ciphertext, additional data or tag is caught
+    ciphertext[10] ^= 1;
+    EXPECT_FALSE(sv::net::aeadDecrypt(key, nonce, aad, sizeof(aad), ciphertext,
+                                      size, tag, plaintext));
+    ciphertext[10] ^= 1;
+    EXPECT_FALSE(sv::net::aeadDecrypt(key, nonce, aad, sizeof(aad) - 1,
+                                      ciphertext, size, tag, plaintext));
+    tag[15] ^= 0x80;
+    EXPECT_FALSE(sv::net::aeadDecrypt(key, nonce, aad, sizeof(aad), ciphertext,
+                                      size, tag, plaintext));
+}
+
+TEST(Crypto, ReplayProtection) {
+    sv::net::ReplayProtection protection;
+    EXPECT_FALSE(protection.isReplay(0));
+    protection.packetReceived(0);
+    EXPECT_TRUE(protection.isReplay(0));
+
+    // Out of order is fine, but only once
+    protection.packetReceived(5);
+    EXPECT_FALSE(protection.isReplay(3));
+    protection.packetReceived(3);
+    EXPECT_TRUE(protection.isReplay(3));
+    EXPECT_TRUE(protection.isReplay(5));
+
+    // Too old to remember
+    protection.packetReceived(1000);
+    EXPECT_TRUE(protection.isReplay(4));
+    EXPECT_FALSE(protection.isReplay(1000 - sv::net::REPLAY_PROTECTION_WINDOW +
+                                     1));
+
+    protection.reset();
+    EXPECT_FALSE(protection.isReplay(1000));
+}
+
+TEST(Crypto, ConnectToken) {
+    uint8_t privateKey[sv::net::CRYPTO_KEY_SIZE];
+    sv::net::randomBytes(privateKey, sizeof(privateKey));
+
+    const uint32_t protocolId = 0x11112222;
+    const uint64_t expire     = sv::net::getTokenTimestamp() + 30;
+
+    sv::net::ConnectToken token;
+    sv::net::generateConnectToken(privateKey, protocolId, 1234, expire, &token);
+    EXPECT_EQ(expire, token.expireTimestamp);
+
+    sv::net::ConnectTokenPrivate result;
+    EXPECT_TRUE(sv::net::readConnectToken(privateKey, protocolId, expire,
+                                          token.nonce, token.privateData,
+                                          &result));
+    EXPECT_EQ(1234, result.clientId);
+    EXPECT_EQ(0, memcmp(token.clientToServerKey, result.clientToServerKey,
+                        sv::net::CRYPTO_KEY_SIZE));
+    EXPECT_EQ(0, memcmp(token.serverToClientKey, result.serverToClientKey,
+                        sv::net::CRYPTO_KEY_SIZE));
+
+    // Expiry and protocol are bound to the token
+    EXPECT_FALSE(sv::net::readConnectToken(privateKey, protocolId, expire + 1,
+                                           token.nonce, token.privateData,
+                                           &result));
+    EXPECT_FALSE(sv::net::readConnectToken(privateKey, protocolId + 1, expire,
+                                           token.nonce, token.privateData,
+                                           &result));
+
+    uint8_t otherKey[sv::net::CRYPTO_KEY_SIZE];
+    sv::net::randomBytes(otherKey, sizeof(otherKey));
+    EXPECT_FALSE(sv::net::readConnectToken(otherKey, protocolId, expire,
+                                           token.nonce, token.privateData,
+                                           &result));
+}
@@ -1,4 +1,7 @@
+#include <memory>
+
 #include <sv/Engine.h>
+#include <sv/platform/NullPlatform.h>
 
 TEST(Engine, Initialize) {
     sv::Engine engine;
@@ -12,3 +15,97 @@ TEST(Engine, GetMilliseconds) {
     EXPECT_TRUE(engine.initialize());
     EXPECT_TRUE(engine.getMilliseconds() >= 0);
 }
+
+TEST(Engine, InitializeHeadless) {
+    sv::Engine engine;
+    const char *argv[] = {"sv", "--headless"};
+
+    EXPECT_TRUE(engine.initialize(2, (char **)argv));
+    EXPECT_TRUE(engine.getMilliseconds() < 1000);
+}
+
+namespace {
+// Counts ticks and renders, asking the engine to quit after some ticks
+class CountingCallbacks : public sv::EngineCallbacks {
+  public:
+    CountingCallbacks() : numTicks(0), numRenders(0), quitAfterTicks(0) {}
+
+    virtual void tick(sv::Engine &engine, double tickSeconds) {
+        EXPECT_DOUBLE_EQ(tickSeconds, 1.0 / 500.0);
+        ++numTicks;
+        if (numTicks == quitAfterTicks) {
+            engine.quit();
+        }
+    }
+
+    virtual void render(sv::Engine &engine, double alpha) {
+        EXPECT_GE(alpha, 0.0);
+        EXPECT_LT(alpha, 1.0);
+        ++numRenders;
+    }
+
+    int numTicks;
+    int numRenders;
+    int quitAfterTicks;
+};
+}
+
+// Test that paced frames simulate about one tick each
+TEST(Engine, RunPaced) {
+    sv::Engine engine;
+    const char *argv[] = {"sv", "--headless"};
+    EXPECT_TRUE(engine.initialize(2, (char **)argv));
+
+    CountingCallbacks callbacks;
+    sv::EngineRunOptions options;
+    options.tickRate  = 500.0;
+    options.frameRate = 500.0;
+    options.maxFrames = 50;
+
+    sv::TimePoint start = sv::Clock::now();
+    EXPECT_TRUE(engine.run(callbacks, options));
+    int64_t elapsed = sv::Clock::now() - start;
+
+    const sv::EngineRunStats &stats = engine.getRunStats();
+    EXPECT_EQ(stats.numFrames, 50u);
+    EXPECT_EQ(callbacks.numRenders, 50);
+    EXPECT_EQ(stats.numTicks, (uint64_t)callbacks.numTicks);
+    // 50 frames of 2 ms, one tick for each 2 ms that passed between them
+    EXPECT_GE(elapsed, 98000000);
+    EXPECT_GE(callbacks.numTicks, 40);
+    EXPECT_LE(callbacks.numTicks, elapsed / 2000000);
+    EXPECT_GE(stats.total.frame, stats.total.wait);
+    EXPECT_GE(stats.longest.frame, stats.last.frame);
+}
+
+// Test that the loop stops when asked to quit, by game code or the platform
+TEST(Engine, RunQuit) {
+    sv::Engine engine;
+    const char *argv[] = {"sv", "--headless"};
+    EXPECT_TRUE(engine.initialize(2, (char **)argv));
+
+    CountingCallbacks callbacks;
+    callbacks.quitAfterTicks = 10;
+    sv::EngineRunOptions options;
+    options.tickRate  = 500.0;
+    options.frameRate = 1000.0;
+    EXPECT_TRUE(engine.run(callbacks, options));
+    EXPECT_EQ(callbacks.numTicks, 10);
+
+    std::shared_ptr<sv::ScriptedEventSource> script(
+        new sv::ScriptedEventSource());
+    sv::PlatformEvent quit;
+    quit.time = engine.getMilliseconds() + 10;
+    quit.type = sv::PlatformEventType::Quit;
+    script->addEvent(quit);
+    dynamic_cast<sv::NullPlatform &>(engine.getPlatform())
+        .setEventSource(script);
+
+    callbacks.quitAfterTicks = 0;
+    EXPECT_TRUE(engine.run(callbacks));
+    EXPECT_EQ(script->getNumRemainingEvents(), 0u);
+    EXPECT_GE(engine.getMilliseconds(), quit.time);
+
+    options.tickRate = 0.0;
+    EXPECT_FALSE(engine.run(callbacks, options));
+}
@@ -0,0 +1,37 @@
+#include <sv/FixedTimestep.h>
+
+TEST(FixedTimestep, Advance) {
+    sv::FixedTimestep timestep(10, 4);
+
+    EXPECT_EQ(timestep.getTickNanoseconds(), 10);
+    EXPECT_EQ(timestep.advance(0), 0);
+    EXPECT_EQ(timestep.advance(5), 0);
+    EXPECT_DOUBLE_EQ(timestep.getAlpha(), 0.5);
+
+    // Remainders accumulate across frames
+    EXPECT_EQ(timestep.advance(7), 1);
+    EXPECT_DOUBLE_EQ(timestep.getAlpha(), 0.2);
+    EXPECT_EQ(timestep.advance(28), 3);
+    EXPECT_DOUBLE_EQ(timestep.getAlpha(), 0.0);
+
+    // Negative time is ignored
+    EXPECT_EQ(timestep.advance(-100), 0);
+    EXPECT_EQ(timestep.getNumDroppedTicks(), 0u);
+
+    timestep.advance(3);
+    timestep.reset();
+    EXPECT_DOUBLE_EQ(timestep.getAlpha(), 0.0);
+}
+
+// Test that a long frame runs at most the maximum ticks and drops the rest
+TEST(FixedTimestep, SpiralOfDeath) {
+    sv::FixedTimestep timestep(10, 4);
+
+    EXPECT_EQ(timestep.advance(1005), 4);
+    EXPECT_EQ(timestep.getNumDroppedTicks(), 96u);
+    EXPECT_DOUBLE_EQ(timestep.getAlpha(), 0.5);
+
+    // Nothing is owed afterwards
+    EXPECT_EQ(timestep.advance(5), 1);
+    EXPECT_EQ(timestep.getNumDroppedTicks(), 96u);
+}
@@ -0,0 +1,169 @@
+#include <vector>
+
+#include <sv/network/Fragments.h>
+
+namespace fragments {
+// Split \p message into fragments and return the fragments in order
+std::vector<std::vector<uint8_t>> split(const std::vector<uint8_t> &message,
+                                        uint16_t fragmentSize) {
+    std::vector<std::vector<uint8_t>> result;
+    for (size_t offset = 0; offset < message.size(); offset += fragmentSize) {
+        size_t end = offset + fragmentSize;
+        if (end > message.size()) {
+            end = message.size();
+        }
+        result.push_back(std::vector<uint8_t>(message.begin() + offset,
+                                              message.begin() + end));
+    }
+
+    return result;
+}
+
+std::vector<uint8_t> makeMessage(size_t size) {
+    std::vector<uint8_t> message(size);
+    for (size_t i = 0; i < size; ++i) {
+        message[i] = (uint8_t)(i * 7);
+    }
+
+    return message;
+}
+}
+
+TEST(Fragments, NumFragments) {
+    EXPECT_EQ(0, sv::net::getNumFragments(0, 100));
+    EXPECT_EQ(1, sv::net::getNumFragments(100, 100));
+    EXPECT_EQ(2, sv::net::getNumFragments(101, 100));
+}
+
+// Fragments arriving out of order are reassembled into the original message
+TEST(Fragments, ReassembleOutOfOrder) {
+    const uint16_t fragmentSize         = 100;
+    const std::vector<uint8_t> message  = fragments::makeMessage(950);
+    std::vector<std::vector<uint8_t>> f =
+        fragments::split(message, fragmentSize);
+    EXPECT_EQ(10, f.size());
+
+    sv::net::FragmentReassembly reassembly;
+    std::vector<uint8_t> out;
+    for (size_t i = f.size(); i-- > 1;) {
+        EXPECT_FALSE(reassembly.addFragment(7, (uint8_t)i, (uint8_t)f.size(),
+                                            fragmentSize, &f[i][0],
+                                            f[i].size(), &out));
+    }
+    EXPECT_EQ(1, reassembly.getNumPending());
+
+    // Duplicates are ignored
+    EXPECT_FALSE(reassembly.addFragment(7, 3, (uint8_t)f.size(), fragmentSize,
+                                        &f[3][0], f[3].size(), &out));
+
+    EXPECT_TRUE(reassembly.addFragment(7, 0, (uint8_t)f.size(), fragmentSize,
+                                       &f[0][0], f[0].size(), &out));
+    EXPECT_TRUE(out == message);
+    EXPECT_EQ(0, reassembly.getNumPending());
+
+    // Late fragments of a completed message don't start a new one
+    EXPECT_FALSE(reassembly.addFragment(7, 3, (uint8_t)f.size(), fragmentSize,
+                                        &f[3][0], f[3].size(), &out));
+    EXPECT_EQ(0, reassembly.getNumPending());
+}
+
+// Incomplete messages NACK the missing fragments, then time out
+TEST(Fragments, NackAndTimeout) {
+    const uint16_t fragmentSize         = 10;
+    const std::vector<uint8_t> message  = fragments::makeMessage(40);
+    std::vector<std::vector<uint8_t>> f =
+        fragments::split(message, fragmentSize);
+
+    sv::net::FragmentReassembly reassembly(1.0f, 0.1f);
+    reassembly.addFragment(1, 0, 4, fragmentSize, &f[0][0], f[0].size(),
+                           nullptr);
+    reassembly.addFragment(1, 2, 4, fragmentSize, &f[2][0], f[2].size(),
+                           nullptr);
+
+    std::vector<sv::net::FragmentNack> nacks;
+    reassembly.update(0.05f, &nacks);
+    EXPECT_TRUE(nacks.empty());
+
+    reassembly.update(0.06f, &nacks);
+    EXPECT_EQ(1, nacks.size());
+    EXPECT_EQ(1, nacks[0].messageId);
+    EXPECT_FALSE(sv::net::isFragmentBitSet(nacks[0].missing, 0));
+    EXPECT_TRUE(sv::net::isFragmentBitSet(nacks[0].missing, 1));
+    EXPECT_FALSE(sv::net::isFragmentBitSet(nacks[0].missing, 2));
+    EXPECT_TRUE(sv::net::isFragmentBitSet(nacks[0].missing, 3));
+
+    reassembly.update(1.0f, &nacks);
+    EXPECT_EQ(0, reassembly.getNumPending());
+}
+
+// The pool is bounded, the least recently active message makes way
+TEST(Fragments, PoolIsBounded) {
+    sv::net::FragmentReassembly reassembly;
+    const uint8_t data[10] = {0};
+
+    for (uint16_t id = 0; id < sv::net::FRAGMENT_POOL_SIZE + 4; ++id) {
+        reassembly.addFragment(id, 0, 2, sizeof(data), data, sizeof(data),
+                               nullptr);
+        reassembly.update(0.01f, nullptr);
+    }
+    EXPECT_EQ(sv::net::FRAGMENT_POOL_SIZE, reassembly.getNumPending());
+}
+
+TEST(Fragments, MalformedFragmentsRejected) {
+    sv::net::FragmentReassembly reassembly;
+    const uint8_t data[10] = {0};
+
+    // Index out of range
+    EXPECT_FALSE(reassembly.addFragment(0, 2, 2, 10, data, 10, nullptr));
+    // Non-last fragment smaller than fragment size
+    EXPECT_FALSE(reassembly.addFragment(0, 0, 2, 10, data, 5, nullptr));
+    // Larger than fragment size
+    EXPECT_FALSE(reassembly.addFragment(0, 1, 2, 5, data, 10, nullptr));
+    EXPECT_EQ(0, reassembly.getNumPending());
+}
+
+// Sizes from the sender can't make the receiver set aside more memory than
+// its limits
+TEST(Fragments, OversizedFragmentsRejected) {
+    sv::net::FragmentReassembly reassembly;
+    reassembly.setLimits(10, 30);
+    const uint8_t data[20] = {0};
+
+    // Fragment larger than the largest fragment size
+    EXPECT_FALSE(reassembly.addFragment(0, 0, 2, 20, data, 20, nullptr));
+    // Message that could be larger than the largest message size
+    EXPECT_FALSE(reassembly.addFragment(1, 0, 4, 10, data, 10, nullptr));
+    EXPECT_EQ(0, reassembly.getNumPending());
+
+    // Within the limits
+    EXPECT_TRUE(reassembly.addFragment(2, 0, 1, 10, data, 10, nullptr));
+    EXPECT_FALSE(reassembly.addFragment(3, 0, 3, 10, data, 10, nullptr));
+    EXPECT_EQ(1, reassembly.getNumPending());
+}
+
+TEST(Fragments, SendBuffer) {
+    const std::vector<uint8_t> message = fragments::makeMessage(25);
+    sv::net::FragmentSendBuffer sendBuffer;
+
+    uint16_t id = sendBuffer.addMessage(&message[0], message.size(), 10);
+
+    const uint8_t *data   = nullptr;
+    size_t size           = 0;
+    uint8_t numFragments  = 0;
+    uint16_t fragmentSize = 0;
+    EXPECT_TRUE(sendBuffer.getFragment(id, 2, &data, &size, &numFragments,
+                                       &fragmentSize));
+    EXPECT_EQ(5, size);
+    EXPECT_EQ(3, numFragments);
+    EXPECT_EQ(10, fragmentSize);
+    EXPECT_EQ(message[20], data[0]);
+    EXPECT_FALSE(sendBuffer.getFragment(id, 3, &data, &size, &numFragments,
+                                        &fragmentSize));
+
+    // Oldest messages are replaced
+    for (size_t i = 0; i < sv::net::FRAGMENT_SEND_BUFFER_SIZE; ++i) {
+        sendBuffer.addMessage(&message[0], message.size(), 10);
+    }
+    EXPECT_FALSE(sendBuffer.getFragment(id, 0, &data, &size, &numFragments,
+                                        &fragmentSize));
+}
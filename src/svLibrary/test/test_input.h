@@ -65,3 +65,183 @@ TEST(Input, UnbindAllCmd) {
     EXPECT_TRUE(console.executeString("unbindall"));
     EXPECT_TRUE(std::string("") == input.getBinding("KEY_W"));
 }
+
+TEST(Input, BindKeycode) {
+    sv::Input input;
+
+    EXPECT_TRUE(input.bind(sv::Keycodes::Enum::KEY_W, "+forward"));
+    ASSERT_TRUE(input.findBinding(sv::Keycodes::Enum::KEY_W) != nullptr);
+    EXPECT_EQ(sv::Keycodes::Enum::KEY_W,
+              input.findBinding(sv::Keycodes::Enum::KEY_W)->keycode);
+    EXPECT_TRUE(input.findBinding(sv::Keycodes::Enum::KEY_S) == nullptr);
+    EXPECT_EQ(std::string("+forward"), input.getBinding("KEY_W"));
+    EXPECT_EQ(std::string("+forward"), input.getBinding("key_w"));
+
+    EXPECT_TRUE(input.bind("KEY_MOUSE1", "+attack"));
+    EXPECT_TRUE(input.findBinding(sv::Keycodes::Enum::KEY_MOUSE1) != nullptr);
+
+    EXPECT_FALSE(input.bind("KEY_NOPE", "+jump"));
+    EXPECT_FALSE(input.bind(sv::Keycodes::Enum::KEY_LAST, "+jump"));
+    EXPECT_TRUE(input.findBinding("KEY_NOPE") == nullptr);
+}
+
+TEST(Input, BindCmdErrors) {
+    sv::Input input;
+    std::shared_ptr<sv::BindCommand> bindCmd(new sv::BindCommand(input));
+    sv::Console console;
+
+    console.registerCommand("bind", bindCmd);
+    EXPECT_FALSE(console.executeString("bind KEY_NOPE +forward"));
+    EXPECT_FALSE(console.getErrorBuffer().empty());
+
+    // Invalid input leaves the binding as it was
+    EXPECT_TRUE(console.executeString("bind KEY_W +forward"));
+    EXPECT_FALSE(console.executeString("bind KEY_W \"+left ; ;\""));
+    EXPECT_FALSE(console.getErrorBuffer().empty());
+    EXPECT_EQ(std::string("+forward"), input.getBinding("KEY_W"));
+}
+
+namespace sv {
+// Counts how many times it is executed
+class PressCmd : public ConsoleCommand {
+  public:
+    PressCmd() : count(0) {}
+
+    virtual bool execute(Console &console, int argc, char *argv[]) {
+        ++count;
+        return true;
+    }
+
+    int count;
+};
+}
+
+// Test that bound keys execute their commands without parsing them again
+TEST(Input, Execute) {
+    sv::Input input;
+    std::shared_ptr<sv::BindCommand> bindCmd(new sv::BindCommand(input));
+    std::shared_ptr<sv::PressCmd> pressCmd(new sv::PressCmd);
+    sv::Console console;
+
+    console.registerCommand("bind", bindCmd);
+    console.registerCommand("press", pressCmd);
+
+    EXPECT_TRUE(input.bind(sv::Keycodes::Enum::KEY_W, "press ; press"));
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(input.execute(sv::Keycodes::Enum::KEY_W, console));
+    }
+    EXPECT_EQ(6, pressCmd->count);
+    EXPECT_EQ(0, console.getNumLineCacheHits());
+
+    EXPECT_FALSE(input.execute(sv::Keycodes::Enum::KEY_A, console));
+
+    // A binding that rebinds its own key finishes the old commands
+    EXPECT_TRUE(
+        console.executeString("bind KEY_Q \"bind KEY_Q press ; press\""));
+    EXPECT_TRUE(input.execute(sv::Keycodes::Enum::KEY_Q, console));
+    EXPECT_EQ(7, pressCmd->count);
+    EXPECT_EQ(std::string("press"), input.getBinding("KEY_Q"));
+    EXPECT_TRUE(input.execute(sv::Keycodes::Enum::KEY_Q, console));
+    EXPECT_EQ(8, pressCmd->count);
+
+    // Bound to a command that doesn't exist
+    EXPECT_TRUE(input.bind(sv::Keycodes::Enum::KEY_E, "use"));
+    EXPECT_FALSE(input.execute(sv::Keycodes::Enum::KEY_E, console));
+}
+
+// Test that actions are held while any press of them is held, and remembered
+// as pressed or released until the next frame
+TEST(Input, Actions) {
+    sv::Input input;
+
+    const int forward = input.registerAction("forward");
+    const int jump    = input.registerAction("jump");
+    EXPECT_LE(0, forward);
+    EXPECT_NE(forward, jump);
+    EXPECT_EQ(forward, input.registerAction("forward"));
+    EXPECT_EQ(jump, input.findAction("jump"));
+    EXPECT_GT(0, input.findAction("back"));
+
+    input.pressAction(forward);
+    input.pressAction(forward);
+    EXPECT_TRUE(input.isActionDown(forward));
+    EXPECT_TRUE(input.wasActionPressed(forward));
+    EXPECT_TRUE(input.getActionsDown()[forward]);
+    EXPECT_FALSE(input.isActionDown(jump));
+
+    input.beginFrame();
+    input.releaseAction(forward);
+    EXPECT_TRUE(input.isActionDown(forward));
+    EXPECT_FALSE(input.wasActionPressed(forward));
+    input.releaseAction(forward);
+    EXPECT_FALSE(input.isActionDown(forward));
+    EXPECT_TRUE(input.wasActionReleased(forward));
+
+    // Pressed and released within a frame
+    input.beginFrame();
+    input.pressAction(jump);
+    input.releaseAction(jump);
+    EXPECT_FALSE(input.isActionDown(jump));
+    EXPECT_TRUE(input.wasActionPressed(jump));
+    EXPECT_TRUE(input.wasActionReleased(jump));
+
+    // Releasing more than pressed, and unknown actions, change nothing
+    input.releaseAction(jump);
+    input.pressAction(-1);
+    input.pressAction(sv::MAX_INPUT_ACTIONS);
+    EXPECT_FALSE(input.isActionDown(-1));
+    EXPECT_EQ(0u, input.getActionsDown().count());
+
+    for (int i = 2; i < sv::MAX_INPUT_ACTIONS; ++i) {
+        EXPECT_EQ(i, input.registerAction("action" + std::to_string(i)));
+    }
+    EXPECT_GT(0, input.registerAction("one_too_many"));
+}
+
+// Test that keys bound to actions hold them without the console, and that
+// other "+command" bindings execute "-command" when released
+TEST(Input, HandleKey) {
+    sv::Input input;
+    sv::Console console;
+    std::shared_ptr<sv::PressCmd> pressCmd(new sv::PressCmd);
+    std::shared_ptr<sv::PressCmd> releaseCmd(new sv::PressCmd);
+    console.registerCommand("press", pressCmd);
+    console.registerCommand("+zoom", pressCmd);
+    console.registerCommand("-zoom", releaseCmd);
+
+    // Bound before the action is registered
+    input.bind(sv::Keycodes::Enum::KEY_W, "+forward");
+    input.bind(sv::Keycodes::Enum::KEY_UPARROW, "+forward");
+    input.bind(sv::Keycodes::Enum::KEY_Z, "+zoom");
+    input.bind(sv::Keycodes::Enum::KEY_E, "press");
+    const int forward = input.registerAction("forward");
+
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_W, true, console));
+    EXPECT_TRUE(input.isActionDown(forward));
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_UPARROW, true,
+                                console));
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_W, false, console));
+    EXPECT_TRUE(input.isActionDown(forward));
+    // Rebinding a held key still releases what it pressed
+    input.bind(sv::Keycodes::Enum::KEY_UPARROW, "press");
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_UPARROW, false,
+                                console));
+    EXPECT_FALSE(input.isActionDown(forward));
+    EXPECT_EQ(0, pressCmd->count);
+
+    // Key repeats are ignored
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_E, true, console));
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_E, true, console));
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_E, false, console));
+    EXPECT_EQ(1, pressCmd->count);
+
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_Z, true, console));
+    EXPECT_EQ(2, pressCmd->count);
+    EXPECT_EQ(0, releaseCmd->count);
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_Z, false, console));
+    EXPECT_EQ(1, releaseCmd->count);
+
+    // Unbound keys do nothing
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_Q, true, console));
+    EXPECT_TRUE(input.handleKey(sv::Keycodes::Enum::KEY_Q, false, console));
+}
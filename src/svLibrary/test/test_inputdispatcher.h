@@ -0,0 +1,104 @@
+#include <cstring>
+#include <memory>
+
+#include <sv/input/InputDispatcher.h>
+
+namespace sv {
+// Hands out events queued by the test
+class QueuePlatform : public Platform {
+  public:
+    virtual bool initialize() { return true; }
+    virtual void shutdown() {}
+    virtual uint32_t getMilliseconds() const { return 0; }
+
+    virtual void startTextInput() {}
+    virtual void stopTextInput() {}
+    virtual bool isTextInputActive() const { return false; }
+
+    void queueKey(Keycodes::Enum keycode, bool down) {
+        PlatformEvent event;
+        event.type   = PlatformEventType::Key;
+        event.value1 = keycode;
+        event.value2 = down ? 1 : 0;
+        queueEvent(event);
+    }
+
+  protected:
+    // Events are queued by the test
+    virtual void pumpEvents() {}
+};
+}
+
+// Test that a frame's events update actions, mouse movement and text input
+TEST(InputDispatcher, Dispatch) {
+    sv::QueuePlatform platform;
+    sv::Input input;
+    sv::Console console;
+    sv::InputDispatcher dispatcher(input, console);
+
+    const int forward = dispatcher.registerAction("forward");
+    const int jump    = dispatcher.registerAction("jump");
+    EXPECT_TRUE(console.commandWithNameExists("+forward"));
+    EXPECT_TRUE(console.commandWithNameExists("-jump"));
+    input.bind(sv::Keycodes::Enum::KEY_W, "+forward");
+    input.bind(sv::Keycodes::Enum::KEY_SPACEBAR, "+jump");
+
+    platform.queueKey(sv::Keycodes::Enum::KEY_W, true);
+    platform.queueKey(sv::Keycodes::Enum::KEY_SPACEBAR, true);
+    platform.queueKey(sv::Keycodes::Enum::KEY_SPACEBAR, false);
+    sv::PlatformEvent mouse;
+    mouse.type   = sv::PlatformEventType::Mouse;
+    mouse.value1 = 3;
+    mouse.value2 = -2;
+    platform.queueEvent(mouse);
+    platform.queueEvent(mouse);
+    platform.queueTextEvent(0, "aa", 2);
+
+    EXPECT_EQ(6u, dispatcher.dispatch(platform));
+    EXPECT_TRUE(input.isActionDown(forward));
+    EXPECT_FALSE(input.isActionDown(jump));
+    EXPECT_TRUE(input.wasActionPressed(jump));
+    EXPECT_EQ(6, dispatcher.getMouseDeltaX());
+    EXPECT_EQ(-4, dispatcher.getMouseDeltaY());
+    EXPECT_EQ(std::string("aa"), dispatcher.getTextInput());
+    EXPECT_FALSE(dispatcher.wasQuitRequested());
+
+    // Next frame starts afresh, held actions stay held
+    EXPECT_EQ(0u, dispatcher.dispatch(platform));
+    EXPECT_TRUE(input.isActionDown(forward));
+    EXPECT_FALSE(input.wasActionPressed(jump));
+    EXPECT_EQ(0, dispatcher.getMouseDeltaX());
+    EXPECT_EQ(std::string(""), dispatcher.getTextInput());
+
+    // Console commands press actions too
+    EXPECT_TRUE(console.executeString("+jump"));
+    EXPECT_TRUE(input.isActionDown(jump));
+    EXPECT_TRUE(console.executeString("-jump"));
+    EXPECT_FALSE(input.isActionDown(jump));
+
+    sv::PlatformEvent quit;
+    quit.type = sv::PlatformEventType::Quit;
+    platform.queueEvent(quit);
+    dispatcher.dispatch(platform);
+    EXPECT_TRUE(dispatcher.wasQuitRequested());
+}
+
+// Test that more events than fit in a batch are all handled
+TEST(InputDispatcher, ManyEvents) {
+    sv::QueuePlatform platform;
+    sv::Input input;
+    sv::Console console;
+    sv::InputDispatcher dispatcher(input, console);
+
+    const int fire = dispatcher.registerAction("fire");
+    input.bind(sv::Keycodes::Enum::KEY_MOUSE1, "+fire");
+
+    const size_t numEvents = sv::INPUT_DISPATCHER_BATCH_SIZE * 2 + 1;
+    for (size_t i = 0; i < numEvents; ++i) {
+        platform.queueKey(sv::Keycodes::Enum::KEY_MOUSE1, i % 2 == 0);
+    }
+
+    EXPECT_EQ(numEvents, dispatcher.dispatch(platform));
+    EXPECT_TRUE(input.isActionDown(fire));
+    EXPECT_TRUE(input.wasActionReleased(fire));
+}
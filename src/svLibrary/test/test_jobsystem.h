@@ -0,0 +1,231 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <sv/job/JobSystem.h>
+
+namespace {
+void addOne(void *data) { ((std::atomic<int> *)data)->fetch_add(1); }
+
+// Data of a job that runs child jobs and waits on them
+struct ParentJobData {
+    sv::JobSystem *jobSystem;
+    std::atomic<int> *numRun;
+    int numChildren;
+};
+
+void runChildren(void *data) {
+    ParentJobData *parent = (ParentJobData *)data;
+    std::vector<sv::Job> children(parent->numChildren,
+                                  sv::Job(&addOne, parent->numRun));
+    sv::JobCounter counter;
+    parent->jobSystem->run(children.data(), children.size(), &counter);
+    parent->jobSystem->wait(counter);
+
+    // Every child finished before the parent
+    EXPECT_TRUE(counter.isDone());
+    parent->numRun->fetch_add(1000);
+}
+
+// Which thread ran a job
+struct ThreadRecord {
+    sv::JobSystem *jobSystem;
+    int threadIndex;
+};
+
+void recordThread(void *data) {
+    ThreadRecord *record = (ThreadRecord *)data;
+    record->threadIndex  = record->jobSystem->getThreadIndex();
+}
+}
+
+TEST(JobSystem, Deque) {
+    sv::JobDeque deque(4);
+    std::atomic<int> value(0);
+
+    sv::QueuedJob job;
+    job.job = sv::Job(&addOne, &value);
+    for (int i = 0; i < 4; ++i) {
+        job.job.data = (void *)(intptr_t)(i + 1);
+        EXPECT_TRUE(deque.push(job));
+    }
+    EXPECT_FALSE(deque.push(job));
+    EXPECT_EQ(deque.getSize(), 4u);
+
+    // Owner takes the newest, thieves the oldest
+    sv::QueuedJob taken;
+    EXPECT_TRUE(deque.pop(&taken));
+    EXPECT_EQ(taken.job.data, (void *)4);
+    EXPECT_TRUE(deque.steal(&taken));
+    EXPECT_EQ(taken.job.data, (void *)1);
+    EXPECT_TRUE(deque.pop(&taken));
+    EXPECT_EQ(taken.job.data, (void *)3);
+    EXPECT_TRUE(deque.pop(&taken));
+    EXPECT_EQ(taken.job.data, (void *)2);
+    EXPECT_FALSE(deque.pop(&taken));
+    EXPECT_FALSE(deque.steal(&taken));
+    EXPECT_EQ(deque.getSize(), 0u);
+}
+
+// Test that each job is taken exactly once while thieves race the owner
+TEST(JobSystem, DequeSteal) {
+    const int numJobs    = 100000;
+    const int numThieves = 3;
+    sv::JobDeque deque(1024);
+    std::vector<std::atomic<int>> taken(numJobs);
+    for (std::atomic<int> &count : taken) {
+        count.store(0);
+    }
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < numThieves; ++i) {
+        thieves.push_back(std::thread([&] {
+            sv::QueuedJob job;
+            while (!done.load()) {
+                if (deque.steal(&job)) {
+                    taken[(intptr_t)job.job.data].fetch_add(1);
+                }
+            }
+        }));
+    }
+
+    sv::QueuedJob job;
+    sv::QueuedJob popped;
+    for (int i = 0; i < numJobs; ++i) {
+        job.job.data = (void *)(intptr_t)i;
+        while (!deque.push(job)) {
+            if (deque.pop(&popped)) {
+                taken[(intptr_t)popped.job.data].fetch_add(1);
+            }
+        }
+        if (i % 3 == 0 && deque.pop(&popped)) {
+            taken[(intptr_t)popped.job.data].fetch_add(1);
+        }
+    }
+    while (deque.pop(&popped)) {
+        taken[(intptr_t)popped.job.data].fetch_add(1);
+    }
+    done.store(true);
+    for (std::thread &thief : thieves) {
+        thief.join();
+    }
+
+    int numWrong = 0;
+    for (std::atomic<int> &count : taken) {
+        numWrong += (count.load() != 1);
+    }
+    EXPECT_EQ(numWrong, 0);
+}
+
+TEST(JobSystem, Run) {
+    std::atomic<int> numRun(0);
+    sv::JobCounter counter;
+
+    // Jobs run at once before the job system is initialized
+    sv::JobSystem jobSystem;
+    jobSystem.run(sv::Job(&addOne, &numRun), &counter);
+    EXPECT_EQ(numRun.load(), 1);
+    EXPECT_TRUE(counter.isDone());
+
+    EXPECT_TRUE(jobSystem.initialize(3));
+    EXPECT_FALSE(jobSystem.initialize(3));
+    EXPECT_EQ(jobSystem.getNumThreads(), 4);
+    EXPECT_EQ(jobSystem.getThreadIndex(), 0);
+
+    // More jobs than fit in a deque
+    std::vector<sv::Job> jobs(10000, sv::Job(&addOne, &numRun));
+    jobSystem.run(jobs.data(), jobs.size(), &counter);
+    jobSystem.wait(counter);
+    EXPECT_EQ(numRun.load(), 10001);
+
+    // Jobs run from a thread outside the job system
+    std::thread outside([&] {
+        EXPECT_LT(jobSystem.getThreadIndex(), 0);
+        for (int i = 0; i < 100; ++i) {
+            jobSystem.run(sv::Job(&addOne, &numRun), &counter);
+        }
+    });
+    outside.join();
+    jobSystem.wait(counter);
+    EXPECT_EQ(numRun.load(), 10101);
+
+    jobSystem.shutdown();
+    EXPECT_EQ(jobSystem.getThreadIndex(), -1);
+}
+
+// Test that jobs waiting on their own jobs finish, even with one thread
+TEST(JobSystem, Dependencies) {
+    for (int numWorkers = 0; numWorkers < 4; numWorkers += 3) {
+        sv::JobSystem jobSystem;
+        EXPECT_TRUE(jobSystem.initialize(numWorkers));
+
+        std::atomic<int> numRun(0);
+        ParentJobData parent;
+        parent.jobSystem   = &jobSystem;
+        parent.numRun      = &numRun;
+        parent.numChildren = 50;
+
+        sv::JobCounter counter;
+        std::vector<sv::Job> parents(20, sv::Job(&runChildren, &parent));
+        jobSystem.run(parents.data(), parents.size(), &counter);
+        jobSystem.wait(counter);
+        EXPECT_EQ(numRun.load(), 20 * 1050);
+    }
+}
+
+TEST(JobSystem, ParallelFor) {
+    sv::JobSystem jobSystem;
+    EXPECT_TRUE(jobSystem.initialize(3));
+
+    std::vector<int> values(100000, 0);
+    sv::parallelFor(jobSystem, values.size(), 1000,
+                    [&](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; ++i) {
+                            values[i] += (int)i;
+                        }
+                    });
+    int numWrong = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        numWrong += (values[i] != (int)i);
+    }
+    EXPECT_EQ(numWrong, 0);
+
+    // Ranges cover the end of a count that isn't a multiple of the grain
+    std::atomic<size_t> total(0);
+    sv::parallelFor(jobSystem, 1001, 100, [&](size_t begin, size_t end) {
+        EXPECT_LE(end - begin, 100u);
+        total.fetch_add(end - begin);
+    });
+    EXPECT_EQ(total.load(), 1001u);
+
+    sv::parallelFor(jobSystem, 0, 100,
+                    [&](size_t begin, size_t end) { total.fetch_add(1); });
+    EXPECT_EQ(total.load(), 1001u);
+}
+
+// Test that jobs queued for the main thread only run on thread 0
+TEST(JobSystem, MainThread) {
+    sv::JobSystem jobSystem;
+    EXPECT_TRUE(jobSystem.initialize(2));
+
+    std::atomic<int> numRun(0);
+    sv::JobCounter counter;
+    std::thread outside([&] {
+        for (int i = 0; i < 10; ++i) {
+            jobSystem.runOnMainThread(sv::Job(&addOne, &numRun), &counter);
+        }
+    });
+    outside.join();
+    EXPECT_EQ(numRun.load(), 0);
+    EXPECT_EQ(counter.get(), 10);
+    EXPECT_EQ(jobSystem.executeMainThreadJobs(), 10u);
+    EXPECT_EQ(numRun.load(), 10);
+    EXPECT_EQ(jobSystem.executeMainThreadJobs(), 0u);
+
+    // Thread 0 runs them while it waits
+    ThreadRecord record = {&jobSystem, -1};
+    jobSystem.runOnMainThread(sv::Job(&recordThread, &record), &counter);
+    jobSystem.wait(counter);
+    EXPECT_EQ(record.threadIndex, 0);
+}
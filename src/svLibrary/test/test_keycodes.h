@@ -352,3 +352,40 @@ TEST(Keycodes, getKeycodeString) {
     expected = "MWheelUp";
     EXPECT_EQ(expected, sv::getKeycodeString(sv::Keycodes::Enum::KEY_MWHEELUP));
 }
+
+// Test that keys are found by name, and that each key has its own index
+TEST(Keycodes, Names) {
+    sv::Keycodes::Enum keycode;
+    ASSERT_TRUE(sv::getKeycodeFromName("KEY_W", &keycode));
+    EXPECT_EQ(sv::Keycodes::Enum::KEY_W, keycode);
+    ASSERT_TRUE(sv::getKeycodeFromName("key_f1", &keycode));
+    EXPECT_EQ(sv::Keycodes::Enum::KEY_F1, keycode);
+    ASSERT_TRUE(sv::getKeycodeFromName("KEY_MWHEELUP", &keycode));
+    EXPECT_EQ(sv::Keycodes::Enum::KEY_MWHEELUP, keycode);
+    EXPECT_FALSE(sv::getKeycodeFromName("KEY_NOPE", &keycode));
+    EXPECT_FALSE(sv::getKeycodeFromName("", &keycode));
+    EXPECT_FALSE(sv::getKeycodeFromName(std::string(64, 'K'), &keycode));
+
+    EXPECT_STREQ("KEY_LEFTGUI",
+                 sv::getKeycodeName(sv::Keycodes::Enum::KEY_LEFTGUI));
+    EXPECT_TRUE(sv::getKeycodeName(sv::Keycodes::Enum::KEY_FIRST) == nullptr);
+    EXPECT_TRUE(sv::getKeycodeName(sv::Keycodes::Enum::KEY_LAST) == nullptr);
+    EXPECT_GT(0, sv::getKeycodeIndex(sv::Keycodes::Enum::KEY_LAST));
+
+    // Every named key has an index, and its name gives it back
+    int numNamed = 0;
+    for (int index = 0; index < sv::NUM_KEYCODE_INDICES; ++index) {
+        sv::Keycodes::Enum key =
+            (index < 128) ? (sv::Keycodes::Enum)index
+                          : (sv::Keycodes::Enum)(0x40000000 + index - 128);
+        EXPECT_EQ(index, sv::getKeycodeIndex(key));
+
+        const char *name = sv::getKeycodeName(key);
+        if (name != nullptr) {
+            ASSERT_TRUE(sv::getKeycodeFromName(name, &keycode));
+            EXPECT_EQ(key, keycode);
+            ++numNamed;
+        }
+    }
+    EXPECT_EQ(107, numNamed);
+}
@@ -0,0 +1,364 @@
+#include <cstring>
+#include <vector>
+
+#include <sv/console/Console.h>
+#include <sv/console/ConsoleCommands.h>
+#include <sv/network/Connection.h>
+#include <sv/network/NetworkSimulator.h>
+
+namespace networksimulator {
+const sv::net::Address destination(127, 0, 0, 1, 30001);
+
+// Send \p count 4 byte packets containing their index, one every \p interval
+// seconds, collecting the indices in the order they are delivered.
+std::vector<uint32_t> sendAndCollect(sv::net::NetworkSimulator &simulator,
+                                     uint32_t count, float interval) {
+    std::vector<uint32_t> delivered;
+
+    for (uint32_t i = 0; i < count + 1000; ++i) {
+        if (i < count) {
+            simulator.sendPacket(destination, &i, sizeof(i));
+        }
+        simulator.update(interval);
+
+        sv::net::Address address;
+        std::vector<uint8_t> data;
+        while (simulator.getNextPacket(&address, &data)) {
+            uint32_t index = 0;
+            memcpy(&index, &data[0], sizeof(index));
+            delivered.push_back(index);
+        }
+    }
+
+    return delivered;
+}
+}
+
+TEST(NetworkSimulator, Disabled) {
+    sv::net::NetworkSimulator simulator;
+    EXPECT_FALSE(simulator.isEnabled());
+
+    const char packet[] = "packet";
+    simulator.sendPacket(networksimulator::destination, packet, sizeof(packet));
+
+    sv::net::Address address;
+    std::vector<uint8_t> data;
+    EXPECT_TRUE(simulator.getNextPacket(&address, &data));
+    EXPECT_EQ(networksimulator::destination, address);
+    EXPECT_EQ(sizeof(packet), data.size());
+    EXPECT_FALSE(simulator.getNextPacket(&address, &data));
+}
+
+TEST(NetworkSimulator, Latency) {
+    sv::net::NetworkConditions conditions;
+    conditions.latency = 0.1f;
+
+    sv::net::NetworkSimulator simulator;
+    simulator.setConditions(conditions);
+    simulator.setEnabled(true);
+
+    const char packet[] = "packet";
+    simulator.sendPacket(networksimulator::destination, packet, sizeof(packet));
+    EXPECT_EQ(1, simulator.getNumPending());
+
+    simulator.update(0.05f);
+    EXPECT_FALSE(simulator.getNextPacket(nullptr, nullptr));
+
+    simulator.update(0.06f);
+    EXPECT_TRUE(simulator.getNextPacket(nullptr, nullptr));
+    EXPECT_EQ(0, simulator.getNumPending());
+}
+
+// Same seed and conditions give exactly the same delivery
+TEST(NetworkSimulator, Deterministic) {
+    sv::net::NetworkConditions conditions;
+    conditions.latency            = 0.05f;
+    conditions.jitter             = 0.02f;
+    conditions.jitterDistribution = sv::net::JitterDistribution::Enum::Normal;
+    conditions.packetLoss         = 0.1f;
+    conditions.duplicates         = 0.05f;
+
+    sv::net::NetworkSimulator a(1234);
+    sv::net::NetworkSimulator b(1234);
+    sv::net::NetworkSimulator c(4321);
+    a.setConditions(conditions);
+    b.setConditions(conditions);
+    c.setConditions(conditions);
+    a.setEnabled(true);
+    b.setEnabled(true);
+    c.setEnabled(true);
+
+    std::vector<uint32_t> deliveredA =
+        networksimulator::sendAndCollect(a, 1000, 0.001f);
+    std::vector<uint32_t> deliveredB =
+        networksimulator::sendAndCollect(b, 1000, 0.001f);
+    std::vector<uint32_t> deliveredC =
+        networksimulator::sendAndCollect(c, 1000, 0.001f);
+
+    EXPECT_TRUE(deliveredA == deliveredB);
+    EXPECT_FALSE(deliveredA == deliveredC);
+
+    // Reseeding starts the same sequence again
+    c.seed(1234);
+    sv::net::NetworkSimulator d(1234);
+    d.setConditions(conditions);
+    d.setEnabled(true);
+    EXPECT_TRUE(networksimulator::sendAndCollect(c, 100, 0.001f) ==
+                networksimulator::sendAndCollect(d, 100, 0.001f));
+}
+
+TEST(NetworkSimulator, PacketLossAndDuplicates) {
+    sv::net::NetworkConditions conditions;
+    conditions.packetLoss = 0.25f;
+    conditions.duplicates = 0.1f;
+
+    sv::net::NetworkSimulator simulator(1);
+    simulator.setConditions(conditions);
+    simulator.setEnabled(true);
+
+    const uint32_t count = 10000;
+    std::vector<uint32_t> delivered =
+        networksimulator::sendAndCollect(simulator, count, 0.001f);
+
+    EXPECT_EQ(count, simulator.getNumSent());
+    EXPECT_EQ(count - simulator.getNumDropped() + simulator.getNumDuplicated(),
+              delivered.size());
+
+    // Roughly the configured rates
+    EXPECT_TRUE(simulator.getNumDropped() > 2200);
+    EXPECT_TRUE(simulator.getNumDropped() < 2800);
+    EXPECT_TRUE(simulator.getNumDuplicated() > 550);
+    EXPECT_TRUE(simulator.getNumDuplicated() < 950);
+}
+
+// Jitter delays packets by different amounts, reordering them
+TEST(NetworkSimulator, JitterReorders) {
+    sv::net::NetworkConditions conditions;
+    conditions.latency = 0.1f;
+    conditions.jitter  = 0.05f;
+
+    sv::net::NetworkSimulator simulator(7);
+    simulator.setConditions(conditions);
+    simulator.setEnabled(true);
+
+    std::vector<uint32_t> delivered =
+        networksimulator::sendAndCollect(simulator, 1000, 0.001f);
+    EXPECT_EQ(1000, delivered.size());
+
+    size_t outOfOrder = 0;
+    for (size_t i = 1; i < delivered.size(); ++i) {
+        if (delivered[i] < delivered[i - 1]) {
+            ++outOfOrder;
+        }
+    }
+    EXPECT_TRUE(outOfOrder > 0);
+}
+
+TEST(NetworkSimulator, Bandwidth) {
+    sv::net::NetworkConditions conditions;
+    conditions.bandwidth = 1000;
+
+    sv::net::NetworkSimulator simulator;
+    simulator.setConditions(conditions);
+    simulator.setEnabled(true);
+
+    // Ten 100 byte packets take a second to get through a 1000 bytes/s link
+    uint8_t packet[100] = {0};
+    for (int i = 0; i < 10; ++i) {
+        simulator.sendPacket(networksimulator::destination, packet,
+                             sizeof(packet));
+    }
+
+    simulator.update(0.51f);
+    int delivered = 0;
+    while (simulator.getNextPacket(nullptr, nullptr)) {
+        ++delivered;
+    }
+    EXPECT_EQ(5, delivered);
+
+    simulator.update(0.5f);
+    while (simulator.getNextPacket(nullptr, nullptr)) {
+        ++delivered;
+    }
+    EXPECT_EQ(10, delivered);
+
+    // Packets that don't fit in the queue are dropped
+    conditions.queueSize = 350;
+    simulator.setConditions(conditions);
+    for (int i = 0; i < 10; ++i) {
+        simulator.sendPacket(networksimulator::destination, packet,
+                             sizeof(packet));
+    }
+    EXPECT_EQ(3, simulator.getNumPending());
+    EXPECT_EQ(7, simulator.getNumDropped());
+}
+
+TEST(NetworkSimulator, Socket) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    sv::net::Socket a, b;
+    const int16_t port1 = 30000;
+    const int16_t port2 = 30001;
+    EXPECT_TRUE(a.open(port1));
+    EXPECT_TRUE(b.open(port2));
+
+    sv::net::NetworkConditions conditions;
+    conditions.latency = 0.1f;
+
+    sv::net::NetworkSimulator simulator;
+    simulator.setConditions(conditions);
+    simulator.setEnabled(true);
+    a.setSimulator(&simulator);
+    EXPECT_EQ(&simulator, a.getSimulator());
+
+    const char packet[] = "packet data";
+    EXPECT_TRUE(
+        a.send(sv::net::Address(127, 0, 0, 1, port2), packet, sizeof(packet)));
+    EXPECT_EQ(1, simulator.getNumPending());
+
+    // Held until simulated latency has passed
+    a.update(0.05f);
+    EXPECT_EQ(1, simulator.getNumPending());
+    a.update(0.06f);
+    EXPECT_EQ(0, simulator.getNumPending());
+
+    bool received = false;
+    for (int i = 0; i < 1000 && !received; ++i) {
+        sv::net::Address sender;
+        char buffer[256];
+        size_t bytesRead = b.receive(sender, buffer, sizeof(buffer));
+        if (bytesRead == sizeof(packet) && strcmp(buffer, packet) == 0) {
+            received = true;
+            EXPECT_EQ(sv::net::Address(127, 0, 0, 1, port1), sender);
+        }
+    }
+    EXPECT_TRUE(received);
+
+    a.close();
+    b.close();
+
+    sv::net::shutdownSockets();
+}
+
+// Fragments lost on the way are recovered by asking for them again
+TEST(NetworkSimulator, ConnectionRecoversLostFragments) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const int16_t serverPort = 30000;
+    const int16_t clientPort = 30001;
+    const int32_t protocolId = 0x11112222;
+    const float deltaTime    = 0.01f;
+    const float timeout      = 1.0f;
+
+    sv::net::Connection client(protocolId, timeout);
+    sv::net::Connection server(protocolId, timeout);
+
+    sv::net::NetworkConditions conditions;
+    conditions.latency    = 0.02f;
+    conditions.packetLoss = 0.3f;
+
+    sv::net::NetworkSimulator simulator(42);
+    simulator.setConditions(conditions);
+    simulator.setEnabled(true);
+    server.setSimulator(&simulator);
+
+    EXPECT_TRUE(client.start(clientPort));
+    EXPECT_TRUE(server.start(serverPort));
+
+    client.connect(sv::net::Address(127, 0, 0, 1, serverPort));
+    server.listen();
+
+    std::vector<uint8_t> payload(20000);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = (uint8_t)(i * 7);
+    }
+
+    bool sent     = false;
+    bool received = false;
+    for (int i = 0; i < 1000 && !received; ++i) {
+        uint8_t clientPacket[] = "client to server";
+        client.sendPacket(clientPacket, sizeof(clientPacket));
+
+        // Payload is sent only once, lost fragments must be resent
+        if (!sent &&
+            server.getState() == sv::net::ConnectionState::Enum::Connected) {
+            EXPECT_TRUE(server.sendPacket(&payload[0], payload.size()));
+            sent = true;
+        }
+
+        while (true) {
+            std::vector<uint8_t> packet(payload.size());
+            size_t bytesRead = client.receivePacket(&packet[0], packet.size());
+            if (bytesRead == 0) {
+                break;
+            }
+            if (bytesRead == payload.size()) {
+                EXPECT_TRUE(packet == payload);
+                received = true;
+            }
+        }
+
+        while (true) {
+            uint8_t packet[256];
+            if (server.receivePacket(packet, sizeof(packet)) == 0) {
+                break;
+            }
+        }
+
+        client.update(deltaTime);
+        server.update(deltaTime);
+    }
+
+    EXPECT_TRUE(sent);
+    EXPECT_TRUE(received);
+    EXPECT_TRUE(simulator.getNumDropped() > 0);
+
+    client.stop();
+    server.stop();
+
+    sv::net::shutdownSockets();
+}
+
+TEST(NetworkSimulator, ConsoleCommand) {
+    sv::net::NetworkSimulator simulator;
+
+    sv::Console console;
+    std::shared_ptr<sv::NetSimCommand> netSimCmd(
+        new sv::NetSimCommand(simulator));
+    console.registerCommand("net_sim", netSimCmd);
+
+    EXPECT_TRUE(console.executeString("net_sim on"));
+    EXPECT_TRUE(simulator.isEnabled());
+
+    EXPECT_TRUE(console.executeString(
+        "net_sim latency 150 ; net_sim jitter 20 ; net_sim loss 5 ; "
+        "net_sim duplicate 1 ; net_sim bandwidth 64000 ; "
+        "net_sim distribution normal"));
+    const sv::net::NetworkConditions &conditions = simulator.getConditions();
+    EXPECT_FLOAT_EQ(0.15f, conditions.latency);
+    EXPECT_FLOAT_EQ(0.02f, conditions.jitter);
+    EXPECT_FLOAT_EQ(0.05f, conditions.packetLoss);
+    EXPECT_FLOAT_EQ(0.01f, conditions.duplicates);
+    EXPECT_EQ(64000, conditions.bandwidth);
+    EXPECT_EQ(sv::net::JitterDistribution::Enum::Normal,
+              conditions.jitterDistribution);
+
+    EXPECT_TRUE(console.executeString("net_sim"));
+    EXPECT_TRUE(console.getOutputBuffer().find("latency 150ms") !=
+                std::string::npos);
+
+    EXPECT_FALSE(console.executeString("net_sim loss 101"));
+    EXPECT_FALSE(console.executeString("net_sim latency fast"));
+    EXPECT_FALSE(console.executeString("net_sim speed 10"));
+    // Too large, or not finite, to convert
+    EXPECT_FALSE(console.executeString("net_sim bandwidth 4294967296"));
+    EXPECT_FALSE(console.executeString("net_sim queue inf"));
+    EXPECT_FALSE(console.executeString("net_sim seed 1e300"));
+    EXPECT_FALSE(console.executeString("net_sim latency inf"));
+    EXPECT_EQ(64000, simulator.getConditions().bandwidth);
+    EXPECT_FALSE(console.getErrorBuffer().empty());
+    EXPECT_FLOAT_EQ(0.05f, simulator.getConditions().packetLoss);
+
+    EXPECT_TRUE(console.executeString("net_sim off"));
+    EXPECT_FALSE(simulator.isEnabled());
+}
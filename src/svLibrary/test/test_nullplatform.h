@@ -0,0 +1,92 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <sv/platform/NullPlatform.h>
+
+TEST(NullPlatform, Milliseconds) {
+    sv::NullPlatform platform;
+
+    EXPECT_TRUE(platform.initialize());
+    uint32_t start = platform.getMilliseconds();
+    EXPECT_LT(start, 1000u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_GE(platform.getMilliseconds(), start + 20);
+
+    EXPECT_FALSE(platform.isTextInputActive());
+    platform.startTextInput();
+    EXPECT_TRUE(platform.isTextInputActive());
+    platform.stopTextInput();
+    EXPECT_FALSE(platform.isTextInputActive());
+
+    // No events without an event source
+    sv::PlatformEvent event;
+    EXPECT_FALSE(platform.getNextEvent(&event));
+    platform.shutdown();
+}
+
+// Test that scripted events arrive once their time has come
+TEST(NullPlatform, ScriptedEvents) {
+    sv::NullPlatform platform;
+    std::shared_ptr<sv::ScriptedEventSource> script(
+        new sv::ScriptedEventSource());
+    platform.setEventSource(script);
+
+    sv::PlatformEvent key;
+    key.type   = sv::PlatformEventType::Key;
+    key.value1 = sv::Keycodes::Enum::KEY_W;
+    key.value2 = 1;
+    script->addEvent(key);
+    script->addTextEvent(0, "hello");
+    sv::PlatformEvent quit;
+    quit.time = 30;
+    quit.type = sv::PlatformEventType::Quit;
+    script->addEvent(quit);
+
+    EXPECT_TRUE(platform.initialize());
+
+    sv::PlatformEvent events[4];
+    ASSERT_EQ(2u, platform.pollEvents(events, 4));
+    EXPECT_EQ(sv::PlatformEventType::Key, events[0].type);
+    EXPECT_EQ(sv::Keycodes::Enum::KEY_W, events[0].value1);
+    EXPECT_EQ(std::string("hello"),
+              std::string(events[1].text, events[1].textLength));
+    EXPECT_EQ(1u, script->getNumRemainingEvents());
+
+    // Quit isn't due yet
+    EXPECT_EQ(0u, platform.pollEvents(events, 4));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    ASSERT_EQ(1u, platform.pollEvents(events, 4));
+    EXPECT_EQ(sv::PlatformEventType::Quit, events[0].type);
+    EXPECT_EQ(0u, script->getNumRemainingEvents());
+
+    platform.setEventSource(nullptr);
+    EXPECT_EQ(0u, platform.pollEvents(events, 4));
+}
+
+// Test that text too large for the text arena is dropped without holding up
+// the events after it
+TEST(NullPlatform, OversizedTextEvent) {
+    sv::NullPlatform platform;
+    std::shared_ptr<sv::ScriptedEventSource> script(
+        new sv::ScriptedEventSource());
+    platform.setEventSource(script);
+
+    script->addTextEvent(0, std::string(sv::PLATFORM_TEXT_ARENA_SIZE + 1, 'a'));
+    sv::PlatformEvent quit;
+    quit.type = sv::PlatformEventType::Quit;
+    script->addEvent(quit);
+
+    EXPECT_TRUE(platform.initialize());
+
+    sv::PlatformEvent events[4];
+    ASSERT_EQ(1u, platform.pollEvents(events, 4));
+    EXPECT_EQ(sv::PlatformEventType::Quit, events[0].type);
+    EXPECT_EQ(0u, script->getNumRemainingEvents());
+    EXPECT_EQ(1u, platform.getNumDroppedEvents());
+
+    EXPECT_EQ(0u, platform.pollEvents(events, 4));
+    EXPECT_EQ(1u, platform.getNumDroppedEvents());
+}
@@ -0,0 +1,122 @@
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include <sv/console/OutputBuffer.h>
+}
+
+namespace {
+// Append everything passed to a std::string
+void appendToString(void *userData, const char *data, size_t size) {
+    ((std::string *)userData)->append(data, size);
+}
+
+std::string outputBufferToString(const svOutputBuffer *buffer) {
+    std::string result;
+    svOutputBufferForEach(buffer, appendToString, &result);
+    return result;
+}
+}
+
+// Ensure a zeroed buffer is empty and uncapped
+TEST(OutputBuffer, Empty) {
+    svOutputBuffer buffer;
+    memset(&buffer, 0, sizeof(buffer));
+
+    EXPECT_EQ(0u, svOutputBufferGetSize(&buffer));
+    char out[4] = "abc";
+    EXPECT_EQ(0u, svOutputBufferCopy(&buffer, out, sizeof(out)));
+    EXPECT_STREQ("", out);
+
+    EXPECT_EQ(5u, svOutputBufferAppend(&buffer, "hello", 5));
+    EXPECT_EQ("hello", outputBufferToString(&buffer));
+    svOutputBufferFree(&buffer);
+}
+
+// Ensure output longer than a chunk is kept whole and in order
+TEST(OutputBuffer, AppendAndPrint) {
+    svOutputBuffer buffer;
+    svOutputBufferInit(&buffer, 0);
+
+    std::string expected;
+    for (int i = 0; i < 2000; ++i) {
+        char line[32];
+        snprintf(line, sizeof(line), "line %d\n", i);
+        expected += line;
+
+        if (i % 2 == 0) {
+            svOutputBufferAppend(&buffer, line, strlen(line));
+        } else {
+            EXPECT_EQ(strlen(line),
+                      svOutputBufferPrint(&buffer, "line %d\n", i));
+        }
+    }
+    // Longer than a chunk in one print
+    std::string longLine(SV_OUTPUT_BUFFER_CHUNK_SIZE * 2 + 7, 'x');
+    svOutputBufferPrint(&buffer, "%s", longLine.c_str());
+    expected += longLine;
+
+    EXPECT_EQ(expected.size(), svOutputBufferGetSize(&buffer));
+    EXPECT_EQ(expected, outputBufferToString(&buffer));
+
+    std::string copy(expected.size() + 1, '\0');
+    EXPECT_EQ(expected.size(),
+              svOutputBufferCopy(&buffer, &copy[0], copy.size()));
+    EXPECT_STREQ(expected.c_str(), copy.c_str());
+
+    // Copy stops at the size of the destination
+    char out[6];
+    EXPECT_EQ(5u, svOutputBufferCopy(&buffer, out, sizeof(out)));
+    EXPECT_STREQ("line ", out);
+
+    // Cleared chunks are reused
+    svOutputBufferChunk *first = buffer.first;
+    svOutputBufferClear(&buffer);
+    EXPECT_EQ(0u, svOutputBufferGetSize(&buffer));
+    EXPECT_EQ("", outputBufferToString(&buffer));
+    svOutputBufferPrint(&buffer, "%d", 42);
+    EXPECT_EQ(first, buffer.first);
+    EXPECT_EQ("42", outputBufferToString(&buffer));
+
+    svOutputBufferFree(&buffer);
+}
+
+// Ensure output past the cap is dropped and counted
+TEST(OutputBuffer, MaxSize) {
+    svOutputBuffer buffer;
+    svOutputBufferInit(&buffer, 8);
+
+    EXPECT_EQ(5u, svOutputBufferAppend(&buffer, "hello", 5));
+    EXPECT_EQ(3u, svOutputBufferPrint(&buffer, " %s", "world"));
+    EXPECT_EQ(0u, svOutputBufferAppend(&buffer, "!", 1));
+    EXPECT_EQ("hello wo", outputBufferToString(&buffer));
+    EXPECT_EQ(4u, svOutputBufferGetNumDropped(&buffer));
+
+    svOutputBufferClear(&buffer);
+    EXPECT_EQ(0u, svOutputBufferGetNumDropped(&buffer));
+
+    svOutputBufferFree(&buffer);
+}
+
+// Ensure output can be streamed as it is written and drained
+TEST(OutputBuffer, Callback) {
+    svOutputBuffer buffer;
+    svOutputBufferInit(&buffer, 4);
+
+    std::string streamed;
+    svOutputBufferSetCallback(&buffer, appendToString, &streamed);
+    svOutputBufferAppend(&buffer, "hello", 5);
+    svOutputBufferPrint(&buffer, " %d", 123);
+    // Streamed output isn't collected or capped
+    EXPECT_EQ("hello 123", streamed);
+    EXPECT_EQ(0u, svOutputBufferGetSize(&buffer));
+
+    svOutputBufferSetCallback(&buffer, NULL, NULL);
+    svOutputBufferAppend(&buffer, "abc", 3);
+    std::string drained;
+    svOutputBufferDrain(&buffer, appendToString, &drained);
+    EXPECT_EQ("abc", drained);
+    EXPECT_EQ(0u, svOutputBufferGetSize(&buffer));
+
+    svOutputBufferFree(&buffer);
+}
@@ -0,0 +1,214 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sv/console/Console.h>
+#include <sv/console/ConsoleCommands.h>
+#include <sv/network/Connection.h>
+#include <sv/network/PacketCapture.h>
+
+namespace packetcapture {
+const char *CAPTURE_PATH = "test_packetcapture.svpc";
+
+// Payloads a connection produced, in order
+typedef std::vector<std::vector<uint8_t>> Payloads;
+
+// Replay a capture into a new server connection
+Payloads replay(uint32_t protocolId, float timeout,
+                sv::net::PacketCaptureReader &reader,
+                sv::net::ConnectionStatistics *stats) {
+    sv::net::Connection server(protocolId, timeout);
+    EXPECT_TRUE(server.startReplay());
+    server.listen();
+
+    Payloads result;
+    sv::net::ConnectionReplay replay(server, reader);
+    std::vector<uint8_t> buffer(server.getMaxPayloadSize());
+    while (!replay.isFinished()) {
+        size_t size = replay.receivePacket(&buffer[0], buffer.size());
+        if (size > 0) {
+            result.push_back(
+                std::vector<uint8_t>(buffer.begin(), buffer.begin() + size));
+        }
+    }
+
+    *stats = server.getStatistics();
+    server.stop();
+
+    return result;
+}
+}
+
+TEST(PacketCapture, WriteAndRead) {
+    sv::net::PacketCapture capture;
+    EXPECT_FALSE(capture.isOpen());
+    EXPECT_TRUE(capture.open(packetcapture::CAPTURE_PATH));
+    EXPECT_TRUE(capture.isOpen());
+
+    const uint8_t v6[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+                            0,    0,    0,    0,    0, 0, 0, 1};
+    const sv::net::Address ipv4(127, 0, 0, 1, 30000);
+    const sv::net::Address ipv6(v6, 30001);
+    const uint8_t first[]  = "first";
+    const uint8_t second[] = "second";
+
+    capture.recordSent(ipv4, first, sizeof(first));
+    capture.recordUpdate(0.016f);
+    capture.recordReceived(ipv6, second, sizeof(second));
+    // Nothing to record
+    capture.recordSent(ipv4, nullptr, 0);
+    EXPECT_EQ(3, capture.getNumRecords());
+    capture.close();
+
+    sv::net::PacketCaptureReader reader;
+    EXPECT_TRUE(reader.open(packetcapture::CAPTURE_PATH));
+
+    sv::net::CaptureRecord record;
+    EXPECT_TRUE(reader.readRecord(&record));
+    EXPECT_EQ(sv::net::CaptureRecordType::Enum::Sent, record.type);
+    EXPECT_EQ(ipv4, record.address);
+    EXPECT_EQ(sizeof(first), record.size);
+    EXPECT_EQ(0, memcmp(first, record.data, record.size));
+    const double firstTime = record.time;
+
+    EXPECT_TRUE(reader.readRecord(&record));
+    EXPECT_EQ(sv::net::CaptureRecordType::Enum::Update, record.type);
+    // Delta time is kept exactly
+    EXPECT_EQ(0.016f, record.deltaTime);
+    EXPECT_TRUE(record.time >= firstTime);
+
+    EXPECT_TRUE(reader.readRecord(&record));
+    EXPECT_EQ(sv::net::CaptureRecordType::Enum::Received, record.type);
+    EXPECT_EQ(ipv6, record.address);
+    EXPECT_EQ(sizeof(second), record.size);
+    EXPECT_EQ(0, memcmp(second, record.data, record.size));
+
+    EXPECT_FALSE(reader.readRecord(&record));
+    EXPECT_FALSE(reader.hasFailed());
+
+    reader.rewind();
+    EXPECT_TRUE(reader.readRecord(&record));
+    EXPECT_EQ(sv::net::CaptureRecordType::Enum::Sent, record.type);
+
+    std::remove(packetcapture::CAPTURE_PATH);
+}
+
+TEST(PacketCapture, CorruptCapture) {
+    sv::net::PacketCaptureReader reader;
+    EXPECT_FALSE(reader.open("does_not_exist.svpc"));
+
+    const uint8_t notCapture[] = "not a capture";
+    EXPECT_FALSE(reader.load(notCapture, sizeof(notCapture)));
+
+    // Datagram record claiming more data than there is
+    const uint8_t cutShort[] = {0x53, 0x56, 0x50, 0x43, 0x00, 0x01, // Header
+                                0x01, 0x00, 0x00, 0x00, 0x00,       // Record
+                                0x01, 0x75, 0x30, 0x7f, 0x00, 0x00, 0x01,
+                                0x00, 0x10, 0xAA};
+    EXPECT_TRUE(reader.load(cutShort, sizeof(cutShort)));
+
+    sv::net::CaptureRecord record;
+    EXPECT_FALSE(reader.readRecord(&record));
+    EXPECT_TRUE(reader.hasFailed());
+}
+
+// A captured session replays to the same payloads the server saw live, every
+// time
+TEST(PacketCapture, ConnectionReplay) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const int16_t serverPort = 30000;
+    const int16_t clientPort = 30001;
+    const int32_t protocolId = 0x11112222;
+    const float deltaTime    = 0.01f;
+    const float timeout      = 1.0f;
+
+    sv::net::Connection client(protocolId, timeout);
+    sv::net::Connection server(protocolId, timeout);
+    EXPECT_TRUE(client.start(clientPort));
+    EXPECT_TRUE(server.start(serverPort));
+    client.connect(sv::net::Address(127, 0, 0, 1, serverPort));
+    server.listen();
+
+    sv::net::PacketCapture capture;
+    EXPECT_TRUE(capture.open(packetcapture::CAPTURE_PATH));
+    server.setCapture(&capture);
+
+    packetcapture::Payloads live;
+    std::vector<uint8_t> buffer(server.getMaxPayloadSize());
+    for (int i = 0; i < 50; ++i) {
+        // Small payloads, with a fragmented one now and then
+        std::vector<uint8_t> payload(i % 10 == 0 ? 3000 : 16, (uint8_t)i);
+        client.sendPacket(&payload[0], payload.size());
+
+        size_t size = 0;
+        while ((size = server.receivePacket(&buffer[0], buffer.size())) > 0) {
+            live.push_back(
+                std::vector<uint8_t>(buffer.begin(), buffer.begin() + size));
+        }
+
+        client.update(deltaTime);
+        server.update(deltaTime);
+    }
+
+    server.setCapture(nullptr);
+    capture.close();
+    sv::net::ConnectionStatistics liveStats = server.getStatistics();
+
+    client.stop();
+    server.stop();
+
+    sv::net::shutdownSockets();
+
+    EXPECT_TRUE(live.size() > 40);
+
+    sv::net::PacketCaptureReader reader;
+    EXPECT_TRUE(reader.open(packetcapture::CAPTURE_PATH));
+
+    sv::net::ConnectionStatistics replayStats;
+    packetcapture::Payloads replayed =
+        packetcapture::replay(protocolId, timeout, reader, &replayStats);
+    EXPECT_FALSE(reader.hasFailed());
+    EXPECT_TRUE(live == replayed);
+    EXPECT_EQ(liveStats.packetsReceived, replayStats.packetsReceived);
+    EXPECT_EQ(liveStats.bytesReceived, replayStats.bytesReceived);
+
+    reader.rewind();
+    EXPECT_TRUE(replayed == packetcapture::replay(protocolId, timeout, reader,
+                                                  &replayStats));
+
+    std::remove(packetcapture::CAPTURE_PATH);
+}
+
+TEST(PacketCapture, ConsoleCommand) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    sv::net::Connection connection(0x11112222, 1.0f);
+    EXPECT_TRUE(connection.start(30000));
+
+    sv::Console console;
+    std::shared_ptr<sv::NetCaptureCommand> netCaptureCmd(
+        new sv::NetCaptureCommand(connection));
+    console.registerCommand("net_capture", netCaptureCmd);
+
+    EXPECT_TRUE(console.executeString("net_capture"));
+    EXPECT_TRUE(console.getOutputBuffer().find("net_capture: off") !=
+                std::string::npos);
+
+    EXPECT_TRUE(console.executeString(std::string("net_capture ") +
+                                      packetcapture::CAPTURE_PATH));
+    connection.update(0.01f);
+    EXPECT_TRUE(console.executeString("net_capture"));
+    EXPECT_TRUE(console.getOutputBuffer().find("net_capture: 1 records") !=
+                std::string::npos);
+
+    EXPECT_TRUE(console.executeString("net_capture off"));
+    EXPECT_FALSE(console.executeString("net_capture a b"));
+
+    connection.stop();
+
+    sv::net::shutdownSockets();
+
+    std::remove(packetcapture::CAPTURE_PATH);
+}
@@ -0,0 +1,103 @@
+#include <cstring>
+#include <string>
+
+#include <sv/platform/Platform.h>
+
+namespace sv {
+// Queues a number of key events and a text event each time it is pumped
+class PumpPlatform : public Platform {
+  public:
+    PumpPlatform() : eventsPerPump(0), numPumps(0) {}
+
+    virtual bool initialize() { return true; }
+    virtual void shutdown() {}
+    virtual uint32_t getMilliseconds() const { return 0; }
+    virtual void startTextInput() {}
+    virtual void stopTextInput() {}
+    virtual bool isTextInputActive() const { return false; }
+
+    size_t eventsPerPump;
+    int numPumps;
+
+  protected:
+    virtual void pumpEvents() {
+        ++numPumps;
+        for (size_t i = 0; i < eventsPerPump; ++i) {
+            PlatformEvent event;
+            event.time   = (uint32_t)i;
+            event.type   = PlatformEventType::Key;
+            event.value1 = (int)i;
+            queueEvent(event);
+        }
+        char text[16];
+        snprintf(text, sizeof(text), "pump%d", numPumps);
+        queueTextEvent(numPumps, text, strlen(text));
+    }
+};
+}
+
+// Test that events come out in order, in bulk or one at a time, and that new
+// events are only fetched once the queue is empty
+TEST(Platform, PollEvents) {
+    sv::PumpPlatform platform;
+    platform.eventsPerPump = 5;
+
+    sv::PlatformEvent events[4];
+    ASSERT_EQ(4u, platform.pollEvents(events, 4));
+    EXPECT_EQ(1, platform.numPumps);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(sv::PlatformEventType::Key, events[i].type);
+        EXPECT_EQ(i, events[i].value1);
+    }
+
+    ASSERT_EQ(2u, platform.pollEvents(events, 4));
+    EXPECT_EQ(4, events[0].value1);
+    EXPECT_EQ(sv::PlatformEventType::TextInput, events[1].type);
+    EXPECT_EQ(std::string("pump1"),
+              std::string(events[1].text, events[1].textLength));
+    EXPECT_EQ(1, platform.numPumps);
+
+    sv::PlatformEvent event;
+    ASSERT_TRUE(platform.getNextEvent(&event));
+    EXPECT_EQ(2, platform.numPumps);
+    EXPECT_EQ(0, event.value1);
+
+    // Nothing more from the operating system
+    platform.eventsPerPump = 0;
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(platform.getNextEvent(&event));
+    }
+    EXPECT_EQ(std::string("pump2"), std::string(event.text, event.textLength));
+    ASSERT_TRUE(platform.getNextEvent(&event));
+    EXPECT_EQ(std::string("pump3"), std::string(event.text, event.textLength));
+    EXPECT_EQ(0u, platform.getNumDroppedEvents());
+}
+
+// Test that a full queue or text arena drops events rather than grow
+TEST(Platform, Full) {
+    sv::PumpPlatform platform;
+    platform.eventsPerPump = sv::PLATFORM_EVENT_QUEUE_SIZE;
+
+    sv::PlatformEvent event;
+    ASSERT_TRUE(platform.getNextEvent(&event));
+    // The text event didn't fit
+    EXPECT_EQ(1u, platform.getNumDroppedEvents());
+
+    // Ring wraps around
+    event.type = sv::PlatformEventType::Quit;
+    EXPECT_TRUE(platform.queueEvent(event));
+    EXPECT_FALSE(platform.queueEvent(event));
+    EXPECT_EQ(2u, platform.getNumDroppedEvents());
+    for (size_t i = 1; i < sv::PLATFORM_EVENT_QUEUE_SIZE; ++i) {
+        ASSERT_TRUE(platform.getNextEvent(&event));
+        EXPECT_EQ((int)i, event.value1);
+    }
+    ASSERT_TRUE(platform.getNextEvent(&event));
+    EXPECT_EQ(sv::PlatformEventType::Quit, event.type);
+
+    std::string text(sv::PLATFORM_TEXT_ARENA_SIZE / 2, 'a');
+    EXPECT_TRUE(platform.queueTextEvent(0, text.data(), text.size()));
+    EXPECT_TRUE(platform.queueTextEvent(0, text.data(), text.size()));
+    EXPECT_FALSE(platform.queueTextEvent(0, "a", 1));
+    EXPECT_EQ(3u, platform.getNumDroppedEvents());
+}
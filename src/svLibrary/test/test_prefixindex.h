@@ -0,0 +1,203 @@
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <string>
+
+extern "C" {
+#include <sv/console/PrefixIndex.h>
+}
+
+// Ensure a zeroed index is empty
+TEST(PrefixIndex, Empty) {
+    svPrefixIndex index;
+    memset(&index, 0, sizeof(index));
+
+    svPrefixIndexMatch matches[4];
+    EXPECT_EQ(0u, svPrefixIndexFind(&index, "echo"));
+    EXPECT_EQ(0u, svPrefixIndexRemove(&index, "echo", 1));
+    EXPECT_EQ(0u, svPrefixIndexGetCount(&index));
+    EXPECT_EQ(0u, svPrefixIndexComplete(&index, "", 1, matches, 4));
+    EXPECT_EQ(0u, svPrefixIndexSearch(&index, "", 1, matches, 4));
+
+    char common[16];
+    EXPECT_EQ(0u, svPrefixIndexGetCommonPrefix(&index, "ec", common,
+                                               sizeof(common)));
+    EXPECT_STREQ("ec", common);
+    svPrefixIndexFree(&index);
+}
+
+// Ensure names are added, found and removed, kind by kind
+TEST(PrefixIndex, InsertFindRemove) {
+    svPrefixIndex index;
+    svPrefixIndexInit(&index);
+
+    char name[16];
+    snprintf(name, sizeof(name), "net_sim");
+    EXPECT_EQ(0, svPrefixIndexInsert(&index, name, 1));
+    EXPECT_EQ(0, svPrefixIndexInsert(&index, "net_stats", 1));
+    EXPECT_EQ(0, svPrefixIndexInsert(&index, "net", 4));
+    EXPECT_EQ(0, svPrefixIndexInsert(&index, "name", 4));
+    // Name is copied
+    name[0] = '\0';
+    EXPECT_EQ(1u, svPrefixIndexFind(&index, "net_sim"));
+    EXPECT_EQ(4u, svPrefixIndexFind(&index, "net"));
+    EXPECT_EQ(0u, svPrefixIndexFind(&index, "net_s"));
+    EXPECT_EQ(0u, svPrefixIndexFind(&index, "n"));
+    EXPECT_EQ(4u, svPrefixIndexGetCount(&index));
+    EXPECT_EQ(3u, svPrefixIndexCountPrefix(&index, "ne"));
+    EXPECT_EQ(2u, svPrefixIndexCountPrefix(&index, "net_"));
+    EXPECT_EQ(0u, svPrefixIndexCountPrefix(&index, "net_x"));
+
+    // A name of two kinds stays until both are removed
+    EXPECT_EQ(0, svPrefixIndexInsert(&index, "net", 1));
+    EXPECT_EQ(5u, svPrefixIndexFind(&index, "net"));
+    EXPECT_EQ(4u, svPrefixIndexGetCount(&index));
+    EXPECT_EQ(5u, svPrefixIndexRemove(&index, "net", 4));
+    EXPECT_EQ(1u, svPrefixIndexFind(&index, "net"));
+    EXPECT_EQ(1u, svPrefixIndexRemove(&index, "net", 1));
+    EXPECT_EQ(0u, svPrefixIndexFind(&index, "net"));
+    EXPECT_EQ(3u, svPrefixIndexGetCount(&index));
+
+    EXPECT_EQ(0u, svPrefixIndexRemove(&index, "net_s", 1));
+    EXPECT_EQ(1u, svPrefixIndexRemove(&index, "net_sim", 1));
+    EXPECT_EQ(1u, svPrefixIndexFind(&index, "net_stats"));
+    EXPECT_EQ(4u, svPrefixIndexFind(&index, "name"));
+    EXPECT_EQ(2u, svPrefixIndexGetCount(&index));
+
+    svPrefixIndexFree(&index);
+    EXPECT_EQ(0u, svPrefixIndexFind(&index, "name"));
+}
+
+// Ensure completion finds names in byte order, stopping at the limit
+TEST(PrefixIndex, Complete) {
+    svPrefixIndex index;
+    svPrefixIndexInit(&index);
+
+    const char *names[] = {"sv_gravity", "sv_cheats", "set",
+                           "sv_maxplayers", "sv_maxrate", "say"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        svPrefixIndexInsert(&index, names[i], (i == 2) ? 2 : 1);
+    }
+
+    svPrefixIndexMatch matches[8];
+    ASSERT_EQ(4u, svPrefixIndexComplete(&index, "sv_", 1, matches, 8));
+    EXPECT_STREQ("sv_cheats", matches[0].name);
+    EXPECT_STREQ("sv_gravity", matches[1].name);
+    EXPECT_STREQ("sv_maxplayers", matches[2].name);
+    EXPECT_STREQ("sv_maxrate", matches[3].name);
+    EXPECT_EQ(9u, matches[0].length);
+
+    ASSERT_EQ(2u, svPrefixIndexComplete(&index, "s", 1, matches, 2));
+    EXPECT_STREQ("say", matches[0].name);
+    EXPECT_STREQ("sv_cheats", matches[1].name);
+
+    // Only names of the given kinds
+    ASSERT_EQ(1u, svPrefixIndexComplete(&index, "s", 2, matches, 8));
+    EXPECT_STREQ("set", matches[0].name);
+
+    // Prefix ending inside an edge
+    ASSERT_EQ(2u, svPrefixIndexComplete(&index, "sv_maxp", 3, matches, 8) +
+                      svPrefixIndexComplete(&index, "sv_maxr", 3, matches, 8));
+    EXPECT_EQ(0u, svPrefixIndexComplete(&index, "sv_x", 3, matches, 8));
+
+    char common[32];
+    EXPECT_EQ(2u, svPrefixIndexGetCommonPrefix(&index, "sv_m", common,
+                                               sizeof(common)));
+    EXPECT_STREQ("sv_max", common);
+    EXPECT_EQ(1u, svPrefixIndexGetCommonPrefix(&index, "sv_g", common,
+                                               sizeof(common)));
+    EXPECT_STREQ("sv_gravity", common);
+    EXPECT_EQ(4u, svPrefixIndexGetCommonPrefix(&index, "sv", common,
+                                               sizeof(common)));
+    EXPECT_STREQ("sv_", common);
+    // Cut short to fit
+    EXPECT_EQ(1u, svPrefixIndexGetCommonPrefix(&index, "sv_g", common, 6));
+    EXPECT_STREQ("sv_gr", common);
+
+    svPrefixIndexFree(&index);
+}
+
+// Ensure fuzzy search ranks tight matches first
+TEST(PrefixIndex, Search) {
+    svPrefixIndex index;
+    svPrefixIndexInit(&index);
+
+    const char *names[] = {"net_sim", "net_stats", "name", "sensitivity",
+                           "noclip", "NetSimulator"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        svPrefixIndexInsert(&index, names[i], 1);
+    }
+
+    svPrefixIndexMatch matches[8];
+    ASSERT_EQ(2u, svPrefixIndexSearch(&index, "nsim", 1, matches, 8));
+    // "NetSimulator" skips 2 bytes, "net_sim" 3
+    EXPECT_STREQ("NetSimulator", matches[0].name);
+    EXPECT_EQ(2, matches[0].score);
+    EXPECT_STREQ("net_sim", matches[1].name);
+    EXPECT_EQ(3, matches[1].score);
+
+    ASSERT_EQ(1u, svPrefixIndexSearch(&index, "nsim", 1, matches, 1));
+    EXPECT_STREQ("NetSimulator", matches[0].name);
+
+    // Equal scores, the shorter name first
+    svPrefixIndexInsert(&index, "net_simulate", 1);
+    ASSERT_EQ(3u, svPrefixIndexSearch(&index, "net_s", 1, matches, 3));
+    EXPECT_STREQ("net_sim", matches[0].name);
+    EXPECT_STREQ("net_stats", matches[1].name);
+    EXPECT_STREQ("net_simulate", matches[2].name);
+
+    EXPECT_EQ(0u, svPrefixIndexSearch(&index, "xyz", 1, matches, 8));
+    EXPECT_EQ(0u, svPrefixIndexSearch(&index, "nsim", 2, matches, 8));
+
+    // Empty pattern matches everything, shortest first
+    ASSERT_EQ(2u, svPrefixIndexSearch(&index, "", 1, matches, 2));
+    EXPECT_STREQ("name", matches[0].name);
+    EXPECT_STREQ("noclip", matches[1].name);
+
+    svPrefixIndexFree(&index);
+}
+
+// Ensure the index stays consistent as many names come and go
+TEST(PrefixIndex, ManyNames) {
+    svPrefixIndex index;
+    svPrefixIndexInit(&index);
+
+    std::set<std::string> expected;
+    char name[32];
+    for (int i = 0; i < 2000; ++i) {
+        snprintf(name, sizeof(name), "cvar_%d_%d", i % 7, i);
+        EXPECT_EQ(0, svPrefixIndexInsert(&index, name, 1));
+        expected.insert(name);
+    }
+    for (int i = 0; i < 2000; i += 3) {
+        snprintf(name, sizeof(name), "cvar_%d_%d", i % 7, i);
+        EXPECT_EQ(1u, svPrefixIndexRemove(&index, name, 1));
+        expected.erase(name);
+    }
+    EXPECT_EQ(expected.size(), svPrefixIndexGetCount(&index));
+
+    // Every name is still there, in order
+    std::vector<svPrefixIndexMatch> matches(expected.size() + 1);
+    ASSERT_EQ(expected.size(),
+              svPrefixIndexComplete(&index, "", 1, matches.data(),
+                                    matches.size()));
+    size_t i = 0;
+    for (const std::string &expectedName : expected) {
+        EXPECT_EQ(expectedName, matches[i].name);
+        ++i;
+    }
+
+    size_t count = 0;
+    for (const std::string &expectedName : expected) {
+        count += expectedName.compare(0, 7, "cvar_3_") == 0;
+    }
+    EXPECT_EQ(count, svPrefixIndexCountPrefix(&index, "cvar_3_"));
+
+    for (const std::string &expectedName : expected) {
+        svPrefixIndexRemove(&index, expectedName.c_str(), 1);
+    }
+    EXPECT_EQ(0u, svPrefixIndexGetCount(&index));
+    EXPECT_EQ(0, index.root.numChildren);
+
+    svPrefixIndexFree(&index);
+}
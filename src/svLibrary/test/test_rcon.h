@@ -0,0 +1,214 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sv/console/Console.h>
+#include <sv/network/Rcon.h>
+#include <sv/network/Sockets.h>
+
+namespace {
+const uint16_t RCON_TEST_PORT = 30200;
+
+// Output its first argument repeated its second argument times
+class RepeatCmd : public sv::ConsoleCommand {
+  public:
+    bool execute(sv::Console &console, int argc, char *argv[]) {
+        if (argc != 3) {
+            return false;
+        }
+
+        int count = std::atoi(argv[2]);
+        for (int i = 0; i < count; ++i) {
+            console.appendToOutputBuffer(argv[1]);
+        }
+        console.appendToErrorBuffer("done");
+
+        return true;
+    }
+};
+
+// Update the server like a game loop until \p done is set
+void updateUntil(sv::net::RconServer &server, std::atomic<bool> &done) {
+    while (!done) {
+        server.update(0.001f);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+}
+
+TEST(Rcon, IsLoopback) {
+    EXPECT_TRUE(sv::net::isLoopback(sv::net::Address(127, 0, 0, 1, 0)));
+    EXPECT_TRUE(sv::net::isLoopback(sv::net::Address(127, 1, 2, 3, 0)));
+    EXPECT_TRUE(sv::net::isLoopback(
+        sv::net::Address(0, 0, 0, 0, 0, 0, 0, 1, (uint16_t)0)));
+    EXPECT_FALSE(sv::net::isLoopback(sv::net::Address(10, 0, 0, 1, 0)));
+    EXPECT_FALSE(sv::net::isLoopback(
+        sv::net::Address(0, 0, 0, 0, 0, 0, 0, 2, (uint16_t)0)));
+    EXPECT_FALSE(sv::net::isLoopback(sv::net::Address()));
+}
+
+TEST(Rcon, Execute) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    sv::Console console;
+    console.registerCommand("echo", std::make_shared<sv::EchoConsoleCmd>());
+    console.registerCommand("fail", std::make_shared<sv::FailCmd>());
+    console.registerCommand("repeat", std::make_shared<RepeatCmd>());
+
+    sv::net::RconServer server(console);
+    EXPECT_FALSE(server.start(RCON_TEST_PORT, ""));
+    EXPECT_TRUE(server.start(RCON_TEST_PORT, "secret"));
+    EXPECT_TRUE(server.isRunning());
+    EXPECT_FALSE(server.start(RCON_TEST_PORT, "secret"));
+
+    // The host's own output isn't touched by remote commands
+    console.appendToOutputBuffer("host output");
+    console.appendToErrorBuffer("host error");
+
+    std::atomic<bool> done(false);
+    bool connected = false;
+    bool executed  = true;
+    sv::net::RconResult echo;
+    sv::net::RconResult fail;
+    sv::net::RconResult repeat;
+    std::thread clientThread([&]() {
+        sv::net::RconClient client;
+        EXPECT_TRUE(client.open());
+        connected = client.connect(
+            sv::net::Address(127, 0, 0, 1, RCON_TEST_PORT), "secret", 2.0f);
+        executed &= client.execute("echo hello", 2.0f, &echo);
+        executed &= client.execute("fail", 2.0f, &fail);
+        // Several chunks of output
+        executed &= client.execute("repeat abcdefghij 500", 2.0f, &repeat);
+        client.close();
+        done = true;
+    });
+    updateUntil(server, done);
+    clientThread.join();
+
+    EXPECT_TRUE(connected);
+    EXPECT_TRUE(executed);
+
+    EXPECT_TRUE(echo.succeeded);
+    EXPECT_EQ("hello", echo.output);
+    EXPECT_EQ("hello", echo.error);
+
+    EXPECT_FALSE(fail.succeeded);
+    EXPECT_EQ("", fail.output);
+    EXPECT_EQ("", fail.error);
+
+    std::string expected;
+    for (int i = 0; i < 500; ++i) {
+        expected += "abcdefghij";
+    }
+    EXPECT_TRUE(repeat.succeeded);
+    EXPECT_EQ(expected, repeat.output);
+    EXPECT_EQ("done", repeat.error);
+
+    EXPECT_EQ(3u, server.getNumCommandsExecuted());
+    EXPECT_EQ("host output", console.getOutputBuffer());
+    EXPECT_EQ("host error", console.getErrorBuffer());
+
+    // Logging out ends the session
+    for (int i = 0; i < 100 && server.getNumSessions() > 0; ++i) {
+        server.update(0.001f);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(0u, server.getNumSessions());
+
+    server.stop();
+    EXPECT_FALSE(server.isRunning());
+
+    sv::net::shutdownSockets();
+}
+
+TEST(Rcon, WrongPassword) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    sv::Console console;
+    sv::net::RconServer server(console);
+    EXPECT_TRUE(server.start(RCON_TEST_PORT, "secret"));
+
+    std::atomic<bool> done(false);
+    bool connected = true;
+    bool executed  = true;
+    std::thread clientThread([&]() {
+        sv::net::RconClient client;
+        EXPECT_TRUE(client.open());
+        connected = client.connect(
+            sv::net::Address(127, 0, 0, 1, RCON_TEST_PORT), "guess", 2.0f);
+        sv::net::RconResult result;
+        executed = client.execute("echo hello", 0.1f, &result);
+        done     = true;
+    });
+    updateUntil(server, done);
+    clientThread.join();
+
+    EXPECT_FALSE(connected);
+    EXPECT_FALSE(executed);
+    EXPECT_EQ(0u, server.getNumSessions());
+    EXPECT_EQ(0u, server.getNumCommandsExecuted());
+
+    sv::net::shutdownSockets();
+}
+
+// Many admins at once share the server's socket
+TEST(Rcon, Sessions) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const size_t numClients  = 4;
+    const int linesPerClient = 20;
+
+    sv::Console console;
+    console.registerCommand("echo", std::make_shared<sv::EchoConsoleCmd>());
+
+    sv::net::RconServer server(console);
+    EXPECT_TRUE(server.start(RCON_TEST_PORT, "secret"));
+
+    std::atomic<int> numLoggedIn(0);
+    std::atomic<int> numCorrect(0);
+    std::atomic<size_t> numFinished(0);
+    std::atomic<bool> done(false);
+    std::atomic<bool> release(false);
+    std::vector<std::thread> clientThreads;
+    for (size_t i = 0; i < numClients; ++i) {
+        clientThreads.push_back(std::thread([&, i]() {
+            sv::net::RconClient client;
+            client.open();
+            if (client.connect(sv::net::Address(127, 0, 0, 1, RCON_TEST_PORT),
+                               "secret", 2.0f)) {
+                ++numLoggedIn;
+            }
+            for (int line = 0; line < linesPerClient; ++line) {
+                std::string text =
+                    std::to_string(i) + "_" + std::to_string(line);
+                sv::net::RconResult result;
+                if (client.execute("echo " + text, 2.0f, &result) &&
+                    result.output == text) {
+                    ++numCorrect;
+                }
+            }
+            // Stay logged in until the sessions have been counted
+            if (++numFinished == numClients) {
+                done = true;
+            }
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }));
+    }
+    updateUntil(server, done);
+    EXPECT_EQ(numClients, server.getNumSessions());
+    release = true;
+    for (size_t i = 0; i < numClients; ++i) {
+        clientThreads[i].join();
+    }
+
+    EXPECT_EQ((int)numClients, numLoggedIn);
+    EXPECT_EQ((int)(numClients * linesPerClient), numCorrect);
+    EXPECT_EQ(numClients * linesPerClient, server.getNumCommandsExecuted());
+
+    sv::net::shutdownSockets();
+}
@@ -46,10 +46,8 @@ TEST(SDL2Platform, GetMilliseconds) {
 //                 break;
 //             }
 //             case sv::PlatformEventType::TextInput: {
-//                 if (event.data != nullptr) {
-//                     std::string str(event.data->begin(), event.data->end());
-//                     std::cout << "Text Received: " << str << std::endl;
-//                 }
+//                 std::string str(event.text, event.textLength);
+//                 std::cout << "Text Received: " << str << std::endl;
 //                 break;
 //             }
 //             default: { break; }
@@ -0,0 +1,243 @@
+#include <vector>
+
+#include <sv/network/Connection.h>
+#include <sv/network/SendScheduler.h>
+
+TEST(TokenBucket, RefillAndDebt) {
+    sv::net::TokenBucket bucket(1000.0f, 100.0f);
+    EXPECT_TRUE(bucket.hasTokens());
+    EXPECT_FLOAT_EQ(100.0f, bucket.getTokens());
+
+    // Can overdraw
+    bucket.consume(300);
+    EXPECT_FALSE(bucket.hasTokens());
+    EXPECT_FLOAT_EQ(-200.0f, bucket.getTokens());
+
+    bucket.update(0.1f);
+    EXPECT_FALSE(bucket.hasTokens());
+    bucket.update(0.15f);
+    EXPECT_TRUE(bucket.hasTokens());
+
+    // Never holds more than its capacity
+    bucket.update(10.0f);
+    EXPECT_FLOAT_EQ(100.0f, bucket.getTokens());
+}
+
+TEST(SendScheduler, UnlimitedByDefault) {
+    sv::net::SendScheduler scheduler;
+    EXPECT_EQ(0, scheduler.getBandwidth());
+    EXPECT_EQ(0, scheduler.getSendRate());
+
+    scheduler.consume(1000000);
+    EXPECT_TRUE(scheduler.canSend(sv::net::SendPriority::Enum::Low));
+}
+
+TEST(SendScheduler, Budget) {
+    sv::net::SendScheduler scheduler;
+    scheduler.setBandwidth(10000);
+    EXPECT_EQ(10000, scheduler.getSendRate());
+
+    EXPECT_TRUE(scheduler.canSend(sv::net::SendPriority::Enum::Normal));
+    scheduler.consume(1200);
+    EXPECT_FALSE(scheduler.canSend(sv::net::SendPriority::Enum::High));
+
+    // Debt of 200 bytes is paid off after 20ms at 10000 bytes/s
+    scheduler.update(0.01f, 0.0f, 0.0f);
+    EXPECT_FALSE(scheduler.canSend(sv::net::SendPriority::Enum::High));
+    scheduler.update(0.011f, 0.0f, 0.0f);
+    EXPECT_TRUE(scheduler.canSend(sv::net::SendPriority::Enum::High));
+}
+
+TEST(SendScheduler, Priorities) {
+    sv::net::SendScheduler scheduler;
+
+    uint8_t low    = 2;
+    uint8_t normal = 1;
+    uint8_t high   = 0;
+    EXPECT_TRUE(scheduler.enqueue(&low, 1, sv::net::SendPriority::Enum::Low));
+    EXPECT_TRUE(
+        scheduler.enqueue(&normal, 1, sv::net::SendPriority::Enum::Normal));
+
+    // Can't jump ahead of waiting messages of the same or higher priority
+    EXPECT_TRUE(scheduler.canSend(sv::net::SendPriority::Enum::High));
+    EXPECT_FALSE(scheduler.canSend(sv::net::SendPriority::Enum::Normal));
+    EXPECT_FALSE(scheduler.canSend(sv::net::SendPriority::Enum::Low));
+
+    EXPECT_TRUE(scheduler.enqueue(&high, 1, sv::net::SendPriority::Enum::High));
+    EXPECT_EQ(3, scheduler.getNumQueued());
+    EXPECT_EQ(3, scheduler.getQueuedBytes());
+
+    // Highest priority first
+    std::vector<uint8_t> data;
+    for (uint8_t expected = 0; expected < 3; ++expected) {
+        EXPECT_TRUE(scheduler.dequeue(&data));
+        EXPECT_EQ(1, data.size());
+        EXPECT_EQ(expected, data[0]);
+    }
+    EXPECT_FALSE(scheduler.dequeue(&data));
+    EXPECT_EQ(0, scheduler.getQueuedBytes());
+}
+
+TEST(SendScheduler, FullQueueDropsLeastImportant) {
+    sv::net::SendScheduler scheduler;
+    scheduler.setMaxQueueSize(300);
+
+    std::vector<uint8_t> message(100);
+    message[0] = 1;
+    EXPECT_TRUE(scheduler.enqueue(&message[0], message.size(),
+                                  sv::net::SendPriority::Enum::Low));
+    message[0] = 2;
+    EXPECT_TRUE(scheduler.enqueue(&message[0], message.size(),
+                                  sv::net::SendPriority::Enum::Normal));
+    message[0] = 3;
+    EXPECT_TRUE(scheduler.enqueue(&message[0], message.size(),
+                                  sv::net::SendPriority::Enum::Low));
+
+    // Oldest low priority message makes room
+    message[0] = 4;
+    EXPECT_TRUE(scheduler.enqueue(&message[0], message.size(),
+                                  sv::net::SendPriority::Enum::High));
+    EXPECT_EQ(1, scheduler.getNumDropped());
+
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> order;
+    while (scheduler.dequeue(&data)) {
+        order.push_back(data[0]);
+    }
+    EXPECT_EQ(3, order.size());
+    EXPECT_EQ(4, order[0]);
+    EXPECT_EQ(2, order[1]);
+    EXPECT_EQ(3, order[2]);
+
+    // Lower priority messages never push out higher priority ones
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(scheduler.enqueue(&message[0], message.size(),
+                                      sv::net::SendPriority::Enum::High));
+    }
+    EXPECT_FALSE(scheduler.enqueue(&message[0], message.size(),
+                                   sv::net::SendPriority::Enum::Low));
+    EXPECT_EQ(3, scheduler.getNumQueued());
+
+    // Larger than the whole queue
+    std::vector<uint8_t> huge(301);
+    EXPECT_FALSE(scheduler.enqueue(&huge[0], huge.size(),
+                                   sv::net::SendPriority::Enum::High));
+}
+
+TEST(SendScheduler, CongestionMode) {
+    sv::net::SendScheduler scheduler;
+    scheduler.setBandwidth(100000);
+    EXPECT_EQ(sv::net::CongestionMode::Enum::Good,
+              scheduler.getCongestionMode());
+
+    // High round trip time drops to a reduced rate
+    scheduler.update(0.1f, 0.5f, 0.0f);
+    EXPECT_EQ(sv::net::CongestionMode::Enum::Bad,
+              scheduler.getCongestionMode());
+    EXPECT_EQ(25000, scheduler.getSendRate());
+
+    // Recovers once conditions have been good for the penalty time
+    const float penaltyTime = scheduler.getPenaltyTime();
+    float elapsed           = 0.0f;
+    while (scheduler.getCongestionMode() ==
+               sv::net::CongestionMode::Enum::Bad &&
+           elapsed < 100.0f) {
+        scheduler.update(0.1f, 0.05f, 0.0f);
+        elapsed += 0.1f;
+    }
+    EXPECT_EQ(sv::net::CongestionMode::Enum::Good,
+              scheduler.getCongestionMode());
+    EXPECT_NEAR(penaltyTime, elapsed, 0.2f);
+    EXPECT_EQ(100000, scheduler.getSendRate());
+
+    // Loss going bad again right away doubles the time needed to recover
+    scheduler.update(0.1f, 0.05f, 0.5f);
+    EXPECT_EQ(sv::net::CongestionMode::Enum::Bad,
+              scheduler.getCongestionMode());
+    EXPECT_FLOAT_EQ(penaltyTime * 2.0f, scheduler.getPenaltyTime());
+
+    // Conditions going bad during recovery restart it
+    scheduler.update(penaltyTime, 0.05f, 0.0f);
+    scheduler.update(0.1f, 0.5f, 0.0f);
+    scheduler.update(penaltyTime, 0.05f, 0.0f);
+    EXPECT_EQ(sv::net::CongestionMode::Enum::Bad,
+              scheduler.getCongestionMode());
+}
+
+// A connection with a bandwidth budget spreads a burst out over time
+TEST(SendScheduler, ConnectionBandwidth) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const int16_t serverPort = 30000;
+    const int16_t clientPort = 30001;
+    const int32_t protocolId = 0x11112222;
+    const float deltaTime    = 0.01f;
+    const float timeout      = 1.0f;
+
+    sv::net::Connection client(protocolId, timeout);
+    sv::net::Connection server(protocolId, timeout);
+    EXPECT_TRUE(client.start(clientPort));
+    EXPECT_TRUE(server.start(serverPort));
+    client.connect(sv::net::Address(127, 0, 0, 1, serverPort));
+    server.listen();
+
+    server.setBandwidth(20000);
+    EXPECT_EQ(20000, server.getBandwidth());
+
+    int numSent          = 0;
+    int numReceived      = 0;
+    int receivedAtSecond = 0;
+    bool highReceived    = false;
+    int normalBeforeHigh = 0;
+    for (int i = 0; i < 500; ++i) {
+        uint8_t clientPacket[] = "client to server";
+        client.sendPacket(clientPacket, sizeof(clientPacket));
+
+        if (numSent == 0 &&
+            server.getState() == sv::net::ConnectionState::Enum::Connected) {
+            // Burst of 40 1000 byte payloads, then an urgent one
+            std::vector<uint8_t> payload(1000, 1);
+            for (; numSent < 40; ++numSent) {
+                EXPECT_TRUE(server.sendPacket(&payload[0], payload.size()));
+            }
+            payload[0] = 2;
+            EXPECT_TRUE(server.sendPacket(&payload[0], payload.size(),
+                                          sv::net::SendPriority::Enum::High));
+            EXPECT_TRUE(server.getStatistics().queuedMessages > 30);
+        }
+
+        uint8_t packet[2048];
+        size_t bytesRead = 0;
+        while ((bytesRead = client.receivePacket(packet, sizeof(packet))) > 0) {
+            if (bytesRead == 1000) {
+                if (packet[0] == 2) {
+                    highReceived = true;
+                } else if (!highReceived) {
+                    ++normalBeforeHigh;
+                }
+                ++numReceived;
+            }
+        }
+        while (server.receivePacket(packet, sizeof(packet)) > 0) {
+        }
+
+        client.update(deltaTime);
+        server.update(deltaTime);
+
+        if (numSent > 0 && ++receivedAtSecond == 100) {
+            // About a second's worth of the budget has arrived
+            EXPECT_TRUE(numReceived > 10);
+            EXPECT_TRUE(numReceived < 30);
+        }
+    }
+
+    EXPECT_EQ(41, numReceived);
+    EXPECT_TRUE(highReceived);
+    EXPECT_TRUE(normalBeforeHigh < 5);
+    EXPECT_EQ(0, server.getStatistics().queuedMessages);
+
+    client.stop();
+    server.stop();
+
+    sv::net::shutdownSockets();
+}
@@ -0,0 +1,215 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <sv/network/ShardedServer.h>
+#include <sv/network/Sockets.h>
+
+namespace {
+// Echoes every packet back and counts clients
+class EchoHandler : public sv::net::ShardedServerHandler {
+  public:
+    EchoHandler() : connected(0), disconnected(0), packets(0) {}
+
+    virtual void onClientConnected(sv::net::ShardWorker &,
+                                   sv::net::ShardClient &) {
+        ++connected;
+    }
+
+    virtual void onPacket(sv::net::ShardWorker &worker,
+                          sv::net::ShardClient &client, const uint8_t *data,
+                          size_t size) {
+        ++packets;
+        worker.send(client.address, data, size);
+    }
+
+    virtual void onClientDisconnected(sv::net::ShardWorker &,
+                                      sv::net::ShardClient &) {
+        ++disconnected;
+    }
+
+    std::atomic<int> connected;
+    std::atomic<int> disconnected;
+    std::atomic<int> packets;
+};
+
+// Wait up to a second for a condition to hold
+template <typename Condition> bool waitFor(Condition condition) {
+    for (int i = 0; i < 100; ++i) {
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    return condition();
+}
+}
+
+TEST(ShardedServer, ReusePort) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const uint16_t port = 30000;
+
+    sv::net::Socket first;
+    sv::net::Socket second;
+    EXPECT_TRUE(first.open(port, true));
+    EXPECT_TRUE(second.open(port, true));
+
+    // Without the option the port is taken
+    sv::net::Socket third;
+    EXPECT_FALSE(third.open(port));
+
+    first.close();
+    second.close();
+
+    sv::net::shutdownSockets();
+}
+
+TEST(ShardedServer, Wait) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    sv::net::Socket receiver;
+    sv::net::Socket sender;
+    EXPECT_TRUE(receiver.open(30000));
+    EXPECT_TRUE(sender.open(30001));
+
+    EXPECT_FALSE(receiver.wait(0.01f));
+
+    uint8_t data = 1;
+    EXPECT_TRUE(sender.send(sv::net::Address(127, 0, 0, 1, 30000), &data, 1));
+    EXPECT_TRUE(receiver.wait(1.0f));
+
+    receiver.close();
+    sender.close();
+
+    sv::net::shutdownSockets();
+}
+
+TEST(ShardedServer, ClientsSpreadAcrossWorkers) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const uint16_t port        = 30000;
+    const size_t numWorkers    = 2;
+    const size_t numClients    = 8;
+    const int packetsPerClient = 10;
+    const float timeout        = 0.2f;
+
+    EchoHandler handler;
+    sv::net::ShardedServer server(timeout);
+    EXPECT_TRUE(server.start(port, numWorkers, &handler));
+    EXPECT_TRUE(server.isRunning());
+    EXPECT_EQ(numWorkers, server.getNumWorkers());
+    EXPECT_FALSE(server.start(port, numWorkers, &handler));
+
+    std::vector<sv::net::Socket> clients(numClients);
+    for (size_t i = 0; i < numClients; ++i) {
+        EXPECT_TRUE(clients[i].open((uint16_t)(port + 1 + i)));
+    }
+
+    const sv::net::Address serverAddress(127, 0, 0, 1, port);
+    for (int packet = 0; packet < packetsPerClient; ++packet) {
+        for (size_t i = 0; i < numClients; ++i) {
+            uint8_t data[2] = {(uint8_t)i, (uint8_t)packet};
+            EXPECT_TRUE(clients[i].send(serverAddress, data, sizeof(data)));
+        }
+    }
+
+    EXPECT_TRUE(waitFor([&]() {
+        return server.getPacketsReceived() == numClients * packetsPerClient;
+    }));
+    EXPECT_EQ(numClients * packetsPerClient * 2, server.getBytesReceived());
+    EXPECT_EQ(numClients, server.getNumClients());
+    EXPECT_EQ((int)numClients, handler.connected);
+
+    // Each client belongs to exactly one worker
+    size_t workerClients   = 0;
+    uint64_t workerPackets = 0;
+    for (size_t i = 0; i < numWorkers; ++i) {
+        EXPECT_EQ(i, server.getWorker(i).getIndex());
+        workerClients += server.getWorker(i).getNumClients();
+        workerPackets += server.getWorker(i).getPacketsReceived();
+    }
+    EXPECT_EQ(numClients, workerClients);
+    EXPECT_EQ(numClients * packetsPerClient, workerPackets);
+
+    // Replies come back from the port the clients sent to
+    for (size_t i = 0; i < numClients; ++i) {
+        int numReplies = 0;
+        EXPECT_TRUE(waitFor([&]() {
+            sv::net::Address sender;
+            uint8_t data[2];
+            while (clients[i].receive(sender, data, sizeof(data)) ==
+                   sizeof(data)) {
+                EXPECT_EQ(serverAddress, sender);
+                EXPECT_EQ(i, data[0]);
+                ++numReplies;
+            }
+            return numReplies == packetsPerClient;
+        }));
+    }
+
+    // Quiet clients are forgotten
+    EXPECT_TRUE(waitFor([&]() { return server.getNumClients() == 0; }));
+    EXPECT_EQ((int)numClients, handler.disconnected);
+
+    // And come back when they send again
+    uint8_t data[2] = {0, 0};
+    EXPECT_TRUE(clients[0].send(serverAddress, data, sizeof(data)));
+    EXPECT_TRUE(waitFor([&]() { return server.getNumClients() == 1; }));
+
+    server.stop();
+    EXPECT_FALSE(server.isRunning());
+    EXPECT_EQ((int)numClients + 1, handler.disconnected);
+
+    for (size_t i = 0; i < numClients; ++i) {
+        clients[i].close();
+    }
+
+    sv::net::shutdownSockets();
+}
+
+TEST(ShardedServer, MaxClientsPerWorker) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    const uint16_t port     = 30000;
+    const size_t numClients = 4;
+    const size_t maxClients = 2;
+    const float timeout     = 1.0f;
+
+    EchoHandler handler;
+    sv::net::ShardedServer server(timeout, maxClients);
+    EXPECT_TRUE(server.start(port, 1, &handler));
+
+    std::vector<sv::net::Socket> clients(numClients);
+    for (size_t i = 0; i < numClients; ++i) {
+        EXPECT_TRUE(clients[i].open((uint16_t)(port + 1 + i)));
+    }
+
+    // Packets from addresses past the limit are dropped unseen
+    const sv::net::Address serverAddress(127, 0, 0, 1, port);
+    for (size_t i = 0; i < numClients; ++i) {
+        uint8_t data[2] = {(uint8_t)i, 0};
+        EXPECT_TRUE(clients[i].send(serverAddress, data, sizeof(data)));
+        EXPECT_TRUE(waitFor(
+            [&]() { return server.getPacketsReceived() == i + 1; }));
+    }
+    EXPECT_EQ(maxClients, server.getNumClients());
+    EXPECT_EQ(numClients - maxClients, server.getPacketsDropped());
+    EXPECT_EQ((int)maxClients, handler.connected);
+    EXPECT_EQ((int)maxClients, handler.packets);
+
+    // Clients already held still get through
+    uint8_t data[2] = {0, 1};
+    EXPECT_TRUE(clients[0].send(serverAddress, data, sizeof(data)));
+    EXPECT_TRUE(waitFor([&]() { return handler.packets == 3; }));
+
+    server.stop();
+
+    for (size_t i = 0; i < numClients; ++i) {
+        clients[i].close();
+    }
+
+    sv::net::shutdownSockets();
+}
@@ -1,5 +1,6 @@
 #include <cstdio>
 #include <cstring>
+#include <string>
 
 extern "C" {
 #include <sv/console/Shell.h>
@@ -151,6 +152,43 @@ TEST(Shell, WriteToOutputBufferTest) {
     svShellRemoveCommand("echo");
 }
 
+int printLinesFunc(int argc, char **argv) {
+    for (int i = 0; i < 1000; ++i) {
+        svShellPrintOutputBuffer("line %d\n", i);
+    }
+
+    return 0;
+}
+
+// Ensure output longer than a fixed buffer is kept whole
+TEST(Shell, LongOutput) {
+    EXPECT_EQ(0, svShellAddCommand("lines", printLinesFunc));
+    EXPECT_EQ(0, svShellExecute("lines"));
+
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        expected += "line " + std::to_string(i) + "\n";
+    }
+    EXPECT_EQ(expected.size() + 1, svShellGetOutputBufferSize());
+    std::string outBuffer(svShellGetOutputBufferSize(), '\0');
+    svShellGetOutputBuffer(&outBuffer[0]);
+    EXPECT_STREQ(expected.c_str(), outBuffer.c_str());
+
+    // Streamed instead of collected
+    std::string streamed;
+    svShellSetOutputCallback(
+        [](void *userData, const char *data, size_t size) {
+            ((std::string *)userData)->append(data, size);
+        },
+        &streamed);
+    EXPECT_EQ(0, svShellExecute("lines"));
+    svShellSetOutputCallback(NULL, NULL);
+    EXPECT_EQ(expected, streamed);
+    EXPECT_EQ(1u, svShellGetOutputBufferSize());
+
+    svShellRemoveCommand("lines");
+}
+
 int returnsOne(int argc, char **argv) {
     svShellPrintErrorBuffer("Command failed");
     return 1;
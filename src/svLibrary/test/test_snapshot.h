@@ -0,0 +1,228 @@
+#include <memory>
+
+#include <sv/network/Snapshot.h>
+#include <sv/network/Stream.h>
+
+namespace snapshot {
+const uint8_t fieldCount = 8;
+
+// Build a world of \p numEntities entities, entity i has fields i, i + 1, ...
+std::shared_ptr<sv::net::Snapshot> makeWorld(uint32_t sequence,
+                                             uint16_t numEntities) {
+    std::shared_ptr<sv::net::Snapshot> world(
+        new sv::net::Snapshot(fieldCount, sequence));
+    for (uint16_t id = 0; id < numEntities; ++id) {
+        uint32_t fields[fieldCount];
+        for (uint8_t f = 0; f < fieldCount; ++f) {
+            fields[f] = id + f;
+        }
+        world->setEntity(id, fields);
+    }
+
+    return world;
+}
+
+bool snapshotsEqual(const sv::net::Snapshot &a, const sv::net::Snapshot &b) {
+    if (a.getFieldCount() != b.getFieldCount() ||
+        a.getNumEntities() != b.getNumEntities()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.getNumEntities(); ++i) {
+        if (a.getEntityId(i) != b.getEntityId(i) ||
+            memcmp(a.getEntityFields(i), b.getEntityFields(i),
+                   sizeof(uint32_t) * a.getFieldCount()) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+}
+
+TEST(Stream, WriteAndRead) {
+    uint8_t buffer[7];
+    sv::net::WriteStream writer(buffer, sizeof(buffer));
+    writer.writeUint8(0xAB);
+    writer.writeUint16(0x1234);
+    writer.writeUint32(0xDEADBEEF);
+    EXPECT_FALSE(writer.hasFailed());
+    EXPECT_EQ(7, writer.getBytesWritten());
+
+    // Network byte order
+    EXPECT_EQ(0x12, buffer[1]);
+    EXPECT_EQ(0xDE, buffer[3]);
+
+    sv::net::ReadStream reader(buffer, sizeof(buffer));
+    uint8_t a  = 0;
+    uint16_t b = 0;
+    uint32_t c = 0;
+    EXPECT_TRUE(reader.readUint8(&a));
+    EXPECT_TRUE(reader.readUint16(&b));
+    EXPECT_TRUE(reader.readUint32(&c));
+    EXPECT_EQ(0xAB, a);
+    EXPECT_EQ(0x1234, b);
+    EXPECT_EQ(0xDEADBEEF, c);
+
+    // Reading past the end fails and leaves value untouched
+    uint8_t d = 42;
+    EXPECT_FALSE(reader.readUint8(&d));
+    EXPECT_EQ(42, d);
+    EXPECT_TRUE(reader.hasFailed());
+}
+
+TEST(Stream, WriteOverflowFails) {
+    uint8_t buffer[3];
+    sv::net::WriteStream writer(buffer, sizeof(buffer));
+    writer.writeUint16(1);
+    writer.writeUint16(2);
+    EXPECT_TRUE(writer.hasFailed());
+    EXPECT_EQ(2, writer.getBytesWritten());
+}
+
+TEST(Snapshot, SetFindRemoveEntity) {
+    sv::net::Snapshot snapshot(2, 0);
+    const uint32_t a[] = {1, 2};
+    const uint32_t b[] = {3, 4};
+
+    snapshot.setEntity(5, a);
+    snapshot.setEntity(1, b);
+    EXPECT_EQ(2, snapshot.getNumEntities());
+    // Entities are ordered by id
+    EXPECT_EQ(1, snapshot.getEntityId(0));
+    EXPECT_EQ(5, snapshot.getEntityId(1));
+
+    EXPECT_EQ(3, snapshot.findEntity(1)[0]);
+    snapshot.setEntity(1, a);
+    EXPECT_EQ(1, snapshot.findEntity(1)[0]);
+    EXPECT_EQ(2, snapshot.getNumEntities());
+
+    snapshot.removeEntity(1);
+    EXPECT_TRUE(snapshot.findEntity(1) == nullptr);
+    EXPECT_TRUE(snapshot.findEntity(5) != nullptr);
+}
+
+TEST(Snapshot, FloatFields) {
+    EXPECT_EQ(1.5f, sv::net::fieldToFloat(sv::net::floatToField(1.5f)));
+}
+
+// Without an acknowledgement, snapshot is sent in full and read back exactly
+TEST(Snapshot, FullSnapshot) {
+    sv::net::SnapshotSender sender;
+    sv::net::SnapshotReceiver receiver;
+
+    std::shared_ptr<sv::net::Snapshot> world = snapshot::makeWorld(1, 10);
+
+    uint8_t buffer[1024];
+    size_t size = sender.writeSnapshot(world, buffer, sizeof(buffer));
+    EXPECT_TRUE(size > 0);
+
+    sv::net::Snapshot received;
+    EXPECT_TRUE(receiver.readSnapshot(buffer, size, &received));
+    EXPECT_EQ(1, received.getSequence());
+    EXPECT_TRUE(snapshot::snapshotsEqual(*world, received));
+    EXPECT_EQ(1, receiver.getLatestSequence());
+}
+
+// Once acknowledged, only changed fields, added and removed entities are sent
+TEST(Snapshot, DeltaSnapshot) {
+    sv::net::SnapshotSender sender;
+    sv::net::SnapshotReceiver receiver;
+    uint8_t buffer[4096];
+
+    std::shared_ptr<sv::net::Snapshot> first = snapshot::makeWorld(1, 100);
+    size_t fullSize = sender.writeSnapshot(first, buffer, sizeof(buffer));
+    sv::net::Snapshot received;
+    EXPECT_TRUE(receiver.readSnapshot(buffer, fullSize, &received));
+    sender.acknowledge(receiver.getLatestSequence());
+
+    // Change one field of one entity, add one and remove one
+    std::shared_ptr<sv::net::Snapshot> second(new sv::net::Snapshot(*first));
+    second->setSequence(2);
+    uint32_t fields[snapshot::fieldCount] = {0};
+    memcpy(fields, second->findEntity(50), sizeof(fields));
+    fields[3] = 1000;
+    second->setEntity(50, fields);
+    second->setEntity(500, fields);
+    second->removeEntity(7);
+
+    size_t deltaSize = sender.writeSnapshot(second, buffer, sizeof(buffer));
+    EXPECT_TRUE(deltaSize > 0);
+    EXPECT_TRUE(deltaSize * 10 < fullSize);
+
+    EXPECT_TRUE(receiver.readSnapshot(buffer, deltaSize, &received));
+    EXPECT_EQ(2, received.getSequence());
+    EXPECT_TRUE(snapshot::snapshotsEqual(*second, received));
+}
+
+// When the acknowledged snapshot is too old, fall back to a full snapshot
+TEST(Snapshot, StaleBaselineSendsFull) {
+    sv::net::SnapshotSender sender;
+    sv::net::SnapshotReceiver receiver;
+    uint8_t buffer[4096];
+    sv::net::Snapshot received;
+
+    std::shared_ptr<sv::net::Snapshot> first = snapshot::makeWorld(1, 20);
+    size_t fullSize = sender.writeSnapshot(first, buffer, sizeof(buffer));
+    EXPECT_TRUE(receiver.readSnapshot(buffer, fullSize, &received));
+    sender.acknowledge(1);
+
+    // Client stops acknowledging, but keeps receiving
+    size_t size = 0;
+    for (uint32_t seq = 2; seq < 2 + sv::net::SNAPSHOT_HISTORY_SIZE; ++seq) {
+        size = sender.writeSnapshot(snapshot::makeWorld(seq, 20), buffer,
+                                    sizeof(buffer));
+        EXPECT_TRUE(receiver.readSnapshot(buffer, size, &received));
+    }
+
+    // Last snapshot was too far ahead of the acknowledged one to be a delta
+    EXPECT_EQ(fullSize, size);
+}
+
+// A snapshot sent again with the acknowledged sequence isn't encoded against
+// itself, which would read back as a full snapshot missing its entities
+TEST(Snapshot, AcknowledgedSequenceSendsFull) {
+    sv::net::SnapshotSender sender;
+    sv::net::SnapshotReceiver receiver;
+    uint8_t buffer[4096];
+    sv::net::Snapshot received;
+
+    std::shared_ptr<sv::net::Snapshot> first = snapshot::makeWorld(1, 20);
+    size_t fullSize = sender.writeSnapshot(first, buffer, sizeof(buffer));
+    EXPECT_TRUE(receiver.readSnapshot(buffer, fullSize, &received));
+    sender.acknowledge(1);
+
+    std::shared_ptr<sv::net::Snapshot> again(new sv::net::Snapshot(*first));
+    uint32_t fields[snapshot::fieldCount] = {0};
+    memcpy(fields, again->findEntity(5), sizeof(fields));
+    fields[0] = 1000;
+    again->setEntity(5, fields);
+
+    size_t size = sender.writeSnapshot(again, buffer, sizeof(buffer));
+    EXPECT_EQ(fullSize, size);
+    EXPECT_TRUE(receiver.readSnapshot(buffer, size, &received));
+    EXPECT_TRUE(snapshot::snapshotsEqual(*again, received));
+}
+
+// A delta against a baseline the receiver doesn't have is rejected
+TEST(Snapshot, UnknownBaselineRejected) {
+    sv::net::SnapshotSender sender;
+    sv::net::SnapshotReceiver receiver;
+    uint8_t buffer[4096];
+
+    sender.writeSnapshot(snapshot::makeWorld(1, 4), buffer, sizeof(buffer));
+    sender.acknowledge(1);
+    size_t size =
+        sender.writeSnapshot(snapshot::makeWorld(2, 5), buffer, sizeof(buffer));
+
+    sv::net::Snapshot received;
+    EXPECT_FALSE(receiver.readSnapshot(buffer, size, &received));
+    EXPECT_FALSE(receiver.hasReceivedSnapshot());
+
+    // Truncated data is rejected too
+    sender.reset();
+    size =
+        sender.writeSnapshot(snapshot::makeWorld(3, 5), buffer, sizeof(buffer));
+    EXPECT_FALSE(receiver.readSnapshot(buffer, size - 1, &received));
+    EXPECT_TRUE(receiver.readSnapshot(buffer, size, &received));
+}
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <set>
+#include <unordered_set>
 
 #include <sv/System.h>
 #include <sv/network/Sockets.h>
@@ -131,3 +133,96 @@ TEST(Socket, SendAndRecvPackets) {
 
     sv::net::shutdownSockets();
 }
+
+TEST(Address, IPv6) {
+    sv::net::Address address(0x2001, 0xdb8, 0, 0, 0, 0, 0, 1, 30000);
+
+    EXPECT_EQ(sv::net::AddressType::Enum::IPv6, address.getType());
+    EXPECT_TRUE(address.isValid());
+    EXPECT_EQ(0x2001, address.getIPv6Group(0));
+    EXPECT_EQ(0x0db8, address.getIPv6Group(1));
+    EXPECT_EQ(1, address.getIPv6Group(7));
+    EXPECT_EQ(0x20, address.getIPv6()[0]);
+    EXPECT_EQ(0x01, address.getIPv6()[1]);
+    EXPECT_EQ(30000, address.getPort());
+    EXPECT_EQ(0, address.getAddress());
+
+    const uint8_t bytes[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+                               0,    0,    0,    0,    0, 0, 0, 1};
+    EXPECT_EQ(address, sv::net::Address(bytes, 30000));
+    EXPECT_NE(address, sv::net::Address(bytes, 30001));
+
+    // Never equal to an IPv4 address
+    EXPECT_NE(sv::net::Address(0, 0, 0, 0, 0, 0, 0, 1, 30000),
+              sv::net::Address(0, 0, 0, 1, 30000));
+    EXPECT_FALSE(sv::net::Address().isValid());
+    EXPECT_EQ(sv::net::AddressType::Enum::IPv4,
+              sv::net::Address(127, 0, 0, 1, 0).getType());
+}
+
+TEST(Address, ToString) {
+    EXPECT_EQ("127.0.0.1:30000",
+              sv::net::Address(127, 0, 0, 1, 30000).toString());
+    EXPECT_EQ("[::1]:30000",
+              sv::net::Address(0, 0, 0, 0, 0, 0, 0, 1, 30000).toString());
+    EXPECT_EQ("[2001:db8::1:0:0:1]:80",
+              sv::net::Address(0x2001, 0xdb8, 0, 0, 1, 0, 0, 1, 80).toString());
+    EXPECT_EQ("[1:2:3:4:5:6:7:8]:1",
+              sv::net::Address(1, 2, 3, 4, 5, 6, 7, 8, 1).toString());
+}
+
+TEST(Address, HashAndOrder) {
+    std::unordered_set<sv::net::Address> addresses;
+    std::set<sv::net::Address> ordered;
+    for (uint16_t port = 0; port < 100; ++port) {
+        addresses.insert(sv::net::Address(127, 0, 0, 1, port));
+        addresses.insert(sv::net::Address(0, 0, 0, 0, 0, 0, 0, 1, port));
+        ordered.insert(sv::net::Address(127, 0, 0, 1, port));
+        ordered.insert(sv::net::Address(0, 0, 0, 0, 0, 0, 0, 1, port));
+    }
+    EXPECT_EQ(200, addresses.size());
+    EXPECT_EQ(200, ordered.size());
+
+    EXPECT_EQ(1, addresses.count(sv::net::Address(127, 0, 0, 1, 42)));
+    EXPECT_EQ(0, addresses.count(sv::net::Address(127, 0, 0, 2, 42)));
+    EXPECT_EQ(sv::net::Address(10, 0, 0, 1, 5).getHash(),
+              sv::net::Address(10, 0, 0, 1, 5).getHash());
+    EXPECT_NE(sv::net::Address(10, 0, 0, 1, 5).getHash(),
+              sv::net::Address(10, 0, 0, 1, 6).getHash());
+}
+
+TEST(Socket, SendAndRecvIPv6) {
+    EXPECT_TRUE(sv::net::initializeSockets());
+
+    sv::net::Socket a, b;
+    uint16_t port1 = 30000;
+    uint16_t port2 = 30001;
+    EXPECT_TRUE(a.open(port1));
+    EXPECT_TRUE(b.open(port2));
+
+    // Nothing to test on a platform without IPv6
+    if (a.supportsIPv6() && b.supportsIPv6()) {
+        const char packet[] = "packet data";
+        const sv::net::Address loopback(0, 0, 0, 0, 0, 0, 0, 1, port2);
+
+        bool received = false;
+        for (int i = 0; i < 1000 && !received; ++i) {
+            EXPECT_TRUE(a.send(loopback, packet, sizeof(packet)));
+
+            sv::net::Address sender;
+            char buffer[256];
+            size_t bytesRead = b.receive(sender, buffer, sizeof(buffer));
+            if (bytesRead == sizeof(packet) && strcmp(buffer, packet) == 0) {
+                received = true;
+                EXPECT_EQ(sv::net::Address(0, 0, 0, 0, 0, 0, 0, 1, port1),
+                          sender);
+            }
+        }
+        EXPECT_TRUE(received);
+    }
+
+    a.close();
+    b.close();
+
+    sv::net::shutdownSockets();
+}
@@ -486,3 +486,63 @@ TEST(Tokenizer, Valid) {
 
     free(inputLine);
 }
+
+// Test tokenizing in place in a single pass
+TEST(Tokenizer, TokenizeInPlace) {
+    char inputLine[] = "  echo \"Hello World\"  Wo\\ rld\n";
+    char *token[8];
+
+    EXPECT_EQ(3, svTokenizerTokenizeInPlace(inputLine, token, 8, NULL));
+    EXPECT_TRUE(strcmp("echo", token[0]) == 0);
+    EXPECT_TRUE(strcmp("\"Hello World\"", token[1]) == 0);
+    EXPECT_TRUE(strcmp("Wo\\ rld", token[2]) == 0);
+    EXPECT_EQ(NULL, token[3]);
+}
+
+// Test that empty strings are removed when tokenizing in place, leaving an
+// empty token where they were the whole token
+TEST(Tokenizer, TokenizeInPlaceEmptyString) {
+    char inputLine[] = "echo Wo\"\"rld '' ok";
+    char *token[8];
+
+    EXPECT_EQ(4, svTokenizerTokenizeInPlace(inputLine, token, 8, NULL));
+    EXPECT_TRUE(strcmp("echo", token[0]) == 0);
+    EXPECT_TRUE(strcmp("World", token[1]) == 0);
+    EXPECT_TRUE(strcmp("", token[2]) == 0);
+    EXPECT_TRUE(strcmp("ok", token[3]) == 0);
+    EXPECT_EQ(NULL, token[4]);
+}
+
+// Test that an empty quoted argument at the end of the line is kept
+TEST(Tokenizer, TokenizeInPlaceEmptyArgument) {
+    char inputLine[] = "set x \"\"";
+    char *token[8];
+
+    EXPECT_EQ(3, svTokenizerTokenizeInPlace(inputLine, token, 8, NULL));
+    EXPECT_TRUE(strcmp("set", token[0]) == 0);
+    EXPECT_TRUE(strcmp("x", token[1]) == 0);
+    EXPECT_TRUE(strcmp("", token[2]) == 0);
+    EXPECT_EQ(NULL, token[3]);
+}
+
+// Test that tokenizing in place reports strings that are not closed at the
+// same position as 'svTokenizerValidateInput'
+TEST(Tokenizer, TokenizeInPlaceStringNotClosed) {
+    char inputLine[] = "echo \"\" 'Hello World";
+    char *token[8];
+
+    svTokenizerError error;
+    EXPECT_TRUE(svTokenizerTokenizeInPlace(inputLine, token, 8, &error) < 0);
+    EXPECT_EQ(-1, error.errorCode);
+    EXPECT_EQ(8, error.characterPos);
+}
+
+// Test that tokenizing in place never writes past the token array
+TEST(Tokenizer, TokenizeInPlaceTooManyTokens) {
+    char inputLine[] = "a b c d";
+    char *token[3];
+
+    svTokenizerError error;
+    EXPECT_TRUE(svTokenizerTokenizeInPlace(inputLine, token, 3, &error) < 0);
+    EXPECT_EQ(-2, error.errorCode);
+}
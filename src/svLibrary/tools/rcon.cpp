@@ -0,0 +1,105 @@
+//===-- tools/rcon.cpp - Remote console client ------------------*- C++ -*-===//
+//
+//                 The Special Engine Variant Game Engine
+//
+// This file is distributed under the MIT License. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Small command-line client for a game's remote console.
+///
+/// Usage:
+///     svRcon --port PORT --password PASSWORD [--ipv6] [--command LINE]
+///
+/// Executes LINE and exits, or without --command reads lines from standard
+/// input until end of file, printing the output and errors of each.
+///
+//===----------------------------------------------------------------------===//
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <sv/ProgramOptions.h>
+#include <sv/network/Rcon.h>
+
+namespace {
+// Seconds to wait for the server to answer
+const float TIMEOUT = 2.0f;
+
+const char *getArgument(const sv::ProgramOptions &options,
+                        const std::string &option) {
+    int32_t index = options.checkOption(option);
+    return index >= 0 ? options.getOption(index + 1) : nullptr;
+}
+
+bool execute(sv::net::RconClient &client, const std::string &line) {
+    sv::net::RconResult result;
+    if (!client.execute(line, TIMEOUT, &result)) {
+        std::fprintf(stderr, "No reply from server.\n");
+        return false;
+    }
+
+    std::fputs(result.output.c_str(), stdout);
+    std::fputs(result.error.c_str(), stderr);
+    if (!result.error.empty() && result.error.back() != '\n') {
+        std::fputc('\n', stderr);
+    }
+    std::fflush(stdout);
+
+    return result.succeeded;
+}
+}
+
+int main(int argc, const char *argv[]) {
+    sv::ProgramOptions options(argc, argv);
+
+    const char *port     = getArgument(options, "--port");
+    const char *password = getArgument(options, "--password");
+    if (port == nullptr || password == nullptr) {
+        std::fprintf(stderr, "Usage: %s --port PORT --password PASSWORD "
+                             "[--ipv6] [--command LINE]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!sv::net::initializeSockets()) {
+        std::fprintf(stderr, "Failed to initialize sockets.\n");
+        return EXIT_FAILURE;
+    }
+
+    uint16_t serverPort = (uint16_t)std::atoi(port);
+    sv::net::Address server(127, 0, 0, 1, serverPort);
+    if (options.checkOption("--ipv6") >= 0) {
+        server = sv::net::Address(0, 0, 0, 0, 0, 0, 0, 1, serverPort);
+    }
+
+    int status = EXIT_FAILURE;
+    {
+        sv::net::RconClient client;
+        if (!client.open()) {
+            std::fprintf(stderr, "Failed to open socket.\n");
+        } else if (!client.connect(server, password, TIMEOUT)) {
+            std::fprintf(stderr, "Failed to log in to %s.\n",
+                         server.toString().c_str());
+        } else {
+            const char *command = getArgument(options, "--command");
+            if (command != nullptr) {
+                status = execute(client, command) ? EXIT_SUCCESS : EXIT_FAILURE;
+            } else {
+                status = EXIT_SUCCESS;
+                std::string line;
+                while (std::getline(std::cin, line)) {
+                    if (!execute(client, line)) {
+                        status = EXIT_FAILURE;
+                    }
+                }
+            }
+        }
+    }
+
+    sv::net::shutdownSockets();
+
+    return status;
+}